@@ -7,6 +7,7 @@
 
 #include "catch.hpp"
 #include "../src/SystemComponents/WaterSources/AllocatedReservoir.h"
+#include "../src/SystemComponents/WaterSources/Quarry.h"
 #include "../src/SystemComponents/WaterSources/WaterReuse.h"
 #include "../src/SystemComponents/Bonds/LevelDebtServiceBond.h"
 #include "../src/SystemComponents/Utility/Utility.h"
@@ -22,6 +23,16 @@
 #include "../src/Controls/SeasonalMinEnvFlowControl.h"
 #include "../src/Controls/InflowMinEnvFlowControl.h"
 #include "../src/SystemComponents/WaterSources/JointTreatmentCapacityExpansion.h"
+#include "../src/Utils/ROFTablesFile.h"
+#include "../src/Utils/TimeSeriesFile.h"
+#include "../src/Utils/CsvFile.h"
+#include "../src/Utils/../ContinuityModels/LongTermROFCache.h"
+#include "../src/Utils/../ContinuityModels/AdaptiveROFSampling.h"
+#include "../src/Utils/ROFTablesWriter.h"
+#include "../src/Utils/../DataCollector/Base/TimeSeriesStore.h"
+#include "../src/Utils/SimulationOutputFile.h"
+#include "../src/Utils/TextWriter.h"
+#include "../src/Utils/../DataCollector/Base/OutputSpecification.h"
 
 using namespace Catch::literals;
 
@@ -1129,3 +1140,962 @@ TEST_CASE("Checking if reservoir control rules are imported properly.",
     CHECK(al_control->getWeekThresholds() == autumn_controls_weeks);
     CHECK(al_control->getMinEnvFlows() == autumn_releases);
 }
+
+TEST_CASE("Quarry ROF lanes follow the quarry mass balance",
+          "[Quarry][ROF lanes]") {
+    int streamflow_n_weeks = 52 * (1 + 60);
+    vector<vector<double>> streamflows(
+            1, vector<double>((unsigned long) streamflow_n_weeks));
+    for (int w = 0; w < streamflow_n_weeks; ++w)
+        streamflows[0][w] = 20. + 15. * (w % 13);
+    vector<vector<double>> evaporations(
+            1, vector<double>((unsigned long) streamflow_n_weeks, 0.02));
+    Catchment catchment(streamflows, streamflow_n_weeks);
+    vector<Catchment *> catchments = {&catchment};
+    EvaporationSeries evaporation_series(evaporations, streamflow_n_weeks);
+
+    Quarry quarry("Quarry", 0, catchments, 1000., 100., evaporation_series,
+                  50., 60.);
+    vector<double> rdm_factors = {1., 1., 1.};
+    quarry.setRealization(0, rdm_factors);
+
+    // Each ROF year starts from the same state but gets different weeks,
+    // upstream inflows and demands.
+    SourceLanes lanes;
+    int weeks[NUMBER_REALIZATIONS_ROF];
+    double upstream_inflows[NUMBER_REALIZATIONS_ROF];
+    double wastewater_inflows[NUMBER_REALIZATIONS_ROF];
+    vector<vector<double>> demands(
+            2, vector<double>(NUMBER_REALIZATIONS_ROF));
+    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
+        quarry.saveLaneState(lanes, r);
+        upstream_inflows[r] = 2. * r;
+        wastewater_inflows[r] = 1.;
+        demands[0][r] = 10. + r;
+        demands[1][r] = 5.;
+    }
+
+    Quarry scalar_quarry(quarry);
+    for (int step = 0; step < 4; ++step) {
+        for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r)
+            weeks[r] = 7 * r + step;
+        quarry.applyContinuityLanes(weeks, 0, NUMBER_REALIZATIONS_ROF,
+                                    upstream_inflows, wastewater_inflows,
+                                    demands, lanes);
+    }
+
+    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
+        Quarry lane_quarry(scalar_quarry);
+        for (int step = 0; step < 4; ++step) {
+            double upstream_inflow = upstream_inflows[r];
+            double wastewater_inflow = wastewater_inflows[r];
+            vector<double> lane_demands = {demands[0][r], demands[1][r]};
+            lane_quarry.continuityWaterSource(7 * r + step, upstream_inflow,
+                                              wastewater_inflow,
+                                              lane_demands);
+        }
+        CHECK(lanes.available_volume[r] == lane_quarry.getAvailableVolume());
+        CHECK(lanes.total_outflow[r] == lane_quarry.getTotal_outflow());
+    }
+}
+
+TEST_CASE("ROF tables file round-trips float64 tables",
+          "[ROF Tables File]") {
+    string file_name = "test_rof_tables_float64.bin";
+    int n_realizations = 3, n_utilities = 2, n_weeks = 5, n_tiers = 7;
+    ROFTablesFile::create(file_name, n_realizations, n_utilities, n_weeks,
+                          n_tiers, ROF_TABLE_FLOAT64);
+
+    // Realizations can be written in any order.
+    for (int r = n_realizations - 1; r >= 0; --r) {
+        vector<Matrix2D<double>> tables(
+                n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+        for (int u = 0; u < n_utilities; ++u)
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t)
+                    tables[u](w, t) = (100. * r + 10. * u + w) / (t + 3.);
+        ROFTablesFile::writeRealization(file_name, (unsigned long) r, tables);
+    }
+    vector<Matrix2D<double>> one_utility(1, Matrix2D<double>(n_weeks,
+                                                             n_tiers));
+    CHECK_THROWS_AS(ROFTablesFile::writeRealization(file_name, 0,
+                                                    one_utility),
+                    invalid_argument);
+    ROFTablesFile::finalize(file_name);
+
+    ROFTablesFile rof_tables_file;
+    rof_tables_file.open(file_name);
+    const ROFTablesFileHeader &header = rof_tables_file.getHeader();
+    CHECK(header.dtype == ROF_TABLE_FLOAT64);
+    CHECK(header.n_realizations == 3);
+    CHECK(header.n_utilities == 2);
+    CHECK(header.n_weeks == 5);
+    CHECK(header.n_tiers == 7);
+
+    auto tables = rof_tables_file.getTables((unsigned long) n_realizations);
+    REQUIRE(tables.size() == 3);
+    for (int r = 0; r < n_realizations; ++r) {
+        REQUIRE(tables[r].size() == 2);
+        for (int u = 0; u < n_utilities; ++u) {
+            CHECK(tables[r][u].get_i() == n_weeks);
+            CHECK(tables[r][u].get_j() == n_tiers);
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t)
+                    CHECK(tables[r][u](w, t) ==
+                          (100. * r + 10. * u + w) / (t + 3.));
+        }
+    }
+    CHECK_THROWS(tables[0][0](n_weeks, 0));
+
+    rof_tables_file.close();
+    remove(file_name.c_str());
+}
+
+TEST_CASE("ROF tables file round-trips uint8 and float16 tables",
+          "[ROF Tables File]") {
+    string file_name = "test_rof_tables_compact.bin";
+    int n_realizations = 2, n_utilities = 2, n_weeks = 4, n_tiers = 6;
+
+    for (int dtype : {ROF_TABLE_UINT8, ROF_TABLE_FLOAT16}) {
+        // ROFs are counts of failed ROF years, as calculated.
+        ROFTablesFile::create(file_name, n_realizations, n_utilities, n_weeks,
+                              n_tiers, dtype);
+        for (int r = 0; r < n_realizations; ++r) {
+            vector<Matrix2D<double>> tables(
+                    n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+            for (int u = 0; u < n_utilities; ++u)
+                for (int w = 0; w < n_weeks; ++w)
+                    for (int t = 0; t < n_tiers; ++t)
+                        tables[u](w, t) = ((7 * r + 5 * u + 3 * w + t) %
+                                           (NUMBER_REALIZATIONS_ROF + 1)) /
+                                          (double) NUMBER_REALIZATIONS_ROF;
+            ROFTablesFile::writeRealization(file_name, (unsigned long) r,
+                                            tables);
+        }
+        ROFTablesFile::finalize(file_name);
+
+        ROFTablesFile rof_tables_file;
+        rof_tables_file.open(file_name);
+        CHECK(rof_tables_file.getHeader().dtype == (uint32_t) dtype);
+        if (dtype == ROF_TABLE_UINT8)
+            CHECK(rof_tables_file.getHeader().count_denominator ==
+                  NUMBER_REALIZATIONS_ROF);
+
+        auto tables = rof_tables_file.getTables(
+                (unsigned long) n_realizations);
+        for (int r = 0; r < n_realizations; ++r)
+            for (int u = 0; u < n_utilities; ++u) {
+                CHECK(tables[r][u].getDataType() == dtype);
+                for (int w = 0; w < n_weeks; ++w)
+                    for (int t = 0; t < n_tiers; ++t) {
+                        double rof = ((7 * r + 5 * u + 3 * w + t) %
+                                      (NUMBER_REALIZATIONS_ROF + 1)) /
+                                     (double) NUMBER_REALIZATIONS_ROF;
+                        if (dtype == ROF_TABLE_UINT8)
+                            CHECK(tables[r][u](w, t) == rof);
+                        else
+                            CHECK(tables[r][u](w, t) ==
+                                  ROFTable::decodeFloat16(
+                                          ROFTable::encodeFloat16(rof)));
+                    }
+            }
+
+        rof_tables_file.close();
+        remove(file_name.c_str());
+    }
+
+    // Float16 keeps 11 significant bits.
+    for (double rof : {0., 0.02, 0.1, 1. / 3., 0.5, 0.98, 1.}) {
+        CHECK(ROFTable::decodeFloat16(ROFTable::encodeFloat16(rof)) ==
+              Approx(rof).epsilon(1. / 2048));
+    }
+}
+
+TEST_CASE("Time series file round-trips rows of series",
+          "[Time Series File]") {
+    string file_name = "test_series.bin";
+    vector<vector<double>> rows = {{1.5, 2.25, 3.1},
+                                   {},
+                                   {-4., 5e-3}};
+
+    TimeSeriesFile::write(file_name, rows, SERIES_FLOAT64);
+    TimeSeriesFile time_series_file;
+    time_series_file.open(file_name);
+    CHECK(time_series_file.getHeader().n_rows == 3);
+    CHECK(time_series_file.getHeader().n_values == 5);
+    CHECK(time_series_file.getRows() == rows);
+    CHECK(time_series_file.getRows(10000000, {2, 0}) ==
+          vector<vector<double>>({rows[2], rows[0]}));
+    // Same number of rows as read by Utils::parse2DCsvFile.
+    CHECK(time_series_file.getRows(0).size() == 2);
+    CHECK_THROWS_AS(time_series_file.getRows(10000000, {3}),
+                    invalid_argument);
+    time_series_file.close();
+
+    TimeSeriesFile::write(file_name, rows, SERIES_FLOAT32);
+    time_series_file.open(file_name);
+    vector<vector<double>> float32_rows = time_series_file.getRows();
+    REQUIRE(float32_rows.size() == rows.size());
+    for (unsigned long r = 0; r < rows.size(); ++r) {
+        REQUIRE(float32_rows[r].size() == rows[r].size());
+        for (unsigned long w = 0; w < rows[r].size(); ++w)
+            CHECK(float32_rows[r][w] == (double) (float) rows[r][w]);
+    }
+    time_series_file.close();
+    remove(file_name.c_str());
+}
+
+TEST_CASE("Time series files replace the csv files they were converted from",
+          "[Time Series File]") {
+    string csv_file_name = "test_series.csv";
+    string binary_file_name = TimeSeriesFile::binaryFileName(csv_file_name);
+    CHECK(binary_file_name == "test_series.bin");
+    CHECK(TimeSeriesFile::binaryFileName("series") == "series.bin");
+
+    FILE *csv_file = fopen(csv_file_name.c_str(), "w");
+    fprintf(csv_file, "0.1,2,3.3333\n4.5,-6,7e-2\n8,9.25,10\n");
+    fclose(csv_file);
+
+    // Without a binary file the csv file is parsed.
+    auto csv_rows = Utils::parse2DCsvFile(csv_file_name);
+    CHECK(TimeSeriesFile::load(csv_file_name) == csv_rows);
+
+    TimeSeriesFile::convertCSVFile(csv_file_name);
+    CHECK(TimeSeriesFile::load(csv_file_name) == csv_rows);
+    CHECK(TimeSeriesFile::load(csv_file_name, 10000000, {2, 1}) ==
+          Utils::parse2DCsvFile(csv_file_name, 10000000, {2, 1}));
+
+    // The binary file is read instead of the csv file.
+    vector<vector<double>> binary_rows = {{1., 2.}, {3.}};
+    TimeSeriesFile::write(binary_file_name, binary_rows);
+    CHECK(TimeSeriesFile::load(csv_file_name) == binary_rows);
+
+    remove(csv_file_name.c_str());
+    remove(binary_file_name.c_str());
+}
+
+TEST_CASE("Csv file parser reads what the getline and stof parser read",
+          "[Csv File]") {
+    string file_name = "test_parser.csv";
+    FILE *csv_file = fopen(file_name.c_str(), "w");
+    fprintf(csv_file, "0.1,2,-3.5e-2\n"
+                      "#comment\n"
+                      "1e3,4.25\n"
+                      "\n"
+                      "0.30000001,123456789,7\n"
+                      "-0,1.17549435e-38");
+    fclose(csv_file);
+
+    // Values of the previous parser, which read every value with stof.
+    vector<vector<double>> rows = {
+            {stof("0.1"), stof("2"), stof("-3.5e-2")},
+            {},
+            {stof("1e3"), stof("4.25")},
+            {},
+            {stof("0.30000001"), stof("123456789"), stof("7")},
+            {stof("-0"), stof("1.17549435e-38")}};
+
+    CHECK(CsvFile::parse2D(file_name, 10000000, {}) == rows);
+    CHECK(Utils::parse2DCsvFile(file_name) == rows);
+    CHECK(CsvFile::parse2D(file_name, 10000000, {4, 0}) ==
+          vector<vector<double>>({rows[4], rows[0]}));
+    // Up to max_lines + 2 lines are read.
+    CHECK(CsvFile::parse2D(file_name, 1, {}) ==
+          vector<vector<double>>(rows.begin(), rows.begin() + 3));
+
+    double value;
+    CHECK(CsvFile::parseFloat("2.5", "2.5" + 3, value) ==
+          (int) CsvFile::PARSED);
+    CHECK(value == 2.5);
+    CHECK(CsvFile::parseFloat("abc", "abc" + 3, value) ==
+          (int) CsvFile::NOT_A_NUMBER);
+
+    csv_file = fopen(file_name.c_str(), "w");
+    fprintf(csv_file, "1,2\n3 4\n");
+    fclose(csv_file);
+    CHECK_THROWS_AS(CsvFile::parse2D(file_name, 10000000, {}),
+                    invalid_argument);
+
+    remove(file_name.c_str());
+    CHECK_THROWS_AS(CsvFile::parse2D(file_name, 10000000, {}),
+                    invalid_argument);
+}
+
+TEST_CASE("Long-term ROF cache hits only on bitwise equal keys",
+          "[Long-term ROF Cache]") {
+    LongTermROFCache cache(2);
+    vector<double> key = {52., 0.25, 1., 0.};
+    vector<double> risks_of_failure, end_state;
+
+    CHECK_FALSE(cache.find(key, risks_of_failure, end_state));
+    cache.insert(key, {0.1, 0.02}, {100., 200., 300.});
+    REQUIRE(cache.find(key, risks_of_failure, end_state));
+    CHECK(risks_of_failure == vector<double>({0.1, 0.02}));
+    CHECK(end_state == vector<double>({100., 200., 300.}));
+
+    // Values that compare equal but differ in their bits are different keys.
+    CHECK_FALSE(cache.find({52., 0.25, 1., -0.}, risks_of_failure,
+                           end_state));
+    CHECK_FALSE(cache.find({52., 0.25, 1.}, risks_of_failure, end_state));
+    CHECK_FALSE(cache.find({52., nextafter(0.25, 1.), 1., 0.},
+                           risks_of_failure, end_state));
+
+    // Keys already in the cache are not replaced.
+    cache.insert(key, {0.5, 0.5}, {0., 0., 0.});
+    REQUIRE(cache.find(key, risks_of_failure, end_state));
+    CHECK(risks_of_failure == vector<double>({0.1, 0.02}));
+
+    // Without a spill file, entries beyond those kept in memory are dropped.
+    cache.insert({1.}, {0.3}, {4.});
+    cache.insert({2.}, {0.4}, {5.});
+    CHECK(cache.getNEntriesInMemory() == 2);
+    CHECK(cache.getNEntriesSpilled() == 0);
+    CHECK(cache.find({1.}, risks_of_failure, end_state));
+    CHECK_FALSE(cache.find({2.}, risks_of_failure, end_state));
+
+    CHECK(cache.getHits() == 3);
+    CHECK(cache.getMisses() == 5);
+}
+
+TEST_CASE("Long-term ROF cache spills entries beyond those kept in memory",
+          "[Long-term ROF Cache]") {
+    string spill_file_name = "test_long_term_rof_cache.spill";
+    {
+        LongTermROFCache cache(1, spill_file_name);
+        vector<double> risks_of_failure, end_state;
+        for (int k = 0; k < 4; ++k)
+            cache.insert({(double) k, 7.}, {0.1 * k, 0.2 * k},
+                         {(double) k, 10. * k, 100. * k});
+        CHECK(cache.getNEntriesInMemory() == 1);
+        CHECK(cache.getNEntriesSpilled() == 3);
+
+        for (int k = 3; k >= 0; --k) {
+            REQUIRE(cache.find({(double) k, 7.}, risks_of_failure,
+                               end_state));
+            CHECK(risks_of_failure == vector<double>({0.1 * k, 0.2 * k}));
+            CHECK(end_state ==
+                  vector<double>({(double) k, 10. * k, 100. * k}));
+        }
+        CHECK_FALSE(cache.find({4., 7.}, risks_of_failure, end_state));
+        CHECK(cache.getHits() == 4);
+        CHECK(cache.getMisses() == 1);
+    }
+
+    // The spill file is deleted with the cache.
+    CHECK(fopen(spill_file_name.c_str(), "r") == nullptr);
+}
+
+TEST_CASE("Adaptive ROF sampling settles when triggers are outside the ROF "
+          "confidence interval", "[Adaptive ROF Sampling]") {
+    CHECK_THROWS_AS(AdaptiveROFSampling(0, 0.95, false), invalid_argument);
+    CHECK_THROWS_AS(AdaptiveROFSampling(10, 1., false), invalid_argument);
+
+    AdaptiveROFSampling sampling(10, 0.95, false);
+
+    SECTION("No failures") {
+        // After 10 years the 95% interval of the ROF is about [0, 0.24].
+        CHECK_FALSE(sampling.isSettled({0.}, 10, {{0.2}}));
+        CHECK(sampling.isSettled({0.}, 10, {{0.3}}));
+        CHECK(sampling.isSettled({0.}, 45, {{0.1}}));
+    }
+
+    SECTION("Few years left") {
+        // The interval after 48 years is about [0.47, 0.53], but with 2
+        // years left the ROF can only be between 0.48 and 0.52.
+        CHECK(sampling.isSettled({24.}, 48, {{0.525}}));
+        CHECK(sampling.isSettled({24.}, 48, {{0.475}}));
+        CHECK_FALSE(sampling.isSettled({24.}, 48, {{0.5}}));
+    }
+
+    SECTION("All years failed") {
+        // After 10 years the 95% interval of the ROF is about [0.76, 1].
+        CHECK(sampling.isSettled({10.}, 10, {{0.5}}));
+        CHECK_FALSE(sampling.isSettled({10.}, 10, {{0.8}}));
+        // A ROF of 1 is never above a trigger of 1.
+        CHECK(sampling.isSettled({10.}, 10, {{1.}}));
+        // 49 failures alone put the ROF at 0.98 or more.
+        CHECK(sampling.isSettled({49.}, 49, {{0.97}}));
+    }
+
+    SECTION("All years simulated") {
+        CHECK(sampling.isSettled({10.}, NUMBER_REALIZATIONS_ROF, {{0.2}}));
+        CHECK(sampling.isSettled({0.}, NUMBER_REALIZATIONS_ROF, {{0.}}));
+        CHECK(sampling.isSettled({25.}, NUMBER_REALIZATIONS_ROF,
+                                 {{0.5}, {0.4, 0.6}}));
+    }
+
+    SECTION("Trigger at zero") {
+        // A utility that acts only when its ROF is zero is settled by its
+        // first failure, and otherwise only by the last year.
+        CHECK_FALSE(sampling.isSettled({0.}, 45, {{0.}}));
+        CHECK(sampling.isSettled({1.}, 10, {{0.}}));
+        CHECK(sampling.isSettled({0.}, NUMBER_REALIZATIONS_ROF, {{0.}}));
+    }
+
+    SECTION("Several utilities") {
+        // Utilities without triggers are not waited for.
+        CHECK(sampling.isSettled({5., 0.}, 10, {{}, {0.3}}));
+        CHECK_FALSE(sampling.isSettled({5., 0.}, 10, {{0.9, 0.5}, {0.3}}));
+        CHECK_FALSE(sampling.isSettled({0., 0.}, 10, {{0.3}, {0.3, 0.2}}));
+        CHECK(sampling.isSettled({0., 10.}, 10, {{0.3}, {0.5}}));
+    }
+}
+
+TEST_CASE("ROF tables interpolate between storage tiers", "[ROF Table]") {
+    // ROFs of two weeks at four tiers.
+    double rofs[] = {0., 0.25, 0.5, 1.,
+                     1., 0.75, 0.75, 0.};
+    ROFTable table(2, 4, ROF_TABLE_FLOAT64, rofs);
+
+    for (int w = 0; w < 2; ++w) {
+        // At tiers.
+        for (int t = 0; t < 4; ++t)
+            CHECK(table.interpolate(w, t) == table(w, t));
+        // Between tiers.
+        CHECK(table.interpolate(w, 0.5) ==
+              table(w, 0) + 0.5 * (table(w, 1) - table(w, 0)));
+        CHECK(table.interpolate(w, 2.25) ==
+              table(w, 2) + 0.25 * (table(w, 3) - table(w, 2)));
+        // Beyond the first and last tiers.
+        CHECK(table.interpolate(w, -1.) == table(w, 0));
+        CHECK(table.interpolate(w, 10.) == table(w, 3));
+        CHECK(table.interpolate(w, nan("")) == table(w, 0));
+    }
+    CHECK(table.interpolate(0, 1.5) == 0.375);
+    CHECK(table.interpolate(1, 1.5) == 0.75);
+    CHECK(table.interpolate(1, 2.5) == 0.375);
+
+    // Same results for tables of counts of failed ROF years.
+    uint8_t counts[] = {0, 10, 25, 50};
+    ROFTable count_table(1, 4, ROF_TABLE_UINT8, counts,
+                         NUMBER_REALIZATIONS_ROF);
+    CHECK(count_table.interpolate(0, 2.) == 0.5);
+    CHECK(count_table.interpolate(0, 2.5) == Approx(0.75));
+    CHECK(count_table.interpolate(0, 0.5) == Approx(0.1));
+}
+
+TEST_CASE("ROF tables converted to breakpoints keep their values",
+          "[ROF Tables File][Breakpoints]") {
+    string directory = "./";
+    string file_name = directory + ROFTablesFile::FILE_NAME;
+    string dense_file_name = directory + ROFTablesFile::DENSE_FILE_NAME;
+    int n_realizations = 2, n_utilities = 3, n_weeks = 4, n_tiers = 20;
+    CHECK_THROWS_AS(ROFTablesFile::create(file_name, 1, 1, 1, 1,
+                                          ROF_TABLE_BREAKPOINTS),
+                    invalid_argument);
+
+    // ROFs fall with storage, in steps of one failed ROF year or more.
+    auto rof = [&](int r, int u, int w, int t) {
+        int failures = max(0, NUMBER_REALIZATIONS_ROF - (r + u + 1) * t - w);
+        if (u == 2)
+            failures = t < 5 ? 3 : 0;
+        return failures / (double) NUMBER_REALIZATIONS_ROF;
+    };
+    ROFTablesFile::create(file_name, n_realizations, n_utilities, n_weeks,
+                          n_tiers, ROF_TABLE_FLOAT64);
+    for (int r = 0; r < n_realizations; ++r) {
+        vector<Matrix2D<double>> tables(
+                n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+        for (int u = 0; u < n_utilities; ++u)
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t)
+                    tables[u](w, t) = rof(r, u, w, t);
+        ROFTablesFile::writeRealization(file_name, (unsigned long) r, tables);
+    }
+    ROFTablesFile::finalize(file_name);
+
+    ROFTablesFile::convertToBreakpoints(directory);
+    CHECK_THROWS_AS(ROFTablesFile::convertToBreakpoints(directory),
+                    invalid_argument);
+
+    ROFTablesFile breakpoints_file;
+    breakpoints_file.open(file_name);
+    CHECK(breakpoints_file.getHeader().dtype == ROF_TABLE_BREAKPOINTS);
+    CHECK(breakpoints_file.getHeader().count_denominator ==
+          NUMBER_REALIZATIONS_ROF);
+    ROFTablesFile dense_file;
+    dense_file.open(dense_file_name);
+    CHECK(dense_file.getHeader().dtype == ROF_TABLE_FLOAT64);
+
+    auto tables = breakpoints_file.getTables((unsigned long) n_realizations);
+    auto dense_tables = dense_file.getTables((unsigned long) n_realizations);
+    for (int r = 0; r < n_realizations; ++r)
+        for (int u = 0; u < n_utilities; ++u) {
+            CHECK(tables[r][u].getDataType() == ROF_TABLE_BREAKPOINTS);
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t) {
+                    CHECK(tables[r][u](w, t) == rof(r, u, w, t));
+                    CHECK(tables[r][u](w, t) == dense_tables[r][u](w, t));
+                }
+            CHECK(tables[r][u].interpolate(1, 4.5) ==
+                  dense_tables[r][u].interpolate(1, 4.5));
+        }
+
+    breakpoints_file.close();
+    dense_file.close();
+    remove(file_name.c_str());
+    remove(dense_file_name.c_str());
+}
+
+TEST_CASE("ROF tables that are not counts of failed years are not converted "
+          "to breakpoints", "[ROF Tables File][Breakpoints]") {
+    string directory = "./";
+    string file_name = directory + ROFTablesFile::FILE_NAME;
+    string dense_file_name = directory + ROFTablesFile::DENSE_FILE_NAME;
+
+    ROFTablesFile::create(file_name, 1, 1, 2, 3, ROF_TABLE_FLOAT64);
+    vector<Matrix2D<double>> tables(1, Matrix2D<double>(2, 3));
+    for (int w = 0; w < 2; ++w)
+        for (int t = 0; t < 3; ++t)
+            tables[0](w, t) = 0.1;
+    tables[0](1, 2) = 0.013;
+    ROFTablesFile::writeRealization(file_name, 0, tables);
+    ROFTablesFile::finalize(file_name);
+
+    CHECK_THROWS_AS(ROFTablesFile::convertToBreakpoints(directory),
+                    invalid_argument);
+
+    remove(file_name.c_str());
+    remove(dense_file_name.c_str());
+}
+
+TEST_CASE("ROF tables writer writes swapped tables from I/O threads",
+          "[ROF Tables Writer]") {
+    string file_name = "test_rof_tables_writer.bin";
+    int n_realizations = 5, n_utilities = 2, n_weeks = 4, n_tiers = 3;
+    auto rof = [](int r, int u, int w, int t) {
+        return (1000. * r + 100. * u + 10. * w + t) / 7.;
+    };
+    ROFTablesFile::create(file_name, n_realizations, n_utilities, n_weeks,
+                          n_tiers, ROF_TABLE_FLOAT64);
+
+    {
+        ROFTablesWriter writer(file_name, 2, 2);
+        vector<Matrix2D<double>> tables(
+                n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+        for (int r = n_realizations - 1; r >= 0; --r) {
+            for (int u = 0; u < n_utilities; ++u)
+                for (int w = 0; w < n_weeks; ++w)
+                    for (int t = 0; t < n_tiers; ++t)
+                        tables[u](w, t) = rof(r, u, w, t);
+            writer.push((unsigned long) r, tables);
+
+            // The tables handed back are of the same size.
+            REQUIRE(tables.size() == (unsigned long) n_utilities);
+            for (int u = 0; u < n_utilities; ++u) {
+                CHECK(tables[u].get_i() == n_weeks);
+                CHECK(tables[u].get_j() == n_tiers);
+            }
+        }
+        writer.close();
+    }
+    ROFTablesFile::finalize(file_name);
+
+    ROFTablesFile rof_tables_file;
+    rof_tables_file.open(file_name);
+    auto tables = rof_tables_file.getTables((unsigned long) n_realizations);
+    for (int r = 0; r < n_realizations; ++r)
+        for (int u = 0; u < n_utilities; ++u)
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t)
+                    CHECK(tables[r][u](w, t) == rof(r, u, w, t));
+    rof_tables_file.close();
+
+    // Errors of the I/O threads are reported when the writer is closed.
+    ROFTablesWriter writer(file_name, 1, 1);
+    vector<Matrix2D<double>> extra_tables(
+            n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+    writer.push((unsigned long) n_realizations, extra_tables);
+    CHECK_THROWS_AS(writer.close(), runtime_error);
+
+    remove(file_name.c_str());
+}
+
+TEST_CASE("ROF tables shards are merged into a single file",
+          "[ROF Tables File][Shards]") {
+    string directory = "./";
+    int n_shards = 3, n_realizations = 7, n_utilities = 2, n_weeks = 3,
+            n_tiers = 4;
+    auto rof = [](int r, int u, int w, int t) {
+        return (1000. * r + 100. * u + 10. * w + t) / 9.;
+    };
+
+    CHECK(ROFTablesFile::shardFileName(directory, 2) ==
+          "./rof_tables_shard_2.bin");
+    CHECK_THROWS_AS(ROFTablesFile::mergeShards(directory, 0),
+                    invalid_argument);
+
+    // Each shard has the realizations of its rank.
+    for (int k = 0; k < n_shards; ++k) {
+        string shard_file_name = ROFTablesFile::shardFileName(directory, k);
+        ROFTablesFile::create(shard_file_name, n_realizations, n_utilities,
+                              n_weeks, n_tiers, ROF_TABLE_FLOAT64);
+        for (int r = k; r < n_realizations; r += n_shards) {
+            vector<Matrix2D<double>> tables(
+                    n_utilities, Matrix2D<double>(n_weeks, n_tiers));
+            for (int u = 0; u < n_utilities; ++u)
+                for (int w = 0; w < n_weeks; ++w)
+                    for (int t = 0; t < n_tiers; ++t)
+                        tables[u](w, t) = rof(r, u, w, t);
+            ROFTablesFile::writeRealization(shard_file_name,
+                                            (unsigned long) r, tables);
+        }
+        ROFTablesFile::finalize(shard_file_name);
+    }
+    ROFTablesFile::mergeShards(directory, n_shards);
+
+    for (int k = 0; k < n_shards; ++k) {
+        FILE *shard_file = fopen(ROFTablesFile::shardFileName(directory, k)
+                                         .c_str(), "r");
+        CHECK(shard_file == nullptr);
+        if (shard_file) fclose(shard_file);
+    }
+
+    string file_name = directory + ROFTablesFile::FILE_NAME;
+    ROFTablesFile rof_tables_file;
+    rof_tables_file.open(file_name);
+    CHECK(rof_tables_file.getHeader().n_realizations == 7);
+    auto tables = rof_tables_file.getTables((unsigned long) n_realizations);
+    for (int r = 0; r < n_realizations; ++r)
+        for (int u = 0; u < n_utilities; ++u)
+            for (int w = 0; w < n_weeks; ++w)
+                for (int t = 0; t < n_tiers; ++t)
+                    CHECK(tables[r][u](w, t) == rof(r, u, w, t));
+    rof_tables_file.close();
+
+    string manifest_file_name = directory + ROFTablesFile::MANIFEST_FILE_NAME;
+    ifstream manifest(manifest_file_name);
+    vector<string> lines;
+    for (string line; getline(manifest, line);)
+        lines.push_back(line);
+    manifest.close();
+    CHECK(find(lines.begin(), lines.end(), "n_shards,3") != lines.end());
+    CHECK(find(lines.begin(), lines.end(), "n_realizations,7") !=
+          lines.end());
+
+    // Shards of different dimensions are not merged.
+    for (int k = 0; k < 2; ++k) {
+        string shard_file_name = ROFTablesFile::shardFileName(directory, k);
+        ROFTablesFile::create(shard_file_name, n_realizations, n_utilities,
+                              n_weeks + k, n_tiers, ROF_TABLE_FLOAT64);
+        ROFTablesFile::finalize(shard_file_name);
+    }
+    CHECK_THROWS_AS(ROFTablesFile::mergeShards(directory, 2),
+                    invalid_argument);
+
+    for (int k = 0; k < 2; ++k)
+        remove(ROFTablesFile::shardFileName(directory, k).c_str());
+    remove(file_name.c_str());
+    remove(manifest_file_name.c_str());
+}
+
+TEST_CASE("Time series store binds collectors' series to its columns",
+          "[Time Series Store]") {
+    for (bool single_precision : {false, true}) {
+        INFO("single precision: " << single_precision);
+        TimeSeriesStore store;
+        unsigned long n_weeks = 4;
+        // Realizations 5 and 2 are run, in this order.
+        store.allocate(n_weeks, {5, 2}, {2, 1}, single_precision);
+        CHECK(store.isAllocated());
+        CHECK(store.getN_columns() == 3);
+        CHECK(store.getSizeInBytes() ==
+              3 * n_weeks * 2 * (single_precision ? sizeof(float) :
+                                 sizeof(double)));
+
+        TimeSeries storage, restrictions, stored, unbound;
+        store.bind(0, 2, {&storage, &restrictions});
+        store.bind(1, 5, {&stored});
+        // Realizations that are not in the store keep their own values.
+        store.bind(1, 3, {&unbound});
+
+        // Past the weeks of the store, values are kept by the series.
+        for (int w = 0; w < 6; ++w) {
+            storage.push_back(0.1 * w);
+            restrictions.push_back(1. - w);
+            stored.push_back(2500. + w);
+            unbound.push_back(0.3 * w);
+        }
+        for (TimeSeries *time_series : {&storage, &restrictions, &stored,
+                                        &unbound}) {
+            CHECK(time_series->size() == 6);
+            CHECK_FALSE(time_series->empty());
+        }
+        for (unsigned long w = 0; w < 6; ++w) {
+            CHECK(storage[w] == (single_precision && w < n_weeks ?
+                                 (double) (float) (0.1 * w) : 0.1 * w));
+            CHECK(restrictions.at(w) == 1. - w);
+            CHECK(stored[w] == 2500. + w);
+            CHECK(unbound[w] == 0.3 * w);
+        }
+        CHECK(stored.back() == 2505.);
+        CHECK(restrictions.toVector() ==
+              vector<double>({1., 0., -1., -2., -3., -4.}));
+        CHECK_THROWS_AS(storage.at(6), out_of_range);
+
+        // Series are bound before values are collected.
+        CHECK_THROWS_AS(store.bind(0, 5, {&storage}), logic_error);
+        // Components have as many series as counted when allocating.
+        TimeSeries extra[3];
+        CHECK_THROWS_AS(store.bind(1, 2, {&extra[0], &extra[1]}),
+                        logic_error);
+    }
+
+    TimeSeries discarded;
+    discarded.discard();
+    discarded.push_back(1.);
+    CHECK(discarded.empty());
+}
+
+TEST_CASE("Simulation output file round-trips chunks of time series",
+          "[Simulation Output File]") {
+    string file_name = "test_simulation_output.bin";
+    vector<SimulationOutputColumn> columns = {
+            {"Utilities", 0, "Durham", "st_vol"},
+            {"Utilities", 0, "Durham", "rest_m"},
+            {"WaterSources", 3, "Lake", "stored"}};
+    int n_weeks = 6;
+    auto chunkValues = [&](int realization) {
+        vector<vector<double>> values(columns.size(),
+                                      vector<double>((unsigned long) n_weeks));
+        for (int w = 0; w < n_weeks; ++w) {
+            values[0][w] = 1000. - 3.1 * w * (realization + 1);
+            values[1][w] = w < 3 ? 1. : 0.9;
+            values[2][w] = 2500.;
+        }
+        return values;
+    };
+
+    vector<uint32_t> compressions = {
+            SimulationOutputFile::NO_COMPRESSION,
+            SimulationOutputFile::XOR_RLE_COMPRESSION};
+    for (int dtype : {SERIES_FLOAT64, SERIES_FLOAT32})
+        for (uint32_t compression : compressions) {
+            {
+                SimulationOutputFile::Writer writer(file_name, columns, dtype,
+                                                    compression, 10, 2);
+                writer.writeChunk(3, (unsigned long) n_weeks,
+                                  writer.encodeChunk(chunkValues(3)));
+                writer.writeChunk(0, (unsigned long) n_weeks,
+                                  writer.encodeChunk(chunkValues(0)));
+                CHECK_THROWS_AS(writer.encodeChunk({{1.}}), invalid_argument);
+                writer.close();
+            }
+
+            SimulationOutputFile output_file;
+            output_file.open(file_name);
+            const SimulationOutputFileHeader &header = output_file.getHeader();
+            CHECK(header.dtype == (uint32_t) dtype);
+            CHECK(header.compression == compression);
+            CHECK(header.first_week == 10);
+            CHECK(header.week_step == 2);
+            CHECK(header.n_columns == 3);
+            CHECK(header.n_chunks == 2);
+
+            REQUIRE(output_file.getColumns().size() == 3);
+            for (unsigned long c = 0; c < columns.size(); ++c) {
+                CHECK(output_file.getColumns()[c].name() == columns[c].name());
+                CHECK(output_file.getColumns()[c].component_name ==
+                      columns[c].component_name);
+            }
+            CHECK(output_file.getColumns()[0].name() == "Utilities.0st_vol");
+
+            REQUIRE(output_file.getChunks().size() == 2);
+            CHECK(output_file.getChunks()[0].realization == 3);
+            CHECK(output_file.getChunks()[1].realization == 0);
+            for (unsigned long chunk = 0; chunk < 2; ++chunk) {
+                vector<vector<double>> values =
+                        chunkValues((int) output_file.getChunks()[chunk]
+                                .realization);
+                vector<vector<double>> read_values =
+                        output_file.readChunk(chunk, {0, 1, 2});
+                REQUIRE(read_values.size() == 3);
+                for (unsigned long c = 0; c < columns.size(); ++c) {
+                    REQUIRE(read_values[c].size() == (unsigned long) n_weeks);
+                    for (int w = 0; w < n_weeks; ++w)
+                        CHECK(read_values[c][w] == (dtype == SERIES_FLOAT32 ?
+                                                    (double) (float)
+                                                            values[c][w] :
+                                                    values[c][w]));
+                }
+                CHECK(output_file.readChunk(chunk, {2}) ==
+                      vector<vector<double>>({read_values[2]}));
+            }
+
+            CHECK(output_file.selectColumns({}) ==
+                  vector<unsigned long>({0, 1, 2}));
+            CHECK(output_file.selectColumns({"WaterSources"}) ==
+                  vector<unsigned long>({2}));
+            CHECK(output_file.selectColumns({"rest_m", "3stored"}) ==
+                  vector<unsigned long>({1, 2}));
+            CHECK_THROWS_AS(output_file.selectColumns({"Policies"}),
+                            invalid_argument);
+        }
+
+    remove(file_name.c_str());
+}
+
+TEST_CASE("Simulation output compression is lossless",
+          "[Simulation Output File]") {
+    vector<double> series = {0., 0., 1.5, 1.5, 1.5, -2.25, 1e300, 1e-300,
+                             nan(""), 0.};
+    vector<char> values(series.size() * sizeof(double));
+    memcpy(values.data(), series.data(), values.size());
+
+    vector<char> compressed = SimulationOutputFile::compress(values,
+                                                             sizeof(double));
+    CHECK(SimulationOutputFile::decompress(compressed.data(),
+                                           compressed.size(), series.size(),
+                                           sizeof(double)) == values);
+
+    // Constant series shrink to a few bytes.
+    vector<char> constant(100 * sizeof(float), 0);
+    for (unsigned long i = 0; i < constant.size(); i += sizeof(float))
+        constant[i + 2] = 1;
+    vector<char> compressed_constant =
+            SimulationOutputFile::compress(constant, sizeof(float));
+    CHECK(compressed_constant.size() < constant.size() / 10);
+    CHECK(SimulationOutputFile::decompress(compressed_constant.data(),
+                                           compressed_constant.size(), 100,
+                                           sizeof(float)) == constant);
+}
+
+TEST_CASE("Text writer formats values as the ostream it replaces",
+          "[Text Writer]") {
+    string file_name = "test_text_writer.csv";
+    vector<double> values = {0., -0., 1., 0.1, 1. / 3., -2.5e-7, 123456.,
+                             1234567., 9.99999e15, 1e300, 42.125};
+
+    TextWriter writer(16);
+    CHECK_THROWS_AS(writer.open("no_such_directory/file.csv"),
+                    runtime_error);
+    writer.open(file_name);
+    ostringstream expected;
+    for (double value : values) {
+        writer.writeValue(value);
+        writer.write(',');
+        writer.writeValue(value, 12, 4);
+        writer.write(',');
+        writer.writeFixed(value);
+        writer.write(',');
+        writer.writePadded("abc", 5);
+        writer.writeInteger((long) value);
+        writer.write(',');
+        writer.writeInteger(-7, 4);
+        writer.endLine();
+
+        expected << value << "," << setw(12) << setprecision(4) << value
+                 << "," << setprecision(6) << to_string(value) << ","
+                 << setw(5) << "abc" << (long) value << "," << setw(4) << -7
+                 << endl;
+    }
+
+    // Trailing separators are removed without touching previous lines.
+    unsigned long line_start = writer.getLineStart();
+    writer.removeLastCharacter(line_start);
+    writer.write("1,2,");
+    writer.removeLastCharacter(line_start);
+    writer.endLine();
+    expected << "1,2" << endl;
+    writer.close();
+
+    ifstream file(file_name);
+    stringstream written;
+    written << file.rdbuf();
+    file.close();
+    CHECK(written.str() == expected.str());
+
+    // Round-trip values read back to the same doubles.
+    writer.setRoundTrip(true);
+    writer.open(file_name);
+    for (double value : values) {
+        writer.writeValue(value);
+        writer.endLine();
+    }
+    writer.close();
+    file.open(file_name);
+    for (double value : values) {
+        string line;
+        getline(file, line);
+        CHECK(strtod(line.c_str(), nullptr) == value);
+    }
+    file.close();
+
+    remove(file_name.c_str());
+}
+
+TEST_CASE("Output specifications select time series",
+          "[Output Specification]") {
+    OutputSpecification all_series;
+    CHECK_FALSE(all_series.isSet());
+    CHECK(all_series.selectsAllSeries());
+    CHECK(all_series.recordsGroup("Policies"));
+    CHECK(all_series.recordsComponent("WaterSources", 7, ""));
+    CHECK(all_series.recordsVariable("st_vol"));
+    CHECK(all_series.recordsRealization(1000));
+    CHECK(all_series.recordsWeek(2000));
+    CHECK(all_series.getN_recorded_weeks(52) == 52);
+
+    OutputSpecification specification(
+            "components=Utilities.0,WaterSources.Lake;variables=st_vol,rest_m "
+            "weeks=10-100 realizations=0-2,5 every=4");
+    CHECK(specification.isSet());
+    CHECK(specification.filtersWeeks());
+    CHECK_FALSE(specification.selectsAllSeries());
+
+    CHECK(specification.recordsGroup("Utilities"));
+    CHECK(specification.recordsGroup("WaterSources"));
+    CHECK_FALSE(specification.recordsGroup("Policies"));
+    CHECK(specification.recordsComponent("Utilities", 0, "Durham"));
+    CHECK_FALSE(specification.recordsComponent("Utilities", 1, "Raleigh"));
+    CHECK(specification.recordsComponent("WaterSources", 3, "Lake"));
+    CHECK_FALSE(specification.recordsComponent("WaterSources", 0, ""));
+
+    CHECK(specification.recordsVariable("st_vol"));
+    CHECK(specification.recordsVariable("rest_m"));
+    CHECK_FALSE(specification.recordsVariable("net_inf"));
+
+    for (unsigned long r : {0, 1, 2, 5})
+        CHECK(specification.recordsRealization(r));
+    for (unsigned long r : {3, 4, 6})
+        CHECK_FALSE(specification.recordsRealization(r));
+
+    CHECK(specification.recordsWeek(10));
+    CHECK(specification.recordsWeek(14));
+    CHECK(specification.recordsWeek(98));
+    CHECK_FALSE(specification.recordsWeek(9));
+    CHECK_FALSE(specification.recordsWeek(12));
+    CHECK_FALSE(specification.recordsWeek(102));
+    CHECK(specification.getN_recorded_weeks(52) == 11);
+    CHECK(specification.getN_recorded_weeks(1000) == 23);
+    CHECK(specification.getN_recorded_weeks(5) == 0);
+    CHECK(specification.getRecordedWeek(2) == 18);
+
+    // Later clauses replace earlier ones.
+    OutputSpecification realizations("realizations=4-6;realizations=3");
+    CHECK(realizations.recordsRealization(3));
+    CHECK_FALSE(realizations.recordsRealization(4));
+    CHECK(realizations.selectsAllSeries());
+
+    CHECK(OutputSpecification::selectsComponent("Policies", "Policies", 2,
+                                                "Transfers"));
+    CHECK(OutputSpecification::selectsComponent("Policies.Transfers",
+                                                "Policies", 2, "Transfers"));
+    CHECK_FALSE(OutputSpecification::selectsComponent("Policies.", "Policies",
+                                                      2, ""));
+}
+
+TEST_CASE("Invalid output specifications are rejected",
+          "[Output Specification][Exceptions]") {
+    vector<string> invalid_specifications = {
+            "", " ; ", "components=", "variables", "colour=red",
+            "weeks=5", "weeks=5-2", "weeks=1-2-3", "weeks=a-2", "weeks=-3",
+            "realizations=5-2", "realizations=-1", "realizations=,",
+            "realizations=1-x", "every=0", "every=-2",
+            "components=Utilities weeks=10"};
+    for (const string &invalid_specification : invalid_specifications) {
+        INFO(invalid_specification);
+        CHECK_THROWS_AS(OutputSpecification(invalid_specification),
+                        invalid_argument);
+    }
+}
@@ -0,0 +1,175 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "AdaptiveROFSampling.h"
+#include "../Utils/Constants.h"
+
+using namespace Constants;
+
+/**
+ * @param batch_size number of ROF years simulated between checks of whether
+ * ROFs are settled.
+ * @param confidence two-sided confidence with which the side of each trigger
+ * the ROF is on must be known, between 0 and 1.
+ * @param validate whether to simulate all years anyway and compare the
+ * resulting decisions with those made with the adaptive ROFs.
+ */
+AdaptiveROFSampling::AdaptiveROFSampling(int batch_size, double confidence,
+                                         bool validate)
+        : batch_size(batch_size), validate(validate) {
+    if (batch_size < 1 || batch_size > NUMBER_REALIZATIONS_ROF) {
+        char error[256];
+        sprintf(error, "Adaptive ROF batch size must be between 1 and %d, "
+                       "but %d was given.", NUMBER_REALIZATIONS_ROF,
+                batch_size);
+        throw invalid_argument(error);
+    }
+    if (!(confidence > 0. && confidence < 1.)) {
+        char error[256];
+        sprintf(error, "Adaptive ROF confidence must be between 0 and 1, but "
+                       "%f was given.", confidence);
+        throw invalid_argument(error);
+    }
+
+    // Standard normal quantile of the confidence, by bisection.
+    double z_low = 0., z_high = 40.;
+    for (int i = 0; i < 100; ++i) {
+        double z = (z_low + z_high) / 2.;
+        if (erf(z / sqrt(2.)) < confidence)
+            z_low = z;
+        else
+            z_high = z;
+    }
+    z_squared = z_low * z_low;
+}
+
+/**
+ * Checks whether, given the failures in the first n_years ROF years, the
+ * ROF over all years is known with the desired confidence to be on the same
+ * side of every trigger of every utility as the ROF over the first n_years.
+ * @param failures number of failed years of each utility.
+ * @param n_years number of years simulated so far.
+ * @param utilities_rof_triggers triggers of each utility.
+ * @return true if no more years need to be simulated.
+ */
+bool AdaptiveROFSampling::isSettled(
+        const vector<double> &failures, int n_years,
+        const vector<vector<double>> &utilities_rof_triggers) const {
+    if (n_years >= NUMBER_REALIZATIONS_ROF)
+        return true;
+
+    double n = n_years;
+    double n_total = NUMBER_REALIZATIONS_ROF;
+    double z2 = z_squared * (n_total - n) / (n_total - 1.);
+    for (unsigned long u = 0; u < utilities_rof_triggers.size(); ++u) {
+        if (utilities_rof_triggers[u].empty())
+            continue;
+
+        double p = failures[u] / n;
+        double denominator = 1. + z2 / n;
+        double center = (p + z2 / (2. * n)) / denominator;
+        double half_width = sqrt(z2 * (p * (1. - p) / n +
+                                       z2 / (4. * n * n))) / denominator;
+
+        // Failures already seen and years left bound the ROF over all
+        // years regardless of confidence.
+        double lower = max(center - half_width, failures[u] / n_total);
+        double upper = min(center + half_width,
+                           (failures[u] + n_total - n) / n_total);
+
+        for (double trigger : utilities_rof_triggers[u])
+            if (lower <= trigger && upper > trigger)
+                return false;
+    }
+
+    return true;
+}
+
+/**
+ * Records a ROF calculation and the number of years it needed.
+ * @param n_years
+ */
+void AdaptiveROFSampling::recordCalculation(int n_years) {
+    n_calculations++;
+    n_years_needed += (unsigned long) n_years;
+    if (n_years < NUMBER_REALIZATIONS_ROF)
+        n_early_stops++;
+}
+
+/**
+ * Records whether the decision of each utility at each of its triggers
+ * would have been different had the ROF been calculated over all years.
+ * @param adaptive_rofs ROFs calculated adaptively.
+ * @param full_rofs ROFs calculated over all years.
+ * @param utilities_rof_triggers triggers of each utility.
+ */
+void AdaptiveROFSampling::recordDecisions(
+        const vector<double> &adaptive_rofs, const vector<double> &full_rofs,
+        const vector<vector<double>> &utilities_rof_triggers) {
+    lock_guard<mutex> lock(validation_mutex);
+    if (n_decisions.size() < utilities_rof_triggers.size()) {
+        n_decisions.resize(utilities_rof_triggers.size(), 0);
+        n_flips.resize(utilities_rof_triggers.size(), 0);
+    }
+
+    for (unsigned long u = 0; u < utilities_rof_triggers.size(); ++u) {
+        if (utilities_rof_triggers[u].empty())
+            continue;
+
+        bool flipped = false;
+        for (double trigger : utilities_rof_triggers[u])
+            if ((adaptive_rofs[u] > trigger) != (full_rofs[u] > trigger))
+                flipped = true;
+        n_decisions[u]++;
+        n_flips[u] += flipped;
+    }
+}
+
+void AdaptiveROFSampling::resetStatistics() {
+    n_calculations = 0;
+    n_years_needed = 0;
+    n_early_stops = 0;
+    lock_guard<mutex> lock(validation_mutex);
+    n_decisions.clear();
+    n_flips.clear();
+}
+
+int AdaptiveROFSampling::getBatchSize() const {
+    return batch_size;
+}
+
+bool AdaptiveROFSampling::isValidating() const {
+    return validate;
+}
+
+/**
+ * @return largest fraction of the decisions of any utility that would have
+ * been different had its ROFs been calculated over all years.
+ */
+double AdaptiveROFSampling::getMaxFlipRate() {
+    lock_guard<mutex> lock(validation_mutex);
+    double max_flip_rate = 0.;
+    for (unsigned long u = 0; u < n_decisions.size(); ++u)
+        if (n_decisions[u] > 0)
+            max_flip_rate = max(max_flip_rate,
+                                (double) n_flips[u] / n_decisions[u]);
+    return max_flip_rate;
+}
+
+void AdaptiveROFSampling::printStatistics() {
+    unsigned long n_years_total = n_calculations * NUMBER_REALIZATIONS_ROF;
+    printf("Adaptive ROF sampling: %lu of %lu ROF years needed (%.1f%% "
+           "saved), %lu of %lu calculations stopped early.\n",
+           (unsigned long) n_years_needed, n_years_total,
+           n_years_total > 0 ?
+           100. * (1. - (double) n_years_needed / n_years_total) : 0.,
+           (unsigned long) n_early_stops, (unsigned long) n_calculations);
+    if (validate)
+        printf("Adaptive ROF sampling: maximum decision-flip rate against "
+               "all years of %.4f%%.\n", 100. * getMaxFlipRate());
+}
@@ -0,0 +1,71 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_ADAPTIVEROFSAMPLING_H
+#define TRIANGLEMODEL_ADAPTIVEROFSAMPLING_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Settings and statistics of adaptive short-term ROF sampling, in which ROF
+ * years are simulated in batches and the simulation stops as soon as the
+ * ROF of every utility is, with the given confidence, on the same side of
+ * all its triggers (see DroughtMitigationPolicy::addShortTermROFTriggers) as
+ * the ROF over all NUMBER_REALIZATIONS_ROF years would be. The confidence
+ * interval of the ROF is a Wilson score interval corrected for sampling
+ * without replacement from the NUMBER_REALIZATIONS_ROF years.
+ *
+ * In validation mode all years are still simulated, so that decisions based
+ * on the adaptive ROFs can be compared with those based on all years.
+ *
+ * The object can be shared by all threads.
+ */
+class AdaptiveROFSampling {
+private:
+    const int batch_size;
+    const bool validate;
+    double z_squared;
+
+    atomic<unsigned long> n_calculations{0};
+    atomic<unsigned long> n_years_needed{0};
+    atomic<unsigned long> n_early_stops{0};
+
+    mutex validation_mutex;
+    vector<unsigned long> n_decisions;
+    vector<unsigned long> n_flips;
+
+public:
+    AdaptiveROFSampling(int batch_size, double confidence, bool validate);
+
+    AdaptiveROFSampling(const AdaptiveROFSampling &sampling) = delete;
+
+    AdaptiveROFSampling &operator=(const AdaptiveROFSampling &sampling) =
+            delete;
+
+    bool isSettled(const vector<double> &failures, int n_years,
+                   const vector<vector<double>> &utilities_rof_triggers) const;
+
+    void recordCalculation(int n_years);
+
+    void recordDecisions(const vector<double> &adaptive_rofs,
+                         const vector<double> &full_rofs,
+                         const vector<vector<double>> &utilities_rof_triggers);
+
+    void resetStatistics();
+
+    int getBatchSize() const;
+
+    bool isValidating() const;
+
+    double getMaxFlipRate();
+
+    void printStatistics();
+};
+
+
+#endif //TRIANGLEMODEL_ADAPTIVEROFSAMPLING_H
@@ -0,0 +1,65 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <algorithm>
+#include "CompiledNetwork.h"
+
+CompiledNetwork::CompiledNetwork() : n_sources(0) {}
+
+/**
+ * Builds the flat network from the water sources graph.
+ * @param water_sources_graph
+ * @param water_sources water sources sorted by id.
+ */
+CompiledNetwork::CompiledNetwork(const Graph &water_sources_graph,
+                                 const vector<WaterSource *> &water_sources)
+        : n_sources((int) water_sources.size()),
+          topological_order(water_sources_graph.getTopological_order()),
+          sources(water_sources),
+          total_outflows(water_sources.size(), 0.),
+          upstream_inflows(water_sources.size(), 0.),
+          wastewater_inflows(water_sources.size(), 0.) {
+    auto &upstream_sources = water_sources_graph.getUpstream_sources();
+    upstream_offsets.push_back(0);
+    for (auto &upstream : upstream_sources) {
+        upstream_ids.insert(upstream_ids.end(), upstream.begin(),
+                            upstream.end());
+        upstream_offsets.push_back((int) upstream_ids.size());
+    }
+
+    for (int ws = 0; ws < n_sources; ++ws)
+        total_outflows[ws] = sources[ws]->getTotal_outflow();
+}
+
+/**
+ * Zeroes the inflows to be accumulated by the next continuity step.
+ */
+void CompiledNetwork::resetInflows() {
+    fill(upstream_inflows.begin(), upstream_inflows.end(), 0.);
+    fill(wastewater_inflows.begin(), wastewater_inflows.end(), 0.);
+}
+
+/**
+ * Performs the mass balance of all water sources following the topological
+ * order, so that upstream is calculated before downstream, and zeroes the
+ * demands on each source once they have been applied.
+ * @param week week of the streamflows and evaporations to be used.
+ * @param demands demands [water source][utility].
+ */
+#pragma GCC optimize("O3")
+void CompiledNetwork::applyContinuity(int week,
+                                      vector<vector<double>> &demands) {
+    for (int i : topological_order) {
+        // Sum spillage from all sources upstream source i.
+        double upstream_inflow = 0.;
+        for (int k = upstream_offsets[i]; k < upstream_offsets[i + 1]; ++k)
+            upstream_inflow += total_outflows[upstream_ids[k]];
+        upstream_inflows[i] = upstream_inflow;
+
+        sources[i]->continuityWaterSource(week, upstream_inflows[i],
+                                          wastewater_inflows[i], demands[i]);
+        total_outflows[i] = sources[i]->getTotal_outflow();
+        fill(demands[i].begin(), demands[i].end(), 0.);
+    }
+}
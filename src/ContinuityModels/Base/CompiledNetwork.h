@@ -0,0 +1,47 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_COMPILEDNETWORK_H
+#define TRIANGLEMODEL_COMPILEDNETWORK_H
+
+#include <vector>
+#include "../../SystemComponents/WaterSources/Base/WaterSource.h"
+#include "../../Utils/Graph/Graph.h"
+
+using namespace std;
+
+/**
+ * Flat snapshot of the water sources graph stepped by the continuity models.
+ * Upstream sources are stored in compressed sparse row form (the upstream
+ * sources of source i are upstream_ids[upstream_offsets[i]] to
+ * upstream_ids[upstream_offsets[i + 1] - 1]) and the state sources read from
+ * their upstream neighbours is kept in arrays indexed by source id, so that
+ * the mass balance loop does not chase pointers or allocate memory.
+ */
+class CompiledNetwork {
+public:
+    int n_sources;
+    vector<int> topological_order;
+    vector<int> upstream_offsets;
+    vector<int> upstream_ids;
+    vector<WaterSource *> sources;
+
+    /// State of each source at the end of the last continuity step.
+    vector<double> total_outflows;
+    /// Inflows to each source being calculated in the current step.
+    vector<double> upstream_inflows;
+    vector<double> wastewater_inflows;
+
+    CompiledNetwork();
+
+    CompiledNetwork(const Graph &water_sources_graph,
+                    const vector<WaterSource *> &water_sources);
+
+    void resetInflows();
+
+    void applyContinuity(int week, vector<vector<double>> &demands);
+};
+
+
+#endif //TRIANGLEMODEL_COMPILEDNETWORK_H
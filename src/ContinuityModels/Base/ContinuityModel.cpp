@@ -27,7 +27,28 @@ ContinuityModel::ContinuityModel(vector<WaterSource *> &water_sources, vector<Ut
         n_sources((int) water_sources.size()),
         realization_id(realization_id)
         {
+    bindComponents(water_sources, utilities);
 
+    // populate array delta_realization_weeks so that the rounding and casting don't
+    // have to be done every time continuityStep is called, avoiding a bottleneck.
+    // Variable delta_realization_weeks[0] is to be zero representing a continuity
+    // step for a non-ROF simulation: the realization itself.
+    delta_realization_weeks[0] = 0;
+    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
+        delta_realization_weeks[r + 1] = (int) std::round((r + 1) * WEEKS_IN_YEAR);
+    }
+}
+
+/**
+ * Links the model's water sources, utilities and controls to each other and
+ * builds the tables derived from them.
+ * @param water_sources water sources in the order they were passed to the
+ * model, before being sorted by id.
+ * @param utilities utilities in the order they were passed to the model,
+ * before being sorted by id.
+ */
+void ContinuityModel::bindComponents(vector<WaterSource *> &water_sources,
+                                     vector<Utility *> &utilities) {
     //FIXME: THERE IS A STUPID MISTAKE HERE IN THE SORT FUNCTION THAT IS PREVENTING IT FROM WORKING UNDER WINDOWS AND LINUX.
     std::sort(continuity_water_sources.begin(), continuity_water_sources.end(), WaterSource::compare);
     std::sort(continuity_utilities.begin(), continuity_utilities.end(), Utility::compById);
@@ -62,6 +83,7 @@ ContinuityModel::ContinuityModel(vector<WaterSource *> &water_sources, vector<Ut
 
     // The variables below are to make the storage-ROF table calculation
     // faster by limiting the storage curve shifting to online water sources.
+    water_sources_capacities.clear();
     for (auto water_source : water_sources) {
         bool online = false;
 
@@ -80,6 +102,7 @@ ContinuityModel::ContinuityModel(vector<WaterSource *> &water_sources, vector<Ut
 
     // Populate vector with utilities capacities and check if all utilities
     // have storage capacity.
+    utilities_capacities.clear();
     for (Utility *u : continuity_utilities) {
         utilities_capacities.push_back(u->getTotal_storage_capacity());
         if (utilities_capacities.back() == 0) {
@@ -93,6 +116,7 @@ ContinuityModel::ContinuityModel(vector<WaterSource *> &water_sources, vector<Ut
     }
 
     // Populate vector indicating the downstream source from each source.
+    downstream_sources.clear();
     for (vector<int> ds : water_sources_graph.getDownSources()) {
         if (ds.empty()) {
             downstream_sources.push_back(NON_INITIALIZED);
@@ -114,18 +138,47 @@ ContinuityModel::ContinuityModel(vector<WaterSource *> &water_sources, vector<Ut
     demands = std::vector<vector<double>>(
             continuity_water_sources.size(),
             vector<double>(continuity_utilities.size(), 0.));
-    
-    // populate array delta_realization_weeks so that the rounding and casting don't
-    // have to be done every time continuityStep is called, avoiding a bottleneck.
-    // Variable delta_realization_weeks[0] is to be zero representing a continuity
-    // step for a non-ROF simulation: the realization itself.
-    delta_realization_weeks[0] = 0;
-    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
-        delta_realization_weeks[r + 1] = (int) std::round((r + 1) * WEEKS_IN_YEAR);
-    }
+
+    // Flat version of the water sources graph to be stepped by
+    // continuityStep.
+    network = CompiledNetwork(water_sources_graph, continuity_water_sources);
+}
+
+/**
+ * Replaces the model's water sources, utilities and controls, which are
+ * deleted, by the ones of another realization, so that the model can be
+ * reused instead of built again. The new components must be copies of the
+ * ones the model was built with.
+ * @param water_sources
+ * @param utilities
+ * @param min_env_flow_controls
+ * @param utilities_rdm
+ * @param water_sources_rdm
+ * @param realization_id
+ */
+void ContinuityModel::rebindComponents(
+        vector<WaterSource *> &water_sources, vector<Utility *> &utilities,
+        vector<MinEnvFlowControl *> &min_env_flow_controls,
+        const vector<double> &utilities_rdm,
+        const vector<double> &water_sources_rdm,
+        unsigned long realization_id) {
+    deleteComponents();
+
+    continuity_water_sources = water_sources;
+    continuity_utilities = utilities;
+    this->min_env_flow_controls = min_env_flow_controls;
+    this->utilities_rdm = utilities_rdm;
+    this->water_sources_rdm = water_sources_rdm;
+    this->realization_id = realization_id;
+
+    bindComponents(water_sources, utilities);
 }
 
 ContinuityModel::~ContinuityModel() {
+    deleteComponents();
+}
+
+void ContinuityModel::deleteComponents() {
     /// Delete water sources
     for (auto ws : continuity_water_sources) {
         delete ws;
@@ -150,10 +203,7 @@ ContinuityModel::~ContinuityModel() {
  */
 void ContinuityModel::continuityStep(
         int week, int rof_realization, bool apply_demand_buffer) {
-    double* upstream_spillage = new double[n_sources];
-    fill_n(upstream_spillage, n_sources, 0.);
-    double* wastewater_discharges = new double[n_sources];
-    fill_n(wastewater_discharges, n_sources, 0.);
+    network.resetInflows();
 
     // if ROF calculations use previous year unless this is the first year (to
     // simplify data input, since the first year of the simulation is probably
@@ -172,7 +222,8 @@ void ContinuityModel::continuityStep(
      * source, and (2) sums the flow contributions of upstream reservoirs.
      */
     for (Utility *u : continuity_utilities) {
-        u->calculateWastewater_releases(week_demand, wastewater_discharges);
+        u->calculateWastewater_releases(week_demand,
+                                        network.wastewater_inflows.data());
         u->splitDemands(week_demand, demands, apply_demand_buffer);
     }
 
@@ -192,31 +243,17 @@ void ContinuityModel::continuityStep(
      * from source catchments for each rof year realization. If this is not an
      * rof calculation but an actual simulation instead, rof_realization will
      * be equal to -1 (see header file) so that there is no week shift.
+     * The value of rof_realization for a a non-ROF continuity step is -1
+     * (NON_INITIALIZED), so adding 1 brings it to delta_realization_weeks[0]
+     * which is 0, while delta_realization_weeks[1] is 52, and so on.
      */
-    auto& upstream_sources_ids = water_sources_graph.getUpstream_sources();
-    for (int i : sources_topological_order) {
-        // Sum spillage from all sources upstream source i.
-        for (int ws : upstream_sources_ids[i]) {
-            upstream_spillage[i] += continuity_water_sources.at(
-                            static_cast<unsigned long>(ws))->getTotal_outflow();
-        }
-
-        // Mass balance. The value of rof_realization for a a non-ROF continuity
-	// step is -1 (NON_INITIALIZED), so adding 1 brings it to delta_realization_weeks[0]
-	// which is 0, while delta_realization_weeks[1] is 52, and so on.
-        continuity_water_sources[i]->continuityWaterSource(
-                week - delta_realization_weeks[rof_realization + 1],
-                upstream_spillage[i], wastewater_discharges[i], demands[i]);
-        demands[i] = vector<double>(n_utilities, 0.);
-    }
+    network.applyContinuity(week - delta_realization_weeks[rof_realization + 1],
+                            demands);
 
     // updates combined storage for utilities.
     for (Utility *u : continuity_utilities) {
         u->updateTotalAvailableVolume();
     }
-
-    delete[] upstream_spillage;
-    delete[] wastewater_discharges;
 }
 
 void ContinuityModel::setRealization(unsigned long realization_id, const vector<double> &utilities_rdm,
@@ -10,6 +10,7 @@
 #include "../../SystemComponents/Utility/Utility.h"
 #include "../../Utils/Graph/Graph.h"
 #include "../../Controls/Base/MinEnvFlowControl.h"
+#include "CompiledNetwork.h"
 #include <vector>
 
 using namespace Constants;
@@ -31,15 +32,28 @@ protected:
     vector<double> water_sources_capacities;
     vector<double> utilities_capacities;
     vector<vector<double>> demands;
-    const vector<double> utilities_rdm;
-    const vector<double> water_sources_rdm;
+    CompiledNetwork network;
+    vector<double> utilities_rdm;
+    vector<double> water_sources_rdm;
     const int n_utilities;
     const int n_sources;
     int delta_realization_weeks[NUMBER_REALIZATIONS_ROF + 1];
 //    int delta_realization_weeks[NUMBER_REALIZATIONS_ROF];
 
+    void bindComponents(vector<WaterSource *> &water_sources,
+                        vector<Utility *> &utilities);
+
+    void rebindComponents(vector<WaterSource *> &water_sources,
+                          vector<Utility *> &utilities,
+                          vector<MinEnvFlowControl *> &min_env_flow_controls,
+                          const vector<double> &utilities_rdm,
+                          const vector<double> &water_sources_rdm,
+                          unsigned long realization_id);
+
+    void deleteComponents();
+
 public:
-    const unsigned long realization_id;
+    unsigned long realization_id;
 
     ContinuityModel(vector<WaterSource *> &water_sources, vector<Utility *> &utilities,
                     vector<MinEnvFlowControl *> &min_env_flow_controls,
@@ -6,8 +6,10 @@
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include "ContinuityModelROF.h"
 #include "../Utils/Utils.h"
+#include "../Controls/StorageMinEnvFlowControl.h"
 
 ContinuityModelROF::ContinuityModelROF(vector<WaterSource *> water_sources, const Graph &water_sources_graph,
                                        const vector<vector<int>> &water_sources_to_utilities,
@@ -15,28 +17,39 @@ ContinuityModelROF::ContinuityModelROF(vector<WaterSource *> water_sources, cons
                                        vector<MinEnvFlowControl *> min_env_flow_controls,
                                        const vector<double> &utilities_rdm,
                                        const vector<double> &water_sources_rdm, unsigned long total_weeks_simulation,
-                                       const int use_precomputed_rof_tables, const unsigned long realization_id)
+                                       const int use_precomputed_rof_tables, const unsigned long realization_id,
+                                       const bool calculates_rofs)
         : ContinuityModel(water_sources, utilities, min_env_flow_controls,
                           water_sources_graph, water_sources_to_utilities, utilities_rdm,
                           water_sources_rdm,
                           realization_id),
           n_topo_sources((int) sources_topological_order.size()),
           use_precomputed_rof_tables(use_precomputed_rof_tables) {
-    // update utilities' total stored volume
-    for (Utility *u : this->continuity_utilities) {
-        u->updateTotalAvailableVolume();
-        u->setNoFinaicalCalculations();
-    }
-
-    for (int u = 0; u < n_utilities; ++u) {
-        ut_storage_to_rof_rof_realization.emplace_back(
-                (unsigned long) ceil(WEEKS_IN_YEAR),
-                (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS + 1);
-        if (use_precomputed_rof_tables != IMPORT_ROF_TABLES) {
-            ut_storage_to_rof_table.emplace_back(
-                    total_weeks_simulation,
+    // Models only used for continuity steps, such as the ones insurance
+    // policies use for pricing, do not need the storage-ROF tables nor the
+    // lanes state, which are large.
+    if (calculates_rofs) {
+        for (int u = 0; u < n_utilities; ++u) {
+            ut_storage_to_rof_rof_realization.emplace_back(
+                    (unsigned long) ceil(WEEKS_IN_YEAR),
                     (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS + 1);
+            if (use_precomputed_rof_tables != IMPORT_ROF_TABLES) {
+                ut_storage_to_rof_table.emplace_back(
+                        total_weeks_simulation,
+                        (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS + 1);
+            }
         }
+
+        n_tier_words = (NO_OF_INSURANCE_STORAGE_TIERS + 1 + 63) / 64;
+        tier_delta_storages = Matrix2D<double>(
+                n_sources, NO_OF_INSURANCE_STORAGE_TIERS + 1);
+        tier_available_volumes = tier_delta_storages;
+        tier_utility_storages = vector<double>(
+                (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS + 1);
+        utility_supply_fractions = vector<vector<double>>(
+                (unsigned long) n_utilities);
+        tier_failures = vector<uint64_t>(
+                (unsigned long) (n_utilities * n_tier_words));
     }
 
     // Record which sources have no downstream sources.
@@ -44,6 +57,85 @@ ContinuityModelROF::ContinuityModelROF(vector<WaterSource *> water_sources, cons
     for (int ws : sources_topological_order)
         storage_wout_downstream[ws] = downstream_sources[ws] != NON_INITIALIZED;
 
+    // Allocate the state for running all ROF years at once, if all
+    // minimum environmental flow controls can be evaluated that way.
+    lanes_supported = calculates_rofs && lanesSupported();
+    if (lanes_supported) {
+        source_lanes = vector<SourceLanes>((unsigned long) n_sources);
+        utility_lanes = vector<UtilityLanes>((unsigned long) n_utilities);
+        demands_lanes = vector<vector<vector<double>>>(
+                (unsigned long) n_sources, vector<vector<double>>(
+                        (unsigned long) n_utilities,
+                        vector<double>(NUMBER_REALIZATIONS_ROF, 0.)));
+        upstream_spillage_lanes = vector<vector<double>>(
+                (unsigned long) n_sources,
+                vector<double>(NUMBER_REALIZATIONS_ROF, 0.));
+        wastewater_discharges_lanes = upstream_spillage_lanes;
+        control_release_lanes = vector<vector<double>>(
+                min_env_flow_controls.size(),
+                vector<double>(WEEKS_ROF_LONG_TERM * NUMBER_REALIZATIONS_ROF,
+                               0.));
+        year_failure_lanes = vector<vector<double>>(
+                (unsigned long) n_utilities,
+                vector<double>(NUMBER_REALIZATIONS_ROF, NON_FAILURE));
+        for (int u = 0; u < n_utilities; ++u) {
+            ut_storage_to_rof_lanes.emplace_back(
+                    (unsigned long) NUMBER_REALIZATIONS_ROF,
+                    (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS + 1);
+        }
+    }
+
+    source_with_control = vector<bool>((unsigned long) n_sources, false);
+    for (MinEnvFlowControl *c : min_env_flow_controls)
+        source_with_control[c->water_source_id] = true;
+
+    resetROFState();
+}
+
+/**
+ * Rebinds the model to copies of the water sources, utilities and controls
+ * of another realization, keeping the storage-ROF tables and lanes state
+ * that were allocated when the model was built.
+ * @param water_sources
+ * @param utilities
+ * @param min_env_flow_controls
+ * @param utilities_rdm
+ * @param water_sources_rdm
+ * @param realization_id
+ */
+void ContinuityModelROF::rebind(vector<WaterSource *> &water_sources,
+                                vector<Utility *> &utilities,
+                                vector<MinEnvFlowControl *> &min_env_flow_controls,
+                                const vector<double> &utilities_rdm,
+                                const vector<double> &water_sources_rdm,
+                                unsigned long realization_id) {
+    rebindComponents(water_sources, utilities, min_env_flow_controls,
+                     utilities_rdm, water_sources_rdm, realization_id);
+
+    for (auto &t : ut_storage_to_rof_rof_realization)
+        t.reset(NON_FAILURE);
+    for (auto &t : ut_storage_to_rof_table)
+        t.reset(NON_FAILURE);
+    utility_base_storage_capacity.clear();
+    utility_base_delta_capacity_table.clear();
+    realization_water_sources.clear();
+    realization_utilities.clear();
+    beginning_tier = 0;
+
+    resetROFState();
+}
+
+/**
+ * Sets up the part of the model state that depends on its water sources and
+ * utilities.
+ */
+void ContinuityModelROF::resetROFState() {
+    // update utilities' total stored volume
+    for (Utility *u : this->continuity_utilities) {
+        u->updateTotalAvailableVolume();
+        u->setNoFinaicalCalculations();
+    }
+
     // Get next online downstream source for each source.
     online_downstream_sources = getOnlineDownstreamSources();
 
@@ -64,18 +156,225 @@ ContinuityModelROF::ContinuityModelROF(vector<WaterSource *> water_sources, cons
         current_storage_table_shift =
                 vector<double>((unsigned long) n_utilities);
     }
+
+    if (lanes_supported) {
+        for (int ws = 0; ws < n_sources; ++ws) {
+            continuity_water_sources[ws]->saveLaneState(source_lanes[ws], 0);
+            source_lanes[ws].allocated =
+                    continuity_water_sources[ws]->source_type ==
+                    ALLOCATED_RESERVOIR;
+        }
+    }
+}
+
+/**
+ * Sets the cache long-term ROFs are looked up in, or nullptr for none.
+ * @param long_term_rof_cache
+ */
+void ContinuityModelROF::setLongTermROFCache(
+        LongTermROFCache *long_term_rof_cache) {
+    ContinuityModelROF::long_term_rof_cache = long_term_rof_cache;
+}
+
+/**
+ * Sets the settings short-term ROFs are sampled adaptively with, which may
+ * be shared with other models, or nullptr for always running all years.
+ * @param adaptive_rof_sampling
+ * @param utilities_rof_triggers short-term ROF triggers of each utility.
+ */
+void ContinuityModelROF::setAdaptiveROFSampling(
+        AdaptiveROFSampling *adaptive_rof_sampling,
+        const vector<vector<double>> &utilities_rof_triggers) {
+    ContinuityModelROF::adaptive_rof_sampling = adaptive_rof_sampling;
+    ContinuityModelROF::utilities_rof_triggers = utilities_rof_triggers;
+}
+
+/**
+ * Runs ROF years one at a time even if they could all be run at once, for
+ * comparing both engines or checking a source's applyContinuityLanes.
+ */
+void ContinuityModelROF::disableROFLanes() {
+    lanes_supported = false;
+}
+
+/**
+ * Sets the storage bound short-term ROFs are checked against before being
+ * simulated, which may be shared with other models, or nullptr for always
+ * simulating them.
+ * @param storage_bound_rof
+ * @param rof_table_used whether the storage-ROF table is exported or used
+ * by policies, in which case ROF years must always be simulated so that the
+ * table is filled.
+ */
+void ContinuityModelROF::setStorageBoundROF(StorageBoundROF *storage_bound_rof,
+                                            bool rof_table_used) {
+    ContinuityModelROF::storage_bound_rof = storage_bound_rof;
+    ContinuityModelROF::rof_table_used = rof_table_used;
+    if (storage_bound_rof != nullptr) {
+        source_natural_loss_bounds.resize((unsigned long) n_sources);
+        source_outflow_bounds.resize((unsigned long) n_sources);
+        source_max_releases.resize((unsigned long) n_sources);
+        utility_demand_bounds.resize((unsigned long) n_utilities);
+        utility_max_restricted_demands.resize((unsigned long) n_utilities);
+        utility_demand_failures.resize((unsigned long) n_utilities);
+        tier_volume_bounds.resize((unsigned long) n_sources);
+        utility_source_loss_bounds.resize((unsigned long) n_sources);
+        utility_tier_demand_losses.resize((unsigned long) n_utilities);
+        source_supply_fractions.resize((unsigned long) n_sources);
+    }
 }
 
 ContinuityModelROF::~ContinuityModelROF() {
     delete[] storage_wout_downstream;
 }
 
+/**
+ * Calculates the long-term ROF for a given week, looking it up in the
+ * long-term ROF cache if one was set.
+ * @param week for which rof is to be calculated.
+ */
+vector<double> ContinuityModelROF::calculateLongTermROF(int week) {
+    if (long_term_rof_cache == nullptr)
+        return calculateLongTermROFFullCalcs(week);
+
+    // checks if new infrastructure became available and, if so, set the
+    // corresponding realization infrastructure online, which is part of the
+    // key.
+    updateOnlineInfrastructure(week);
+
+    vector<double> risk_of_failure;
+    longTermROFKey(week, long_term_rof_key);
+    if (long_term_rof_cache->find(long_term_rof_key, risk_of_failure,
+                                  long_term_rof_end_state)) {
+        // Leave the model as if the ROFs had been calculated.
+        loadROFState(long_term_rof_end_state);
+    } else {
+        risk_of_failure = calculateLongTermROFFullCalcs(week);
+        saveROFState(long_term_rof_end_state);
+        long_term_rof_cache->insert(long_term_rof_key, risk_of_failure,
+                                    long_term_rof_end_state);
+    }
+
+    return risk_of_failure;
+}
+
+/**
+ * Builds the key of the long-term ROF cache for a given week, which has all
+ * inputs of the long-term ROF calculations besides the streamflows,
+ * evaporation and demand series, which are determined by the realization
+ * and the RDM factors. These are: the realization, week and RDM factors,
+ * which sources are online and in which order each utility had them come
+ * online, source and utility capacities, utilities' demand buffers and
+ * multipliers, and the state carried over from the last ROF calculation
+ * that is not reset before the next one, namely the utilities' restricted
+ * demands (which set the first week's wastewater discharges) and the
+ * minimum environmental outflows of sources without a control.
+ * @param week
+ * @param key
+ */
+void ContinuityModelROF::longTermROFKey(int week, vector<double> &key) const {
+    key.clear();
+    key.push_back((double) realization_id);
+    key.push_back((double) week);
+    key.insert(key.end(), utilities_rdm.begin(), utilities_rdm.end());
+    key.insert(key.end(), water_sources_rdm.begin(), water_sources_rdm.end());
+
+    for (int ws = 0; ws < n_sources; ++ws) {
+        WaterSource *water_source = continuity_water_sources[ws];
+        key.push_back(water_source->isOnline());
+        key.push_back(water_source->getSupplyCapacity());
+        key.push_back(water_source->getTotal_treatment_capacity());
+        if (!source_with_control[ws])
+            key.push_back(water_source->getMin_environmental_outflow());
+    }
+
+    for (int u = 0; u < n_utilities; ++u) {
+        Utility *utility = continuity_utilities[u];
+        key.push_back(utility->getDemand_buffer());
+        key.push_back(utility->getDemand_multiplier());
+        key.push_back(utility->getDemand_offset());
+        key.push_back(utility->getTotal_storage_capacity());
+        key.push_back(utility->getTotal_treatment_capacity());
+        key.push_back(utility->getRestrictedDemand());
+        key.push_back((double) water_sources_online_to_utilities[u].size());
+        for (int ws : water_sources_online_to_utilities[u])
+            key.push_back((double) ws);
+    }
+}
+
+/**
+ * Saves the state the water sources and utilities carry from one week to
+ * the next, the same saved for each year in the batched ROF calculations.
+ * @param state
+ */
+void ContinuityModelROF::saveROFState(vector<double> &state) const {
+    state.clear();
+    SourceLanes source_state;
+    for (WaterSource *ws : continuity_water_sources) {
+        ws->saveLaneState(source_state, 0);
+        state.push_back(source_state.available_volume[0]);
+        state.push_back(source_state.total_outflow[0]);
+        state.push_back(source_state.upstream_source_inflow[0]);
+        state.push_back(source_state.wastewater_inflow[0]);
+        state.push_back(source_state.upstream_catchment_inflow[0]);
+        state.push_back(source_state.total_demand[0]);
+        state.push_back(source_state.min_environmental_outflow[0]);
+        state.push_back(source_state.evaporated_volume[0]);
+        for (auto &allocated_volume : source_state.available_allocated_volumes)
+            state.push_back(allocated_volume[0]);
+        source_state.available_allocated_volumes.clear();
+    }
+
+    UtilityLanes utility_state;
+    for (Utility *u : continuity_utilities) {
+        u->saveLaneState(utility_state, 0);
+        state.push_back(utility_state.total_available_volume[0]);
+        state.push_back(utility_state.total_stored_volume[0]);
+        state.push_back(utility_state.restricted_demand[0]);
+        state.push_back(utility_state.unfulfilled_demand[0]);
+    }
+}
+
+/**
+ * Sets the water sources and utilities to a state saved by saveROFState.
+ * @param state
+ */
+void ContinuityModelROF::loadROFState(const vector<double> &state) {
+    unsigned long i = 0;
+    SourceLanes source_state;
+    for (WaterSource *ws : continuity_water_sources) {
+        // Size the allocated volumes of the source.
+        ws->saveLaneState(source_state, 0);
+        source_state.available_volume[0] = state[i++];
+        source_state.total_outflow[0] = state[i++];
+        source_state.upstream_source_inflow[0] = state[i++];
+        source_state.wastewater_inflow[0] = state[i++];
+        source_state.upstream_catchment_inflow[0] = state[i++];
+        source_state.total_demand[0] = state[i++];
+        source_state.min_environmental_outflow[0] = state[i++];
+        source_state.evaporated_volume[0] = state[i++];
+        for (auto &allocated_volume : source_state.available_allocated_volumes)
+            allocated_volume[0] = state[i++];
+        ws->loadLaneState(source_state, 0);
+        source_state.available_allocated_volumes.clear();
+    }
+
+    UtilityLanes utility_state;
+    for (Utility *u : continuity_utilities) {
+        utility_state.total_available_volume[0] = state[i++];
+        utility_state.total_stored_volume[0] = state[i++];
+        utility_state.restricted_demand[0] = state[i++];
+        utility_state.unfulfilled_demand[0] = state[i++];
+        u->loadLaneState(utility_state, 0);
+    }
+}
+
 /**
  * Runs one the full rof calculations for realization #realization_id for a
  * given week.
  * @param week for which rof is to be calculated.
  */
-vector<double> ContinuityModelROF::calculateLongTermROF(int week) {
+vector<double> ContinuityModelROF::calculateLongTermROFFullCalcs(int week) {
     // vector where risks of failure will be stored.
     vector<double> risk_of_failure((unsigned long) n_utilities, 0.0);
     vector<double> year_failure((unsigned long) n_utilities, 0.0);
@@ -86,30 +385,36 @@ vector<double> ContinuityModelROF::calculateLongTermROF(int week) {
     updateOnlineInfrastructure(week);
 
     // perform a continuity simulation for NUMBER_REALIZATIONS_ROF (50) yearly
-    // realization.
-    for (int yr = 0; yr < NUMBER_REALIZATIONS_ROF; ++yr) {
-        // reset current reservoirs' and utilities' storage and combined
-        // storage, respectively, in the corresponding realization simulation.
-        resetUtilitiesAndReservoirs(LONG_TERM_ROF);
-
-        for (int w = 0; w < WEEKS_ROF_LONG_TERM; ++w) {
-            // one week continuity time-step.
-            continuityStep(w + week, yr, APPLY_DEMAND_BUFFER);
-
-            // check total available storage for each utility and, if smaller
-            // than the fail ration, increase the number of failed years of
-            // that utility by 1 (FAILURE).
-            for (int u = 0; u < n_utilities; ++u)
-                if (continuity_utilities[u]->getStorageToCapacityRatio() <=
-                    STORAGE_CAPACITY_RATIO_FAIL || continuity_utilities[u]->getUnrestrictedDemand() > 0.9 * continuity_utilities[u]->getTotal_treatment_capacity()) {
-                    year_failure[u] = FAILURE;
-                }
-        }
+    // realization, all years at once if possible.
+    if (lanes_supported) {
+        calculateROFLanes(week, LONG_TERM_ROF, 0, NUMBER_REALIZATIONS_ROF,
+                          risk_of_failure);
+    } else {
+        for (int yr = 0; yr < NUMBER_REALIZATIONS_ROF; ++yr) {
+            // reset current reservoirs' and utilities' storage and combined
+            // storage, respectively, in the corresponding realization
+            // simulation.
+            resetUtilitiesAndReservoirs(LONG_TERM_ROF);
+
+            for (int w = 0; w < WEEKS_ROF_LONG_TERM; ++w) {
+                // one week continuity time-step.
+                continuityStep(w + week, yr, APPLY_DEMAND_BUFFER);
+
+                // check total available storage for each utility and, if
+                // smaller than the fail ration, increase the number of failed
+                // years of that utility by 1 (FAILURE).
+                for (int u = 0; u < n_utilities; ++u)
+                    if (continuity_utilities[u]->getStorageToCapacityRatio() <=
+                        STORAGE_CAPACITY_RATIO_FAIL || continuity_utilities[u]->getUnrestrictedDemand() > 0.9 * continuity_utilities[u]->getTotal_treatment_capacity()) {
+                        year_failure[u] = FAILURE;
+                    }
+            }
 
-        // Count failures and reset failures counter.
-        for (int uu = 0; uu < n_utilities; ++uu) {
-            risk_of_failure[uu] += year_failure[uu];
-            year_failure[uu] = NON_FAILURE;
+            // Count failures and reset failures counter.
+            for (int uu = 0; uu < n_utilities; ++uu) {
+                risk_of_failure[uu] += year_failure[uu];
+                year_failure[uu] = NON_FAILURE;
+            }
         }
     }
 
@@ -121,60 +426,23 @@ vector<double> ContinuityModelROF::calculateLongTermROF(int week) {
     return risk_of_failure;
 }
 
-vector<double> ContinuityModelROF::calculateShortTermROF(int week,
-                                                         int import_export_rof_tables) {
-    vector<double> risk_of_failure;
-    if (import_export_rof_tables == IMPORT_ROF_TABLES) {
-        return ContinuityModelROF::calculateShortTermROFTable(week,
-                                                              realization_utilities,
-                                                              utility_base_storage_capacity,
-                                                              ut_storage_to_rof_table,
-                                                              current_storage_table_shift);
-    } else {
-        return ContinuityModelROF::calculateShortTermROFFullCalcs(week);
-    }
-}
-
 /**
- * Runs one the full rof calculations for realization #realization_id for a
- * given week.
- * @param week for which rof is to be calculated.
+ * Calculates the short-term ROFs of all utilities for a given week, either
+ * by simulation or from imported storage-ROF tables.
+ * @param week
+ * @param import_export_rof_tables
+ * @param risks_of_failure ROFs of all utilities, which must be as long as
+ * the number of utilities.
  */
-vector<double> ContinuityModelROF::calculateShortTermROFTable(int week,
-                                                              vector<Utility *> utilities,
-                                                              vector<double> utilities_base_storage_capacity,
-                                                              const vector<Matrix2D<double>> &ut_storage_to_rof_table,
-                                                              vector<double> current_storage_table_shift) {
-    // vector where risks of failure will be stored.
-    auto n_utilities = utilities.size();
-    vector<double> risk_of_failure(n_utilities, 0.0);
-    double m;
-    for (int u = 0; u < n_utilities; ++u) {
-        // Get current stored volume for utility u.
-        double utility_storage =
-                utilities[u]->getTotal_stored_volume();
-        // Ratio of current and status-quo utility storage capacities
-        //        double m = current_and_base_storage_capacity_ratio[u];
-        m = utilities[u]->getTotal_storage_capacity() /
-            utilities_base_storage_capacity[u];
-        // Calculate base table tier that contains the desired ROF by
-        // shifting the table around based on new infrastructure -- the
-        // shift is made by the part (m - 1) * STORAGE_CAPACITY_RATIO_FAIL *
-        // utility_base_storage_capacity[u] - current_storage_table_shift[u]
-        double storage_convert = utility_storage +
-                                 STORAGE_CAPACITY_RATIO_FAIL *
-                                 utilities_base_storage_capacity[u] *
-                                 (1. - m) + current_storage_table_shift[u];
-        int tier = (int) (storage_convert * NO_OF_INSURANCE_STORAGE_TIERS /
-                          utilities_base_storage_capacity[u]);
-        // Mean ROF between the two tiers of the ROF table where
-        // current storage is located.
-//        risk_of_failure[u] = ut_storage_to_rof_table[u](week, tier);
-        risk_of_failure[u] = (ut_storage_to_rof_table[u](week, tier) +
-                              ut_storage_to_rof_table[u](week, tier + 1)) / 2;
+void ContinuityModelROF::calculateShortTermROF(int week,
+                                               int import_export_rof_tables,
+                                               vector<double> &risks_of_failure) {
+    if (import_export_rof_tables == IMPORT_ROF_TABLES) {
+        lookUpTableROFs(week, realization_utilities, ut_imported_rof_table,
+                        risks_of_failure.data());
+    } else {
+        risks_of_failure = calculateShortTermROFFullCalcs(week);
     }
-
-    return risk_of_failure;
 }
 
 /**
@@ -197,44 +465,131 @@ vector<double> ContinuityModelROF::calculateShortTermROFFullCalcs(int week) {
     // corresponding realization infrastructure online.
     updateOnlineInfrastructure(week);
 
-    // perform a continuity simulation for NUMBER_REALIZATIONS_ROF (50)
-    // yearly realization.
-    for (int yr = 0; yr < NUMBER_REALIZATIONS_ROF; ++yr) {
-        // Reset realization temp tables
-        for (auto &t : ut_storage_to_rof_rof_realization)
-            t.reset(NON_FAILURE);
-
-        // reset current reservoirs' and utilities' storage and combined
-        // storage, respectively, in the corresponding realization simulation.
+    prepareStorageToROFTable(INSURANCE_SHIFT_STORAGE_CURVES_THRESHOLD,
+                             to_full);
+
+    // If no utility can fail, ROFs are zero and the ROF years are not run.
+    // Otherwise, the storage-ROF table tiers in which no utility can fail are
+    // not evaluated.
+    bool rof_is_zero = false;
+    int validated_tiers = 0;
+    bounded_tiers = 0;
+    if (storage_bound_rof != nullptr) {
         resetUtilitiesAndReservoirs(SHORT_TERM_ROF);
+        if (boundSourceLosses(week)) {
+            rof_is_zero = !rof_table_used && shortTermROFIsZero();
+            if (!rof_is_zero)
+                bounded_tiers = boundTableTiers();
+        }
+        storage_bound_rof->recordCalculation(rof_is_zero);
+
+        if (rof_is_zero && !storage_bound_rof->isValidating()) {
+            skipShortTermROF(week);
+            return risk_of_failure;
+        } else if (!rof_is_zero) {
+            storage_bound_rof->recordTableRow(
+                    bounded_tiers, max(0, bounded_tiers - beginning_tier));
+        }
 
-        for (int w = 0; w < WEEKS_ROF_SHORT_TERM; ++w) {
-            // one week continuity time-step.
-            continuityStep(w + week, yr, !APPLY_DEMAND_BUFFER);
+        // Evaluate all tiers when validating so that the bounded ones can
+        // be checked.
+        if (storage_bound_rof->isValidating()) {
+            validated_tiers = bounded_tiers;
+            bounded_tiers = 0;
+        }
+    }
 
-            // check total available storage for each utility and, if smaller
-            // than the fail ration, increase the number of failed years of
-            // that utility by 1 (FAILURE).
-            for (int u = 0; u < n_utilities; ++u)
-                if (continuity_utilities[u]->getStorageToCapacityRatio() <=
-                    STORAGE_CAPACITY_RATIO_FAIL || continuity_utilities[u]->getUnrestrictedDemand() > 0.9 * continuity_utilities[u]->getTotal_treatment_capacity()) {
-                    year_failure[u] = FAILURE;
+    // perform a continuity simulation for NUMBER_REALIZATIONS_ROF (50)
+    // yearly realization, all years at once if possible. With adaptive
+    // sampling, years are run in batches until the ROFs are settled.
+    int batch_size = (adaptive_rof_sampling == nullptr ?
+                      NUMBER_REALIZATIONS_ROF :
+                      adaptive_rof_sampling->getBatchSize());
+    int n_years_needed = NUMBER_REALIZATIONS_ROF;
+    int n_years_run = 0;
+    while (n_years_run < NUMBER_REALIZATIONS_ROF) {
+        int end_year = min(n_years_run + batch_size, NUMBER_REALIZATIONS_ROF);
+        if (lanes_supported) {
+            calculateROFLanes(week, SHORT_TERM_ROF, n_years_run, end_year,
+                              risk_of_failure);
+        } else {
+            for (int yr = n_years_run; yr < end_year; ++yr) {
+                // Reset realization temp tables
+                for (auto &t : ut_storage_to_rof_rof_realization)
+                    t.reset(NON_FAILURE);
+
+                // reset current reservoirs' and utilities' storage and
+                // combined storage, respectively, in the corresponding
+                // realization simulation.
+                resetUtilitiesAndReservoirs(SHORT_TERM_ROF);
+
+                for (int w = 0; w < WEEKS_ROF_SHORT_TERM; ++w) {
+                    // one week continuity time-step.
+                    continuityStep(w + week, yr, !APPLY_DEMAND_BUFFER);
+
+                    // check total available storage for each utility and, if
+                    // smaller than the fail ration, increase the number of
+                    // failed years of that utility by 1 (FAILURE).
+                    for (int u = 0; u < n_utilities; ++u)
+                        if (continuity_utilities[u]->getStorageToCapacityRatio() <=
+                            STORAGE_CAPACITY_RATIO_FAIL || continuity_utilities[u]->getUnrestrictedDemand() > 0.9 * continuity_utilities[u]->getTotal_treatment_capacity()) {
+                            year_failure[u] = FAILURE;
+                        }
+
+                    // calculated week of storage-rof table
+                    updateStorageToROFTable(week_of_the_year);
                 }
 
-            // calculated week of storage-rof table
-            updateStorageToROFTable(INSURANCE_SHIFT_STORAGE_CURVES_THRESHOLD,
-                                    week_of_the_year, to_full);
+                // Record ROF realization results into final ROF table for
+                // that week.
+                recordROFStorageTable(ut_storage_to_rof_rof_realization,
+                                      ut_storage_to_rof_table,
+                                      n_utilities, week, week_of_the_year);
+
+                // Count failures and reset failures counter.
+                for (int uu = 0; uu < n_utilities; ++uu) {
+                    risk_of_failure[uu] += year_failure[uu];
+                    year_failure[uu] = NON_FAILURE;
+                }
+            }
         }
+        n_years_run = end_year;
+
+        if (adaptive_rof_sampling != nullptr &&
+            n_years_needed == NUMBER_REALIZATIONS_ROF &&
+            adaptive_rof_sampling->isSettled(risk_of_failure, n_years_run,
+                                             utilities_rof_triggers)) {
+            n_years_needed = n_years_run;
+            adaptive_failures = risk_of_failure;
+            if (!adaptive_rof_sampling->isValidating())
+                break;
+        }
+    }
 
-        // Record ROF realization results into final ROF table for that week.
-        recordROFStorageTable(ut_storage_to_rof_rof_realization,
-                              ut_storage_to_rof_table,
-                              n_utilities, week, week_of_the_year);
+    // Record ROF realizations results into final ROF table for that
+    // week, in the same order as if years had been run one at a time.
+    if (lanes_supported) {
+        for (int r = 0; r < n_years_run; ++r) {
+            for (int u = 0; u < n_utilities; ++u) {
+                double *rof_data =
+                        ut_storage_to_rof_lanes[u].getPointerToElement(r, 0);
+                for (int t = 0; t < NO_OF_INSURANCE_STORAGE_TIERS; ++t)
+                    rof_data[t] /= NUMBER_REALIZATIONS_ROF;
+                ut_storage_to_rof_table[u].add_to_position(
+                        week, 0, rof_data, NO_OF_INSURANCE_STORAGE_TIERS);
+            }
+        }
+    }
 
-        // Count failures and reset failures counter.
-        for (int uu = 0; uu < n_utilities; ++uu) {
-            risk_of_failure[uu] += year_failure[uu];
-            year_failure[uu] = NON_FAILURE;
+    // Table rows of weeks for which not all years were run are averages
+    // over the years that were.
+    if (n_years_run < NUMBER_REALIZATIONS_ROF) {
+        double scale = (double) NUMBER_REALIZATIONS_ROF / n_years_run;
+        for (int u = 0; u < n_utilities; ++u) {
+            double *rof_data =
+                    ut_storage_to_rof_table[u].getPointerToElement(week, 0);
+            for (int t = 0; t < NO_OF_INSURANCE_STORAGE_TIERS; ++t)
+                rof_data[t] *= scale;
         }
     }
 
@@ -242,8 +597,28 @@ vector<double> ContinuityModelROF::calculateShortTermROFFullCalcs(int week) {
                         beginning_tier);
 
     // Finish ROF calculations
+    for (int u = 0; u < n_utilities; ++u)
+        risk_of_failure[u] /= n_years_run;
+
+    if (storage_bound_rof != nullptr && storage_bound_rof->isValidating())
+        validateStorageBound(week, risk_of_failure, rof_is_zero,
+                             validated_tiers);
+
+    // When validating adaptive sampling, all years were run but the ROFs
+    // of the years that were needed are the ones used.
+    if (adaptive_rof_sampling != nullptr) {
+        adaptive_rof_sampling->recordCalculation(n_years_needed);
+        if (n_years_needed < n_years_run) {
+            for (int u = 0; u < n_utilities; ++u)
+                adaptive_failures[u] /= n_years_needed;
+            adaptive_rof_sampling->recordDecisions(adaptive_failures,
+                                                   risk_of_failure,
+                                                   utilities_rof_triggers);
+            risk_of_failure = adaptive_failures;
+        }
+    }
+
     for (int u = 0; u < n_utilities; ++u) {
-        risk_of_failure[u] /= NUMBER_REALIZATIONS_ROF;
         if (std::isnan(risk_of_failure[u])) {
             string error_m = "nan rof imported tables. Realization " +
                              to_string(realization_id) + ", week " +
@@ -257,131 +632,533 @@ vector<double> ContinuityModelROF::calculateShortTermROFFullCalcs(int week) {
 }
 
 /**
- * Updates approximate ROF table based on continuity realization ran for
- * simulation based ROF calculations.
- * @param storage_percent_decrement
- * @param week_of_the_year
- * @param to_full empty volume of all reservoir in ID order.
+ * Bounds from above what can be lost over the short-term ROF years, in
+ * which inflows may be anything from zero (or their lowest, if negative)
+ * upwards: the total restricted demand of each utility, which is never more
+ * than it would be if storage were not limiting, and the largest minimum
+ * environmental outflow and evaporation of each source every week. Also
+ * records each utility's largest restricted demand and whether its demand
+ * exceeds the treatment capacity failure threshold in any week. Sources and
+ * utilities must have been reset to the realization's current state.
+ * @param week
+ * @return false if a control's releases cannot be bounded, in which case
+ * neither can the losses.
  */
-#pragma GCC optimize("O3")
-void ContinuityModelROF::updateStorageToROFTable(
-        double storage_percent_decrement, int week_of_the_year,
-        const double *to_full) {
-    double available_volumes[n_sources];
+bool ContinuityModelROF::boundSourceLosses(int week) {
+    fill(source_max_releases.begin(), source_max_releases.end(), 0.);
+    for (MinEnvFlowControl *c : min_env_flow_controls) {
+        double max_release = c->getMaxRelease();
+        if (max_release < 0.)
+            return false;
+        source_max_releases[c->water_source_id] =
+                max(source_max_releases[c->water_source_id], max_release);
+    }
+
+    for (int u = 0; u < n_utilities; ++u) {
+        Utility *utility = continuity_utilities[u];
+        double failure_demand = 0.9 * utility->getTotal_treatment_capacity();
+        utility_demand_bounds[u] = 0.;
+        utility_max_restricted_demands[u] = 0.;
+        utility_demand_failures[u] = false;
+        for (int w = week; w < week + WEEKS_ROF_SHORT_TERM; ++w) {
+            int week_demand = w - (w > WEEKS_IN_YEAR_ROUND ?
+                                   WEEKS_IN_YEAR_ROUND : NONE);
+            double restricted_demand = max(0., utility->predictRestrictedDemand(
+                    week_demand, !APPLY_DEMAND_BUFFER));
+            utility_demand_bounds[u] += restricted_demand;
+            utility_max_restricted_demands[u] = max(
+                    utility_max_restricted_demands[u], restricted_demand);
+            if (utility->getUnrestrictedDemand(week_demand) > failure_demand)
+                utility_demand_failures[u] = true;
+        }
+    }
+
+    // Sources without a control keep their current outflow, unless it is
+    // reduced by a water quality pool running low.
     for (int ws = 0; ws < n_sources; ++ws) {
-        available_volumes[ws] =
-                continuity_water_sources[ws]->getAvailableSupplyVolume();
+        WaterSource *water_source = continuity_water_sources[ws];
+        double max_outflow = (source_with_control[ws] ?
+                              source_max_releases[ws] :
+                              water_source->getMin_environmental_outflow());
+        source_outflow_bounds[ws] = WEEKS_ROF_SHORT_TERM * max_outflow;
+        source_natural_loss_bounds[ws] = WEEKS_ROF_SHORT_TERM *
+                                         water_source->getMaxWeeklyNaturalLoss();
     }
 
-    // loops over the percent storage levels to populate table. The loop
-    // begins from one level above the level  where at least one failure was
-    // observed in the last iteration. This saves a lot of computational time.
-    for (int s = beginning_tier; s <= NO_OF_INSURANCE_STORAGE_TIERS; ++s) {
-        // calculate delta storage for all reservoirs and array that will
-        // receive the shifted storage curves.
-        double percent_decrement_storage_level =
-                (double) s * storage_percent_decrement;
-        double delta_storage[n_sources];
-        double available_volumes_shifted[n_sources];
-        memcpy(available_volumes_shifted, available_volumes,
-               sizeof(double) * n_sources);
-
-        // calculate the difference between the simulated available water and
-        // the one for the table calculated above based on the percent
-        // decrement.
-        for (int wss = 0; wss < n_sources; ++wss) {
-            delta_storage[wss] = to_full[wss] - water_sources_capacities[wss] *
-                                                percent_decrement_storage_level;
-        }
-
-        // Shift storages.
-        shiftStorages(available_volumes_shifted, delta_storage);
-
-        // Checks for utilities failures.
-        int count_fails = 0;
+    return true;
+}
+
+/**
+ * Checks, with the bounds from boundSourceLosses, whether every utility is
+ * certain to keep its storage ratio above STORAGE_CAPACITY_RATIO_FAIL and
+ * its demand below the treatment capacity failure threshold in all
+ * short-term ROF years. For skipping the years to leave the model as running
+ * them would, utilities must also always have enough water available for
+ * their restricted demands not to be cut and sources without controls must
+ * keep their minimum environmental outflows.
+ *
+ * A utility's demand is drawn from all its sources combined, so what each
+ * source has available to a utility is bounded with the demands of the
+ * other utilities drawing from it only. Allocations of allocated reservoirs
+ * lose nothing to other utilities or to environmental outflows, which come
+ * out of the water quality pool.
+ * @return true if all short-term ROFs are certainly zero.
+ */
+bool ContinuityModelROF::shortTermROFIsZero() {
+    for (int ws = 0; ws < n_sources; ++ws)
+        if (!source_with_control[ws] &&
+            !continuity_water_sources[ws]->keepsMinEnvironmentalOutflow(
+                    source_outflow_bounds[ws], source_natural_loss_bounds[ws],
+                    utility_demand_bounds))
+            return false;
+
+    for (int u = 0; u < n_utilities; ++u) {
+        if (utility_demand_failures[u])
+            return false;
+
+        for (int ws = 0; ws < n_sources; ++ws) {
+            WaterSource *water_source = continuity_water_sources[ws];
+            if (water_source->source_type == ALLOCATED_RESERVOIR) {
+                utility_source_loss_bounds[ws] =
+                        water_source->getAllocatedFraction(u) *
+                        source_natural_loss_bounds[ws];
+            } else {
+                double loss = source_outflow_bounds[ws] +
+                              source_natural_loss_bounds[ws];
+                for (int v : utilities_to_water_sources[ws])
+                    if (v != u)
+                        loss += utility_demand_bounds[v];
+                utility_source_loss_bounds[ws] = loss;
+            }
+        }
+
+        Utility *utility = continuity_utilities[u];
+        double stored_volume = utility->getTotalStoredVolumeLowerBound(
+                utility_source_loss_bounds, utility_demand_bounds[u]);
+        if (!(stored_volume / utility->getTotal_storage_capacity() >
+              STORAGE_CAPACITY_RATIO_FAIL) ||
+            stored_volume < utility_max_restricted_demands[u])
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Counts the storage-ROF table tiers, starting from full storage, in which
+ * no utility can fail in any ROF year, by following shiftStorages with the
+ * lowest volume each source can have given the bounds from
+ * boundSourceLosses. A source retrieves at most what it is short of full
+ * from its downstream source and loses at most its minimum environmental
+ * outflow when it has no spillage. Sources without storage, whose volumes
+ * depend on inflows, are not bounded.
+ *
+ * Demands are left out of the shifted volumes and subtracted from each
+ * utility's storage instead: a volume drawn from a source can at most be
+ * missing from it and from every source downstream of it, weighted by the
+ * utility's supply fractions.
+ * @return number of tiers proven to have no failures.
+ */
+int ContinuityModelROF::boundTableTiers() {
+    for (int u = 0; u < n_utilities; ++u) {
+        fill(source_supply_fractions.begin(), source_supply_fractions.end(),
+             0.);
+        const vector<int> &sources = water_sources_online_to_utilities[u];
+        for (unsigned long i = 0; i < sources.size(); ++i)
+            source_supply_fractions[sources[i]] =
+                    utility_supply_fractions[u][i];
+
+        utility_tier_demand_losses[u] = 0.;
+        for (int v = 0; v < n_utilities; ++v) {
+            double max_weight = 0.;
+            for (int ws = 0; ws < n_sources; ++ws) {
+                const vector<int> &drawing = utilities_to_water_sources[ws];
+                if (find(drawing.begin(), drawing.end(), v) == drawing.end())
+                    continue;
+                double weight = source_supply_fractions[ws];
+                for (int d = online_downstream_sources[ws]; d > 0;
+                     d = online_downstream_sources[d])
+                    weight += source_supply_fractions[d];
+                max_weight = max(max_weight, weight);
+            }
+            utility_tier_demand_losses[u] +=
+                    max_weight * utility_demand_bounds[v];
+        }
+    }
+
+    const int n_tiers = NO_OF_INSURANCE_STORAGE_TIERS + 1;
+    const double no_bound = -numeric_limits<double>::infinity();
+    int s = 0;
+    for (; s < n_tiers; ++s) {
+        for (int ws = 0; ws < n_sources; ++ws) {
+            WaterSource *water_source = continuity_water_sources[ws];
+            bool has_storage = water_source->source_type == RESERVOIR ||
+                               water_source->source_type ==
+                               ALLOCATED_RESERVOIR ||
+                               water_source->source_type == QUARRY;
+            double volume;
+            if (!water_source->isOnline())
+                // Sources not online are bypassed, which empties them but
+                // for their water quality pool allocations.
+                volume = water_source->getAvailableSupplyVolume() -
+                         water_source->getAvailableVolume();
+            else if (water_source->source_type == ALLOCATED_RESERVOIR)
+                // Outflows come out of the water quality pool, which is not
+                // part of the supply volume.
+                volume = water_source->getAvailableSupplyVolume() -
+                         source_natural_loss_bounds[ws];
+            else if (has_storage)
+                volume = water_source->getAvailableSupplyVolume() -
+                         source_outflow_bounds[ws] -
+                         source_natural_loss_bounds[ws];
+            else
+                volume = no_bound;
+            tier_volume_bounds[ws] = volume + tier_delta_storages(ws, s);
+        }
+
+        for (int ws : sources_topological_order) {
+            double capacity = water_sources_capacities[ws];
+            double volume = tier_volume_bounds[ws];
+            if (online_downstream_sources[ws] > 0)
+                tier_volume_bounds[online_downstream_sources[ws]] -=
+                        max(0., capacity - volume);
+            double max_outflow = (source_with_control[ws] ?
+                                  source_max_releases[ws] :
+                                  continuity_water_sources[ws]
+                                          ->getMin_environmental_outflow());
+            tier_volume_bounds[ws] = min(capacity, volume - max_outflow);
+        }
+
+        for (int u = 0; u < n_utilities; ++u) {
+            const vector<int> &sources = water_sources_online_to_utilities[u];
+            double utility_storage = -utility_tier_demand_losses[u];
+            for (unsigned long i = 0; i < sources.size(); ++i)
+                if (utility_supply_fractions[u][i] > 0.)
+                    utility_storage += tier_volume_bounds[sources[i]] *
+                                       utility_supply_fractions[u][i];
+            if (!(utility_storage / utilities_capacities[u] >=
+                  STORAGE_CAPACITY_RATIO_FAIL))
+                return s;
+        }
+    }
+
+    return s;
+}
+
+/**
+ * Leaves the model as running the short-term ROF years would have when all
+ * ROFs are zero: controls are asked for the releases of all years, since
+ * some keep track of previous releases, and utilities are left with the
+ * restricted demand of the last week.
+ * @param week
+ */
+void ContinuityModelROF::skipShortTermROF(int week) {
+    for (MinEnvFlowControl *c : min_env_flow_controls)
+        if (c->type != STORAGE_CONTROLS)
+            for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r)
+                for (int w = 0; w < WEEKS_ROF_SHORT_TERM; ++w)
+                    c->getRelease(w + week);
+
+    int last_week = week + WEEKS_ROF_SHORT_TERM - 1;
+    int last_week_demand = last_week - (last_week > WEEKS_IN_YEAR_ROUND ?
+                                        WEEKS_IN_YEAR_ROUND : NONE);
+    for (Utility *u : continuity_utilities)
+        u->setRestricted_demand(u->predictRestrictedDemand(
+                last_week_demand, !APPLY_DEMAND_BUFFER));
+}
+
+/**
+ * Checks the short-term ROFs and storage-ROF table row of a week against
+ * what the storage bound proved about them.
+ * @param week
+ * @param risk_of_failure ROFs calculated over all years run.
+ * @param rof_is_zero whether the bound proved all ROFs to be zero.
+ * @param bounded_tiers number of tiers proven to have no failures.
+ */
+void ContinuityModelROF::validateStorageBound(
+        int week, const vector<double> &risk_of_failure, bool rof_is_zero,
+        int bounded_tiers) {
+    char error[512];
+    if (rof_is_zero) {
+        int last_week = week + WEEKS_ROF_SHORT_TERM - 1;
+        int last_week_demand = last_week - (last_week > WEEKS_IN_YEAR_ROUND ?
+                                            WEEKS_IN_YEAR_ROUND : NONE);
         for (int u = 0; u < n_utilities; ++u) {
-            double utility_storage = 0;
-            // Calculate combined stored volume for each utility based on
-            // shifted storages.
-            for (int ws : water_sources_online_to_utilities[u])
-                utility_storage += available_volumes_shifted[ws] *
-                                   continuity_water_sources[ws]->getSupplyAllocatedFraction(
-                                           u) *
-                                    (realization_utilities[u]->hasTreatmentConnected(ws)
-                                    &&
-                                    realization_water_sources[ws]->isOnline());
-            // Register failure in the table for each utility meeting
-            // failure criteria.
-            if (utility_storage / utilities_capacities[u] <
-                STORAGE_CAPACITY_RATIO_FAIL) {
-                ut_storage_to_rof_rof_realization[u](week_of_the_year,
-                                                     NO_OF_INSURANCE_STORAGE_TIERS -
-                                                     s) = FAILURE;
-                count_fails++;
+            Utility *utility = continuity_utilities[u];
+            double restricted_demand = utility->predictRestrictedDemand(
+                    last_week_demand, !APPLY_DEMAND_BUFFER);
+            if (risk_of_failure[u] != 0. ||
+                utility->getRestrictedDemand() != restricted_demand) {
+                sprintf(error, "Storage bound proved short-term ROFs to be "
+                               "zero in week %d of realization %lu, but "
+                               "utility %d had a ROF of %f and a last "
+                               "restricted demand of %f instead of %f.",
+                        week, realization_id, u, risk_of_failure[u],
+                        utility->getRestrictedDemand(), restricted_demand);
+                throw logic_error(error);
             }
         }
+    }
 
-        // If all utilities have failed, stop dropping storage level and label
-        // all storage levels below failures.
-        if (count_fails == n_utilities) {
-            for (int ss = s; ss <= NO_OF_INSURANCE_STORAGE_TIERS; ++ss) {
-                for (unsigned long u = 0;
-                     u < (unsigned long) n_utilities; ++u) {
-                    ut_storage_to_rof_rof_realization[u](week_of_the_year,
-                                                         NO_OF_INSURANCE_STORAGE_TIERS -
-                                                         ss)
-                            = FAILURE;
-                }
+    for (int u = 0; u < n_utilities; ++u) {
+        const double *rof_row =
+                ut_storage_to_rof_table[u].getPointerToElement(week, 0);
+        for (int s = 0; s < bounded_tiers; ++s) {
+            if (rof_row[NO_OF_INSURANCE_STORAGE_TIERS - s] != NON_FAILURE) {
+                sprintf(error, "Storage bound proved storage-ROF table tiers "
+                               "0 to %d to have no failures in week %d of "
+                               "realization %lu, but utility %d has a ROF "
+                               "of %f in tier %d.", bounded_tiers - 1, week,
+                        realization_id, u,
+                        rof_row[NO_OF_INSURANCE_STORAGE_TIERS - s], s);
+                throw logic_error(error);
             }
-            break;
         }
     }
 }
 
-//FIXME: MAKE THIS MORE EFFICIENT. THIS METHOD IS THE MOST EXPENSIVE ONE IN THE CODE.
+/**
+ * Precomputes what the storage-ROF table updates of the current week have
+ * in common: the shift in storage of each source for each storage tier and
+ * the fraction of the storage of each source that counts towards each
+ * utility.
+ * @param storage_percent_decrement
+ * @param to_full empty volume of all reservoir in ID order.
+ */
+void ContinuityModelROF::prepareStorageToROFTable(
+        double storage_percent_decrement, const double *to_full) {
+    // calculate the difference between the simulated available water and
+    // the one for each tier of the table based on the percent decrement.
+    for (int ws = 0; ws < n_sources; ++ws) {
+        double *delta_storage = tier_delta_storages.getPointerToElement(ws, 0);
+        for (int s = 0; s <= NO_OF_INSURANCE_STORAGE_TIERS; ++s) {
+            double percent_decrement_storage_level =
+                    (double) s * storage_percent_decrement;
+            delta_storage[s] = to_full[ws] - water_sources_capacities[ws] *
+                                             percent_decrement_storage_level;
+        }
+    }
+
+    for (int u = 0; u < n_utilities; ++u) {
+        utility_supply_fractions[u].clear();
+        for (int ws : water_sources_online_to_utilities[u])
+            utility_supply_fractions[u].push_back(
+                    continuity_water_sources[ws]->getSupplyAllocatedFraction(
+                            u) *
+                    (realization_utilities[u]->hasTreatmentConnected(ws) &&
+                     realization_water_sources[ws]->isOnline()));
+    }
+}
+
+/**
+ * Updates approximate ROF table based on continuity realization ran for
+ * simulation based ROF calculations.
+ * @param week_of_the_year
+ */
+void ContinuityModelROF::updateStorageToROFTable(int week_of_the_year) {
+    double available_volumes[n_sources];
+    double total_outflows[n_sources];
+    double min_environmental_outflows[n_sources];
+    for (int ws = 0; ws < n_sources; ++ws) {
+        available_volumes[ws] =
+                continuity_water_sources[ws]->getAvailableSupplyVolume();
+        total_outflows[ws] = continuity_water_sources[ws]->getTotal_outflow();
+        min_environmental_outflows[ws] =
+                continuity_water_sources[ws]->getMin_environmental_outflow();
+    }
+
+    double *utilities_rof_rows[n_utilities];
+    for (int u = 0; u < n_utilities; ++u) {
+        utilities_rof_rows[u] = ut_storage_to_rof_rof_realization[u]
+                .getPointerToElement(week_of_the_year, 0);
+    }
+
+    updateStorageToROFTable(available_volumes, total_outflows,
+                            min_environmental_outflows, utilities_rof_rows);
+}
+
+/**
+ * Updates approximate ROF table rows of all utilities for one ROF year based
+ * on the state of the water sources in that year. All storage tiers are
+ * evaluated at once, using the storage shifts and supply fractions from
+ * prepareStorageToROFTable.
+ * @param available_volumes available supply volume of each source.
+ * @param total_outflows total outflow of each source.
+ * @param min_environmental_outflows minimum environmental outflow of each
+ * source.
+ * @param utilities_rof_rows table row of each utility to be updated.
+ */
 #pragma GCC optimize("O3")
-void ContinuityModelROF::shiftStorages(
-        double *available_volumes_shifted,
-        const double *delta_storage) {
-    // Add deltas to all sources following the topological order, so that
-    // upstream is calculated before downstream.
-    for (int ws : sources_topological_order) {
-        // calculate initial estimate for shifted
-        available_volumes_shifted[ws] += delta_storage[ws];
+void ContinuityModelROF::updateStorageToROFTable(
+        const double *available_volumes, const double *total_outflows,
+        const double *min_environmental_outflows,
+        double *const *utilities_rof_rows) {
+    // Tiers are only evaluated from one level above the level where at least
+    // one failure was observed in the last week. This saves a lot of
+    // computational time. Tiers the storage bound proved to have no
+    // failures are not evaluated either.
+    const int first_tier = max(beginning_tier, bounded_tiers);
+    const int n_tiers = NO_OF_INSURANCE_STORAGE_TIERS + 1;
+    if (first_tier >= n_tiers)
+        return;
+
+    shiftStorages(available_volumes, total_outflows,
+                  min_environmental_outflows);
+
+    // Flag the tiers at which each utility fails, based on its combined
+    // stored volume from the shifted storages.
+    double *utility_storage = tier_utility_storages.data();
+    for (int u = 0; u < n_utilities; ++u) {
+        fill(utility_storage + first_tier, utility_storage + n_tiers, 0.);
+        const vector<int> &sources = water_sources_online_to_utilities[u];
+        for (unsigned long i = 0; i < sources.size(); ++i) {
+            const double *volumes =
+                    tier_available_volumes.getPointerToElement(sources[i], 0);
+            double supply_fraction = utility_supply_fractions[u][i];
+            for (int s = first_tier; s < n_tiers; ++s)
+                utility_storage[s] += volumes[s] * supply_fraction;
+        }
 
-        double available_volume_to_full = water_sources_capacities[ws] -
-                                          available_volumes_shifted[ws];
+        uint64_t *failures = &tier_failures[u * n_tier_words];
+        fill_n(failures, n_tier_words, 0);
+        double capacity = utilities_capacities[u];
+        for (int s = first_tier; s < n_tiers; ++s)
+            failures[s / 64] |= (uint64_t) (utility_storage[s] / capacity <
+                                            STORAGE_CAPACITY_RATIO_FAIL)
+                    << (s % 64);
+    }
 
-        // if not full, retrieve spill to downstream source.
-        if (available_volume_to_full > 0) {
-            // Calculate spilled water. Since the curves are shifted as the
-            // weeks of the rof realizations are calculated, the minimum
-            // environmental outflows below will be the ones at the time when
-            // the storage is being shifted.
-            double spillage =
-                    continuity_water_sources[ws]->getTotal_outflow() -
-                    continuity_water_sources[ws]
-                            ->getMin_environmental_outflow();
+    // Once all utilities have failed, label all lower storage levels as
+    // failures as well.
+    int first_all_failed = n_tiers;
+    for (int w = 0; w < n_tier_words && first_all_failed == n_tiers; ++w) {
+        uint64_t all_failed = ~0ULL;
+        for (int u = 0; u < n_utilities; ++u)
+            all_failed &= tier_failures[u * n_tier_words + w];
+        if (all_failed != 0)
+            first_all_failed = w * 64 + __builtin_ctzll(all_failed);
+    }
 
-            double spillage_retrieved = min(available_volume_to_full, spillage);
+    for (int u = 0; u < n_utilities; ++u) {
+        const uint64_t *failures = &tier_failures[u * n_tier_words];
+        double *rof_row = utilities_rof_rows[u];
+        for (int s = first_tier; s < n_tiers; ++s)
+            if (s >= first_all_failed || ((failures[s / 64] >> (s % 64)) & 1))
+                rof_row[NO_OF_INSURANCE_STORAGE_TIERS - s] = FAILURE;
+    }
+}
 
-            available_volumes_shifted[ws] += spillage_retrieved;
+/**
+ * Looks up the short-term ROFs of all utilities in storage-ROF tables,
+ * interpolating linearly between the two tiers around each utility's
+ * current storage.
+ * @param week table row.
+ * @param utilities utilities whose storages are looked up.
+ * @param tables storage-ROF table of each utility.
+ * @param risks_of_failure ROF of each utility.
+ */
+#pragma GCC optimize("O3")
+void ContinuityModelROF::lookUpTableROFs(int week,
+                                         const vector<Utility *> &utilities,
+                                         const vector<ROFTable> &tables,
+                                         double *risks_of_failure) const {
+    const auto n_utilities = (int) utilities.size();
+    for (int u = 0; u < n_utilities; ++u)
+        risks_of_failure[u] = lookUpTableROF(
+                week, u, utilities[u]->getTotal_storage_capacity(),
+                utilities[u]->getTotal_stored_volume(), tables[u]);
+}
 
-            if (online_downstream_sources[ws] > 0)
-                available_volumes_shifted[online_downstream_sources[ws]] -=
-                        spillage_retrieved;
+/**
+ * Looks up the short-term ROF of a utility with the given storage in its
+ * storage-ROF table, interpolating linearly between the two tiers around
+ * the storage. The tiers are shifted to account for infrastructure built
+ * since the table was calculated, whose capacity was
+ * utility_base_storage_capacity.
+ * @param week table row.
+ * @param u utility id.
+ * @param total_storage_capacity current storage capacity of the utility.
+ * @param stored_volume storage of the utility.
+ * @param table storage-ROF table of the utility.
+ * @return ROF.
+ */
+double ContinuityModelROF::lookUpTableROF(int week, int u,
+                                          double total_storage_capacity,
+                                          double stored_volume,
+                                          const ROFTable &table) const {
+    double base_storage_capacity = utility_base_storage_capacity[u];
+    // Ratio of current and status-quo utility storage capacities
+    double m = total_storage_capacity / base_storage_capacity;
+    // Calculate base table tier that contains the desired ROF by
+    // shifting the table around based on new infrastructure -- the
+    // shift is made by the part (m - 1) * STORAGE_CAPACITY_RATIO_FAIL *
+    // utility_base_storage_capacity[u] - current_storage_table_shift[u]
+    double storage_convert = stored_volume +
+                             STORAGE_CAPACITY_RATIO_FAIL *
+                             base_storage_capacity * (1. - m) +
+                             current_storage_table_shift[u];
+    return table.interpolate(week, storage_convert *
+                                   NO_OF_INSURANCE_STORAGE_TIERS /
+                                   base_storage_capacity);
+}
+
+/**
+ * Shifts the storage curves of all sources for all storage tiers at once,
+ * following the topological order so that upstream is calculated before
+ * downstream. Spills are computed without branching so that tiers are
+ * processed as vector lanes.
+ * @param available_volumes available supply volume of each source.
+ * @param total_outflows total outflow of each source.
+ * @param min_environmental_outflows minimum environmental outflow of each
+ * source.
+ */
+#pragma GCC optimize("O3")
+void ContinuityModelROF::shiftStorages(
+        const double *available_volumes, const double *total_outflows,
+        const double *min_environmental_outflows) {
+    const int first_tier = max(beginning_tier, bounded_tiers);
+    const int n_tiers = NO_OF_INSURANCE_STORAGE_TIERS + 1;
+    for (int ws = 0; ws < n_sources; ++ws) {
+        double *volumes = tier_available_volumes.getPointerToElement(ws, 0);
+        fill(volumes + first_tier, volumes + n_tiers, available_volumes[ws]);
+    }
+
+    for (int ws : sources_topological_order) {
+        double *volumes = tier_available_volumes.getPointerToElement(ws, 0);
+        const double *delta_storage =
+                tier_delta_storages.getPointerToElement(ws, 0);
+        double capacity = water_sources_capacities[ws];
+        // Since the curves are shifted as the weeks of the rof realizations
+        // are calculated, the minimum environmental outflows below will be
+        // the ones at the time when the storage is being shifted.
+        double spillage = total_outflows[ws] - min_environmental_outflows[ws];
+
+        // If not full, retrieve spill from downstream source. Otherwise,
+        // spill the excess to the downstream source, if any.
+        if (online_downstream_sources[ws] > 0) {
+            double *downstream_volumes = tier_available_volumes
+                    .getPointerToElement(online_downstream_sources[ws], 0);
+            for (int s = first_tier; s < n_tiers; ++s) {
+                double volume = volumes[s] + delta_storage[s];
+                double volume_to_full = capacity - volume;
+                double spilled = (volume_to_full > 0 ?
+                                  min(volume_to_full, spillage) :
+                                  volume_to_full);
+                volumes[s] = volume + spilled;
+                downstream_volumes[s] -= spilled;
+            }
         } else {
-            double spillage = -available_volume_to_full;
-            if (online_downstream_sources[ws] > 0) {
-                available_volumes_shifted[ws] -= spillage;
-                available_volumes_shifted[online_downstream_sources[ws]] +=
-                        spillage;
+            for (int s = first_tier; s < n_tiers; ++s) {
+                double volume = volumes[s] + delta_storage[s];
+                double volume_to_full = capacity - volume;
+                double spilled = (volume_to_full > 0 ?
+                                  min(volume_to_full, spillage) : 0.);
+                volumes[s] = volume + spilled;
             }
         }
     }
 }
 
-
 /**
  * Prints a binary file with the rof_table for a given realization in a
  * given week.
@@ -522,9 +1299,9 @@ void ContinuityModelROF::updateOnlineInfrastructure(int week) {
 }
 
 void ContinuityModelROF::setROFTablesAndShifts(
-        const vector<Matrix2D<double>> &storage_to_rof_table,
+        const vector<ROFTable> &imported_rof_table,
         const vector<vector<double>> &table_storage_shift) {
-    this->ut_storage_to_rof_table = storage_to_rof_table;
+    this->ut_imported_rof_table = imported_rof_table;
     this->table_storage_shift = table_storage_shift;
 }
 
@@ -551,6 +1328,10 @@ vector<Matrix2D<double>> &ContinuityModelROF::getUt_storage_to_rof_table() {
     return ut_storage_to_rof_table;
 }
 
+const vector<ROFTable> &ContinuityModelROF::getUt_imported_rof_table() const {
+    return ut_imported_rof_table;
+}
+
 /**
  * Set first tier for ROF table calculation close to where the first
  * failure was observed for last week's table, so to save computations
@@ -618,3 +1399,358 @@ void ContinuityModelROF::calculateEmptyVolumes(
         }
     }
 }
+
+/**
+ * Checks if the ROF years can be run all at once, which requires that the
+ * minimum environmental flow of every control depends either on the week
+ * alone or on the storage of its own source. Controls depending on the
+ * inflows or on other sources are only evaluated one year at a time.
+ * @return true if calculateROFLanes can be used.
+ */
+bool ContinuityModelROF::lanesSupported() const {
+    for (MinEnvFlowControl *c : min_env_flow_controls) {
+        if (c->type != FIXED_FLOW_CONTROLS && c->type != SEASONAL_CONTROLS &&
+            c->type != STORAGE_CONTROLS)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Runs the continuity simulations of ROF years begin_lane to end_lane - 1
+ * at once and adds their failures to risk_of_failure. Running years one at a
+ * time, each year inherits from the end of the previous one the utilities'
+ * restricted demands (through wastewater discharges) and the minimum
+ * environmental outflows of sources without controls. All years but the
+ * first are run assuming these were not affected by storage during the
+ * previous year, and each year for which the assumption turns out false is
+ * run again on its own, in order, with the values its previous year ended
+ * with. Results are therefore the same as running years one at a time, and
+ * so are the results of running consecutive ranges of years one after the
+ * other, while no year is run more than twice.
+ *
+ * If most years of the previous calculation of the same type had to be run
+ * again, as happens when storage is low enough for restrictions to last
+ * from one year into the next, years are run one at a time from the start
+ * instead of being run twice.
+ * @param week
+ * @param rof_type SHORT_TERM_ROF, which also updates the storage-ROF table
+ * rows in ut_storage_to_rof_lanes, or LONG_TERM_ROF.
+ * @param begin_lane first ROF year to be run.
+ * @param end_lane one past the last ROF year to be run.
+ * @param risk_of_failure
+ */
+void ContinuityModelROF::calculateROFLanes(int week, int rof_type,
+                                           int begin_lane, int end_lane,
+                                           vector<double> &risk_of_failure) {
+    bool short_term = rof_type == SHORT_TERM_ROF;
+    int n_weeks = (short_term ? WEEKS_ROF_SHORT_TERM : WEEKS_ROF_LONG_TERM);
+    bool apply_demand_buffer = !short_term;
+
+    // Releases of controls not depending on storage are the same for all
+    // years, so they are calculated beforehand in the same order as they
+    // would be calculated running years one at a time, because some controls
+    // keep track of previous releases.
+    for (unsigned long c = 0; c < min_env_flow_controls.size(); ++c) {
+        if (min_env_flow_controls[c]->type != STORAGE_CONTROLS) {
+            for (int r = begin_lane; r < end_lane; ++r) {
+                for (int w = 0; w < n_weeks; ++w) {
+                    control_release_lanes[c][w * NUMBER_REALIZATIONS_ROF + r] =
+                            min_env_flow_controls[c]->getRelease(w + week);
+                }
+            }
+        }
+    }
+
+    // Values inherited by the first year to be run and the ones assumed for
+    // the years after it.
+    int last_week = week + n_weeks - 1;
+    int last_week_demand = last_week - (last_week > WEEKS_IN_YEAR_ROUND ?
+                                        WEEKS_IN_YEAR_ROUND : NONE);
+    double carried_restricted_demand[n_utilities];
+    double assumed_restricted_demand[n_utilities];
+    for (int u = 0; u < n_utilities; ++u) {
+        carried_restricted_demand[u] =
+                continuity_utilities[u]->getRestrictedDemand();
+        assumed_restricted_demand[u] = continuity_utilities[u]
+                ->predictRestrictedDemand(last_week_demand,
+                                          apply_demand_buffer);
+    }
+    double carried_min_env_outflow[n_sources];
+    double assumed_min_env_outflow[n_sources];
+    for (int ws = 0; ws < n_sources; ++ws) {
+        carried_min_env_outflow[ws] =
+                continuity_water_sources[ws]->getMin_environmental_outflow();
+        assumed_min_env_outflow[ws] = carried_min_env_outflow[ws];
+    }
+
+    // Run all years at once, or only the first one if years are to be run
+    // one at a time.
+    bool &run_serially = rof_years_run_serially[rof_type];
+    runROFLanes(week, rof_type, begin_lane,
+                run_serially ? begin_lane + 1 : end_lane,
+                carried_restricted_demand, carried_min_env_outflow,
+                assumed_restricted_demand, assumed_min_env_outflow);
+
+    // Run again, in order, the years whose previous year did not end with
+    // the assumed values, and the years not yet run.
+    int n_lanes_not_as_assumed = 0;
+    for (int r = begin_lane + 1; r < end_lane; ++r) {
+        bool as_assumed = laneEndedAsAssumed(r - 1, assumed_restricted_demand,
+                                             assumed_min_env_outflow);
+        if (!as_assumed)
+            n_lanes_not_as_assumed++;
+        if (!as_assumed || run_serially) {
+            for (int u = 0; u < n_utilities; ++u)
+                carried_restricted_demand[u] =
+                        utility_lanes[u].restricted_demand[r - 1];
+            for (int ws = 0; ws < n_sources; ++ws)
+                carried_min_env_outflow[ws] =
+                        source_lanes[ws].min_environmental_outflow[r - 1];
+            runROFLanes(week, rof_type, r, r + 1, carried_restricted_demand,
+                        carried_min_env_outflow, assumed_restricted_demand,
+                        assumed_min_env_outflow);
+        }
+    }
+    run_serially = 2 * n_lanes_not_as_assumed > end_lane - begin_lane - 1;
+
+    // Count failures.
+    for (int u = 0; u < n_utilities; ++u)
+        for (int r = begin_lane; r < end_lane; ++r)
+            risk_of_failure[u] += year_failure_lanes[u][r];
+
+    // Leave water sources and utilities as they would be after running the
+    // last year.
+    for (int ws = 0; ws < n_sources; ++ws)
+        continuity_water_sources[ws]->loadLaneState(source_lanes[ws],
+                                                    end_lane - 1);
+    for (int u = 0; u < n_utilities; ++u) {
+        continuity_utilities[u]->loadLaneState(utility_lanes[u],
+                                               end_lane - 1);
+        continuity_utilities[u]->updateTotalAvailableVolume();
+    }
+}
+
+/**
+ * Runs the continuity simulations of ROF years first_lane to end_lane - 1
+ * at once, with storage-ROF table rows and failures of these years starting
+ * from scratch.
+ * @param week
+ * @param rof_type
+ * @param first_lane
+ * @param end_lane
+ * @param first_restricted_demands restricted demand of each utility at the
+ * beginning of the first year.
+ * @param first_min_env_outflows minimum environmental outflow of each
+ * source at the beginning of the first year.
+ * @param assumed_restricted_demands restricted demand of each utility at
+ * the beginning of the other years.
+ * @param assumed_min_env_outflows minimum environmental outflow of each
+ * source at the beginning of the other years.
+ */
+void ContinuityModelROF::runROFLanes(int week, int rof_type, int first_lane,
+                                     int end_lane,
+                                     const double *first_restricted_demands,
+                                     const double *first_min_env_outflows,
+                                     const double *assumed_restricted_demands,
+                                     const double *assumed_min_env_outflows) {
+    bool short_term = rof_type == SHORT_TERM_ROF;
+    int n_weeks = (short_term ? WEEKS_ROF_SHORT_TERM : WEEKS_ROF_LONG_TERM);
+    bool apply_demand_buffer = !short_term;
+
+    // reset current reservoirs' and utilities' storage and combined
+    // storage, respectively, and copy them to all years to be run.
+    resetUtilitiesAndReservoirs(rof_type);
+    for (int ws = 0; ws < n_sources; ++ws) {
+        continuity_water_sources[ws]->setMin_environmental_outflow(
+                assumed_min_env_outflows[ws]);
+        for (int r = first_lane; r < end_lane; ++r)
+            continuity_water_sources[ws]->saveLaneState(source_lanes[ws], r);
+        source_lanes[ws].min_environmental_outflow[first_lane] =
+                first_min_env_outflows[ws];
+    }
+    for (int u = 0; u < n_utilities; ++u) {
+        for (int r = first_lane; r < end_lane; ++r) {
+            continuity_utilities[u]->saveLaneState(utility_lanes[u], r);
+            utility_lanes[u].restricted_demand[r] =
+                    assumed_restricted_demands[u];
+            year_failure_lanes[u][r] = NON_FAILURE;
+        }
+        utility_lanes[u].restricted_demand[first_lane] =
+                first_restricted_demands[u];
+        if (short_term) {
+            fill_n(ut_storage_to_rof_lanes[u].getPointerToElement(
+                           first_lane, 0),
+                   (end_lane - first_lane) *
+                   (NO_OF_INSURANCE_STORAGE_TIERS + 1), NON_FAILURE);
+        }
+    }
+
+    for (int w = 0; w < n_weeks; ++w) {
+        // one week continuity time-step for all years.
+        continuityStepLanes(w + week, w, first_lane, end_lane,
+                            apply_demand_buffer);
+
+        // check total available storage for each utility and, if smaller
+        // than the fail ration, flag a failure for that year.
+        for (int u = 0; u < n_utilities; ++u) {
+            Utility *utility = continuity_utilities[u];
+            bool demand_failure = utility->getUnrestrictedDemand() >
+                                  0.9 *
+                                  utility->getTotal_treatment_capacity();
+            double capacity = utility->getTotal_storage_capacity();
+            const double *stored_volume =
+                    utility_lanes[u].total_stored_volume.data();
+            double *year_failure = year_failure_lanes[u].data();
+            for (int r = first_lane; r < end_lane; ++r) {
+                if (stored_volume[r] / capacity <=
+                    STORAGE_CAPACITY_RATIO_FAIL || demand_failure)
+                    year_failure[r] = FAILURE;
+            }
+        }
+
+        // calculated week of storage-rof table for each year.
+        if (short_term) {
+            double available_volumes[n_sources];
+            double total_outflows[n_sources];
+            double min_environmental_outflows[n_sources];
+            double *utilities_rof_rows[n_utilities];
+            for (int r = first_lane; r < end_lane; ++r) {
+                for (int ws = 0; ws < n_sources; ++ws) {
+                    available_volumes[ws] =
+                            source_lanes[ws].availableSupplyVolume(r);
+                    total_outflows[ws] = source_lanes[ws].total_outflow[r];
+                    min_environmental_outflows[ws] =
+                            source_lanes[ws].min_environmental_outflow[r];
+                }
+                for (int u = 0; u < n_utilities; ++u)
+                    utilities_rof_rows[u] = ut_storage_to_rof_lanes[u]
+                            .getPointerToElement(r, 0);
+
+                updateStorageToROFTable(available_volumes, total_outflows,
+                                        min_environmental_outflows,
+                                        utilities_rof_rows);
+            }
+        }
+    }
+}
+
+/**
+ * Checks if a ROF year ended with the restricted demands and the minimum
+ * environmental outflows of sources without controls that the next year
+ * was run assuming.
+ * @param lane
+ * @param assumed_restricted_demands
+ * @param assumed_min_env_outflows
+ * @return
+ */
+bool ContinuityModelROF::laneEndedAsAssumed(
+        int lane, const double *assumed_restricted_demands,
+        const double *assumed_min_env_outflows) const {
+    for (int u = 0; u < n_utilities; ++u)
+        if (utility_lanes[u].restricted_demand[lane] !=
+            assumed_restricted_demands[u])
+            return false;
+    for (int ws = 0; ws < n_sources; ++ws)
+        if (!source_with_control[ws] &&
+            source_lanes[ws].min_environmental_outflow[lane] !=
+            assumed_min_env_outflows[ws])
+            return false;
+    return true;
+}
+
+/**
+ * Same as continuityStep but for ROF years first_lane to end_lane - 1 at
+ * once.
+ * @param week current week.
+ * @param step week of the ROF years being calculated, starting at 0.
+ * @param first_lane
+ * @param end_lane
+ * @param apply_demand_buffer
+ */
+#pragma GCC optimize("O3")
+void ContinuityModelROF::continuityStepLanes(int week, int step,
+                                             int first_lane, int end_lane,
+                                             bool apply_demand_buffer) {
+    int n_lanes = end_lane - first_lane;
+    for (int r = first_lane; r < end_lane; ++r)
+        lane_weeks[r] = week - delta_realization_weeks[r + 1];
+
+    for (int ws = 0; ws < n_sources; ++ws) {
+        fill_n(upstream_spillage_lanes[ws].begin() + first_lane, n_lanes, 0.);
+        fill_n(wastewater_discharges_lanes[ws].begin() + first_lane, n_lanes,
+               0.);
+    }
+
+    // ROF calculations use previous year's demands unless this is the
+    // first year.
+    int week_demand = week - (week > WEEKS_IN_YEAR_ROUND ?
+                              WEEKS_IN_YEAR_ROUND : NONE);
+
+    // Get wastewater discharges based on previous week's demand and split
+    // weekly demands among each reservoir for each utility.
+    for (int u = 0; u < n_utilities; ++u) {
+        continuity_utilities[u]->calculateWastewater_releasesLanes(
+                week_demand, utility_lanes[u], wastewater_discharges_lanes,
+                first_lane, end_lane);
+        continuity_utilities[u]->splitDemandsLanes(
+                week_demand, source_lanes, demands_lanes, apply_demand_buffer,
+                utility_lanes[u], first_lane, end_lane);
+    }
+
+    // Set minimum environmental flows for water sources based on their
+    // individual controls.
+    for (unsigned long c = 0; c < min_env_flow_controls.size(); ++c) {
+        MinEnvFlowControl *control = min_env_flow_controls[c];
+        double *min_env_outflow = source_lanes[control->water_source_id]
+                .min_environmental_outflow.data();
+        if (control->type == STORAGE_CONTROLS) {
+            auto *storage_control =
+                    dynamic_cast<StorageMinEnvFlowControl *>(control);
+            const double *source_storage =
+                    source_lanes[storage_control->water_source_id]
+                            .available_volume.data();
+            const vector<double> &storages = storage_control->storages;
+            const vector<double> &releases = storage_control->releases;
+            for (int r = first_lane; r < end_lane; ++r) {
+                double release = 0;
+                for (unsigned long i = 0; i < storages.size(); ++i) {
+                    release = (source_storage[r] >= storages[i] ?
+                               releases[i] : release);
+                }
+                min_env_outflow[r] = release;
+            }
+        } else {
+            memcpy(min_env_outflow + first_lane,
+                   control_release_lanes[c].data() +
+                   step * NUMBER_REALIZATIONS_ROF + first_lane,
+                   sizeof(double) * n_lanes);
+        }
+    }
+
+    // Mass balance for all water sources following the topological order,
+    // so that upstream is calculated before downstream.
+    for (int i : network.topological_order) {
+        double *upstream_spillage = upstream_spillage_lanes[i].data();
+        for (int k = network.upstream_offsets[i];
+             k < network.upstream_offsets[i + 1]; ++k) {
+            const double *outflow =
+                    source_lanes[network.upstream_ids[k]].total_outflow.data();
+            for (int r = first_lane; r < end_lane; ++r)
+                upstream_spillage[r] += outflow[r];
+        }
+
+        continuity_water_sources[i]->applyContinuityLanes(
+                lane_weeks, first_lane, end_lane, upstream_spillage,
+                wastewater_discharges_lanes[i].data(), demands_lanes[i],
+                source_lanes[i]);
+        for (auto &d : demands_lanes[i])
+            fill_n(d.begin() + first_lane, n_lanes, 0.);
+    }
+
+    // updates combined storage for utilities.
+    for (int u = 0; u < n_utilities; ++u)
+        continuity_utilities[u]->updateTotalAvailableVolumeLanes(
+                source_lanes, utility_lanes[u], first_lane, end_lane);
+}
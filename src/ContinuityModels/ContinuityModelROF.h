@@ -8,6 +8,10 @@
 
 #include "Base/ContinuityModel.h"
 #include "../Utils/Matrices.h"
+#include "../Utils/ROFTable.h"
+#include "LongTermROFCache.h"
+#include "AdaptiveROFSampling.h"
+#include "StorageBoundROF.h"
 
 
 class ContinuityModelROF : public ContinuityModel {
@@ -20,11 +24,87 @@ private:
     const int n_topo_sources;
     const int use_precomputed_rof_tables;
 
+    /// State for advancing all NUMBER_REALIZATIONS_ROF years at once.
+    bool lanes_supported;
+    int lane_weeks[NUMBER_REALIZATIONS_ROF];
+    vector<SourceLanes> source_lanes;
+    vector<UtilityLanes> utility_lanes;
+    vector<vector<vector<double>>> demands_lanes;
+    vector<vector<double>> upstream_spillage_lanes;
+    vector<vector<double>> wastewater_discharges_lanes;
+    vector<vector<double>> control_release_lanes;
+    vector<vector<double>> year_failure_lanes;
+    vector<Matrix2D<double>> ut_storage_to_rof_lanes;
+    vector<bool> source_with_control;
+    /// Whether most years of the last ROF calculation of each type had to be
+    /// run again, in which case years are run one at a time.
+    bool rof_years_run_serially[2] = {false, false};
+
+    /// State for evaluating all storage tiers of a table row at once.
+    int n_tier_words;
+    Matrix2D<double> tier_delta_storages;
+    Matrix2D<double> tier_available_volumes;
+    vector<double> tier_utility_storages;
+    vector<vector<double>> utility_supply_fractions;
+    vector<uint64_t> tier_failures;
+
+    LongTermROFCache *long_term_rof_cache = nullptr;
+    vector<double> long_term_rof_key;
+    vector<double> long_term_rof_end_state;
+
+    AdaptiveROFSampling *adaptive_rof_sampling = nullptr;
+    vector<vector<double>> utilities_rof_triggers;
+    vector<double> adaptive_failures;
+
+    StorageBoundROF *storage_bound_rof = nullptr;
+    bool rof_table_used = true;
+    int bounded_tiers = 0;
+    vector<double> source_natural_loss_bounds;
+    vector<double> source_outflow_bounds;
+    vector<double> source_max_releases;
+    vector<double> utility_demand_bounds;
+    vector<double> utility_max_restricted_demands;
+    vector<bool> utility_demand_failures;
+    vector<double> tier_volume_bounds;
+    vector<double> utility_source_loss_bounds;
+    vector<double> utility_tier_demand_losses;
+    vector<double> source_supply_fractions;
+
+    void resetROFState();
+
+    void runROFLanes(int week, int rof_type, int first_lane, int end_lane,
+                     const double *first_restricted_demands,
+                     const double *first_min_env_outflows,
+                     const double *assumed_restricted_demands,
+                     const double *assumed_min_env_outflows);
+
+    bool laneEndedAsAssumed(int lane,
+                            const double *assumed_restricted_demands,
+                            const double *assumed_min_env_outflows) const;
+
+    bool boundSourceLosses(int week);
+
+    bool shortTermROFIsZero();
+
+    int boundTableTiers();
+
+    void skipShortTermROF(int week);
+
+    void validateStorageBound(int week, const vector<double> &risk_of_failure,
+                              bool rof_is_zero, int bounded_tiers);
+
+    void longTermROFKey(int week, vector<double> &key) const;
+
+    void saveROFState(vector<double> &state) const;
+
+    void loadROFState(const vector<double> &state);
+
 protected:
     int beginning_tier = 0;
     vector<WaterSource *> realization_water_sources;
     vector<Utility *> realization_utilities;
     vector<Matrix2D<double>> ut_storage_to_rof_table;
+    vector<ROFTable> ut_imported_rof_table;
 
     vector<vector<double>> table_storage_shift;
     vector<double> utility_base_storage_capacity;;
@@ -32,26 +112,47 @@ protected:
     vector<double> current_and_base_storage_capacity_ratio;
     vector<double> current_storage_table_shift;
 
+    void lookUpTableROFs(int week, const vector<Utility *> &utilities,
+                         const vector<ROFTable> &tables,
+                         double *risks_of_failure) const;
+
+    double lookUpTableROF(int week, int u, double total_storage_capacity,
+                          double stored_volume, const ROFTable &table) const;
+
 public:
     ContinuityModelROF(vector<WaterSource *> water_sources, const Graph &water_sources_graph,
                        const vector<vector<int>> &water_sources_to_utilities, vector<Utility *> utilities,
                        vector<MinEnvFlowControl *> min_env_flow_controls, const vector<double> &utilities_rdm,
                        const vector<double> &water_sources_rdm, unsigned long total_weeks_simulation,
-                       const int use_precomputed_rof_tables, const unsigned long realization_id);
+                       const int use_precomputed_rof_tables, const unsigned long realization_id,
+                       const bool calculates_rofs = true);
+
+    void rebind(vector<WaterSource *> &water_sources, vector<Utility *> &utilities,
+                vector<MinEnvFlowControl *> &min_env_flow_controls, const vector<double> &utilities_rdm,
+                const vector<double> &water_sources_rdm, unsigned long realization_id);
 
 //    ContinuityModelROF(ContinuityModelROF &continuity_model_rof);
 
-    vector<double> calculateShortTermROF(int week, int import_export_rof_tables);
+    void calculateShortTermROF(int week, int import_export_rof_tables,
+                               vector<double> &risks_of_failure);
 
     vector<double> calculateShortTermROFFullCalcs(int week);
 
-    vector<double> calculateShortTermROFTable(int week, vector<Utility *> utilities,
-                                              vector<double> utilities_base_storage_capacity,
-                                              const vector<Matrix2D<double>> &ut_storage_to_rof_table,
-                                              vector<double> current_storage_table_shift);
-
     vector<double> calculateLongTermROF(int week);
 
+    vector<double> calculateLongTermROFFullCalcs(int week);
+
+    void setLongTermROFCache(LongTermROFCache *long_term_rof_cache);
+
+    void setAdaptiveROFSampling(
+            AdaptiveROFSampling *adaptive_rof_sampling,
+            const vector<vector<double>> &utilities_rof_triggers);
+
+    void setStorageBoundROF(StorageBoundROF *storage_bound_rof,
+                            bool rof_table_used);
+
+    void disableROFLanes();
+
     void resetUtilitiesAndReservoirs(int rof_type);
 
     void connectRealizationWaterSources(const vector<WaterSource *> &realization_water_sources);
@@ -62,18 +163,27 @@ public:
 
     ~ContinuityModelROF() override;
 
-    void updateStorageToROFTable(double storage_percent_decrement,
-                                 int week_of_the_year,
-                                 const double *to_full_toposort);
+    void prepareStorageToROFTable(double storage_percent_decrement,
+                                  const double *to_full);
+
+    void updateStorageToROFTable(int week_of_the_year);
+
+    void updateStorageToROFTable(const double *available_volumes,
+                                 const double *total_outflows,
+                                 const double *min_environmental_outflows,
+                                 double *const *utilities_rof_rows);
 
     vector<Matrix2D<double>> &getUt_storage_to_rof_table();
 
-    void shiftStorages(double *available_volumes_shifted, const double
-    *delta_storage);
+    const vector<ROFTable> &getUt_imported_rof_table() const;
+
+    void shiftStorages(const double *available_volumes,
+                       const double *total_outflows,
+                       const double *min_environmental_outflows);
 
     void printROFTable(const string &folder);
 
-    void setROFTablesAndShifts(const vector<Matrix2D<double>> &storage_to_rof_table,
+    void setROFTablesAndShifts(const vector<ROFTable> &imported_rof_table,
                                const vector<vector<double>> &table_storage_shift);
 
     void tableROFExceptionHandler(double m, int u, int week);
@@ -85,6 +195,14 @@ public:
                                int &week_of_the_year);
 
     void calculateEmptyVolumes(vector<WaterSource *> &realization_water_sources, double *to_full);
+
+    bool lanesSupported() const;
+
+    void calculateROFLanes(int week, int rof_type, int begin_lane,
+                           int end_lane, vector<double> &risk_of_failure);
+
+    void continuityStepLanes(int week, int step, int first_lane,
+                             int end_lane, bool apply_demand_buffer);
 };
 
 
@@ -30,6 +30,41 @@ ContinuityModelRealization::ContinuityModelRealization(
     }
 }
 
+/**
+ * Rebinds the model to copies of the water sources, utilities, drought
+ * mitigation policies and controls of another realization, deleting the
+ * current ones.
+ * @param water_sources
+ * @param utilities
+ * @param drought_mitigation_policies
+ * @param min_env_flow_controls
+ * @param utilities_rdm
+ * @param water_sources_rdm
+ * @param policy_rdm
+ * @param realization_id
+ */
+void ContinuityModelRealization::rebind(
+        vector<WaterSource *> &water_sources, vector<Utility *> &utilities,
+        const vector<DroughtMitigationPolicy *> &drought_mitigation_policies,
+        vector<MinEnvFlowControl *> &min_env_flow_controls,
+        const vector<double> &utilities_rdm,
+        const vector<double> &water_sources_rdm,
+        const vector<double> &policy_rdm, unsigned long realization_id) {
+    for (auto dmp : this->drought_mitigation_policies) {
+        delete dmp;
+    }
+
+    rebindComponents(water_sources, utilities, min_env_flow_controls,
+                     utilities_rdm, water_sources_rdm, realization_id);
+    this->drought_mitigation_policies = drought_mitigation_policies;
+
+    for (DroughtMitigationPolicy *dmp : this->drought_mitigation_policies) {
+        dmp->addSystemComponents(utilities, water_sources, min_env_flow_controls);
+        dmp->setRealization(realization_id, utilities_rdm, water_sources_rdm,
+                            policy_rdm);
+    }
+}
+
 ContinuityModelRealization::~ContinuityModelRealization() {
     // Delete drought mitigation policies.
     for (auto dmp : drought_mitigation_policies) {
@@ -39,7 +74,7 @@ ContinuityModelRealization::~ContinuityModelRealization() {
 
 void ContinuityModelRealization::setShortTermROFs(const vector<double> &risks_of_failure) {
     for (unsigned long i = 0; i < continuity_utilities.size(); ++i) {
-        continuity_utilities.at(i)->setRisk_of_failure(risks_of_failure.at(i));
+        continuity_utilities[i]->setRisk_of_failure(risks_of_failure[i]);
     }
 }
 
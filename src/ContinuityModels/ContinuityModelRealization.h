@@ -28,6 +28,13 @@ public:
 
     ~ContinuityModelRealization() override;
 
+    void rebind(vector<WaterSource *> &water_sources, vector<Utility *> &utilities,
+                const vector<DroughtMitigationPolicy *> &drought_mitigation_policies,
+                vector<MinEnvFlowControl *> &min_env_flow_controls,
+                const vector<double> &utilities_rdm,
+                const vector<double> &water_sources_rdm,
+                const vector<double> &policy_rdm, unsigned long realization_id);
+
     void setShortTermROFs(const vector<double> &risks_of_failure);
 
     void applyDroughtMitigationPolicies(int week);
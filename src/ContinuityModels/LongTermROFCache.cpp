@@ -0,0 +1,226 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "LongTermROFCache.h"
+
+/**
+ * FNV-1a hash of the bits of the key.
+ * @param key
+ * @return hash.
+ */
+size_t LongTermROFCache::KeyHash::operator()(const vector<double> &key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (double value : key) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(double));
+        hash = (hash ^ bits) * 1099511628211ULL;
+    }
+    return (size_t) hash;
+}
+
+bool LongTermROFCache::KeyEqual::operator()(const vector<double> &a,
+                                            const vector<double> &b) const {
+    return a.size() == b.size() &&
+           memcmp(a.data(), b.data(), sizeof(double) * a.size()) == 0;
+}
+
+/**
+ * @param max_entries_in_memory number of entries kept in memory.
+ * @param spill_file_name file to which entries beyond max_entries_in_memory
+ * are written, or empty for not caching them. The file is overwritten and
+ * deleted when the cache is destroyed.
+ */
+LongTermROFCache::LongTermROFCache(unsigned long max_entries_in_memory,
+                                   const string &spill_file_name)
+        : max_entries_in_memory(max_entries_in_memory),
+          spill_file_name(spill_file_name) {
+    if (!spill_file_name.empty()) {
+        spill_file = open(spill_file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+                          0644);
+        if (spill_file < 0) {
+            char error[512];
+            sprintf(error, "Could not create long-term ROF cache spill file "
+                           "%s.", spill_file_name.c_str());
+            throw invalid_argument(error);
+        }
+    }
+}
+
+LongTermROFCache::~LongTermROFCache() {
+    if (spill_file >= 0) {
+        close(spill_file);
+        unlink(spill_file_name.c_str());
+    }
+}
+
+/**
+ * Looks for the long-term ROFs calculated for a key.
+ * @param key
+ * @param risks_of_failure long-term ROF of each utility, if found.
+ * @param end_state state of the ROF continuity model after calculating the
+ * ROFs, if found.
+ * @return whether the key was found.
+ */
+bool LongTermROFCache::find(const vector<double> &key,
+                            vector<double> &risks_of_failure,
+                            vector<double> &end_state) {
+    size_t hash = KeyHash()(key);
+    Shard &shard = shards[hash % N_SHARDS];
+    vector<unsigned long> offsets;
+    {
+        lock_guard<mutex> lock(shard.shard_mutex);
+        auto entry = shard.entries.find(key);
+        if (entry != shard.entries.end()) {
+            risks_of_failure = entry->second.risks_of_failure;
+            end_state = entry->second.end_state;
+            hits++;
+            return true;
+        }
+        auto spilled = shard.spilled_entries.equal_range(hash);
+        for (auto it = spilled.first; it != spilled.second; ++it)
+            offsets.push_back(it->second);
+    }
+
+    // Spilled entries are never modified, so they can be read unlocked.
+    for (unsigned long offset : offsets) {
+        if (readSpilledEntry(offset, key, risks_of_failure, end_state)) {
+            hits++;
+            return true;
+        }
+    }
+
+    misses++;
+    return false;
+}
+
+/**
+ * Adds the long-term ROFs calculated for a key, unless the key is already
+ * in the cache.
+ * @param key
+ * @param risks_of_failure long-term ROF of each utility.
+ * @param end_state state of the ROF continuity model after calculating the
+ * ROFs.
+ */
+void LongTermROFCache::insert(const vector<double> &key,
+                              const vector<double> &risks_of_failure,
+                              const vector<double> &end_state) {
+    size_t hash = KeyHash()(key);
+    Shard &shard = shards[hash % N_SHARDS];
+    lock_guard<mutex> lock(shard.shard_mutex);
+    if (shard.entries.count(key) > 0)
+        return;
+
+    if (++n_entries_in_memory <= max_entries_in_memory) {
+        shard.entries[key] = {risks_of_failure, end_state};
+    } else {
+        n_entries_in_memory--;
+        if (spill_file >= 0)
+            spillEntry(shard, hash, key, risks_of_failure, end_state);
+    }
+}
+
+/**
+ * Appends an entry to the spill file. Spilled entries are stored as the
+ * sizes of the key, ROFs and end state as uint64, followed by their values.
+ * Keys spilled twice by different threads are harmless.
+ * @param shard shard of the key, which must be locked.
+ * @param hash hash of the key.
+ * @param key
+ * @param risks_of_failure
+ * @param end_state
+ */
+void LongTermROFCache::spillEntry(Shard &shard, size_t hash,
+                                  const vector<double> &key,
+                                  const vector<double> &risks_of_failure,
+                                  const vector<double> &end_state) {
+    uint64_t sizes[3] = {key.size(), risks_of_failure.size(),
+                         end_state.size()};
+    vector<double> record;
+    record.reserve(sizes[0] + sizes[1] + sizes[2] + 3);
+    record.resize(3);
+    memcpy(record.data(), sizes, sizeof(sizes));
+    record.insert(record.end(), key.begin(), key.end());
+    record.insert(record.end(), risks_of_failure.begin(),
+                  risks_of_failure.end());
+    record.insert(record.end(), end_state.begin(), end_state.end());
+
+    auto n_bytes = (unsigned long) (sizeof(double) * record.size());
+    unsigned long offset = spill_file_size.fetch_add(n_bytes);
+    if (pwrite(spill_file, record.data(), n_bytes, (off_t) offset) !=
+        (ssize_t) n_bytes) {
+        char error[512];
+        sprintf(error, "Could not write to long-term ROF cache spill file "
+                       "%s.", spill_file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    shard.spilled_entries.emplace(hash, offset);
+    n_entries_spilled++;
+}
+
+/**
+ * Reads an entry from the spill file if its key is the given one.
+ * @param offset offset of the entry in the spill file.
+ * @param key
+ * @param risks_of_failure
+ * @param end_state
+ * @return whether the entry has the given key.
+ */
+bool LongTermROFCache::readSpilledEntry(unsigned long offset,
+                                        const vector<double> &key,
+                                        vector<double> &risks_of_failure,
+                                        vector<double> &end_state) const {
+    uint64_t sizes[3];
+    if (pread(spill_file, sizes, sizeof(sizes), (off_t) offset) !=
+        (ssize_t) sizeof(sizes) || sizes[0] != key.size())
+        return false;
+
+    vector<double> values(sizes[0] + sizes[1] + sizes[2]);
+    auto n_bytes = (ssize_t) (sizeof(double) * values.size());
+    if (pread(spill_file, values.data(), (size_t) n_bytes,
+              (off_t) (offset + sizeof(sizes))) != n_bytes) {
+        char error[512];
+        sprintf(error, "Could not read from long-term ROF cache spill file "
+                       "%s.", spill_file_name.c_str());
+        throw runtime_error(error);
+    }
+    if (memcmp(values.data(), key.data(), sizeof(double) * key.size()) != 0)
+        return false;
+
+    auto rofs_begin = values.begin() + sizes[0];
+    risks_of_failure.assign(rofs_begin, rofs_begin + sizes[1]);
+    end_state.assign(rofs_begin + sizes[1], values.end());
+    return true;
+}
+
+unsigned long LongTermROFCache::getHits() const {
+    return hits;
+}
+
+unsigned long LongTermROFCache::getMisses() const {
+    return misses;
+}
+
+unsigned long LongTermROFCache::getNEntriesInMemory() const {
+    return n_entries_in_memory;
+}
+
+unsigned long LongTermROFCache::getNEntriesSpilled() const {
+    return n_entries_spilled;
+}
+
+void LongTermROFCache::printStatistics() const {
+    unsigned long n_lookups = hits + misses;
+    printf("Long-term ROF cache: %lu hits, %lu misses (%.1f%% hit rate), "
+           "%lu entries in memory, %lu spilled to disk.\n",
+           getHits(), getMisses(),
+           n_lookups > 0 ? 100. * getHits() / n_lookups : 0.,
+           getNEntriesInMemory(), getNEntriesSpilled());
+}
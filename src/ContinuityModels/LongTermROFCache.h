@@ -0,0 +1,104 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_LONGTERMROFCACHE_H
+#define TRIANGLEMODEL_LONGTERMROFCACHE_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Long-term ROFs, along with the state the ROF continuity model is left in
+ * after calculating them, keyed on everything the calculation depends on
+ * (see ContinuityModelROF::longTermROFKey). Since the long-term ROF does not
+ * depend on current storage nor on drought mitigation decision variables,
+ * keys recur across simulations of different solutions, such as across
+ * function evaluations of an optimization, whose long-term ROF calculations
+ * are then replaced by lookups.
+ *
+ * The cache can be shared by all threads. Entries beyond the number kept in
+ * memory are appended to a spill file, if one is given, and otherwise not
+ * cached.
+ */
+class LongTermROFCache {
+private:
+    static const int N_SHARDS = 64;
+
+    struct KeyHash {
+        size_t operator()(const vector<double> &key) const;
+    };
+
+    /// Keys are compared bitwise, so that cached values are only used for
+    /// exactly the same inputs.
+    struct KeyEqual {
+        bool operator()(const vector<double> &a,
+                        const vector<double> &b) const;
+    };
+
+    struct Entry {
+        vector<double> risks_of_failure;
+        vector<double> end_state;
+    };
+
+    struct Shard {
+        mutex shard_mutex;
+        unordered_map<vector<double>, Entry, KeyHash, KeyEqual> entries;
+        /// Offsets of spilled entries in the spill file by key hash.
+        unordered_multimap<size_t, unsigned long> spilled_entries;
+    };
+
+    const unsigned long max_entries_in_memory;
+    const string spill_file_name;
+    int spill_file = -1;
+    Shard shards[N_SHARDS];
+
+    atomic<unsigned long> n_entries_in_memory{0};
+    atomic<unsigned long> n_entries_spilled{0};
+    atomic<unsigned long> spill_file_size{0};
+    atomic<unsigned long> hits{0};
+    atomic<unsigned long> misses{0};
+
+    bool readSpilledEntry(unsigned long offset, const vector<double> &key,
+                          vector<double> &risks_of_failure,
+                          vector<double> &end_state) const;
+
+    void spillEntry(Shard &shard, size_t hash, const vector<double> &key,
+                    const vector<double> &risks_of_failure,
+                    const vector<double> &end_state);
+
+public:
+    explicit LongTermROFCache(unsigned long max_entries_in_memory,
+                              const string &spill_file_name = "");
+
+    LongTermROFCache(const LongTermROFCache &cache) = delete;
+
+    LongTermROFCache &operator=(const LongTermROFCache &cache) = delete;
+
+    ~LongTermROFCache();
+
+    bool find(const vector<double> &key, vector<double> &risks_of_failure,
+              vector<double> &end_state);
+
+    void insert(const vector<double> &key,
+                const vector<double> &risks_of_failure,
+                const vector<double> &end_state);
+
+    unsigned long getHits() const;
+
+    unsigned long getMisses() const;
+
+    unsigned long getNEntriesInMemory() const;
+
+    unsigned long getNEntriesSpilled() const;
+
+    void printStatistics() const;
+};
+
+
+#endif //TRIANGLEMODEL_LONGTERMROFCACHE_H
@@ -0,0 +1,62 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <cstdio>
+#include "StorageBoundROF.h"
+#include "../Utils/Constants.h"
+
+using namespace Constants;
+
+/**
+ * @param validate whether to simulate the ROF years anyway and check their
+ * results against the bound.
+ */
+StorageBoundROF::StorageBoundROF(bool validate) : validate(validate) {}
+
+/**
+ * Records a short-term ROF calculation and whether the bound proved its
+ * ROFs to be zero.
+ * @param skipped
+ */
+void StorageBoundROF::recordCalculation(bool skipped) {
+    n_calculations++;
+    n_skipped += skipped;
+}
+
+/**
+ * Records a storage-ROF table row calculated with the bound.
+ * @param bounded_tiers number of tiers, starting from full storage, proven
+ * to have no failures.
+ * @param tiers_filled number of those tiers that would otherwise have been
+ * evaluated.
+ */
+void StorageBoundROF::recordTableRow(int bounded_tiers, int tiers_filled) {
+    n_table_rows++;
+    n_bounded_tiers += (unsigned long) bounded_tiers;
+    n_tiers_filled += (unsigned long) tiers_filled;
+}
+
+void StorageBoundROF::resetStatistics() {
+    n_calculations = 0;
+    n_skipped = 0;
+    n_table_rows = 0;
+    n_bounded_tiers = 0;
+    n_tiers_filled = 0;
+}
+
+bool StorageBoundROF::isValidating() const {
+    return validate;
+}
+
+void StorageBoundROF::printStatistics() {
+    printf("Storage-bound ROF: %lu of %lu short-term ROF calculations "
+           "skipped%s.\n", (unsigned long) n_skipped,
+           (unsigned long) n_calculations,
+           validate ? " (all simulated and validated)" : "");
+    unsigned long n_tiers = n_table_rows * (NO_OF_INSURANCE_STORAGE_TIERS + 1);
+    printf("Storage-bound ROF: %lu of %lu table tiers proven free of "
+           "failures, %lu of which filled directly.\n",
+           (unsigned long) n_bounded_tiers, n_tiers,
+           (unsigned long) n_tiers_filled);
+}
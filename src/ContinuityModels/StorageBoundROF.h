@@ -0,0 +1,59 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_STORAGEBOUNDROF_H
+#define TRIANGLEMODEL_STORAGEBOUNDROF_H
+
+#include <atomic>
+
+using namespace std;
+
+/**
+ * Settings and statistics of the storage bound on short-term ROFs. Before
+ * simulating the short-term ROF years of a week, what can be lost over
+ * WEEKS_ROF_SHORT_TERM weeks with zero inflows is bounded from above by the
+ * restricted demands of the utilities, the largest releases of the sources'
+ * controls and their largest evaporation. If the storage left to every
+ * utility after such losses still cannot reach STORAGE_CAPACITY_RATIO_FAIL
+ * and no utility's demand exceeds the treatment capacity failure threshold,
+ * ROFs are zero and the simulation is skipped.
+ * When the storage-ROF table is needed, the table tiers for which the same
+ * bound proves there are no failures are filled directly instead.
+ *
+ * In validation mode the ROF years are still simulated, and an exception is
+ * thrown if their results contradict the bound.
+ *
+ * The object can be shared by all threads.
+ */
+class StorageBoundROF {
+private:
+    const bool validate;
+
+    atomic<unsigned long> n_calculations{0};
+    atomic<unsigned long> n_skipped{0};
+    atomic<unsigned long> n_table_rows{0};
+    atomic<unsigned long> n_bounded_tiers{0};
+    atomic<unsigned long> n_tiers_filled{0};
+
+public:
+    explicit StorageBoundROF(bool validate);
+
+    StorageBoundROF(const StorageBoundROF &storage_bound_rof) = delete;
+
+    StorageBoundROF &operator=(const StorageBoundROF &storage_bound_rof) =
+            delete;
+
+    void recordCalculation(bool skipped);
+
+    void recordTableRow(int bounded_tiers, int tiers_filled);
+
+    void resetStatistics();
+
+    bool isValidating() const;
+
+    void printStatistics();
+};
+
+
+#endif //TRIANGLEMODEL_STORAGEBOUNDROF_H
@@ -38,6 +38,16 @@ void MinEnvFlowControl::addComponents(
     }
 }
 
+/**
+ * Upper bound on the releases of the control, or NON_INITIALIZED if the
+ * releases depend on inflows or on other components and cannot be bounded
+ * from the control's own parameters.
+ * @return
+ */
+double MinEnvFlowControl::getMaxRelease() const {
+    return NON_INITIALIZED;
+}
+
 void MinEnvFlowControl::setRealization(unsigned long r, const vector<double> &rdm_factors) {
 
 }
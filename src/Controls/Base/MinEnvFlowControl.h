@@ -31,6 +31,8 @@ public:
 
     virtual double getRelease(int week) = 0;
 
+    virtual double getMaxRelease() const;
+
     void addComponents(
             vector<WaterSource *> water_sources, vector<Utility *> utilities);
 
@@ -16,7 +16,8 @@ EvaporationSeries::EvaporationSeries(
  * @param catchment
  */
 EvaporationSeries::EvaporationSeries(const EvaporationSeries &evaporation_series)
-        : Catchment(evaporation_series) {}
+        : Catchment(evaporation_series),
+          evaporation_multiplier(evaporation_series.evaporation_multiplier) {}
 
 /**
  * Copy assignment operator.
@@ -30,6 +31,7 @@ EvaporationSeries &EvaporationSeries::operator=(
     streamflows_all = evaporation_series.streamflows_all;
     series_length = evaporation_series.series_length;
     streamflows_realization = evaporation_series.streamflows_realization;
+    evaporation_multiplier = evaporation_series.evaporation_multiplier;
 
     return *this;
 }
@@ -37,13 +39,23 @@ EvaporationSeries &EvaporationSeries::operator=(
 EvaporationSeries::~EvaporationSeries() {}
 
 double EvaporationSeries::getEvaporation(int week) {
-    return Catchment::getStreamflow(week);
+    return Catchment::getStreamflow(week) * evaporation_multiplier;
+}
+
+/**
+ * @return largest evaporation rate of the current realization over the
+ * whole series.
+ */
+double EvaporationSeries::getMaxEvaporation() {
+    double min_evaporation, max_evaporation;
+    getStreamflowRange(min_evaporation, max_evaporation);
+    return evaporation_multiplier * (evaporation_multiplier >= 0. ?
+                                     max_evaporation : min_evaporation);
 }
 
 void EvaporationSeries::setRealization(unsigned long r, const vector<double> &rdm_factors) {
     Catchment::setRealization(r, rdm_factors);
 
-    for (unsigned long w = 0; w < streamflows_realization.size(); ++w) {
-        streamflows_realization[w] *= rdm_factors.at(0);
-    }
+    // Applied on lookup, so that the series is not copied.
+    evaporation_multiplier = rdm_factors.at(0);
 }
@@ -9,6 +9,9 @@
 #include "../SystemComponents/Catchment.h"
 
 class EvaporationSeries : public Catchment {
+private:
+    double evaporation_multiplier = 1.;
+
 public:
     EvaporationSeries();
 
@@ -23,6 +26,8 @@ public:
 
     double getEvaporation(int week);
 
+    double getMaxEvaporation();
+
     void setRealization(unsigned long r, const vector<double> &rdm_factors) override;
 };
 
@@ -17,4 +17,8 @@ double FixedMinEnvFlowControl::getRelease(int week) {
     return release;
 }
 
+double FixedMinEnvFlowControl::getMaxRelease() const {
+    return release;
+}
+
 FixedMinEnvFlowControl::~FixedMinEnvFlowControl() = default;
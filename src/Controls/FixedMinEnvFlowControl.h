@@ -19,6 +19,8 @@ public:
     ~FixedMinEnvFlowControl() override;
 
     double getRelease(int week) override;
+
+    double getMaxRelease() const override;
 };
 
 
@@ -2,6 +2,7 @@
 // Created by bct52 on 6/28/17.
 //
 
+#include <algorithm>
 #include "SeasonalMinEnvFlowControl.h"
 #include "../Utils/Utils.h"
 
@@ -55,6 +56,10 @@ double SeasonalMinEnvFlowControl::getRelease(int week) {
     }
 }
 
+double SeasonalMinEnvFlowControl::getMaxRelease() const {
+    return *max_element(min_env_flows.begin(), min_env_flows.end());
+}
+
 const vector<int> &SeasonalMinEnvFlowControl::getWeekThresholds() const {
     return week_thresholds;
     }
@@ -27,6 +27,8 @@ public:
 
     double getRelease(int week) override;
 
+    double getMaxRelease() const override;
+
     const vector<int> &getWeekThresholds() const;
 
     const vector<double> &getMinEnvFlows() const;
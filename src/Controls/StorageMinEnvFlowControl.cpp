@@ -2,6 +2,7 @@
 // Created by bct52 on 6/28/17.
 //
 
+#include <algorithm>
 #include "StorageMinEnvFlowControl.h"
 
 StorageMinEnvFlowControl::StorageMinEnvFlowControl(
@@ -42,3 +43,8 @@ double StorageMinEnvFlowControl::getRelease(int week) {
     }
     return release;
 }
+
+double StorageMinEnvFlowControl::getMaxRelease() const {
+    // No release at all below the lowest storage threshold.
+    return max(0., *max_element(releases.begin(), releases.end()));
+}
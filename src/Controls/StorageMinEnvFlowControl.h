@@ -22,6 +22,8 @@ public:
     const vector<double> &storages;
     const vector<double> &releases;
 
+    double getMaxRelease() const override;
+
 private:
     double getRelease(int week);
 };
@@ -12,36 +12,32 @@ AllocatedReservoirDataCollector::AllocatedReservoirDataCollector(AllocatedReserv
                 getAvailable_allocated_volumes().size()) * COLUMN_WIDTH, realization),
           allocated_reservoir(allocated_reservoir),
           utilities_with_allocations
-                  (allocated_reservoir->getUtilitiesWithAllocations()) {
+                  (allocated_reservoir->getUtilitiesWithAllocations()),
+          allocated_stored_volumes(utilities_with_allocations.size()),
+          allocated_treatment_cap(utilities_with_allocations.size()) {
+    for (unsigned long i = 0; i < utilities_with_allocations.size(); ++i)
+        registerTimeSeries({&allocated_stored_volumes[i],
+                            &allocated_treatment_cap[i]},
+                           {"valloc_" + to_string(utilities_with_allocations[i]),
+                            "talloc_" + to_string(utilities_with_allocations[i])});
 }
 
-string AllocatedReservoirDataCollector::printTabularString(int week) {
-    string output = ReservoirDataCollector::printTabularString(week);
+void AllocatedReservoirDataCollector::printTabularString(int week, TextWriter &writer) {
+    ReservoirDataCollector::printTabularString(week, writer);
 
-    stringstream out_stream;
-
-    out_stream << output;
-
-    for (int u : utilities_with_allocations)
-        out_stream << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-                   << allocated_stored_volumes[week][u];
-
-    return out_stream.str();
+    for (const TimeSeries &stored_volume : allocated_stored_volumes)
+        writer.writeValue(stored_volume[week], COLUMN_WIDTH, COLUMN_PRECISION);
 }
 
-string AllocatedReservoirDataCollector::printCompactString(int week) {
-    string output = ReservoirDataCollector::printCompactString(week);
-
-    stringstream out_stream;
-
-    out_stream << output;
+void AllocatedReservoirDataCollector::printCompactString(int week, TextWriter &writer) {
+    ReservoirDataCollector::printCompactString(week, writer);
 
-    for (int u : utilities_with_allocations) {
-        out_stream << allocated_stored_volumes[week][u] << ",";
-        out_stream << allocated_treatment_cap[week][u] << ",";
+    for (unsigned long i = 0; i < utilities_with_allocations.size(); ++i) {
+        writer.writeValue(allocated_stored_volumes[i][week]);
+        writer.write(',');
+        writer.writeValue(allocated_treatment_cap[i][week]);
+        writer.write(',');
     }
-
-    return out_stream.str();
 }
 
 string AllocatedReservoirDataCollector::printTabularStringHeaderLine1() {
@@ -83,8 +79,14 @@ string AllocatedReservoirDataCollector::printCompactStringHeader() {
 
 void AllocatedReservoirDataCollector::collect_data() {
     ReservoirDataCollector::collect_data();
-    vector<double> alloc_vol_vector = allocated_reservoir->getAvailable_allocated_volumes();
-    allocated_stored_volumes.push_back(alloc_vol_vector);
-    auto alloc_treat_vector = allocated_reservoir->getAllocatedTreatmentCapacities();
-    allocated_treatment_cap.push_back(alloc_treat_vector);
+    if (!recording)
+        return;
+
+    const vector<double> &alloc_vol_vector = allocated_reservoir->getAvailable_allocated_volumes();
+    const vector<double> &alloc_treat_vector = allocated_reservoir->getAllocatedTreatmentCapacities();
+    for (unsigned long i = 0; i < utilities_with_allocations.size(); ++i) {
+        int u = utilities_with_allocations[i];
+        allocated_stored_volumes[i].push_back(alloc_vol_vector[u]);
+        allocated_treatment_cap[i].push_back(alloc_treat_vector[u]);
+    }
 }
@@ -11,17 +11,18 @@
 
 class AllocatedReservoirDataCollector : public ReservoirDataCollector {
     AllocatedReservoir *allocated_reservoir;
-    vector<vector<double>> allocated_stored_volumes;
-    vector<vector<double>> allocated_treatment_cap;
     vector<int> utilities_with_allocations;
+    /// Series of each utility in utilities_with_allocations.
+    vector<TimeSeries> allocated_stored_volumes;
+    vector<TimeSeries> allocated_treatment_cap;
 
 public:
     AllocatedReservoirDataCollector(AllocatedReservoir *allocated_reservoir,
                                         unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -9,3 +9,46 @@ DataCollector::DataCollector(int id, string name, unsigned long realization, int
 
 DataCollector::~DataCollector() {}
 
+/**
+ * Adds time series to the ones of the collector. Series must be registered
+ * in the same order by all realizations' collectors of a component.
+ * @param series
+ * @param names variable name of each series, as in compact output headers
+ * but without the component id.
+ */
+void DataCollector::registerTimeSeries(const vector<TimeSeries *> &series,
+                                       const vector<string> &names) {
+    time_series.insert(time_series.end(), series.begin(), series.end());
+    time_series_names.insert(time_series_names.end(), names.begin(),
+                             names.end());
+}
+
+/**
+ * Keeps only the time series of variables selected by an output
+ * specification, discarding the values of the others.
+ * @param output_specification
+ */
+void DataCollector::selectTimeSeries(
+        const OutputSpecification &output_specification) {
+    vector<TimeSeries *> selected_series;
+    vector<string> selected_names;
+    for (unsigned long i = 0; i < time_series.size(); ++i) {
+        if (output_specification.recordsVariable(time_series_names[i])) {
+            selected_series.push_back(time_series[i]);
+            selected_names.push_back(time_series_names[i]);
+        } else {
+            time_series[i]->discard();
+        }
+    }
+    time_series = selected_series;
+    time_series_names = selected_names;
+}
+
+const vector<TimeSeries *> &DataCollector::getTimeSeries() const {
+    return time_series;
+}
+
+const vector<string> &DataCollector::getTimeSeriesNames() const {
+    return time_series_names;
+}
+
@@ -6,10 +6,25 @@
 #define TRIANGLEMODEL_DATACOLLECTOR_H
 
 #include <string>
+#include <vector>
+#include "TimeSeriesStore.h"
+#include "OutputSpecification.h"
+#include "../../Utils/TextWriter.h"
 
 using namespace std;
 
 class DataCollector {
+protected:
+    /// Time series of the collector, in the order they are stored in a
+    /// TimeSeriesStore, and their variable names.
+    vector<TimeSeries *> time_series;
+    vector<string> time_series_names;
+    /// If false, the current week is not recorded in the time series.
+    bool recording = true;
+
+    void registerTimeSeries(const vector<TimeSeries *> &series,
+                            const vector<string> &names);
+
 public:
     const int id;
     const int type;
@@ -21,9 +36,9 @@ public:
 
     virtual ~DataCollector();
 
-    virtual string printTabularString(int week) = 0;
+    virtual void printTabularString(int week, TextWriter &writer) = 0;
 
-    virtual string printCompactString(int week) = 0;
+    virtual void printCompactString(int week, TextWriter &writer) = 0;
 
     virtual string printTabularStringHeaderLine1() = 0;
 
@@ -32,6 +47,16 @@ public:
     virtual string printCompactStringHeader() = 0;
 
     virtual void collect_data() = 0;
+
+    void selectTimeSeries(const OutputSpecification &output_specification);
+
+    inline void setRecording(bool recording) {
+        DataCollector::recording = recording;
+    }
+
+    const vector<TimeSeries *> &getTimeSeries() const;
+
+    const vector<string> &getTimeSeriesNames() const;
 };
 
 
@@ -0,0 +1,237 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include "OutputSpecification.h"
+
+static vector<string> split(const string &text, const string &separators) {
+    vector<string> parts;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find_first_of(separators, start);
+        if (end == string::npos)
+            end = text.size();
+        if (end > start)
+            parts.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
+
+static long parseNonNegative(const string &number, const string &clause) {
+    char *end;
+    long value = strtol(number.c_str(), &end, 10);
+    if (number.empty() || *end != '\0' || value < 0) {
+        char error[512];
+        sprintf(error, "Invalid number \"%s\" in output specification clause "
+                       "\"%s\".", number.c_str(), clause.c_str());
+        throw invalid_argument(error);
+    }
+    return value;
+}
+
+/**
+ * Parses an output specification.
+ * @param specification clauses separated by spaces or semicolons.
+ */
+OutputSpecification::OutputSpecification(const string &specification)
+        : specification(specification) {
+    vector<string> clauses = split(specification, " \t;");
+    if (clauses.empty())
+        throw invalid_argument("Empty output specification.");
+    for (const string &clause : clauses)
+        parseClause(clause);
+}
+
+void OutputSpecification::parseClause(const string &clause) {
+    size_t equals = clause.find('=');
+    string key = clause.substr(0, equals);
+    string value = equals == string::npos ? "" : clause.substr(equals + 1);
+    if (value.empty()) {
+        char error[512];
+        sprintf(error, "Output specification clause \"%s\" has no value.",
+                clause.c_str());
+        throw invalid_argument(error);
+    }
+
+    if (key == "components") {
+        components = split(value, ",");
+    } else if (key == "variables") {
+        variables = split(value, ",");
+    } else if (key == "weeks") {
+        vector<string> weeks = split(value, "-");
+        if (weeks.size() != 2 || value.find('-') != value.rfind('-'))
+            throw invalid_argument("Weeks of output specification must be "
+                                   "given as weeks=<first>-<last>.");
+        first_week = (int) parseNonNegative(weeks[0], clause);
+        last_week = (int) parseNonNegative(weeks[1], clause);
+        if (first_week > last_week) {
+            char error[512];
+            sprintf(error, "First week recorded (%d) is after the last (%d).",
+                    first_week, last_week);
+            throw invalid_argument(error);
+        }
+    } else if (key == "realizations") {
+        realization_ranges.clear();
+        for (const string &range : split(value, ",")) {
+            size_t dash = range.find('-');
+            unsigned long first = (unsigned long) parseNonNegative(
+                    range.substr(0, dash), clause);
+            unsigned long last = dash == string::npos ? first :
+                                 (unsigned long) parseNonNegative(
+                                         range.substr(dash + 1), clause);
+            if (first > last) {
+                char error[512];
+                sprintf(error, "First realization recorded (%lu) is after "
+                               "the last (%lu).", first, last);
+                throw invalid_argument(error);
+            }
+            realization_ranges.emplace_back(first, last);
+        }
+        if (realization_ranges.empty())
+            throw invalid_argument("No realizations selected by output "
+                                   "specification.");
+    } else if (key == "every") {
+        week_step = (int) parseNonNegative(value, clause);
+        if (week_step < 1)
+            throw invalid_argument("Weeks recorded by output specification "
+                                   "must be at least 1 week apart.");
+    } else {
+        char error[512];
+        sprintf(error, "Unknown output specification clause \"%s\". Valid "
+                       "clauses are components, variables, weeks, "
+                       "realizations and every.", clause.c_str());
+        throw invalid_argument(error);
+    }
+}
+
+/**
+ * Whether the specification selects anything less than all time series.
+ * @return
+ */
+bool OutputSpecification::isSet() const {
+    return !specification.empty();
+}
+
+bool OutputSpecification::filtersWeeks() const {
+    return first_week > 0 || last_week >= 0 || week_step > 1;
+}
+
+/**
+ * Whether all weeks of all variables of all components are recorded, even
+ * if only for some realizations.
+ * @return
+ */
+bool OutputSpecification::selectsAllSeries() const {
+    return components.empty() && variables.empty() && !filtersWeeks();
+}
+
+/**
+ * Whether time series of any component of a group are recorded.
+ * @param group Utilities, WaterSources or Policies.
+ * @return
+ */
+bool OutputSpecification::recordsGroup(const string &group) const {
+    if (components.empty())
+        return true;
+    for (const string &selector : components)
+        if (selector == group || selector.compare(0, group.size() + 1,
+                                                  group + ".") == 0)
+            return true;
+    return false;
+}
+
+/**
+ * Whether a component's time series are recorded.
+ * @param group Utilities, WaterSources or Policies.
+ * @param id
+ * @param name
+ * @return
+ */
+bool OutputSpecification::recordsComponent(const string &group, int id,
+                                           const string &name) const {
+    if (components.empty())
+        return true;
+    for (const string &selector : components)
+        if (selectsComponent(selector, group, id, name))
+            return true;
+    return false;
+}
+
+/**
+ * Whether a components selector selects a component.
+ * @param selector group, or group and component id or name.
+ * @param group Utilities, WaterSources or Policies.
+ * @param id
+ * @param name
+ * @return
+ */
+bool OutputSpecification::selectsComponent(const string &selector,
+                                           const string &group, int id,
+                                           const string &name) {
+    return selector == group ||
+           selector == group + "." + to_string(id) ||
+           (!name.empty() && selector == group + "." + name);
+}
+
+bool OutputSpecification::recordsVariable(const string &variable) const {
+    return variables.empty() ||
+           find(variables.begin(), variables.end(), variable) !=
+           variables.end();
+}
+
+bool OutputSpecification::recordsRealization(unsigned long realization) const {
+    if (realization_ranges.empty())
+        return true;
+    for (const pair<unsigned long, unsigned long> &range : realization_ranges)
+        if (realization >= range.first && realization <= range.second)
+            return true;
+    return false;
+}
+
+/**
+ * Number of weeks recorded in a simulation.
+ * @param n_weeks number of weeks simulated.
+ * @return
+ */
+unsigned long OutputSpecification::getN_recorded_weeks(
+        unsigned long n_weeks) const {
+    long last = last_week < 0 ? (long) n_weeks - 1 :
+                min((long) last_week, (long) n_weeks - 1);
+    if (last < first_week)
+        return 0;
+    return (unsigned long) ((last - first_week) / week_step + 1);
+}
+
+/**
+ * Week of the simulation of a recorded value.
+ * @param record position of the value in its time series.
+ * @return
+ */
+int OutputSpecification::getRecordedWeek(unsigned long record) const {
+    return first_week + (int) record * week_step;
+}
+
+int OutputSpecification::getFirst_week() const {
+    return first_week;
+}
+
+int OutputSpecification::getWeek_step() const {
+    return week_step;
+}
+
+const string &OutputSpecification::getSpecification() const {
+    return specification;
+}
+
+const vector<string> &OutputSpecification::getComponents() const {
+    return components;
+}
+
+const vector<string> &OutputSpecification::getVariables() const {
+    return variables;
+}
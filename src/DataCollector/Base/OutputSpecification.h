@@ -0,0 +1,92 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_OUTPUTSPECIFICATION_H
+#define TRIANGLEMODEL_OUTPUTSPECIFICATION_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Which time series are recorded during a simulation. A specification is a
+ * list of clauses separated by spaces or semicolons:
+ *
+ *   components=<selector>,...  components whose data collectors record time
+ *                              series, each selected by group (Utilities,
+ *                              WaterSources or Policies) or by group and
+ *                              component id or name, as in WaterSources.3.
+ *   variables=<name>,...       variables recorded, with the names of the
+ *                              compact csv and binary outputs (e.g. st_vol).
+ *   weeks=<first>-<last>       weeks recorded, both included.
+ *   realizations=<r>,<r>-<r>   realizations recorded.
+ *   every=<n>                  records one week out of n from the first.
+ *
+ * Clauses left out select everything. Collectors of water sources and
+ * policies that are not selected are not created, and utilities and
+ * restriction policies that are not selected only keep the data needed to
+ * calculate objectives. Selectors of components or variables that select no
+ * time series, such as misspelled names, are reported with a warning.
+ */
+class OutputSpecification {
+private:
+    string specification;
+    vector<string> components;
+    vector<string> variables;
+    int first_week = 0;
+    int last_week = -1; /// -1 for the last week of the simulation.
+    int week_step = 1;
+    /// Ranges of realizations recorded, both ends included, or none for all
+    /// realizations.
+    vector<pair<unsigned long, unsigned long>> realization_ranges;
+
+    void parseClause(const string &clause);
+
+public:
+    OutputSpecification() = default;
+
+    explicit OutputSpecification(const string &specification);
+
+    bool isSet() const;
+
+    bool filtersWeeks() const;
+
+    bool selectsAllSeries() const;
+
+    bool recordsGroup(const string &group) const;
+
+    bool recordsComponent(const string &group, int id,
+                          const string &name) const;
+
+    static bool selectsComponent(const string &selector, const string &group,
+                                 int id, const string &name);
+
+    bool recordsVariable(const string &variable) const;
+
+    bool recordsRealization(unsigned long realization) const;
+
+    inline bool recordsWeek(int week) const {
+        return week >= first_week && (last_week < 0 || week <= last_week) &&
+               (week - first_week) % week_step == 0;
+    }
+
+    unsigned long getN_recorded_weeks(unsigned long n_weeks) const;
+
+    int getRecordedWeek(unsigned long record) const;
+
+    int getFirst_week() const;
+
+    int getWeek_step() const;
+
+    const string &getSpecification() const;
+
+    const vector<string> &getComponents() const;
+
+    const vector<string> &getVariables() const;
+};
+
+
+#endif //TRIANGLEMODEL_OUTPUTSPECIFICATION_H
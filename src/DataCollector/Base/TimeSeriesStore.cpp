@@ -0,0 +1,182 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include "TimeSeriesStore.h"
+
+/**
+ * Keeps a value that does not fit in the series' column.
+ * @param value
+ */
+void TimeSeries::spill(double value) {
+    if (discarded)
+        return;
+    values.push_back(value);
+    n_values++;
+}
+
+/**
+ * Makes the series write its values into a column of a TimeSeriesStore.
+ * @param column first value of the series in the column.
+ * @param capacity number of values the series has in the column.
+ */
+void TimeSeries::bind(double *column, unsigned long capacity) {
+    if (n_values > 0)
+        throw logic_error("Time series must be bound to a store before any "
+                          "value is collected.");
+    doubles = column;
+    floats = nullptr;
+    this->capacity = capacity;
+}
+
+/**
+ * Makes the series write its values into a single precision column of a
+ * TimeSeriesStore.
+ * @param column first value of the series in the column.
+ * @param capacity number of values the series has in the column.
+ */
+void TimeSeries::bind(float *column, unsigned long capacity) {
+    if (n_values > 0)
+        throw logic_error("Time series must be bound to a store before any "
+                          "value is collected.");
+    doubles = nullptr;
+    floats = column;
+    this->capacity = capacity;
+}
+
+/**
+ * Stops the series from recording values, for variables that are not part
+ * of the outputs.
+ */
+void TimeSeries::discard() {
+    discarded = true;
+    capacity = 0;
+    n_values = 0;
+    values.clear();
+}
+
+double TimeSeries::at(unsigned long week) const {
+    if (week >= n_values) {
+        char error[128];
+        sprintf(error, "Week %lu requested from a time series with %lu "
+                       "weeks.", week, n_values);
+        throw out_of_range(error);
+    }
+    return (*this)[week];
+}
+
+double TimeSeries::back() const {
+    return (*this)[n_values - 1];
+}
+
+unsigned long TimeSeries::size() const {
+    return n_values;
+}
+
+bool TimeSeries::empty() const {
+    return n_values == 0;
+}
+
+/**
+ * Copies the values of the series into a vector, for writers that need
+ * contiguous double precision values.
+ * @return
+ */
+vector<double> TimeSeries::toVector() const {
+    vector<double> copy(n_values);
+    for (unsigned long w = 0; w < n_values; ++w)
+        copy[w] = (*this)[w];
+    return copy;
+}
+
+/**
+ * Allocates the columns of all components' variables.
+ * @param n_weeks number of weeks of each realization.
+ * @param realizations realizations to be run, which get one row of n_weeks
+ * values in each column in this order.
+ * @param n_variables_per_component number of time series of each component.
+ * @param single_precision whether values are stored as floats.
+ */
+void TimeSeriesStore::allocate(unsigned long n_weeks,
+                               const vector<unsigned long> &realizations,
+                               const vector<unsigned long> &n_variables_per_component,
+                               bool single_precision) {
+    this->n_weeks = n_weeks;
+    this->single_precision = single_precision;
+    n_rows = realizations.size();
+
+    realization_rows.clear();
+    if (!realizations.empty())
+        realization_rows.assign(
+                *max_element(realizations.begin(), realizations.end()) + 1,
+                -1);
+    for (unsigned long i = 0; i < realizations.size(); ++i)
+        realization_rows[realizations[i]] = (long) i;
+
+    first_columns.assign(1, 0);
+    for (unsigned long n_variables : n_variables_per_component)
+        first_columns.push_back(first_columns.back() + n_variables);
+
+    unsigned long column_size = n_weeks * n_rows;
+    double_columns.clear();
+    float_columns.clear();
+    if (single_precision)
+        float_columns.assign(first_columns.back(),
+                             vector<float>(column_size));
+    else
+        double_columns.assign(first_columns.back(),
+                              vector<double>(column_size));
+}
+
+/**
+ * Binds the time series of a component's collector for a realization to the
+ * component's columns. Series of realizations without rows in the store are
+ * left unbound and keep their own values.
+ * @param component
+ * @param realization
+ * @param time_series series of the collector, in the order they were
+ * counted when the store was allocated.
+ */
+void TimeSeriesStore::bind(unsigned long component, unsigned long realization,
+                           const vector<TimeSeries *> &time_series) {
+    if (realization >= realization_rows.size() ||
+        realization_rows[realization] < 0)
+        return;
+
+    unsigned long n_columns = first_columns[component + 1] -
+                              first_columns[component];
+    if (time_series.size() > n_columns) {
+        char error[256];
+        sprintf(error, "Data collector of component %lu has %lu time series "
+                       "in realization %lu but the store holds %lu.",
+                component, (unsigned long) time_series.size(), realization,
+                n_columns);
+        throw logic_error(error);
+    }
+
+    unsigned long offset = (unsigned long) realization_rows[realization] *
+                           n_weeks;
+    for (unsigned long i = 0; i < time_series.size(); ++i) {
+        unsigned long c = first_columns[component] + i;
+        if (single_precision)
+            time_series[i]->bind(float_columns[c].data() + offset, n_weeks);
+        else
+            time_series[i]->bind(double_columns[c].data() + offset, n_weeks);
+    }
+}
+
+bool TimeSeriesStore::isAllocated() const {
+    return !first_columns.empty();
+}
+
+unsigned long TimeSeriesStore::getN_columns() const {
+    return first_columns.empty() ? 0 : first_columns.back();
+}
+
+unsigned long TimeSeriesStore::getSizeInBytes() const {
+    return getN_columns() * n_weeks * n_rows *
+           (single_precision ? sizeof(float) : sizeof(double));
+}
@@ -0,0 +1,120 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_TIMESERIESSTORE_H
+#define TRIANGLEMODEL_TIMESERIESSTORE_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Weekly values of one variable of a data collector. The values are written
+ * into a TimeSeriesStore column once the series is bound to it, or kept by
+ * the series itself otherwise (or if more weeks are collected than the
+ * column holds).
+ */
+class TimeSeries {
+private:
+    double *doubles = nullptr;
+    float *floats = nullptr;
+    unsigned long capacity = 0;
+    unsigned long n_values = 0;
+    vector<double> values;
+    /// If true, values are not recorded.
+    bool discarded = false;
+
+    void spill(double value);
+
+public:
+    TimeSeries() = default;
+
+    TimeSeries(const TimeSeries &time_series) = delete;
+
+    TimeSeries &operator=(const TimeSeries &time_series) = delete;
+
+    void bind(double *column, unsigned long capacity);
+
+    void bind(float *column, unsigned long capacity);
+
+    void discard();
+
+    inline void push_back(double value) {
+        if (n_values < capacity) {
+            if (doubles)
+                doubles[n_values] = value;
+            else
+                floats[n_values] = (float) value;
+            n_values++;
+        } else {
+            spill(value);
+        }
+    }
+
+    inline double operator[](unsigned long week) const {
+        if (week < capacity)
+            return doubles ? doubles[week] : floats[week];
+        else
+            return values[week - capacity];
+    }
+
+    double at(unsigned long week) const;
+
+    double back() const;
+
+    unsigned long size() const;
+
+    bool empty() const;
+
+    vector<double> toVector() const;
+};
+
+/**
+ * Preallocated weekly values of all data collectors' time series. Each
+ * variable of each component (utility, water source or drought mitigation
+ * policy) gets one contiguous column with n_weeks values for each of the
+ * realizations, stored one realization after the other in the order the
+ * realizations are run, so that collectors write their values straight into
+ * place and the values of a variable are read in order across realizations.
+ *
+ * The store is allocated once, after which realizations get their columns
+ * without locking. Values can be kept in single precision to halve the
+ * memory taken by outputs.
+ */
+class TimeSeriesStore {
+private:
+    unsigned long n_weeks = 0;
+    unsigned long n_rows = 0;
+    /// Row of each realization in the columns, or -1 if it is not run.
+    vector<long> realization_rows;
+    bool single_precision = false;
+    vector<vector<double>> double_columns;
+    vector<vector<float>> float_columns;
+    vector<unsigned long> first_columns;
+
+public:
+    TimeSeriesStore() = default;
+
+    TimeSeriesStore(const TimeSeriesStore &time_series_store) = delete;
+
+    TimeSeriesStore &operator=(const TimeSeriesStore &time_series_store) =
+            delete;
+
+    void allocate(unsigned long n_weeks,
+                  const vector<unsigned long> &realizations,
+                  const vector<unsigned long> &n_variables_per_component,
+                  bool single_precision);
+
+    void bind(unsigned long component, unsigned long realization,
+              const vector<TimeSeries *> &time_series);
+
+    bool isAllocated() const;
+
+    unsigned long getN_columns() const;
+
+    unsigned long getSizeInBytes() const;
+};
+
+
+#endif //TRIANGLEMODEL_TIMESERIESSTORE_H
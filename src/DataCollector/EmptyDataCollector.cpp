@@ -11,14 +11,10 @@ EmptyDataCollector::EmptyDataCollector() : DataCollector
                                                     Constants::NON_INITIALIZED,
                                                     0) {}
 
-string EmptyDataCollector::printTabularString(int week) {
-    string output = "";
-    return output;
+void EmptyDataCollector::printTabularString(int week, TextWriter &writer) {
 }
 
-string EmptyDataCollector::printCompactString(int week) {
-    string output = "";
-    return output;
+void EmptyDataCollector::printCompactString(int week, TextWriter &writer) {
 }
 
 string EmptyDataCollector::printTabularStringHeaderLine1() {
@@ -12,9 +12,9 @@ class EmptyDataCollector : public DataCollector {
 public:
     EmptyDataCollector();
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
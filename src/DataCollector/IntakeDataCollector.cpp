@@ -9,40 +9,30 @@ IntakeDataCollector::IntakeDataCollector(Intake *intake,
                                          unsigned long realization)
         : DataCollector(intake->id, intake->name, realization, INTAKE,
                         5 * COLUMN_WIDTH), intake(intake) {
+    registerTimeSeries({&total_upstream_sources_inflows, &demands,
+                        &wastewater_inflows, &outflows,
+                        &total_catchments_inflow, &treatment_capacity},
+                       {"up_spill", "demand", "ww_inflow", "ds_spill",
+                        "catch_inflow", "treat_cap"});
 }
 
-string IntakeDataCollector::printTabularString(int week) {
-    stringstream outStream;
-
-    outStream
-            << setw(2 * COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << demands[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << total_upstream_sources_inflows[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << wastewater_inflows[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << total_catchments_inflow[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << outflows[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << treatment_capacity[week];
-
-    return outStream.str();
+void IntakeDataCollector::printTabularString(int week, TextWriter &writer) {
+    writer.writeValue(demands[week], 2 * COLUMN_WIDTH, COLUMN_PRECISION);
+    for (const TimeSeries *series : {&total_upstream_sources_inflows,
+                                     &wastewater_inflows,
+                                     &total_catchments_inflow, &outflows,
+                                     &treatment_capacity})
+        writer.writeValue((*series)[week], COLUMN_WIDTH, COLUMN_PRECISION);
 }
 
-string IntakeDataCollector::printCompactString(int week) {
-    stringstream outStream;
-
-    outStream
-            << demands[week] << ","
-            << total_upstream_sources_inflows[week] << ","
-            << wastewater_inflows[week] << ","
-            << total_catchments_inflow[week] << ","
-            << outflows[week] << ","
-            << treatment_capacity[week];
-
-    return outStream.str();
+void IntakeDataCollector::printCompactString(int week, TextWriter &writer) {
+    for (const TimeSeries *series : {&demands, &total_upstream_sources_inflows,
+                                     &wastewater_inflows,
+                                     &total_catchments_inflow, &outflows}) {
+        writer.writeValue((*series)[week]);
+        writer.write(',');
+    }
+    writer.writeValue(treatment_capacity[week]);
 }
 
 string IntakeDataCollector::printTabularStringHeaderLine1() {
@@ -87,6 +77,8 @@ string IntakeDataCollector::printCompactStringHeader() {
 }
 
 void IntakeDataCollector::collect_data() {
+    if (!recording)
+        return;
 
     demands.push_back(intake->getDemand());
     total_upstream_sources_inflows
@@ -12,19 +12,19 @@
 class IntakeDataCollector : public DataCollector {
 
     Intake *intake;
-    vector<double> total_upstream_sources_inflows;
-    vector<double> demands;
-    vector<double> wastewater_inflows;
-    vector<double> outflows;
-    vector<double> total_catchments_inflow;
-    vector<double> treatment_capacity;
+    TimeSeries total_upstream_sources_inflows;
+    TimeSeries demands;
+    TimeSeries wastewater_inflows;
+    TimeSeries outflows;
+    TimeSeries total_catchments_inflow;
+    TimeSeries treatment_capacity;
 
 public:
     IntakeDataCollector(Intake *intake, unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -4,6 +4,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <omp.h>
 #include <sys/stat.h>
 #include <numeric>
 #include <random>
@@ -25,6 +26,7 @@ static const int NC_ERR = 2;
 #include "MasterDataCollector.h"
 #include "../Utils/ObjectivesCalculator.h"
 #include "../Utils/Utils.h"
+#include "../Utils/SimulationOutputFile.h"
 #include "../DroughtMitigationInstruments/Transfers.h"
 #include "TransfersDataCollector.h"
 #include "../SystemComponents/WaterSources/Quarry.h"
@@ -42,10 +44,15 @@ using namespace Constants;
 
 int MasterDataCollector::seed = NON_INITIALIZED;
 
+/**
+ * @param realizations_to_run
+ * @param n_weeks number of weeks of each realization, for which the time
+ * series of all collectors are allocated.
+ */
 MasterDataCollector::MasterDataCollector(
-        const vector<unsigned long> &realizations_to_run)
+        const vector<unsigned long> &realizations_to_run, unsigned long n_weeks)
         : n_realizations(*max_element(realizations_to_run.begin(), realizations_to_run.end()) + 1),
-        realizations_ran(realizations_to_run) {}
+        n_weeks(n_weeks), realizations_ran(realizations_to_run) {}
 
 MasterDataCollector::~MasterDataCollector() {
     for (vector<DataCollector *> dcs : water_source_collectors)
@@ -134,22 +141,22 @@ int MasterDataCollector::printNETCDFUtilities(string base_file_name) {
                     ERR(retval);
 
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u],
-						utility_collectors[u][r]->getCombined_storage().data())))
+						utility_collectors[u][r]->getCombined_storage().toVector().data())))
 	            ERR(retval);
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u + 1],
-						utility_collectors[u][r]->getSt_rof().data())))
+						utility_collectors[u][r]->getSt_rof().toVector().data())))
 	            ERR(retval);
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u + 2],
-						utility_collectors[u][r]->getLt_rof().data())))
+						utility_collectors[u][r]->getLt_rof().toVector().data())))
 	            ERR(retval);
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u + 3],
-						utility_collectors[u][r]->getRestricted_demand().data())))
+						utility_collectors[u][r]->getRestricted_demand().toVector().data())))
 	            ERR(retval);
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u + 4],
-						utility_collectors[u][r]->getContingency_fund_size().data())))
+						utility_collectors[u][r]->getContingency_fund_size().toVector().data())))
 	            ERR(retval);
                 if ((retval = nc_put_var_double(utilities_group_ids[n_utilities * r + u], vars_ids[n_utilities * r * n_vars + u + 5],
-						utility_collectors[u][r]->getDebt_service_payments().data())))
+						utility_collectors[u][r]->getDebt_service_payments().toVector().data())))
 	            ERR(retval);
 	    }
 	}
@@ -166,198 +173,364 @@ int MasterDataCollector::printNETCDFUtilities(string base_file_name) {
 
 void MasterDataCollector::printPoliciesOutputCompact(
         int week_i, int week_f, string file_name) {
-    if (!drought_mitigation_policy_collectors.empty()) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-        for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-            auto r = realizations_ran[rr];
-            std::ofstream out_stream;
-            out_stream.open(output_directory + file_name + "_r"
-                            + std::to_string(r) + ".csv");
-
-            string line;
-            for (vector<DataCollector *> p : drought_mitigation_policy_collectors)
-                line += p[r]->printCompactStringHeader();
-            line.pop_back();
-            out_stream << line << endl;
-
-            for (int w = week_i; w < week_f; ++w) {
-                line = "";
-                for (vector<DataCollector *> p : drought_mitigation_policy_collectors)
-                    line += p[r]->printCompactString(w);
-                line.pop_back();
-                out_stream << line << endl;
-            }
-
-            out_stream.close();
-        }
+    if (!drought_mitigation_policy_collectors.empty() &&
+        printsGroup("Policies")) {
+        printRealizationFiles(
+                file_name, ".csv", [&](unsigned long r, TextWriter &writer) {
+                    vector<DataCollector *> collectors;
+                    for (vector<DataCollector *> &p :
+                            drought_mitigation_policy_collectors)
+                        collectors.push_back(p[r]);
+                    printCompactRealization(collectors, week_i, week_f,
+                                            writer);
+                });
     }
 }
 
 
 void MasterDataCollector::printPoliciesOutputTabular(
         int week_i, int week_f, string file_name) {
-    if (!drought_mitigation_policy_collectors.empty()) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-        for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-            auto r = realizations_ran[rr];
-            std::ofstream out_stream;
-            out_stream.open(output_directory + file_name + "_r"
-                            + std::to_string(r) + ".tab");
-
-            out_stream << "    ";
-            for (vector<DataCollector *> p : drought_mitigation_policy_collectors)
-                out_stream << p[r]->printTabularStringHeaderLine1();
-            out_stream << endl;
-
-            out_stream << "Week";
-            for (vector<DataCollector *> p : drought_mitigation_policy_collectors)
-                out_stream << p[r]->printTabularStringHeaderLine2();
-            out_stream << endl;
-
-            for (int w = week_i; w < week_f; ++w) {
-                out_stream << setw(4) << w;
-                for (vector<DataCollector *> p : drought_mitigation_policy_collectors)
-                    out_stream << p[r]->printTabularString(w);
-                out_stream << endl;
-            }
+    if (!drought_mitigation_policy_collectors.empty() &&
+        printsGroup("Policies")) {
+        printRealizationFiles(
+                file_name, ".tab", [&](unsigned long r, TextWriter &writer) {
+                    vector<DataCollector *> collectors;
+                    for (vector<DataCollector *> &p :
+                            drought_mitigation_policy_collectors)
+                        collectors.push_back(p[r]);
+                    printTabularRealization(collectors, week_i, week_f,
+                                            false, writer);
+                });
+    }
+}
+
+/**
+ * Prints the time series of all utilities, water sources and policies of
+ * all realizations into a single binary simulation output file (see
+ * SimulationOutputFile), with one chunk per realization. Chunks of as many
+ * realizations at a time as there are threads are encoded in parallel and
+ * then written in order.
+ * @param week_i
+ * @param week_f
+ * @param file_name name of the file, without extension.
+ * @param compress whether to compress the series.
+ */
+void MasterDataCollector::printTimeSeriesBinary(int week_i, int week_f,
+                                                string file_name,
+                                                bool compress) {
+    vector<unsigned long> realizations = getRecordedRealizations();
+    if (realizations.empty())
+        return;
+
+    // Collectors of a realization in the order their series are stored.
+    auto realization_collectors = [this](unsigned long r) {
+        vector<pair<string, DataCollector *>> collectors;
+        for (vector<UtilitiesDataCollector *> &uc : utility_collectors)
+            collectors.emplace_back("Utilities", uc[r]);
+        for (vector<DataCollector *> &ws : water_source_collectors)
+            collectors.emplace_back("WaterSources", ws[r]);
+        for (vector<DataCollector *> &dmp : drought_mitigation_policy_collectors)
+            collectors.emplace_back("Policies", dmp[r]);
+        return collectors;
+    };
 
-            out_stream.close();
+    vector<SimulationOutputColumn> columns;
+    for (auto &collector : realization_collectors(realizations[0]))
+        for (const string &variable : collector.second->getTimeSeriesNames())
+            columns.push_back({collector.first, collector.second->id,
+                               collector.second->name, variable});
+    if (columns.empty())
+        return;
+
+    // Recorded values of the weeks printed.
+    unsigned long record_i = output_specification.getN_recorded_weeks(
+            (unsigned long) week_i);
+    unsigned long n_weeks_printed = output_specification.getN_recorded_weeks(
+            (unsigned long) week_f) - record_i;
+
+    string path = output_directory + file_name + ".bin";
+    SimulationOutputFile::Writer writer(
+            path, columns,
+            single_precision_series ? SERIES_FLOAT32 : SERIES_FLOAT64,
+            compress ? SimulationOutputFile::XOR_RLE_COMPRESSION :
+            SimulationOutputFile::NO_COMPRESSION,
+            output_specification.getRecordedWeek(record_i),
+            output_specification.getWeek_step());
+
+    auto batch_size = (unsigned long) omp_get_max_threads();
+    for (unsigned long first = 0; first < realizations.size();
+         first += batch_size) {
+        unsigned long last = min(first + batch_size,
+                                 (unsigned long) realizations.size());
+        vector<vector<char>> chunks(last - first);
+#pragma omp parallel for schedule(dynamic)
+        for (long i = 0; i < (long) (last - first); ++i) {
+            vector<vector<double>> values;
+            for (auto &collector :
+                    realization_collectors(realizations[first + i]))
+                for (TimeSeries *series : collector.second->getTimeSeries()) {
+                    values.emplace_back(n_weeks_printed);
+                    for (unsigned long w = 0; w < n_weeks_printed; ++w)
+                        values.back()[w] = (*series)[record_i + w];
+                }
+            chunks[i] = writer.encodeChunk(values);
         }
+        for (unsigned long i = first; i < last; ++i)
+            writer.writeChunk(realizations[i], n_weeks_printed,
+                              chunks[i - first]);
     }
+    writer.close();
+
+    printf("Printed %lu time series of %lu realizations into %s (%.1f MB).\n",
+           (unsigned long) columns.size(),
+           (unsigned long) realizations.size(), path.c_str(),
+           (double) writer.getBytesWritten() / 1e6);
 }
 
 void MasterDataCollector::printUtilitiesOutputCompact(
         int week_i, int week_f, string file_name) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-    for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-        auto r = realizations_ran[rr];
-        std::ofstream out_stream;
-        out_stream.open(output_directory + file_name + "_r"
-                        + std::to_string(r) + ".csv");
-
-        string line;
-        for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-            line += p[r]->printCompactStringHeader();
-        line.pop_back();
-        out_stream << line << endl;
-
-        for (int w = week_i; w < week_f; ++w) {
-            line = "";
-            for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-                line += p[r]->printCompactString(w);
-            line.pop_back();
-            out_stream << line << endl;
-        }
-
-        out_stream.close();
-    }
+    if (!printsGroup("Utilities"))
+        return;
+
+    printRealizationFiles(
+            file_name, ".csv", [&](unsigned long r, TextWriter &writer) {
+                vector<DataCollector *> collectors;
+                for (vector<UtilitiesDataCollector *> &p : utility_collectors)
+                    collectors.push_back(p[r]);
+                printCompactRealization(collectors, week_i, week_f, writer);
+            });
 }
 
 
 void MasterDataCollector::printUtilitesOutputTabular(
         int week_i, int week_f, string file_name) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-    for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-        auto r = realizations_ran[rr];
-        std::ofstream out_stream;
-        out_stream.open(output_directory + file_name + "_r"
-                        + std::to_string(r) + ".tab");
-
-        stringstream names;
-        names << "    ";
-        for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-            names << setw(p[realizations_ran[0]]->table_width) << p[r]->name;
-
-        out_stream << names.str();
-        out_stream << endl;
-
-        out_stream << "    ";
-        for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-            out_stream << p[r]->printTabularStringHeaderLine1();
-        out_stream << endl;
-
-        out_stream << "Week";
-        for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-            out_stream << p[r]->printTabularStringHeaderLine2();
-        out_stream << endl;
-
-        for (int w = week_i; w < week_f; ++w) {
-            out_stream << setw(4) << w;
-            for (vector<UtilitiesDataCollector *> &p : utility_collectors)
-                out_stream << p[r]->printTabularString(w);
-            out_stream << endl;
-        }
-
-        out_stream.close();
-    }
+    if (!printsGroup("Utilities"))
+        return;
+
+    printRealizationFiles(
+            file_name, ".tab", [&](unsigned long r, TextWriter &writer) {
+                vector<DataCollector *> collectors;
+                for (vector<UtilitiesDataCollector *> &p : utility_collectors)
+                    collectors.push_back(p[r]);
+                printTabularRealization(collectors, week_i, week_f, true,
+                                        writer);
+            });
 }
 
 void MasterDataCollector::printWaterSourcesOutputCompact(
         int week_i, int week_f, string file_name) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-    for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-        auto r = realizations_ran[rr];
-        try {
-            std::ofstream out_stream;
-            out_stream.open(output_directory + file_name + "_r"
-                            + std::to_string(r) + ".csv");
-
-            string line;
-            for (vector<DataCollector *> p : water_source_collectors)
-                line += p[r]->printCompactStringHeader();
-            line.pop_back();
-            out_stream << line << endl;
-
-            for (int w = week_i; w < week_f; ++w) {
-                line = "";
-                for (vector<DataCollector *> p : water_source_collectors)
-                    line += p[r]->printCompactString(w);
-                line.pop_back();
-                out_stream << line << endl;
-            }
+    if (!printsGroup("WaterSources"))
+        return;
+
+    printRealizationFiles(
+            file_name, ".csv", [&](unsigned long r, TextWriter &writer) {
+                try {
+                    vector<DataCollector *> collectors;
+                    for (vector<DataCollector *> &p : water_source_collectors)
+                        collectors.push_back(p[r]);
+                    printCompactRealization(collectors, week_i, week_f,
+                                            writer);
+                } catch (...) {
+                    printf("Warning: water sources data for realization %lu not saved due to error.\n", r);
+                }
+            });
+}
 
-            out_stream.close();
-        } catch (...) {
-            printf("Warning: water sources data for realization %lu not saved due to error.\n", r);
+void MasterDataCollector::printWaterSourcesOutputTabular(
+        int week_i, int week_f, string file_name) {
+    if (!printsGroup("WaterSources"))
+        return;
+
+    printRealizationFiles(
+            file_name, ".tab", [&](unsigned long r, TextWriter &writer) {
+                vector<DataCollector *> collectors;
+                for (vector<DataCollector *> &p : water_source_collectors)
+                    collectors.push_back(p[r]);
+                printTabularRealization(collectors, week_i, week_f, true,
+                                        writer);
+            });
+}
+
+/**
+ * Checks if a group has time series to print. If the output specification
+ * leaves out series, groups none of whose recorded components have any of
+ * the selected variables are skipped, as their files would only have the
+ * week column.
+ * @param group Utilities, WaterSources or Policies.
+ * @return
+ */
+bool MasterDataCollector::printsGroup(const string &group) const {
+    if (!output_specification.recordsGroup(group))
+        return false;
+    if (output_specification.selectsAllSeries())
+        return true;
+
+    vector<unsigned long> realizations = getRecordedRealizations();
+    if (realizations.empty())
+        return false;
+    unsigned long r = realizations[0];
+
+    vector<DataCollector *> collectors;
+    if (group == "Utilities")
+        for (const vector<UtilitiesDataCollector *> &uc : utility_collectors)
+            collectors.push_back(uc[r]);
+    else if (group == "WaterSources")
+        for (const vector<DataCollector *> &ws : water_source_collectors)
+            collectors.push_back(ws[r]);
+    else
+        for (const vector<DataCollector *> &dmp :
+                drought_mitigation_policy_collectors)
+            collectors.push_back(dmp[r]);
+
+    for (DataCollector *dc : collectors)
+        if (!dc->getTimeSeries().empty())
+            return true;
+    return false;
+}
+
+/**
+ * Prints one file per recorded realization, with as many files written at
+ * once as there are threads, up to MAX_TEXT_FILES_IN_FLIGHT. Each thread
+ * formats its files into its own writer, whose buffer is reused from file to
+ * file.
+ * @param file_name name of the files, to which the realization is appended.
+ * @param extension
+ * @param print_realization prints the contents of a realization's file.
+ */
+void MasterDataCollector::printRealizationFiles(
+        const string &file_name, const string &extension,
+        const function<void(unsigned long, TextWriter &)> &print_realization) {
+    int n_writers = min(omp_get_max_threads(), MAX_TEXT_FILES_IN_FLIGHT);
+    vector<TextWriter> writers((unsigned long) n_writers);
+    for (TextWriter &writer : writers)
+        writer.setRoundTrip(round_trip_text);
+
+    vector<unsigned long> realizations = getRecordedRealizations();
+#pragma omp parallel for num_threads(n_writers) schedule(dynamic)
+    for (int rr = 0; rr < (int) realizations.size(); ++rr) {
+        auto r = realizations[rr];
+        TextWriter &writer = writers[omp_get_thread_num()];
+        writer.open(output_directory + file_name + "_r" + std::to_string(r) +
+                    extension);
+        print_realization(r, writer);
+        writer.close();
+    }
+}
+
+/**
+ * Prints the header and weekly values of a realization's collectors as
+ * comma separated values. If the output specification leaves out variables,
+ * components or weeks, the recorded time series are printed instead, with
+ * the week of each row in the first column.
+ * @param collectors
+ * @param week_i
+ * @param week_f
+ * @param writer
+ */
+void MasterDataCollector::printCompactRealization(
+        const vector<DataCollector *> &collectors, int week_i, int week_f,
+        TextWriter &writer) const {
+    if (!output_specification.selectsAllSeries()) {
+        writer.write("week");
+        for (DataCollector *dc : collectors)
+            for (const string &variable : dc->getTimeSeriesNames()) {
+                writer.write(',');
+                writer.writeInteger(dc->id);
+                writer.write(variable);
+            }
+        writer.endLine();
+
+        unsigned long record_i = output_specification.getN_recorded_weeks(
+                (unsigned long) week_i);
+        unsigned long record_f = output_specification.getN_recorded_weeks(
+                (unsigned long) week_f);
+        for (unsigned long k = record_i; k < record_f; ++k) {
+            writer.writeInteger(output_specification.getRecordedWeek(k));
+            for (DataCollector *dc : collectors)
+                for (TimeSeries *series : dc->getTimeSeries()) {
+                    writer.write(',');
+                    writer.writeValue((*series)[k]);
+                }
+            writer.endLine();
         }
+        return;
+    }
+
+    unsigned long line_start = writer.getLineStart();
+    for (DataCollector *dc : collectors)
+        writer.write(dc->printCompactStringHeader());
+    writer.removeLastCharacter(line_start);
+    writer.endLine();
+
+    for (int w = week_i; w < week_f; ++w) {
+        line_start = writer.getLineStart();
+        for (DataCollector *dc : collectors)
+            dc->printCompactString(w, writer);
+        writer.removeLastCharacter(line_start);
+        writer.endLine();
     }
 }
 
-void MasterDataCollector::printWaterSourcesOutputTabular(
-        int week_i, int week_f, string file_name) {
-#pragma omp parallel for default(none) shared(file_name, week_i, week_f)
-    for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
-        auto r = realizations_ran[rr];
-        std::ofstream out_stream;
-        out_stream.open(output_directory + file_name + "_r"
-                        + std::to_string(r) + ".tab");
-
-        stringstream names;
-        names << "    ";
-        for (vector<DataCollector *> p : water_source_collectors)
-            names << setw(p[realizations_ran[0]]->table_width) << p[r]->name;
-
-        out_stream << names.str();
-        out_stream << endl;
-
-        out_stream << "    ";
-        for (vector<DataCollector *> p : water_source_collectors)
-            out_stream << p[r]->printTabularStringHeaderLine1();
-        out_stream << endl;
-
-        out_stream << "Week";
-        for (vector<DataCollector *> p : water_source_collectors)
-            out_stream << p[r]->printTabularStringHeaderLine2();
-        out_stream << endl;
-
-        for (int w = week_i; w < week_f; ++w) {
-            out_stream << setw(4) << w;
-            for (vector<DataCollector *> p : water_source_collectors)
-                out_stream << p[r]->printTabularString(w);
-            out_stream << endl;
+/**
+ * Prints the header and weekly values of a realization's collectors as a
+ * table with fixed width columns.
+ * @param collectors
+ * @param week_i
+ * @param week_f
+ * @param print_names whether to print a line with the collectors' names
+ * above the header. If the output specification leaves out variables,
+ * components or weeks, the recorded time series are printed instead under
+ * a single header line.
+ * @param writer
+ */
+void MasterDataCollector::printTabularRealization(
+        const vector<DataCollector *> &collectors, int week_i, int week_f,
+        bool print_names, TextWriter &writer) const {
+    if (!output_specification.selectsAllSeries()) {
+        writer.write("Week");
+        for (DataCollector *dc : collectors)
+            for (const string &variable : dc->getTimeSeriesNames())
+                writer.writePadded(to_string(dc->id) + variable,
+                                   COLUMN_WIDTH);
+        writer.endLine();
+
+        unsigned long record_i = output_specification.getN_recorded_weeks(
+                (unsigned long) week_i);
+        unsigned long record_f = output_specification.getN_recorded_weeks(
+                (unsigned long) week_f);
+        for (unsigned long k = record_i; k < record_f; ++k) {
+            writer.writeInteger(output_specification.getRecordedWeek(k), 4);
+            for (DataCollector *dc : collectors)
+                for (TimeSeries *series : dc->getTimeSeries())
+                    writer.writeValue((*series)[k], COLUMN_WIDTH,
+                                      COLUMN_PRECISION);
+            writer.endLine();
         }
+        return;
+    }
+
+    if (print_names) {
+        writer.write("    ");
+        for (DataCollector *dc : collectors)
+            writer.writePadded(dc->name, dc->table_width);
+        writer.endLine();
+    }
 
-        out_stream.close();
+    writer.write("    ");
+    for (DataCollector *dc : collectors)
+        writer.write(dc->printTabularStringHeaderLine1());
+    writer.endLine();
+
+    writer.write("Week");
+    for (DataCollector *dc : collectors)
+        writer.write(dc->printTabularStringHeaderLine2());
+    writer.endLine();
+
+    for (int w = week_i; w < week_f; ++w) {
+        writer.writeInteger(w, 4);
+        for (DataCollector *dc : collectors)
+            dc->printTabularString(w, writer);
+        writer.endLine();
     }
 }
 
@@ -567,24 +740,23 @@ void MasterDataCollector::performBootstrapAnalysis(
 
 void MasterDataCollector::printBSSamples(int sol_id, int n_sets, int n_samples,
                                          const vector<vector<unsigned long>> &bootstrap_sample_sets) const {
-    ofstream outStream_realizations; // Either read samples from file or create new ones.
-    outStream_realizations.open(output_directory + "bootstrap_realizations_" +
-                                to_string(n_sets) + "_" + to_string(n_samples) +
-                                "_S" +
-                                to_string(sol_id) + ".csv");
+    TextWriter writer; // Either read samples from file or create new ones.
+    writer.open(output_directory + "bootstrap_realizations_" +
+                to_string(n_sets) + "_" + to_string(n_samples) + "_S" +
+                to_string(sol_id) + ".csv");
 
-    string line;
     for (int set = 0; set < n_sets; ++set) {
         // Generate one set of bootstrapped realizations, if none was specified.
-        line = "";
+        unsigned long line_start = writer.getLineStart();
         for (int s : bootstrap_sample_sets[set]) {
-            line += to_string(s) + ",";
+            writer.writeInteger(s);
+            writer.write(',');
         }
-        line.pop_back();
-        outStream_realizations << line << endl;
+        writer.removeLastCharacter(line_start);
+        writer.endLine();
     }
 
-    outStream_realizations.close();
+    writer.close();
 }
 
 void
@@ -596,41 +768,42 @@ MasterDataCollector::printObjectivesOfAllRealizationsForBSAnalysis(int sol_id,
                        "_" + to_string(n_samples) + "_S" + to_string(sol_id) + ".csv";
     vector<double> objectives_all_reals = calculatePrintObjectives("", false);
 
-    string line;
-    line = "";
+    TextWriter writer;
+    writer.setRoundTrip(round_trip_text);
+    writer.open(file_name);
+    unsigned long line_start = writer.getLineStart();
     for (double &o : objectives_all_reals) {
-	    line += to_string(o) + ",";
+        writer.writeFixed(o);
+        writer.write(',');
     }
-    line.pop_back();
-
-    ofstream outStream_objs_all_reals;
-    outStream_objs_all_reals.open(file_name);
-    outStream_objs_all_reals << line << endl;
+    writer.removeLastCharacter(line_start);
+    writer.endLine();
 
-    outStream_objs_all_reals.close();
+    writer.close();
 }
 
 void
 MasterDataCollector::printObjsBSSamples(int sol_id, int n_sets, int n_samples,
                                               vector<vector<double>> &objectives) {// Print objectives.
-    ofstream outStream_objs;
     string objectives_file_name =
             output_directory + "bootstrap_objs_" + to_string(n_sets) + "_" +
                         to_string(n_samples) + "_S" + to_string(sol_id) + ".csv";
-    outStream_objs.open(objectives_file_name);
+    TextWriter writer;
+    writer.setRoundTrip(round_trip_text);
+    writer.open(objectives_file_name);
     printf("Bootstrap objectives files will be printed at %s\n",
            objectives_file_name.c_str());
 
-    string line;
     for (int set = 0; set < n_sets; ++set) {
-        line = "";
+        unsigned long line_start = writer.getLineStart();
         for (double &o : objectives[set]) {
-            line += to_string(o) + ",";
+            writer.writeFixed(o);
+            writer.write(',');
         }
-        line.pop_back();
-        outStream_objs << line << endl;
+        writer.removeLastCharacter(line_start);
+        writer.endLine();
     }
-    outStream_objs.close();
+    writer.close();
 }
 
 void MasterDataCollector::readOrCreateBSSamples(int sol_id, int n_sets,
@@ -658,21 +831,26 @@ void MasterDataCollector::readOrCreateBSSamples(int sol_id, int n_sets,
 }
 
 void MasterDataCollector::printPathways(string file_name) {
-    std::ofstream outStream;
-    outStream.open(output_directory + file_name + ".out");
+    TextWriter writer;
+    writer.open(output_directory + file_name + ".out");
 
-    outStream << "Realization\tutility\tweek\tinfra." << endl;
+    writer.write("Realization\tutility\tweek\tinfra.");
+    writer.endLine();
 
     for (auto &uc : utility_collectors)
         for (int rr = 0; rr < (int) realizations_ran.size(); ++rr) {
             auto r = realizations_ran[rr];
-            for (vector<int> infra : uc[r]->getPathways()) {
-                outStream << r << "\t" << infra[0] << "\t" << infra[1] << "\t"
-                          << infra[2] << endl;
+            for (const vector<int> &infra : uc[r]->getPathways()) {
+                writer.writeInteger((long) r);
+                for (int i = 0; i < 3; ++i) {
+                    writer.write('\t');
+                    writer.writeInteger(infra[i]);
+                }
+                writer.endLine();
             }
         }
 
-    outStream.close();
+    writer.close();
 }
 
 void MasterDataCollector::setOutputDirectory(string io_directory) {
@@ -684,11 +862,23 @@ void MasterDataCollector::setOutputDirectory(string io_directory) {
     }
 }
 
+/**
+ * Creates the data collector of a drought mitigation policy.
+ * @param dmp
+ * @param r
+ * @param record whether the policy's time series are recorded. If not,
+ * restriction policies only keep the data needed to calculate objectives and
+ * other policies get no data collector.
+ * @return
+ */
 DataCollector *
 MasterDataCollector::createPolicyDataCollector(DroughtMitigationPolicy *dmp,
-                                               unsigned long r) {
+                                               unsigned long r, bool record) {
     if (dmp->type == RESTRICTIONS)
-        return new RestrictionsDataCollector(dynamic_cast<Restrictions *> (dmp), r);
+        return new RestrictionsDataCollector(dynamic_cast<Restrictions *> (dmp), r,
+                                             !record);
+    else if (!record)
+        return new EmptyDataCollector();
     else if (dmp->type == TRANSFERS)
         return new TransfersDataCollector(dynamic_cast<Transfers *> (dmp), r);
     else if (dmp->type == BILATERAL_TRANSFERS)
@@ -702,10 +892,21 @@ MasterDataCollector::createPolicyDataCollector(DroughtMitigationPolicy *dmp,
                                  " function or to create its data collector??");
 }
 
+/**
+ * Creates the data collector of a water source.
+ * @param ws
+ * @param r
+ * @param record whether the source's time series are recorded. If not, the
+ * source gets no data collector.
+ * @return
+ */
 DataCollector *
 MasterDataCollector::createWaterSourceDataCollector(WaterSource *ws,
-                                                    unsigned long r) {
-    if (ws->source_type == RESERVOIR)
+                                                    unsigned long r,
+                                                    bool record) {
+    if (!record)
+        return new EmptyDataCollector();
+    else if (ws->source_type == RESERVOIR)
         return new ReservoirDataCollector(dynamic_cast<Reservoir *> (ws), r);
     else if (ws->source_type == INTAKE)
         return new IntakeDataCollector(dynamic_cast<Intake *> (ws), r);
@@ -730,44 +931,175 @@ MasterDataCollector::createWaterSourceDataCollector(WaterSource *ws,
                                  " function?");
 }
 
+/**
+ * Warns about the components and variables selectors of the output
+ * specification that select no time series of a recorded realization, such
+ * as misspelled names, which would otherwise silently leave outputs empty.
+ * @param utilities_realization
+ * @param drought_mitigation_policies_realization
+ * @param water_sources_realization
+ * @param collectors collectors of the realization's utilities, policies and
+ * water sources, in this order, after their time series were selected.
+ */
+void MasterDataCollector::warnUnmatchedSelectors(
+        const vector<Utility *> &utilities_realization,
+        const vector<DroughtMitigationPolicy *> &drought_mitigation_policies_realization,
+        const vector<WaterSource *> &water_sources_realization,
+        const vector<DataCollector *> &collectors) const {
+    // Group, id and name of the component of each collector.
+    vector<string> groups;
+    vector<int> ids;
+    vector<string> names;
+    for (Utility *utility : utilities_realization) {
+        groups.emplace_back("Utilities");
+        ids.push_back(utility->id);
+        names.push_back(utility->name);
+    }
+    for (DroughtMitigationPolicy *dmp : drought_mitigation_policies_realization) {
+        groups.emplace_back("Policies");
+        ids.push_back(dmp->id);
+        names.emplace_back("");
+    }
+    for (WaterSource *ws : water_sources_realization) {
+        groups.emplace_back("WaterSources");
+        ids.push_back(ws->id);
+        names.push_back(ws->name);
+    }
+
+    for (const string &selector : output_specification.getComponents()) {
+        bool matched = false;
+        for (unsigned long c = 0; c < collectors.size() && !matched; ++c)
+            matched = !collectors[c]->getTimeSeries().empty() &&
+                      OutputSpecification::selectsComponent(
+                              selector, groups[c], ids[c], names[c]);
+        if (!matched)
+            printf("Warning: components=%s in the output specification "
+                   "selects no time series.\n", selector.c_str());
+    }
+
+    for (const string &variable : output_specification.getVariables()) {
+        bool matched = false;
+        for (unsigned long c = 0; c < collectors.size() && !matched; ++c) {
+            const vector<string> &series_names =
+                    collectors[c]->getTimeSeriesNames();
+            matched = find(series_names.begin(), series_names.end(),
+                           variable) != series_names.end();
+        }
+        if (!matched)
+            printf("Warning: variables=%s in the output specification "
+                   "selects no time series.\n", variable.c_str());
+    }
+}
+
+/**
+ * Creates the data collectors of a realization and binds their time series
+ * to the time series store. The collectors vectors are set up by the first
+ * realization added and the store by the first realization recorded, after
+ * which realizations are added without locking. Only the components,
+ * variables and realizations in the output specification are recorded.
+ * @param water_sources_realization
+ * @param drought_mitigation_policies_realization
+ * @param utilities_realization
+ * @param r
+ */
 void MasterDataCollector::addRealization(
         vector<WaterSource *> water_sources_realization,
         vector<DroughtMitigationPolicy *> drought_mitigation_policies_realization,
         vector<Utility *> utilities_realization,
         unsigned long r) {
-    // If collectors vectors have not yet been initialized, initialize them.
-#pragma omp critical
-    {
-        if (water_source_collectors.empty()) {
-            water_source_collectors = vector<vector<DataCollector *>>
-                    (water_sources_realization.size(),
-                     vector<DataCollector *>(n_realizations));
-            drought_mitigation_policy_collectors = vector<vector<DataCollector *>>
-                    (drought_mitigation_policies_realization.size(),
-                     vector<DataCollector *>(n_realizations));
-            utility_collectors = vector<vector<UtilitiesDataCollector *>>
-                    (utilities_realization.size(),
-                     vector<UtilitiesDataCollector *>(n_realizations));
-        }
-        realizations_created++;
-    };
+    bool record_realization =
+            !objectives_only && output_specification.recordsRealization(r);
 
     // Create utilities data collectors
-    for (int u = 0; u < (int) utilities_realization.size(); ++u) {
-        utility_collectors[u][r] = new UtilitiesDataCollector(
-                utilities_realization[u], r);
-    }
+    vector<DataCollector *> collectors;
+    for (Utility *utility : utilities_realization)
+        collectors.push_back(new UtilitiesDataCollector(
+                utility, r, !(record_realization &&
+                              output_specification.recordsComponent(
+                                      "Utilities", utility->id,
+                                      utility->name))));
 
     // Create drought mitigation policies data collector
-    for (int dmp = 0; dmp < (int) drought_mitigation_policies_realization.size(); ++dmp)
-        drought_mitigation_policy_collectors[dmp][r] =
-                createPolicyDataCollector(drought_mitigation_policies_realization[dmp], r);
+    for (DroughtMitigationPolicy *dmp : drought_mitigation_policies_realization)
+        collectors.push_back(createPolicyDataCollector(
+                dmp, r, record_realization &&
+                        output_specification.recordsComponent("Policies",
+                                                              dmp->id, "")));
 
     // Create water sources data collectors
-    for (int ws = 0; ws < (int) water_sources_realization.size(); ++ws) {
-        water_source_collectors[ws][r] = createWaterSourceDataCollector(water_sources_realization[ws], r);
+    for (WaterSource *ws : water_sources_realization)
+        collectors.push_back(createWaterSourceDataCollector(
+                ws, r, record_realization &&
+                       output_specification.recordsComponent("WaterSources",
+                                                             ws->id,
+                                                             ws->name)));
+
+    // Record only the variables in the output specification, dropping the
+    // collectors left without time series unless their data is needed to
+    // calculate objectives.
+    if (output_specification.isSet()) {
+        for (DataCollector *&dc : collectors) {
+            dc->selectTimeSeries(output_specification);
+            if (dc->getTimeSeries().empty() && dc->type != UTILITY &&
+                dc->type != RESTRICTIONS && dc->type != NON_INITIALIZED) {
+                delete dc;
+                dc = new EmptyDataCollector();
+            }
+        }
+        if (record_realization)
+            call_once(selectors_checked, [&]() {
+                warnUnmatchedSelectors(
+                        utilities_realization,
+                        drought_mitigation_policies_realization,
+                        water_sources_realization, collectors);
+            });
     }
-} 
+
+    // If collectors vectors have not yet been initialized, initialize them.
+    call_once(collectors_initialized, [&]() {
+        water_source_collectors = vector<vector<DataCollector *>>
+                (water_sources_realization.size(),
+                 vector<DataCollector *>(n_realizations));
+        drought_mitigation_policy_collectors = vector<vector<DataCollector *>>
+                (drought_mitigation_policies_realization.size(),
+                 vector<DataCollector *>(n_realizations));
+        utility_collectors = vector<vector<UtilitiesDataCollector *>>
+                (utilities_realization.size(),
+                 vector<UtilitiesDataCollector *>(n_realizations));
+    });
+
+    // If the time series have not yet been allocated, allocate those of all
+    // recorded realizations with the number of series of this realization's
+    // collectors.
+    if (record_realization) {
+        call_once(time_series_allocated, [&]() {
+            vector<unsigned long> n_series_per_component;
+            for (DataCollector *dc : collectors)
+                n_series_per_component.push_back(dc->getTimeSeries().size());
+            time_series_store.allocate(
+                    output_specification.getN_recorded_weeks(n_weeks),
+                    getRecordedRealizations(), n_series_per_component,
+                    single_precision_series);
+        });
+    }
+    realizations_created++;
+
+    unsigned long n_utilities = utilities_realization.size();
+    unsigned long n_policies = drought_mitigation_policies_realization.size();
+    for (unsigned long c = 0; c < collectors.size(); ++c) {
+        if (record_realization)
+            time_series_store.bind(c, r, collectors[c]->getTimeSeries());
+        if (c < n_utilities)
+            utility_collectors[c][r] =
+                    dynamic_cast<UtilitiesDataCollector *>(collectors[c]);
+        else if (c < n_utilities + n_policies)
+            drought_mitigation_policy_collectors[c - n_utilities][r] =
+                    collectors[c];
+        else
+            water_source_collectors[c - n_utilities - n_policies][r] =
+                    collectors[c];
+    }
+}
 
 void MasterDataCollector::removeRealization(unsigned long r) {
     for (int u = 0; u < (int) utility_collectors.size(); ++u) {
@@ -802,7 +1134,23 @@ void MasterDataCollector::cleanCollectorsOfDeletedRealizations() {
 }
 
 
-void MasterDataCollector::collectData(unsigned long r) {
+/**
+ * Collects the data of a week of a realization.
+ * @param r realization.
+ * @param week week of the simulation, used to only record the weeks in the
+ * output specification.
+ */
+void MasterDataCollector::collectData(unsigned long r, int week) {
+    if (output_specification.filtersWeeks()) {
+        bool record = output_specification.recordsWeek(week);
+        for (vector<UtilitiesDataCollector *> &uc : utility_collectors)
+            uc[r]->setRecording(record);
+        for (vector<DataCollector *> &dmp : drought_mitigation_policy_collectors)
+            dmp[r]->setRecording(record);
+        for (vector<DataCollector *> &ws : water_source_collectors)
+            ws[r]->setRecording(record);
+    }
+
     for (vector<UtilitiesDataCollector *> &uc : utility_collectors)
         uc[r]->collect_data();
     for (vector<DataCollector *> dmp : drought_mitigation_policy_collectors)
@@ -822,3 +1170,65 @@ void MasterDataCollector::unsetSeed() {
 int MasterDataCollector::getRealizations_created() const {
     return realizations_created;
 }
+
+/**
+ * Sets whether only the data needed to calculate objectives is collected,
+ * in which case realizations take memory proportional to their number of
+ * years instead of weeks but no time series can be printed. Must be called
+ * before any realization is added.
+ * @param objectives_only
+ */
+void MasterDataCollector::setObjectivesOnly(bool objectives_only) {
+    MasterDataCollector::objectives_only = objectives_only;
+}
+
+bool MasterDataCollector::isObjectivesOnly() const {
+    return objectives_only;
+}
+
+/**
+ * Sets whether time series are stored in single precision, which halves the
+ * memory they take at the cost of printing values rounded to about 7
+ * significant digits. Must be called before any realization is added.
+ * @param single_precision_series
+ */
+void MasterDataCollector::setSinglePrecisionSeries(
+        bool single_precision_series) {
+    MasterDataCollector::single_precision_series = single_precision_series;
+}
+
+/**
+ * Prints values in text outputs with all the digits needed to read them
+ * back exactly, instead of six significant digits.
+ * @param round_trip_text
+ */
+void MasterDataCollector::setRoundTripText(bool round_trip_text) {
+    MasterDataCollector::round_trip_text = round_trip_text;
+}
+
+/**
+ * Sets which time series are recorded. Must be called before realizations
+ * are added.
+ * @param output_specification
+ */
+void MasterDataCollector::setOutputSpecification(
+        const OutputSpecification &output_specification) {
+    MasterDataCollector::output_specification = output_specification;
+}
+
+/**
+ * Realizations run whose time series are recorded, in the order they are
+ * run.
+ * @return
+ */
+vector<unsigned long> MasterDataCollector::getRecordedRealizations() const {
+    vector<unsigned long> realizations;
+    for (unsigned long r : realizations_ran)
+        if (output_specification.recordsRealization(r))
+            realizations.push_back(r);
+    return realizations;
+}
+
+const TimeSeriesStore &MasterDataCollector::getTime_series_store() const {
+    return time_series_store;
+}
@@ -6,8 +6,12 @@
 #define TRIANGLEMODEL_MASTERDATACOLLECTOR_H
 
 
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <vector>
 #include "Base/DataCollector.h"
+#include "Base/TimeSeriesStore.h"
 #include "UtilitiesDataCollector.h"
 #include "../DroughtMitigationInstruments/Base/DroughtMitigationPolicy.h"
 #include "RestrictionsDataCollector.h"
@@ -16,22 +20,53 @@ class MasterDataCollector {
 private:
     string output_directory;
     unsigned long n_realizations;
+    unsigned long n_weeks;
 
     vector<vector<DataCollector *>> water_source_collectors;
     vector<vector<DataCollector *>> drought_mitigation_policy_collectors;
     vector<vector<UtilitiesDataCollector *>> utility_collectors;
     vector<unsigned long> crashed_realizations;
     vector<unsigned long> realizations_ran;
-    int realizations_created = 0;
+    atomic<int> realizations_created{0};
+    /// If true, only the data needed to calculate objectives is collected.
+    bool objectives_only = false;
+    bool single_precision_series = false;
+    /// If true, values in text outputs are printed with all the digits
+    /// needed to read them back exactly.
+    bool round_trip_text = false;
+    once_flag collectors_initialized;
+    once_flag time_series_allocated;
+    once_flag selectors_checked;
+    /// Time series of all collectors of all recorded realizations.
+    TimeSeriesStore time_series_store;
+    /// Which time series are recorded.
+    OutputSpecification output_specification;
 
     static int seed;
 
 //    void removeNullptrs(vector<vector<void *>> vector_of_collectors);
 
+    void printRealizationFiles(
+            const string &file_name, const string &extension,
+            const function<void(unsigned long, TextWriter &)> &
+            print_realization);
+
+    void printCompactRealization(const vector<DataCollector *> &collectors,
+                                 int week_i, int week_f,
+                                 TextWriter &writer) const;
+
+    void printTabularRealization(const vector<DataCollector *> &collectors,
+                                 int week_i, int week_f, bool print_names,
+                                 TextWriter &writer) const;
+
+    vector<unsigned long> getRecordedRealizations() const;
+
+    bool printsGroup(const string &group) const;
+
 public:
 
-    explicit MasterDataCollector(
-            const vector<unsigned long> &realizations_to_run);
+    MasterDataCollector(const vector<unsigned long> &realizations_to_run,
+                        unsigned long n_weeks);
 
 
     int printNETCDFUtilities(string file_name);
@@ -47,6 +82,9 @@ public:
 
     void printUtilitiesOutputCompact(int week_i, int week_f, string file_name);
 
+    void printTimeSeriesBinary(int week_i, int week_f, string file_name,
+                               bool compress);
+
     void printUtilitesOutputTabular(int week_i, int week_f, string file_name);
 
     void
@@ -68,14 +106,22 @@ public:
 
     void cleanCollectorsOfDeletedRealizations();
 
-    void collectData(unsigned long r);
+    void collectData(unsigned long r, int week);
 
     void performBootstrapAnalysis(int sol_id, int n_sets, int n_samples, int n_threads,
                                   vector<vector<unsigned long>> bootstrap_samples = vector<vector<unsigned long>>());
 
-    DataCollector* createPolicyDataCollector(DroughtMitigationPolicy* dmp, unsigned long r);
+    DataCollector* createPolicyDataCollector(DroughtMitigationPolicy* dmp, unsigned long r,
+                                             bool record);
+
+    DataCollector* createWaterSourceDataCollector(WaterSource* ws, unsigned long r,
+                                                  bool record);
 
-    DataCollector* createWaterSourceDataCollector(WaterSource* ws, unsigned long r);
+    void warnUnmatchedSelectors(
+            const vector<Utility *> &utilities_realization,
+            const vector<DroughtMitigationPolicy *> &drought_mitigation_policies_realization,
+            const vector<WaterSource *> &water_sources_realization,
+            const vector<DataCollector *> &collectors) const;
 
     void printUtilityObjectivesToRowOutStream(vector<UtilitiesDataCollector *> &u, std::ofstream &outStream,
             vector<double> &objectives);
@@ -99,6 +145,19 @@ public:
                                           vector<RestrictionsDataCollector *> &utility_restrictions) const;
 
     int getRealizations_created() const;
+
+    void setObjectivesOnly(bool objectives_only);
+
+    bool isObjectivesOnly() const;
+
+    void setSinglePrecisionSeries(bool single_precision_series);
+
+    void setRoundTripText(bool round_trip_text);
+
+    void setOutputSpecification(
+            const OutputSpecification &output_specification);
+
+    const TimeSeriesStore &getTime_series_store() const;
 };
 
 
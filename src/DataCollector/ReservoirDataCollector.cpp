@@ -7,62 +7,52 @@
 #include "ReservoirDataCollector.h"
 
 ReservoirDataCollector::ReservoirDataCollector(Reservoir *reservoir, unsigned long realization)
-        : DataCollector(reservoir->id, reservoir->name, realization, RESERVOIR, 7 * COLUMN_WIDTH), reservoir(reservoir),
-          fixed_area(reservoir->fixed_area), fixed_area_value(reservoir->getArea()) {
-}
+        : ReservoirDataCollector(reservoir, RESERVOIR, 7 * COLUMN_WIDTH, realization) {}
 
 ReservoirDataCollector::ReservoirDataCollector(Reservoir *reservoir, int type, int table_width,
                                                unsigned long realization)
         : DataCollector(reservoir->id, reservoir->name, realization, type, table_width), reservoir(reservoir),
           fixed_area(reservoir->fixed_area), fixed_area_value(reservoir->getArea()) {
-}
-
-string ReservoirDataCollector::printTabularString(int week) {
-    stringstream outStream;
-
-    outStream
-            << setw(2 * COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << stored_volume[week];
-
+    registerTimeSeries({&stored_volume, &total_upstream_sources_inflows,
+                        &wastewater_inflows, &demands, &outflows,
+                        &total_catchments_inflow, &evaporated_volume,
+                        &treatment_capacity},
+                       {"volume", "up_spill", "ww_inflow", "demand",
+                        "ds_spill", "catch_inflow", "evap", "treat_cap"});
     if (fixed_area)
-        outStream << setw(COLUMN_WIDTH) << area[week];
-
-    outStream
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << demands[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << total_upstream_sources_inflows[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << wastewater_inflows[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << total_catchments_inflow[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << evaporated_volume[week]
-            << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-            << outflows[week];
-
-    return outStream.str();
+        registerTimeSeries({&area}, {"s_area"});
 }
 
-string ReservoirDataCollector::printCompactString(int week) {
-    stringstream outStream;
-
-    outStream
-            << stored_volume[week] << ",";
+void ReservoirDataCollector::printTabularString(int week, TextWriter &writer) {
+    writer.writeValue(stored_volume[week], 2 * COLUMN_WIDTH, COLUMN_PRECISION);
 
     if (fixed_area)
-        outStream << fixed_area << ",";
+        writer.writeValue(area[week], COLUMN_WIDTH, COLUMN_PRECISION);
 
-    outStream
-            << demands[week] << ","
-            << total_upstream_sources_inflows[week] << ","
-            << wastewater_inflows[week] << ","
-            << total_catchments_inflow[week] << ","
-            << evaporated_volume[week] << ","
-            << outflows[week] << ","
-            << treatment_capacity[week] << ",";
+    for (const TimeSeries *series : {&demands, &total_upstream_sources_inflows,
+                                     &wastewater_inflows,
+                                     &total_catchments_inflow,
+                                     &evaporated_volume, &outflows})
+        writer.writeValue((*series)[week], COLUMN_WIDTH, COLUMN_PRECISION);
+}
 
-    return outStream.str();
+void ReservoirDataCollector::printCompactString(int week, TextWriter &writer) {
+    writer.writeValue(stored_volume[week]);
+    writer.write(',');
+
+    if (fixed_area) {
+        writer.writeInteger(fixed_area);
+        writer.write(',');
+    }
+
+    for (const TimeSeries *series : {&demands, &total_upstream_sources_inflows,
+                                     &wastewater_inflows,
+                                     &total_catchments_inflow,
+                                     &evaporated_volume, &outflows,
+                                     &treatment_capacity}) {
+        writer.writeValue((*series)[week]);
+        writer.write(',');
+    }
 }
 
 string ReservoirDataCollector::printTabularStringHeaderLine1() {
@@ -127,6 +117,8 @@ string ReservoirDataCollector::printCompactStringHeader() {
 }
 
 void ReservoirDataCollector::collect_data() {
+    if (!recording)
+        return;
 
     stored_volume.push_back(reservoir->getAvailableSupplyVolume());
     demands.push_back(reservoir->getDemand());
@@ -13,15 +13,15 @@
 class ReservoirDataCollector : public DataCollector {
 
     Reservoir *reservoir;
-    vector<double> stored_volume;
-    vector<double> total_upstream_sources_inflows;
-    vector<double> wastewater_inflows;
-    vector<double> demands;
-    vector<double> outflows;
-    vector<double> total_catchments_inflow;
-    vector<double> evaporated_volume;
-    vector<double> area;
-    vector<double> treatment_capacity;
+    TimeSeries stored_volume;
+    TimeSeries total_upstream_sources_inflows;
+    TimeSeries wastewater_inflows;
+    TimeSeries demands;
+    TimeSeries outflows;
+    TimeSeries total_catchments_inflow;
+    TimeSeries evaporated_volume;
+    TimeSeries area;
+    TimeSeries treatment_capacity;
     bool fixed_area;
     double fixed_area_value;
 
@@ -31,9 +31,9 @@ public:
     explicit ReservoirDataCollector(Reservoir *reservoir, int type, int table_width,
                                         unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -4,24 +4,31 @@
 
 #include <iomanip>
 #include "RestrictionsDataCollector.h"
-
-RestrictionsDataCollector::RestrictionsDataCollector(Restrictions *restriction_policy, unsigned long realization)
+#include "../Utils/Utils.h"
+
+/**
+ * @param restriction_policy
+ * @param realization
+ * @param objectives_only if true, only the years with restrictions are kept,
+ * so that the collector cannot print time series.
+ */
+RestrictionsDataCollector::RestrictionsDataCollector(Restrictions *restriction_policy, unsigned long realization,
+                                                     bool objectives_only)
         : DataCollector(restriction_policy->id, "", realization, RESTRICTIONS, NON_INITIALIZED),
-          restriction_policy(restriction_policy) {
+          restriction_policy(restriction_policy),
+          objectives_only(objectives_only) {
+    if (!objectives_only)
+        registerTimeSeries({&restriction_multipliers}, {"rest_m"});
 }
 
-string RestrictionsDataCollector::printTabularString(int week) {
-    stringstream outStream;
-
-    outStream << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << restriction_multipliers.at((unsigned long) week);
-
-    return outStream.str();
+void RestrictionsDataCollector::printTabularString(int week, TextWriter &writer) {
+    writer.writeValue(restriction_multipliers.at((unsigned long) week),
+                      COLUMN_WIDTH, COLUMN_PRECISION);
 }
 
-string RestrictionsDataCollector::printCompactString(int week) {
-
-    return to_string(restriction_multipliers.at((unsigned long) week)) + ",";
+void RestrictionsDataCollector::printCompactString(int week, TextWriter &writer) {
+    writer.writeFixed(restriction_multipliers.at((unsigned long) week));
+    writer.write(',');
 }
 
 string RestrictionsDataCollector::printTabularStringHeaderLine1() {
@@ -47,11 +54,32 @@ string RestrictionsDataCollector::printCompactStringHeader() {
 }
 
 void RestrictionsDataCollector::collect_data() {
-    restriction_multipliers.push_back
-            (restriction_policy->getCurrent_multiplier());
+    double multiplier = restriction_policy->getCurrent_multiplier();
+    if (!objectives_only && recording)
+        restriction_multipliers.push_back(multiplier);
+
+    auto year = (unsigned long) Utils::objectivesYearOfWeek(
+            n_weeks_collected++);
+    if (restriction_years.size() <= year)
+        restriction_years.resize(year + 1, false);
+    if (multiplier != 1.0)
+        restriction_years[year] = true;
 }
 
-const vector<double> &
+const TimeSeries &
 RestrictionsDataCollector::getRestriction_multipliers() const {
     return restriction_multipliers;
 }
+
+int RestrictionsDataCollector::getN_weeks_collected() const {
+    return n_weeks_collected;
+}
+
+/**
+ * Whether restrictions were in place in any week of each year (see
+ * Utils::objectivesYearOfWeek).
+ * @return
+ */
+const vector<bool> &RestrictionsDataCollector::getRestriction_years() const {
+    return restriction_years;
+}
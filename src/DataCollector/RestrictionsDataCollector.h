@@ -13,14 +13,20 @@
 class RestrictionsDataCollector : public DataCollector {
 private:
     Restrictions *restriction_policy;
-    vector<double> restriction_multipliers;
+    TimeSeries restriction_multipliers;
+    /// If true, only the years with restrictions are kept, not the
+    /// multipliers.
+    const bool objectives_only;
+    int n_weeks_collected = 0;
+    vector<bool> restriction_years;
 
 public:
-    explicit RestrictionsDataCollector(Restrictions *restriction_policy, unsigned long realization);
+    explicit RestrictionsDataCollector(Restrictions *restriction_policy, unsigned long realization,
+                                       bool objectives_only = false);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -30,7 +36,11 @@ public:
 
     void collect_data() override;
 
-    const vector<double> &getRestriction_multipliers() const;
+    const TimeSeries &getRestriction_multipliers() const;
+
+    int getN_weeks_collected() const;
+
+    const vector<bool> &getRestriction_years() const;
 };
 
 
@@ -11,27 +11,26 @@ TransfersBilateralDataCollector::TransfersBilateralDataCollector(
         : DataCollector(transfer_policy->id, "", realization,
                         BILATERAL_TRANSFERS, NON_INITIALIZED),
           transfer_policy(transfer_policy),
+          demand_offsets(transfer_policy->getUtilities_ids().size()),
           utilities_ids(transfer_policy->getUtilities_ids()) {
+    for (unsigned long i = 0; i < demand_offsets.size(); ++i)
+        registerTimeSeries({&demand_offsets[i]},
+                           {"transf_" + to_string(utilities_ids[i])});
 }
 
-string TransfersBilateralDataCollector::printTabularString(int week) {
+void TransfersBilateralDataCollector::printTabularString(int week, TextWriter &writer) {
 
-    stringstream outStream;
-
-    for (double &a : demand_offsets.at((unsigned int) week))
-        outStream << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION) << a;
-
-    return outStream.str();
+    for (const TimeSeries &demand_offset : demand_offsets)
+        writer.writeValue(demand_offset.at((unsigned long) week), COLUMN_WIDTH,
+                          COLUMN_PRECISION);
 }
 
-string TransfersBilateralDataCollector::printCompactString(int week) {
+void TransfersBilateralDataCollector::printCompactString(int week, TextWriter &writer) {
 
-    stringstream outStream;
-
-    for (double &a : demand_offsets.at((unsigned int) week))
-        outStream << a << ",";
-
-    return outStream.str();
+    for (const TimeSeries &demand_offset : demand_offsets) {
+        writer.writeValue(demand_offset.at((unsigned long) week));
+        writer.write(',');
+    }
 }
 
 string TransfersBilateralDataCollector::printTabularStringHeaderLine1() {
@@ -64,5 +63,10 @@ string TransfersBilateralDataCollector::printCompactStringHeader() {
 }
 
 void TransfersBilateralDataCollector::collect_data() {
-    demand_offsets.push_back(transfer_policy->getTransferedVolumes());
+    if (!recording)
+        return;
+
+    const vector<double> &allocations = transfer_policy->getTransferedVolumes();
+    for (unsigned long i = 0; i < demand_offsets.size(); ++i)
+        demand_offsets[i].push_back(allocations[i]);
 }
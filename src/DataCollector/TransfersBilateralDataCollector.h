@@ -11,16 +11,17 @@
 class TransfersBilateralDataCollector : public DataCollector {
 private:
     TransfersBilateral *transfer_policy;
-    vector<vector<double>> demand_offsets;
+    /// Series of each utility in utilities_ids.
+    vector<TimeSeries> demand_offsets;
     vector<int> utilities_ids;
 
 public:
     TransfersBilateralDataCollector(TransfersBilateral *transfer_policy,
                                     unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -8,30 +8,31 @@
 TransfersDataCollector::TransfersDataCollector(Transfers *transfer_policy, unsigned long realization)
         : DataCollector(transfer_policy->id, "", realization, TRANSFERS, NON_INITIALIZED),
           utilities_ids(transfer_policy->getUtilities_ids()),
+          demand_offsets(utilities_ids.size()),
           transfer_policy(transfer_policy) {
 
     std::sort(utilities_ids.begin(),
               utilities_ids.end());
-}
-
-string TransfersDataCollector::printTabularString(int week) {
-
-    stringstream outStream;
-
-    for (double &a : demand_offsets.at((unsigned int) week))
-        outStream << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION) << a;
 
-    return outStream.str();
+    for (unsigned long i = 0; i < demand_offsets.size(); ++i)
+        registerTimeSeries({&demand_offsets[i]},
+                           {"transf_" + to_string(
+                                   transfer_policy->getUtilities_ids()[i])});
 }
 
-string TransfersDataCollector::printCompactString(int week) {
+void TransfersDataCollector::printTabularString(int week, TextWriter &writer) {
 
-    stringstream outStream;
+    for (const TimeSeries &demand_offset : demand_offsets)
+        writer.writeValue(demand_offset.at((unsigned long) week), COLUMN_WIDTH,
+                          COLUMN_PRECISION);
+}
 
-    for (double &a : demand_offsets.at((unsigned int) week))
-        outStream << a << ",";
+void TransfersDataCollector::printCompactString(int week, TextWriter &writer) {
 
-    return outStream.str();
+    for (const TimeSeries &demand_offset : demand_offsets) {
+        writer.writeValue(demand_offset.at((unsigned long) week));
+        writer.write(',');
+    }
 }
 
 string TransfersDataCollector::printTabularStringHeaderLine1() {
@@ -64,5 +65,10 @@ string TransfersDataCollector::printCompactStringHeader() {
 }
 
 void TransfersDataCollector::collect_data() {
-    demand_offsets.push_back(transfer_policy->getAllocations());
+    if (!recording)
+        return;
+
+    const vector<double> &allocations = transfer_policy->getAllocations();
+    for (unsigned long i = 0; i < demand_offsets.size(); ++i)
+        demand_offsets[i].push_back(allocations[i]);
 }
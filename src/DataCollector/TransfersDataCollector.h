@@ -13,15 +13,16 @@
 class TransfersDataCollector : public DataCollector {
 private:
     vector<int> utilities_ids;
-    vector<vector<double>> demand_offsets;
+    /// Series of each utility in utilities_ids.
+    vector<TimeSeries> demand_offsets;
     Transfers *transfer_policy;
 
 public:
     TransfersDataCollector(Transfers *transfer_policy, unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
@@ -5,87 +5,93 @@
 #include <iomanip>
 //#include <cmath>
 #include "UtilitiesDataCollector.h"
+#include "../Utils/Utils.h"
+
+/**
+ * Sums at the start of a year, with a tiny revenue so that costs over
+ * revenue never divide by zero.
+ * @return
+ */
+FinancialAmounts FinancialAmounts::startOfYear() {
+    FinancialAmounts year;
+    year.gross_revenue = 1e-6;
+    return year;
+}
 
+/**
+ * Adds a week's amounts to a year's sums.
+ * @param week
+ */
+void FinancialAmounts::add(const FinancialAmounts &week) {
+    debt_service_payments += week.debt_service_payments;
+    contingency_fund_contribution += week.contingency_fund_contribution;
+    insurance_contract_cost += week.insurance_contract_cost;
+    drought_mitigation_cost += week.drought_mitigation_cost;
+    gross_revenue += week.gross_revenue;
+    contingency_fund_size = week.contingency_fund_size;
+}
 
-UtilitiesDataCollector::UtilitiesDataCollector(const Utility *utility, unsigned long realization)
+/**
+ * @param utility
+ * @param realization
+ * @param objectives_only if true, only the yearly aggregates needed by the
+ * objectives are kept, so that the collector cannot print time series.
+ */
+UtilitiesDataCollector::UtilitiesDataCollector(const Utility *utility, unsigned long realization,
+                                               bool objectives_only)
         : DataCollector(utility->id, utility->name, realization, UTILITY, 15 * COLUMN_WIDTH),
-          utility(utility) {
+          utility(utility),
+          infra_discount_rate(utility->getInfraDiscountRate()),
+          objectives_only(objectives_only) {
+    if (!objectives_only)
+        registerTimeSeries({&st_rof, &lt_rof, &combined_storage,
+                            &unrestricted_demand, &restricted_demand,
+                            &contingency_fund_size, &gross_revenues,
+                            &contingency_fund_contribution,
+                            &debt_service_payments, &insurance_contract_cost,
+                            &insurance_payout, &drought_mitigation_cost,
+                            &capacity, &net_present_infrastructure_cost,
+                            &waste_water_discharge, &unfulfilled_demand,
+                            &net_stream_inflow, &total_treatment_capacity},
+                           {"st_rof", "lt_rof", "st_vol", "unrest_demand",
+                            "rest_demand", "cont_fund", "gross_rev",
+                            "cont_fund_contr", "debt_serv", "ins_price",
+                            "ins_pout", "dm_cost", "capacity", "infra_npv",
+                            "wastewater", "unfulf_demand", "net_inf",
+                            "treat_capacity"});
 }
 
-string UtilitiesDataCollector::printTabularString(int week) {
-
-    stringstream outStream;
-
-    outStream << setw(2 * COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << combined_storage[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << capacity[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-	          << net_stream_inflow[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << st_rof[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << lt_rof[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << unfulfilled_demand[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << restricted_demand[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << unrestricted_demand[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << waste_water_discharge[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << total_treatment_capacity[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << contingency_fund_size[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << insurance_payout[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << insurance_contract_cost[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << net_present_infrastructure_cost[week]
-              << setw(COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-              << debt_service_payments[week];
-
-    return outStream.str();
+void UtilitiesDataCollector::printTabularString(int week, TextWriter &writer) {
+
+    writer.writeValue(combined_storage[week], 2 * COLUMN_WIDTH,
+                      COLUMN_PRECISION);
+    for (const TimeSeries *series : {&capacity, &net_stream_inflow, &st_rof,
+                                     &lt_rof, &unfulfilled_demand,
+                                     &restricted_demand, &unrestricted_demand,
+                                     &waste_water_discharge,
+                                     &total_treatment_capacity,
+                                     &contingency_fund_size, &insurance_payout,
+                                     &insurance_contract_cost,
+                                     &net_present_infrastructure_cost,
+                                     &debt_service_payments})
+        writer.writeValue((*series)[week], COLUMN_WIDTH, COLUMN_PRECISION);
 }
 
-string UtilitiesDataCollector::printCompactString(int week) {
-
-    stringstream outStream;
-
-    outStream << combined_storage[week]
-              << ","
-              << capacity[week]
-              << ","
-	          << net_stream_inflow[week]
-              << ","
-              << st_rof[week]
-              << ","
-              << lt_rof[week]
-              << ","
-              << restricted_demand[week]
-              << ","
-              << unrestricted_demand[week]
-              << ","
-              << unfulfilled_demand[week]
-              << ","
-              << waste_water_discharge[week]
-              << ","
-              << total_treatment_capacity[week]
-              << ","
-              << contingency_fund_size[week]
-              << ","
-              << insurance_payout[week]
-              << ","
-              << insurance_contract_cost[week]
-              << ","
-              << net_present_infrastructure_cost[week]
-              << ","
-              << debt_service_payments[week]
-              << ",";
-
-    return outStream.str();
+void UtilitiesDataCollector::printCompactString(int week, TextWriter &writer) {
+
+    for (const TimeSeries *series : {&combined_storage, &capacity,
+                                     &net_stream_inflow, &st_rof, &lt_rof,
+                                     &restricted_demand, &unrestricted_demand,
+                                     &unfulfilled_demand,
+                                     &waste_water_discharge,
+                                     &total_treatment_capacity,
+                                     &contingency_fund_size, &insurance_payout,
+                                     &insurance_contract_cost,
+                                     &net_present_infrastructure_cost,
+                                     &debt_service_payments}) {
+        writer.writeValue((*series)[week]);
+        writer.write(',');
+    }
 }
 
 string UtilitiesDataCollector::printTabularStringHeaderLine1() {
@@ -159,24 +165,28 @@ string UtilitiesDataCollector::printCompactStringHeader() {
 void UtilitiesDataCollector::collect_data() {
     vector<int> infra_built;
 
-    combined_storage.push_back(utility->getTotal_available_volume());
-    lt_rof.push_back(utility->getLong_term_risk_of_failure());
-    st_rof.push_back(utility->getRisk_of_failure());
-    unrestricted_demand.push_back(utility->getUnrestrictedDemand());
-    restricted_demand.push_back(utility->getRestrictedDemand());
-    contingency_fund_size.push_back(utility->getContingency_fund());
-    net_present_infrastructure_cost.push_back(utility->getInfrastructure_net_present_cost());
-    gross_revenues.push_back(utility->getGrossRevenue());
-    debt_service_payments.push_back(utility->getCurrent_debt_payment());
-    contingency_fund_contribution.push_back(utility->getCurrent_contingency_fund_contribution());
-    drought_mitigation_cost.push_back(utility->getDrought_mitigation_cost());
-    insurance_contract_cost.push_back(utility->getInsurance_purchase());
-    insurance_payout.push_back(utility->getInsurance_payout());
-    capacity.push_back(utility->getTotal_storage_capacity());
-    waste_water_discharge.push_back(utility->getWaste_water_discharge());
-    unfulfilled_demand.push_back(utility->getUnfulfilled_demand());
-    net_stream_inflow.push_back(utility->getNet_stream_inflow());
-    total_treatment_capacity.push_back(utility->getTotal_treatment_capacity());
+    if (!objectives_only && recording) {
+        combined_storage.push_back(utility->getTotal_available_volume());
+        lt_rof.push_back(utility->getLong_term_risk_of_failure());
+        st_rof.push_back(utility->getRisk_of_failure());
+        unrestricted_demand.push_back(utility->getUnrestrictedDemand());
+        restricted_demand.push_back(utility->getRestrictedDemand());
+        contingency_fund_size.push_back(utility->getContingency_fund());
+        net_present_infrastructure_cost.push_back(utility->getInfrastructure_net_present_cost());
+        gross_revenues.push_back(utility->getGrossRevenue());
+        debt_service_payments.push_back(utility->getCurrent_debt_payment());
+        contingency_fund_contribution.push_back(utility->getCurrent_contingency_fund_contribution());
+        drought_mitigation_cost.push_back(utility->getDrought_mitigation_cost());
+        insurance_contract_cost.push_back(utility->getInsurance_purchase());
+        insurance_payout.push_back(utility->getInsurance_payout());
+        capacity.push_back(utility->getTotal_storage_capacity());
+        waste_water_discharge.push_back(utility->getWaste_water_discharge());
+        unfulfilled_demand.push_back(utility->getUnfulfilled_demand());
+        net_stream_inflow.push_back(utility->getNet_stream_inflow());
+        total_treatment_capacity.push_back(utility->getTotal_treatment_capacity());
+    }
+
+    collectObjectivesData();
 
 //    checkForNans();
 
@@ -188,6 +198,48 @@ void UtilitiesDataCollector::collect_data() {
             pathways.push_back(infra_built);
 }
 
+/**
+ * Updates the yearly aggregates used by ObjectivesCalculator with the
+ * current week.
+ */
+void UtilitiesDataCollector::collectObjectivesData() {
+    int week = n_weeks_collected++;
+
+    // Years in which storage fell below the failure threshold.
+    auto year = (unsigned long) Utils::objectivesYearOfWeek(week);
+    if (failure_years.size() <= year)
+        failure_years.resize(year + 1, false);
+    if (utility->getTotal_available_volume() /
+        utility->getTotal_storage_capacity() < STORAGE_CAPACITY_RATIO_FAIL)
+        failure_years[year] = true;
+
+    net_present_infrastructure_cost_sum +=
+            utility->getInfrastructure_net_present_cost();
+
+    // Financial amounts summed into years ending before the first week of
+    // each year.
+    FinancialAmounts amounts;
+    amounts.debt_service_payments = utility->getCurrent_debt_payment();
+    amounts.contingency_fund_contribution =
+            utility->getCurrent_contingency_fund_contribution();
+    amounts.insurance_contract_cost = utility->getInsurance_purchase();
+    amounts.drought_mitigation_cost = utility->getDrought_mitigation_cost();
+    amounts.gross_revenue = utility->getGrossRevenue();
+    amounts.contingency_fund_size = utility->getContingency_fund();
+
+    bool last_week_of_year = Utils::isFirstWeekOfTheYear(week + 1);
+    if (!first_financial_year_closed) {
+        first_financial_year_weeks.push_back(amounts);
+        first_financial_year_closed = last_week_of_year;
+    } else {
+        open_financial_year.add(amounts);
+        if (last_week_of_year) {
+            later_financial_years.push_back(open_financial_year);
+            open_financial_year = FinancialAmounts::startOfYear();
+        }
+    }
+}
+
 void UtilitiesDataCollector::checkForNans() const {
     string error = "nan collecting data for utility " + to_string(id) + " in week " + to_string(lt_rof.size
             ()) + ", realization " + to_string(realization);
@@ -232,38 +284,38 @@ void UtilitiesDataCollector::checkForNans() const {
     
 }
 
-const vector<double> &UtilitiesDataCollector::getCombined_storage() const {
+const TimeSeries &UtilitiesDataCollector::getCombined_storage() const {
     return combined_storage;
 }
 
-const vector<double> &UtilitiesDataCollector::getCapacity() const {
+const TimeSeries &UtilitiesDataCollector::getCapacity() const {
     return capacity;
 }
 
-const vector<double> &UtilitiesDataCollector::getGross_revenues() const {
+const TimeSeries &UtilitiesDataCollector::getGross_revenues() const {
     return gross_revenues;
 }
 
-const vector<double> &
+const TimeSeries &
 UtilitiesDataCollector::getContingency_fund_contribution() const {
     return contingency_fund_contribution;
 }
 
-const vector<double> &UtilitiesDataCollector::getDebt_service_payments() const {
+const TimeSeries &UtilitiesDataCollector::getDebt_service_payments() const {
     return debt_service_payments;
 }
 
-const vector<double> &
+const TimeSeries &
 UtilitiesDataCollector::getInsurance_contract_cost() const {
     return insurance_contract_cost;
 }
 
-const vector<double> &
+const TimeSeries &
 UtilitiesDataCollector::getDrought_mitigation_cost() const {
     return drought_mitigation_cost;
 }
 
-const vector<double> &UtilitiesDataCollector::getContingency_fund_size() const {
+const TimeSeries &UtilitiesDataCollector::getContingency_fund_size() const {
     return contingency_fund_size;
 }
 
@@ -271,23 +323,86 @@ const vector<vector<int>> &UtilitiesDataCollector::getPathways() const {
     return pathways;
 }
 
-const vector<double> &
+const TimeSeries &
 UtilitiesDataCollector::getNet_present_infrastructure_cost() const {
     return net_present_infrastructure_cost;
 }
 
-const vector<double> &UtilitiesDataCollector::getSt_rof() const {
+const TimeSeries &UtilitiesDataCollector::getSt_rof() const {
     return st_rof;
 }
 
-const vector<double> &UtilitiesDataCollector::getLt_rof() const {
+const TimeSeries &UtilitiesDataCollector::getLt_rof() const {
     return lt_rof;
 }
 
-const vector<double> &UtilitiesDataCollector::getRestricted_demand() const {
+const TimeSeries &UtilitiesDataCollector::getRestricted_demand() const {
     return restricted_demand;
 }
 
 const Utility *UtilitiesDataCollector::getUtility() const {
     return utility;
 }
+
+/**
+ * Discount rate of the utility's infrastructure, kept by the collector
+ * because the utility is deleted or reused once its realization is over.
+ * @return
+ */
+double UtilitiesDataCollector::getInfra_discount_rate() const {
+    return infra_discount_rate;
+}
+
+bool UtilitiesDataCollector::isObjectivesOnly() const {
+    return objectives_only;
+}
+
+int UtilitiesDataCollector::getN_weeks_collected() const {
+    return n_weeks_collected;
+}
+
+/**
+ * Whether storage fell below STORAGE_CAPACITY_RATIO_FAIL of capacity in
+ * each year (see Utils::objectivesYearOfWeek).
+ * @return
+ */
+const vector<bool> &UtilitiesDataCollector::getFailure_years() const {
+    return failure_years;
+}
+
+double UtilitiesDataCollector::getNet_present_infrastructure_cost_sum() const {
+    return net_present_infrastructure_cost_sum;
+}
+
+/**
+ * Financial amounts of each week until the end of the first year, or of all
+ * weeks if no year has ended.
+ * @return
+ */
+const vector<FinancialAmounts> &
+UtilitiesDataCollector::getFirst_financial_year_weeks() const {
+    return first_financial_year_weeks;
+}
+
+bool UtilitiesDataCollector::isFirst_financial_year_closed() const {
+    return first_financial_year_closed;
+}
+
+/**
+ * Financial amounts summed over each year after the first.
+ * @return
+ */
+const vector<FinancialAmounts> &
+UtilitiesDataCollector::getLater_financial_years() const {
+    return later_financial_years;
+}
+
+/**
+ * Financial amounts summed since the end of the last year, if the first
+ * year has ended.
+ * @return
+ */
+const FinancialAmounts &
+UtilitiesDataCollector::getOpen_financial_year() const {
+    return open_financial_year;
+}
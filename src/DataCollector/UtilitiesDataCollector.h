@@ -9,38 +9,76 @@
 #include "Base/DataCollector.h"
 #include "../SystemComponents/Utility/Utility.h"
 
+/**
+ * A utility's financial amounts used by the peak financial cost and worse
+ * case cost objectives, either of one week or summed over a year.
+ */
+struct FinancialAmounts {
+    double debt_service_payments = 0;
+    double contingency_fund_contribution = 0;
+    double insurance_contract_cost = 0;
+    double drought_mitigation_cost = 0;
+    double gross_revenue = 0;
+    /// Size of the contingency fund at the end of the week or year.
+    double contingency_fund_size = 0;
+
+    static FinancialAmounts startOfYear();
+
+    void add(const FinancialAmounts &week);
+};
+
 class UtilitiesDataCollector : public DataCollector {
 private:
-    vector<double> st_rof;
-    vector<double> lt_rof;
-    vector<double> combined_storage;
-    vector<double> unrestricted_demand;
-    vector<double> restricted_demand;
-    vector<double> contingency_fund_size;
-    vector<double> gross_revenues;
-    vector<double> contingency_fund_contribution;
-    vector<double> debt_service_payments;
-    vector<double> insurance_contract_cost;
-    vector<double> insurance_payout;
-    vector<double> drought_mitigation_cost;
-    vector<double> capacity;
-    vector<double> net_present_infrastructure_cost;
-    vector<double> waste_water_discharge;
-    vector<double> unfulfilled_demand;
-    vector<double> net_stream_inflow;
-    vector<double> total_treatment_capacity;
+    TimeSeries st_rof;
+    TimeSeries lt_rof;
+    TimeSeries combined_storage;
+    TimeSeries unrestricted_demand;
+    TimeSeries restricted_demand;
+    TimeSeries contingency_fund_size;
+    TimeSeries gross_revenues;
+    TimeSeries contingency_fund_contribution;
+    TimeSeries debt_service_payments;
+    TimeSeries insurance_contract_cost;
+    TimeSeries insurance_payout;
+    TimeSeries drought_mitigation_cost;
+    TimeSeries capacity;
+    TimeSeries net_present_infrastructure_cost;
+    TimeSeries waste_water_discharge;
+    TimeSeries unfulfilled_demand;
+    TimeSeries net_stream_inflow;
+    TimeSeries total_treatment_capacity;
     vector<vector<int>> pathways;
     const Utility *utility;
+    const double infra_discount_rate;
+    /// If true, only the yearly aggregates below are kept, not the time
+    /// series above, which are not registered.
+    const bool objectives_only;
+
+    /// Yearly aggregates the objectives are calculated from.
+    int n_weeks_collected = 0;
+    vector<bool> failure_years;
+    double net_present_infrastructure_cost_sum = 0;
+    /// The financial objectives sum weekly amounts into years without
+    /// resetting the sums between realizations, so the weeks of the first
+    /// year are kept for the sums to be finished once the previous
+    /// realization is known.
+    vector<FinancialAmounts> first_financial_year_weeks;
+    bool first_financial_year_closed = false;
+    vector<FinancialAmounts> later_financial_years;
+    FinancialAmounts open_financial_year = FinancialAmounts::startOfYear();
+
+    void collectObjectivesData();
 
 public:
 
-    explicit UtilitiesDataCollector(const Utility *utility, unsigned long realization);
+    explicit UtilitiesDataCollector(const Utility *utility, unsigned long realization,
+                                    bool objectives_only = false);
 
     UtilitiesDataCollector &operator=(const UtilitiesDataCollector &utility_data_collector);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     void collect_data() override;
 
@@ -50,35 +88,53 @@ public:
 
     string printCompactStringHeader() override;
 
-    const vector<double> &getCombined_storage() const;
+    const TimeSeries &getCombined_storage() const;
 
-    const vector<double> &getCapacity() const;
+    const TimeSeries &getCapacity() const;
 
-    const vector<double> &getGross_revenues() const;
+    const TimeSeries &getGross_revenues() const;
 
-    const vector<double> &getContingency_fund_contribution() const;
+    const TimeSeries &getContingency_fund_contribution() const;
 
-    const vector<double> &getDebt_service_payments() const;
+    const TimeSeries &getDebt_service_payments() const;
 
-    const vector<double> &getInsurance_contract_cost() const;
+    const TimeSeries &getInsurance_contract_cost() const;
 
-    const vector<double> &getDrought_mitigation_cost() const;
+    const TimeSeries &getDrought_mitigation_cost() const;
 
-    const vector<double> &getContingency_fund_size() const;
+    const TimeSeries &getContingency_fund_size() const;
 
     const vector<vector<int>> &getPathways() const;
 
-    const vector<double> &getNet_present_infrastructure_cost() const;
+    const TimeSeries &getNet_present_infrastructure_cost() const;
 
-    const vector<double> &getSt_rof() const;
+    const TimeSeries &getSt_rof() const;
 
-    const vector<double> &getLt_rof() const;
+    const TimeSeries &getLt_rof() const;
 
-    const vector<double> &getRestricted_demand() const;
+    const TimeSeries &getRestricted_demand() const;
 
     void checkForNans() const;
 
     const Utility *getUtility() const;
+
+    double getInfra_discount_rate() const;
+
+    bool isObjectivesOnly() const;
+
+    int getN_weeks_collected() const;
+
+    const vector<bool> &getFailure_years() const;
+
+    double getNet_present_infrastructure_cost_sum() const;
+
+    const vector<FinancialAmounts> &getFirst_financial_year_weeks() const;
+
+    bool isFirst_financial_year_closed() const;
+
+    const vector<FinancialAmounts> &getLater_financial_years() const;
+
+    const FinancialAmounts &getOpen_financial_year() const;
 };
 
 
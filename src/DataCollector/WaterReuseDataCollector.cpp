@@ -10,21 +10,14 @@ WaterReuseDataCollector::WaterReuseDataCollector(WaterReuse *water_reuse, unsign
         : DataCollector(water_reuse->id, water_reuse->name, realization, WATER_REUSE, 2 * COLUMN_WIDTH),
           water_reuse(water_reuse), reused_volume(water_reuse->getReused_volume()) {}
 
-string WaterReuseDataCollector::printTabularString(int week) {
-    stringstream out_stream;
-
-    out_stream << setw(2 * COLUMN_WIDTH) << setprecision(COLUMN_PRECISION)
-               << water_reuse->getReused_volume();
-
-    return out_stream.str();
+void WaterReuseDataCollector::printTabularString(int week, TextWriter &writer) {
+    writer.writeValue(water_reuse->getReused_volume(), 2 * COLUMN_WIDTH,
+                      COLUMN_PRECISION);
 }
 
-string WaterReuseDataCollector::printCompactString(int week) {
-    stringstream out_stream;
-
-    out_stream << reused_volume << ",";
-
-    return out_stream.str();
+void WaterReuseDataCollector::printCompactString(int week, TextWriter &writer) {
+    writer.writeValue(reused_volume);
+    writer.write(',');
 }
 
 string WaterReuseDataCollector::printTabularStringHeaderLine1() {
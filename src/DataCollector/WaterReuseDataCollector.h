@@ -17,9 +17,9 @@ private:
 public:
     WaterReuseDataCollector(WaterReuse *water_reuse, unsigned long realization);
 
-    string printTabularString(int week) override;
+    void printTabularString(int week, TextWriter &writer) override;
 
-    string printCompactString(int week) override;
+    void printCompactString(int week, TextWriter &writer) override;
 
     string printTabularStringHeaderLine1() override;
 
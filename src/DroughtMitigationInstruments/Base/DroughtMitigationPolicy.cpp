@@ -30,16 +30,37 @@ bool DroughtMitigationPolicy::operator>(const DroughtMitigationPolicy *other) {
     return id > other->id;
 }
 
-double DroughtMitigationPolicy::getRofFromRealizationTable(int utility_id, int week, int tier) {
-    return (*DroughtMitigationPolicy::storage_to_rof_table_)[utility_id](week, tier);
+/**
+ * Gets the storage-ROF tables of the realization, which are either imported
+ * or calculated as the realization is simulated.
+ * @return storage-ROF table of each utility.
+ */
+const vector<ROFTable> &DroughtMitigationPolicy::getRealizationROFTables() const {
+    if (use_imported_tables)
+        return *DroughtMitigationPolicy::imported_rof_table_;
+    return storage_to_rof_table_views_;
 }
 
 void DroughtMitigationPolicy::setStorage_to_rof_table_(vector<Matrix2D<double>> &storage_to_rof_table_,
+                                                       const vector<ROFTable> &imported_rof_table_,
                                                        int use_imported_tables) {
     DroughtMitigationPolicy::storage_to_rof_table_ = &storage_to_rof_table_;
+    DroughtMitigationPolicy::imported_rof_table_ = &imported_rof_table_;
     DroughtMitigationPolicy::use_imported_tables = use_imported_tables == IMPORT_ROF_TABLES;
-}
-
-
 
+    storage_to_rof_table_views_.clear();
+    for (Matrix2D<double> &table : storage_to_rof_table_)
+        storage_to_rof_table_views_.emplace_back(
+                table.get_i(), table.get_j(), ROF_TABLE_FLOAT64,
+                table.getPointerToElement(0, 0));
+}
 
+/**
+ * Adds to the list of each utility the short-term ROFs at which this policy
+ * changes its decisions, so that ROFs can be estimated from fewer years when
+ * they are far from all of them (see AdaptiveROFSampling). Policies whose
+ * decisions do not depend on short-term ROF triggers add none.
+ * @param utilities_rof_triggers triggers of each utility, by utility ID.
+ */
+void DroughtMitigationPolicy::addShortTermROFTriggers(
+        vector<vector<double>> &utilities_rof_triggers) const {}
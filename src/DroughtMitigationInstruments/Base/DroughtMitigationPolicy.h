@@ -9,11 +9,16 @@
 #include "../../Utils/Constants.h"
 #include "../../Utils/Graph/Graph.h"
 #include "../../Utils/Matrices.h"
+#include "../../Utils/ROFTable.h"
 #include "../../Controls/Base/MinEnvFlowControl.h"
 
 class DroughtMitigationPolicy {
 private:
     vector<Matrix2D<double>> *storage_to_rof_table_;
+    const vector<ROFTable> *imported_rof_table_;
+    /// Views of storage_to_rof_table_, for lookups made the same way as
+    /// with imported tables.
+    vector<ROFTable> storage_to_rof_table_views_;
 
 protected:
     DroughtMitigationPolicy(const DroughtMitigationPolicy &drought_mitigation_policy);
@@ -26,7 +31,7 @@ protected:
     double *rdm_factors_realization;
     bool use_imported_tables;
 
-    double getRofFromRealizationTable(int utility_id, int week, int tier);
+    const vector<ROFTable> &getRealizationROFTables() const;
 
 public:
     const int id;
@@ -48,11 +53,16 @@ public:
 
     virtual ~DroughtMitigationPolicy();
 
-    void setStorage_to_rof_table_(vector<Matrix2D<double>> &storage_to_rof_table_, int use_imported_tables);
+    void setStorage_to_rof_table_(vector<Matrix2D<double>> &storage_to_rof_table_,
+                                  const vector<ROFTable> &imported_rof_table_,
+                                  int use_imported_tables);
 
     virtual void setRealization(unsigned long realization_id, const vector<double> &utilities_rdm,
                                 const vector<double> &water_sources_rdm, const vector<double> &policy_rdm)= 0;
 
+    virtual void addShortTermROFTriggers(
+            vector<vector<double>> &utilities_rof_triggers) const;
+
 };
 
 
@@ -0,0 +1,92 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "InsurancePricing.h"
+#include "../Utils/Constants.h"
+
+using namespace Constants;
+
+/**
+ * @param max_trajectory_age number of years for which the storage
+ * trajectory of a ROF year is reused, of at least 1.
+ * @param validate whether to also price insurance by simulating all years
+ * and use those prices instead.
+ */
+InsurancePricing::InsurancePricing(int max_trajectory_age, bool validate)
+        : max_trajectory_age(max_trajectory_age), validate(validate) {
+    if (max_trajectory_age < 1) {
+        char error[128];
+        sprintf(error, "Insurance trajectories must be reused for at least "
+                       "one year, but %d was given.", max_trajectory_age);
+        throw invalid_argument(error);
+    }
+}
+
+/**
+ * Records an insurance pricing and the number of ROF years it simulated.
+ * @param n_years_simulated
+ */
+void InsurancePricing::recordPricing(int n_years_simulated) {
+    n_pricings++;
+    this->n_years_simulated += (unsigned long) n_years_simulated;
+}
+
+/**
+ * Records the difference between the prices calculated with reused
+ * trajectories and by simulating all years.
+ * @param reused_prices prices calculated with reused trajectories.
+ * @param simulated_prices prices calculated by simulating all years.
+ * @param utilities_ids utilities that purchase insurance.
+ */
+void InsurancePricing::recordPrices(const vector<double> &reused_prices,
+                                    const vector<double> &simulated_prices,
+                                    const vector<int> &utilities_ids) {
+    lock_guard<mutex> lock(validation_mutex);
+    for (int u : utilities_ids) {
+        double error = abs(reused_prices[u] - simulated_prices[u]);
+        n_prices_compared++;
+        sum_price_errors += error;
+        sum_prices += simulated_prices[u];
+        max_price_error = max(max_price_error, error);
+    }
+}
+
+void InsurancePricing::resetStatistics() {
+    n_pricings = 0;
+    n_years_simulated = 0;
+    lock_guard<mutex> lock(validation_mutex);
+    n_prices_compared = 0;
+    sum_price_errors = 0;
+    sum_prices = 0;
+    max_price_error = 0;
+}
+
+int InsurancePricing::getMaxTrajectoryAge() const {
+    return max_trajectory_age;
+}
+
+bool InsurancePricing::isValidating() const {
+    return validate;
+}
+
+void InsurancePricing::printStatistics() {
+    unsigned long n_years_total = n_pricings * NUMBER_REALIZATIONS_ROF;
+    printf("Insurance pricing: %lu of %lu ROF years simulated (%.1f%% "
+           "reused) over %lu pricings.\n",
+           (unsigned long) n_years_simulated, n_years_total,
+           n_years_total > 0 ?
+           100. * (1. - (double) n_years_simulated / n_years_total) : 0.,
+           (unsigned long) n_pricings);
+    if (validate) {
+        lock_guard<mutex> lock(validation_mutex);
+        printf("Insurance pricing: mean price error against all years of "
+               "%.4f%% of the mean price, maximum error of %g over %lu "
+               "prices.\n",
+               sum_prices > 0 ? 100. * sum_price_errors / sum_prices : 0.,
+               max_price_error, n_prices_compared);
+    }
+}
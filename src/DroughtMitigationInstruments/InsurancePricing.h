@@ -0,0 +1,78 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_INSURANCEPRICING_H
+#define TRIANGLEMODEL_INSURANCEPRICING_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Settings and statistics of insurance pricing with reused ROF-year
+ * trajectories. Pricing insurance simulates, once a year, the
+ * NUMBER_REALIZATIONS_ROF ROF years preceding the pricing week, and the ROF
+ * year k years back from one pricing is usually, one year later, the ROF year
+ * k + 1 years back, with the same inflows. The utilities' storage trajectory
+ * of each ROF year is therefore kept for up to max_trajectory_age years and,
+ * when inflows starting on the same week are needed again, shifted by the
+ * difference between the utilities' current storage and the storage the
+ * trajectory started from and bounded by the utilities' storage capacities.
+ * Payouts are then found by looking the shifted storages up in the
+ * storage-ROF tables, so that each pricing only simulates the years that are
+ * new or expired. Trajectories are discarded when new infrastructure comes
+ * online.
+ *
+ * The shift ignores how demands, restrictions and transfers changed since
+ * the trajectory was simulated. Years whose shift plus change in yearly
+ * demand exceeds INSURANCE_TRAJECTORY_MAX_SHIFT of a utility's storage
+ * capacity are therefore simulated again, but prices are approximate unless
+ * max_trajectory_age is one year, in which case every year is simulated and
+ * prices are the same as without reuse. In validation mode prices are also
+ * calculated by simulating all years, those are the prices used, and the
+ * difference between both is reported.
+ *
+ * The object can be shared by all threads.
+ */
+class InsurancePricing {
+private:
+    const int max_trajectory_age;
+    const bool validate;
+
+    atomic<unsigned long> n_pricings{0};
+    atomic<unsigned long> n_years_simulated{0};
+
+    mutex validation_mutex;
+    unsigned long n_prices_compared = 0;
+    double sum_price_errors = 0;
+    double sum_prices = 0;
+    double max_price_error = 0;
+
+public:
+    InsurancePricing(int max_trajectory_age, bool validate);
+
+    InsurancePricing(const InsurancePricing &insurance_pricing) = delete;
+
+    InsurancePricing &operator=(const InsurancePricing &insurance_pricing) =
+            delete;
+
+    void recordPricing(int n_years_simulated);
+
+    void recordPrices(const vector<double> &reused_prices,
+                      const vector<double> &simulated_prices,
+                      const vector<int> &utilities_ids);
+
+    void resetStatistics();
+
+    int getMaxTrajectoryAge() const;
+
+    bool isValidating() const;
+
+    void printStatistics();
+};
+
+
+#endif //TRIANGLEMODEL_INSURANCEPRICING_H
@@ -3,6 +3,7 @@
 //
 
 #include <iostream>
+#include <cmath>
 #include "InsuranceStorageToROF.h"
 #include "../Utils/Utils.h"
 
@@ -21,7 +22,8 @@ InsuranceStorageToROF::InsuranceStorageToROF(const int id, vector<WaterSource *>
           ContinuityModelROF(Utils::copyWaterSourceVector(water_sources), water_sources_graph,
                              water_sources_to_utilities, Utils::copyUtilityVector(utilities, true),
                              Utils::copyMinEnvFlowControlVector(min_env_flow_controls), utilities_rdm.at(0),
-                             water_sources_rdm.at(0), total_simulation_time, false, (unsigned int) NON_INITIALIZED),
+                             water_sources_rdm.at(0), total_simulation_time, false, (unsigned int) NON_INITIALIZED,
+                             false),
           rof_triggers(rof_triggers),
           total_simulation_time(total_simulation_time),
           insurance_premium(insurance_premium),
@@ -29,6 +31,7 @@ InsuranceStorageToROF::InsuranceStorageToROF(const int id, vector<WaterSource *>
           fixed_payouts(fixed_payouts),
           utilities_revenue_update(vector<double>((unsigned long) n_utilities, 0.)),
           utilities_revenue_last_year(vector<double>((unsigned long) n_utilities, 0.)),
+          utilities_rofs(vector<double>((unsigned long) n_utilities, 0.)),
           drought_mitigation_policies(Utils::copyDroughtMitigationPolicyVector(drought_mitigation_policies))
 {
 
@@ -63,7 +66,7 @@ InsuranceStorageToROF::InsuranceStorageToROF(
                            insurance.utilities_rdm,
                            insurance.water_sources_rdm,
                            insurance.total_simulation_time,
-                           false, insurance.realization_id),
+                           false, insurance.realization_id, false),
         rof_triggers(insurance.rof_triggers),
         total_simulation_time(insurance.total_simulation_time),
         insurance_premium(insurance.insurance_premium),
@@ -72,7 +75,9 @@ InsuranceStorageToROF::InsuranceStorageToROF(
         fixed_payouts(insurance.fixed_payouts),
         utilities_revenue_update(vector<double>((unsigned long) n_utilities, 0.)),
         utilities_revenue_last_year(vector<double>((unsigned long) n_utilities, 0.)),
-        drought_mitigation_policies(Utils::copyDroughtMitigationPolicyVector(insurance.drought_mitigation_policies)) {
+        utilities_rofs(vector<double>((unsigned long) n_utilities, 0.)),
+        drought_mitigation_policies(Utils::copyDroughtMitigationPolicyVector(insurance.drought_mitigation_policies)),
+        insurance_pricing(insurance.insurance_pricing) {
     utilities_ids = insurance.utilities_ids;
 }
 
@@ -139,7 +144,8 @@ void InsuranceStorageToROF::addSystemComponents(vector<Utility *> utilities,
 /**
  * Runs a ROF set of 50 year long simulations in order to estimate how likely payouts are expected
  * to occur. The price of the insurance is set as the average sum of payouts across all 50 years
- * times the insurance premium.
+ * times the insurance premium. If insurance_pricing is set, the storage trajectories of years
+ * simulated by previous pricings are reused instead of simulated again (see InsurancePricing).
  * @param week
  */
 void InsuranceStorageToROF::priceInsurance(int week) {
@@ -151,36 +157,25 @@ void InsuranceStorageToROF::priceInsurance(int week) {
     // infrastructure online.
     updateOnlineInfrastructure(week);
 
-    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
-        // reset reservoirs' and utilities' storage and combined storage, respectively, they currently
-        // have in the corresponding realization simulation.
-        resetUtilitiesAndReservoirs(SHORT_TERM_ROF);// CHECK IF NEED TO OVERWRITE THIS FUNCTION AND RESET RESTRICTION AND TRANSFER VOLUMES
-
-        for (int w = week - (int) WEEKS_IN_YEAR + 1; w <= week; ++w) {
-            // one week continuity time-step.
-            continuityStep(w, r);
-
-            // Get utilities' approximate rof from storage-rof-table.
-            auto utilities_rofs = InsuranceStorageToROF::calculateShortTermROFTable(
-                        w, continuity_utilities, n_utilities);
-
-            for (int u = 0; u < continuity_utilities.size(); ++u) {
-                continuity_utilities[u]->setRisk_of_failure(utilities_rofs[u]);
-            }
-
-            // apply supply drought mitigation instruments.
-            for (DroughtMitigationPolicy* dmp : drought_mitigation_policies) {
-                dmp->applyPolicy(week);
-            }
-
-            // Increase the price of the insurance if payout is triggered and reset dmp utility-variables.
-            for (const int &u : utilities_ids) {
-                if (utilities_rofs[u] > rof_triggers[u]) {
-                    insurance_price[u] += fixed_payouts[u] *
-                            utilities_revenue_last_year[u] * insurance_premium;
-                }
-                continuity_utilities[u]->resetDroughtMitigationVariables();
+    if (insurance_pricing == nullptr) {
+        for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r)
+            simulatePricingYear(week, r, nullptr);
+    } else {
+        insurance_pricing->recordPricing(addReusedTrajectoriesPrices(week));
+
+        // Price insurance again simulating all years and use that price instead.
+        if (insurance_pricing->isValidating()) {
+            vector<double> reused_prices = insurance_price;
+            for (int u : utilities_ids) insurance_price[u] = 0;
+            for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r)
+                simulatePricingYear(week, r, nullptr);
+
+            vector<double> simulated_prices = insurance_price;
+            for (int u : utilities_ids) {
+                reused_prices[u] /= NUMBER_REALIZATIONS_ROF;
+                simulated_prices[u] /= NUMBER_REALIZATIONS_ROF;
             }
+            insurance_pricing->recordPrices(reused_prices, simulated_prices, utilities_ids);
         }
     }
 
@@ -198,9 +193,139 @@ void InsuranceStorageToROF::priceInsurance(int week) {
     }
 }
 
+/**
+ * Simulates the year of ROF realization r that ends in the pricing week and adds the payouts
+ * triggered in it to the insurance prices.
+ * @param week pricing week.
+ * @param r ROF realization.
+ * @param storages if not null, where to record the storage of each utility after each week,
+ * by week and then utility.
+ */
+void InsuranceStorageToROF::simulatePricingYear(int week, int r, double *storages) {
+    // reset reservoirs' and utilities' storage and combined storage, respectively, they currently
+    // have in the corresponding realization simulation.
+    resetUtilitiesAndReservoirs(SHORT_TERM_ROF);// CHECK IF NEED TO OVERWRITE THIS FUNCTION AND RESET RESTRICTION AND TRANSFER VOLUMES
+
+    for (int w = week - (int) WEEKS_IN_YEAR + 1; w <= week; ++w) {
+        // one week continuity time-step.
+        continuityStep(w, r);
+
+        if (storages != nullptr) {
+            for (int u = 0; u < n_utilities; ++u)
+                storages[u] = continuity_utilities[u]->getTotal_stored_volume();
+            storages += n_utilities;
+        }
+
+        // Get utilities' approximate rof from storage-rof-table.
+        lookUpTableROFs(w, continuity_utilities, getRealizationROFTables(),
+                        utilities_rofs.data());
+
+        for (int u = 0; u < continuity_utilities.size(); ++u) {
+            continuity_utilities[u]->setRisk_of_failure(utilities_rofs[u]);
+        }
+
+        // apply supply drought mitigation instruments.
+        for (DroughtMitigationPolicy* dmp : drought_mitigation_policies) {
+            dmp->applyPolicy(week);
+        }
+
+        // Increase the price of the insurance if payout is triggered and reset dmp utility-variables.
+        for (const int &u : utilities_ids) {
+            if (utilities_rofs[u] > rof_triggers[u]) {
+                insurance_price[u] += fixed_payouts[u] *
+                        utilities_revenue_last_year[u] * insurance_premium;
+            }
+            continuity_utilities[u]->resetDroughtMitigationVariables();
+        }
+    }
+}
+
+/**
+ * Adds to the insurance prices the payouts of all ROF years, simulating the years whose
+ * hydrology has no trajectory younger than the maximum age and shifting the trajectories of
+ * the others to the utilities' current storages. A trajectory's storages may be off by as
+ * much as the shift plus the change in the utility's demand over the year, which the shift
+ * ignores, so years for which this exceeds INSURANCE_TRAJECTORY_MAX_SHIFT of any utility's
+ * storage capacity are simulated again as well.
+ * @param week pricing week.
+ * @return number of years simulated.
+ */
+int InsuranceStorageToROF::addReusedTrajectoriesPrices(int week) {
+    const int n_weeks = (int) WEEKS_IN_YEAR;
+    const int max_age_weeks = (int) std::round(
+            insurance_pricing->getMaxTrajectoryAge() * WEEKS_IN_YEAR);
+    const vector<ROFTable> &tables = getRealizationROFTables();
+
+    // Drop trajectories of inflows earlier than those of any ROF year.
+    while (!pricing_trajectories.empty() &&
+           pricing_trajectories.begin()->first <
+           week - delta_realization_weeks[NUMBER_REALIZATIONS_ROF])
+        pricing_trajectories.erase(pricing_trajectories.begin());
+
+    resetUtilitiesAndReservoirs(SHORT_TERM_ROF);
+    vector<double> current_storages((unsigned long) n_utilities);
+    vector<double> capacities((unsigned long) n_utilities);
+    vector<double> year_demands((unsigned long) n_utilities, 0.);
+    for (int u = 0; u < n_utilities; ++u) {
+        current_storages[u] = continuity_utilities[u]->getTotal_stored_volume();
+        capacities[u] = continuity_utilities[u]->getTotal_storage_capacity();
+        for (int w = week - n_weeks + 1; w <= week; ++w)
+            year_demands[u] += continuity_utilities[u]->getUnrestrictedDemand(w);
+    }
+
+    int n_years_simulated = 0;
+    for (int r = 0; r < NUMBER_REALIZATIONS_ROF; ++r) {
+        int inflows_week = week - delta_realization_weeks[r + 1];
+        auto it = pricing_trajectories.find(inflows_week);
+        bool simulate = it == pricing_trajectories.end() ||
+                        week - it->second.pricing_week >= max_age_weeks;
+        for (int u = 0; u < n_utilities && !simulate; ++u)
+            simulate = std::abs(current_storages[u] - it->second.initial_storages[u]) +
+                       std::abs(year_demands[u] - it->second.year_demands[u]) >
+                       INSURANCE_TRAJECTORY_MAX_SHIFT * capacities[u];
+        if (simulate) {
+            PricingTrajectory &trajectory = pricing_trajectories[inflows_week];
+            trajectory.pricing_week = week;
+            trajectory.initial_storages = current_storages;
+            trajectory.year_demands = year_demands;
+            trajectory.storages.resize((unsigned long) (n_weeks * n_utilities));
+            simulatePricingYear(week, r, trajectory.storages.data());
+            n_years_simulated++;
+            continue;
+        }
+
+        const PricingTrajectory &trajectory = it->second;
+        for (int k = 0; k < n_weeks; ++k) {
+            int w = week - n_weeks + 1 + k;
+            for (const int &u : utilities_ids) {
+                double storage = trajectory.storages[k * n_utilities + u] +
+                                 current_storages[u] - trajectory.initial_storages[u];
+                storage = min(max(storage, 0.), capacities[u]);
+                if (lookUpTableROF(w, u, capacities[u], storage, tables[u]) > rof_triggers[u]) {
+                    insurance_price[u] += fixed_payouts[u] *
+                            utilities_revenue_last_year[u] * insurance_premium;
+                }
+            }
+        }
+    }
+
+    return n_years_simulated;
+}
+
+/**
+ * Sets the reuse of ROF-year trajectories across pricings.
+ * @param insurance_pricing settings and statistics shared by all realizations, or null to
+ * simulate all years in every pricing.
+ */
+void InsuranceStorageToROF::setInsurancePricing(InsurancePricing *insurance_pricing) {
+    InsuranceStorageToROF::insurance_pricing = insurance_pricing;
+    pricing_trajectories.clear();
+}
+
 void InsuranceStorageToROF::setRealization(unsigned long realization_id, const vector<double> &utilities_rdm,
                                            const vector<double> &water_sources_rdm, const vector<double> &policy_rdm) {
     ContinuityModel::setRealization(realization_id, utilities_rdm, water_sources_rdm);
+    pricing_trajectories.clear();
 
     // Pass corresponding utilities to drought mitigation instruments.
     for (DroughtMitigationPolicy *dmp : this->drought_mitigation_policies) {
@@ -210,49 +335,18 @@ void InsuranceStorageToROF::setRealization(unsigned long realization_id, const v
     }
 }
 
-/**
- * Runs one the full rof calculations for realization #realization_id for a
- * given week.
- * @param week for which rof is to be calculated.
- * @todo This is mostly a copy and paste from ContinuityModelROF.cpp, so
- * although I'm now on a fix this should be done in a better way at some point.
- */
-vector<double> InsuranceStorageToROF::calculateShortTermROFTable(int week,
-                                                              const vector<Utility *> &utilities,
-                                                              const int &n_utilities) {
-    // vector where risks of failure will be stored.
-    vector<double> risk_of_failure((unsigned long) n_utilities, 0.0);
-    double m;
-    for (int u = 0; u < n_utilities; ++u) {
-        // Get current stored volume for utility u.
-        double utility_storage =
-                utilities[u]->getTotal_stored_volume();
-        // Ratio of current and status-quo utility storage capacities
-        //        double m = current_and_base_storage_capacity_ratio[u];
-        m = utilities[u]->getTotal_storage_capacity() /
-            utility_base_storage_capacity[u];
-        // Calculate base table tier that contains the desired ROF by
-        // shifting the table around based on new infrastructure -- the
-        // shift is made by the part (m - 1) * STORAGE_CAPACITY_RATIO_FAIL *
-        // utility_base_storage_capacity[u] - current_storage_table_shift[u]
-        double storage_convert = utility_storage +
-                                 STORAGE_CAPACITY_RATIO_FAIL * utility_base_storage_capacity[u] *
-                                 (1. - m) + current_storage_table_shift[u];
-        int tier = (int) (storage_convert * NO_OF_INSURANCE_STORAGE_TIERS /
-                          utility_base_storage_capacity[u]);
-        // Mean ROF between the two tiers of the ROF table where
-        // current storage is located.
-//        risk_of_failure[u] = getRofFromRealizationTable(u, week, tier);
-        risk_of_failure[u] = (getRofFromRealizationTable(u, week, tier) +
-                getRofFromRealizationTable(u, week, min(NO_OF_INSURANCE_STORAGE_TIERS, tier + 1))) / 2;
-    }
-
-    return risk_of_failure;
-}
-
 void InsuranceStorageToROF::updateOnlineInfrastructure(int week) {
     ContinuityModelROF::updateOnlineInfrastructure(week);
 
+    // Trajectories simulated with other infrastructure cannot be reused.
+    int n_online = 0;
+    for (WaterSource *ws : continuity_water_sources)
+        n_online += ws->isOnline();
+    if (n_online != n_online_sources) {
+        n_online_sources = n_online;
+        pricing_trajectories.clear();
+    }
+
     // Use capacity multiplier if using pre-computed tables (which are created with such multiplier)
     if (week < WEEKS_IN_YEAR + 1 && use_imported_tables) {
         for (double &u : utility_base_storage_capacity) {
@@ -265,3 +359,9 @@ void InsuranceStorageToROF::updateOnlineInfrastructure(int week) {
     }
 }
 
+void InsuranceStorageToROF::addShortTermROFTriggers(
+        vector<vector<double>> &utilities_rof_triggers) const {
+    for (int u : utilities_ids)
+        utilities_rof_triggers.at((unsigned long) u).push_back(
+                rof_triggers[u]);
+}
@@ -6,7 +6,9 @@
 #define TRIANGLEMODEL_INSURANCESTORAGETOROF_H
 
 
+#include <map>
 #include "Base/DroughtMitigationPolicy.h"
+#include "InsurancePricing.h"
 #include "../ContinuityModels/ContinuityModelROF.h"
 #include "../ContinuityModels/ContinuityModelRealization.h"
 
@@ -21,8 +23,28 @@ private:
     const vector<double> &fixed_payouts;
     vector<double> utilities_revenue_update;
     vector<double> utilities_revenue_last_year;
+    vector<double> utilities_rofs;
     vector<DroughtMitigationPolicy *> drought_mitigation_policies;
 
+    /// Storage of each utility after each week of a simulated ROF year,
+    /// kept to be reused by later pricings (see InsurancePricing).
+    struct PricingTrajectory {
+        int pricing_week;
+        vector<double> initial_storages;
+        /// Unrestricted demand of each utility over the year simulated.
+        vector<double> year_demands;
+        vector<double> storages;
+    };
+
+    InsurancePricing *insurance_pricing = nullptr;
+    /// Trajectories by the week their ROF year's inflows start.
+    map<int, PricingTrajectory> pricing_trajectories;
+    int n_online_sources = 0;
+
+    void simulatePricingYear(int week, int r, double *storages);
+
+    int addReusedTrajectoriesPrices(int week);
+
 public:
 
     InsuranceStorageToROF(const int id, vector<WaterSource *> &water_sources,
@@ -52,9 +74,13 @@ public:
     void setRealization(unsigned long realization_id, const vector<double> &utilities_rdm,
                         const vector<double> &water_sources_rdm, const vector<double> &policy_rdm) override;
 
-    vector<double> calculateShortTermROFTable(int week, const vector<Utility *> &utilities, const int &n_utilities);
 
     void updateOnlineInfrastructure(int week) override;
+
+    void setInsurancePricing(InsurancePricing *insurance_pricing);
+
+    void addShortTermROFTriggers(
+            vector<vector<double>> &utilities_rof_triggers) const override;
 };
 
 
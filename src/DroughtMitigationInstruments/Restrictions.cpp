@@ -159,3 +159,9 @@ const vector<double> &Restrictions::getStageMultipliers() const {
 const vector<double> &Restrictions::getStageTriggers() const {
     return stage_triggers;
 }
+
+void Restrictions::addShortTermROFTriggers(
+        vector<vector<double>> &utilities_rof_triggers) const {
+    for (double t : stage_triggers)
+        utilities_rof_triggers.at((unsigned long) id).push_back(t);
+}
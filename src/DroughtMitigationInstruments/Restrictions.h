@@ -55,6 +55,9 @@ public:
     const vector<double> &getStageMultipliers() const;
 
     const vector<double> &getStageTriggers() const;
+
+    void addShortTermROFTriggers(
+            vector<vector<double>> &utilities_rof_triggers) const override;
 };
 
 
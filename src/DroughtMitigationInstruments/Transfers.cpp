@@ -404,6 +404,22 @@ const vector<double> &Transfers::getBuyersTransferTriggers() const {
     return buyers_transfer_triggers;
 }
 
+/**
+ * Adds the transfer triggers of the buyers and a trigger at zero for the
+ * source utility, which only sells water when its ROF is zero. The latter
+ * is settled as soon as the source fails in any year, and otherwise only
+ * once all years are run.
+ * @param utilities_rof_triggers
+ */
+void Transfers::addShortTermROFTriggers(
+        vector<vector<double>> &utilities_rof_triggers) const {
+    for (int b : buyers_ids)
+        utilities_rof_triggers.at((unsigned long) b).push_back(
+                buyers_transfer_triggers.at(
+                        (unsigned long) util_id_to_vertex_id[b]));
+    utilities_rof_triggers.at((unsigned long) source_utility_id).push_back(0.);
+}
+
 const Matrix<double> &Transfers::getAeq() const {
     return Aeq;
 }
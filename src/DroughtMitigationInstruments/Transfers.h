@@ -64,6 +64,9 @@ public:
 
     const vector<double> &getBuyersTransferTriggers() const;
 
+    void addShortTermROFTriggers(
+            vector<vector<double>> &utilities_rof_triggers) const override;
+
     const Matrix<double> &getAeq() const;
 
     const Vector<double> &getUb() const;
@@ -8,6 +8,9 @@
 #include "MasterSystemInputFileParser.h"
 #include "WaterSourceParsers/ReuseParser.h"
 #include "../Utils/Utils.h"
+#include "../Utils/ROFTablesFile.h"
+#include "../Utils/TimeSeriesFile.h"
+#include "../Utils/SimulationOutputFile.h"
 #include "WaterSourceParsers/ReservoirParser.h"
 #include "WaterSourceParsers/AllocatedReservoirParser.h"
 #include "WaterSourceParsers/ReservoirExpansionParser.h"
@@ -293,6 +296,70 @@ bool MasterSystemInputFileParser::parseRunParams(int line_no,
                         throw invalid_argument(error);
                     }
                     rows_read.push_back(i);
+                } else if (line[0] == "rof_tables_type") {
+                    rof_tables_dtype = ROFTablesFile::dataTypeFromName(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "rof_tables_io_threads") {
+                    rof_tables_io_threads = stoi(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "rof_tables_queue_depth") {
+                    rof_tables_queue_depth = stoul(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "rof_tables_shard") {
+                    rof_tables_shard = stoi(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "rof_tables_n_shards") {
+                    rof_tables_n_shards = stoi(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "distributed_rof_tables") {
+                    distributed_rof_tables = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "long_term_rof_cache_size") {
+                    long_term_rof_cache_size = stoul(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "long_term_rof_cache_spill_file") {
+                    long_term_rof_cache_spill_file = line[1];
+                    rows_read.push_back(i);
+                } else if (line[0] == "adaptive_rof_batch_size") {
+                    adaptive_rof_batch_size = stoi(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "adaptive_rof_confidence") {
+                    adaptive_rof_confidence = stod(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "adaptive_rof_validation") {
+                    adaptive_rof_validation = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "storage_bound_rof") {
+                    storage_bound_rof = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "storage_bound_rof_validation") {
+                    storage_bound_rof_validation = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "insurance_trajectory_reuse_years") {
+                    insurance_trajectory_reuse_years = stoi(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "insurance_trajectory_reuse_validation") {
+                    insurance_trajectory_reuse_validation = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "scalar_rof_years") {
+                    scalar_rof_years = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "objectives_only_collection") {
+                    objectives_only_collection = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "single_precision_time_series") {
+                    single_precision_time_series = true;
+                    rows_read.push_back(i);
+                } else if (line[0] == "time_series_format") {
+                    time_series_format =
+                            SimulationOutputFile::formatFromName(line[1]);
+                    rows_read.push_back(i);
+                } else if (line[0] == "output_spec") {
+                    string specification;
+                    for (unsigned long t = 1; t < line.size(); ++t)
+                        specification += (t > 1 ? " " : "") + line[t];
+                    output_specification = OutputSpecification(specification);
+                    rows_read.push_back(i);
                 } else if (line[0] == "print_time_series") {
                     print_time_series = true;
                     rows_read.push_back(i);
@@ -415,12 +482,12 @@ bool MasterSystemInputFileParser::parsePreloadedData(int line_no,
                         alias.erase(0, 1);
                         pre_loaded_data.insert(
                                 {alias,
-                                 Utils::parse2DCsvFile(line.at(1))});
+                                 TimeSeriesFile::load(line.at(1))});
                     } else {
                         pre_loaded_data.insert(
                                 {alias,
-                                 Utils::parse2DCsvFile(line.at(1),
-                                                       n_realizations)});
+                                 TimeSeriesFile::load(line.at(1),
+                                                      n_realizations)});
                     }
                 } catch (out_of_range &e) {
                     e.what();
@@ -852,6 +919,88 @@ int MasterSystemInputFileParser::getUseRofTables() const {
     return use_rof_tables;
 }
 
+int MasterSystemInputFileParser::getRofTablesDataType() const {
+    return rof_tables_dtype;
+}
+
+int MasterSystemInputFileParser::getRofTablesIOThreads() const {
+    return rof_tables_io_threads;
+}
+
+unsigned long MasterSystemInputFileParser::getRofTablesQueueDepth() const {
+    return rof_tables_queue_depth;
+}
+
+int MasterSystemInputFileParser::getRofTablesShard() const {
+    return rof_tables_shard;
+}
+
+int MasterSystemInputFileParser::getRofTablesNShards() const {
+    return rof_tables_n_shards;
+}
+
+bool MasterSystemInputFileParser::isDistributedRofTables() const {
+    return distributed_rof_tables;
+}
+
+unsigned long MasterSystemInputFileParser::getLongTermROFCacheSize() const {
+    return long_term_rof_cache_size;
+}
+
+const string &
+MasterSystemInputFileParser::getLongTermROFCacheSpillFile() const {
+    return long_term_rof_cache_spill_file;
+}
+
+int MasterSystemInputFileParser::getAdaptiveROFBatchSize() const {
+    return adaptive_rof_batch_size;
+}
+
+double MasterSystemInputFileParser::getAdaptiveROFConfidence() const {
+    return adaptive_rof_confidence;
+}
+
+bool MasterSystemInputFileParser::isAdaptiveROFValidation() const {
+    return adaptive_rof_validation;
+}
+
+bool MasterSystemInputFileParser::isStorageBoundROF() const {
+    return storage_bound_rof;
+}
+
+bool MasterSystemInputFileParser::isStorageBoundROFValidation() const {
+    return storage_bound_rof_validation;
+}
+
+int MasterSystemInputFileParser::getInsuranceTrajectoryReuseYears() const {
+    return insurance_trajectory_reuse_years;
+}
+
+bool MasterSystemInputFileParser::isInsuranceTrajectoryReuseValidation() const {
+    return insurance_trajectory_reuse_validation;
+}
+
+bool MasterSystemInputFileParser::isScalarROFYears() const {
+    return scalar_rof_years;
+}
+
+bool MasterSystemInputFileParser::isObjectivesOnlyCollection() const {
+    return objectives_only_collection;
+}
+
+bool MasterSystemInputFileParser::isSinglePrecisionTimeSeries() const {
+    return single_precision_time_series;
+}
+
+int MasterSystemInputFileParser::getTimeSeriesFormat() const {
+    return time_series_format;
+}
+
+const OutputSpecification &
+MasterSystemInputFileParser::getOutputSpecification() const {
+    return output_specification;
+}
+
 bool MasterSystemInputFileParser::isPrintTimeSeries() const {
     return print_time_series;
 }
@@ -883,6 +1032,14 @@ int MasterSystemInputFileParser::getNRealizations() const {
     return n_realizations;
 }
 
+/**
+ * Number of utilities in the input file, known once it has been preloaded.
+ * @return
+ */
+int MasterSystemInputFileParser::getNUtilities() const {
+    return (int) count(tags.begin(), tags.end(), "[UTILITY]");
+}
+
 int MasterSystemInputFileParser::getNBootstrapSamples() const {
     return n_bootstrap_samples;
 }
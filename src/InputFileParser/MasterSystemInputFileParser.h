@@ -19,6 +19,7 @@
 #include "DroughtMitigationPolicyParsers/RestrictionsParser.h"
 #include "DroughtMitigationPolicyParsers/TransfersParser.h"
 #include "Base/ReservoirControlRuleParser.h"
+#include "../DataCollector/Base/OutputSpecification.h"
 
 using namespace std;
 
@@ -62,6 +63,26 @@ class MasterSystemInputFileParser {
     string solutions_file;
     string output_dir;
     int use_rof_tables = DO_NOT_EXPORT_OR_IMPORT_ROF_TABLES; /// can be "no," "export," and "import."
+    int rof_tables_dtype = ROF_TABLE_FLOAT64; /// can be "float64," "uint8," "float16," and "breakpoints."
+    int rof_tables_io_threads = 1;
+    unsigned long rof_tables_queue_depth = 4;
+    int rof_tables_shard = 0;
+    int rof_tables_n_shards = 1;
+    bool distributed_rof_tables = false;
+    unsigned long long_term_rof_cache_size = 0; /// 0 for no long-term ROF cache.
+    string long_term_rof_cache_spill_file;
+    int adaptive_rof_batch_size = 0; /// 0 for always running all ROF years.
+    double adaptive_rof_confidence = 0.99;
+    bool adaptive_rof_validation = false;
+    bool storage_bound_rof = false;
+    bool storage_bound_rof_validation = false;
+    int insurance_trajectory_reuse_years = 0; /// 0 for simulating all ROF years in every insurance pricing.
+    bool insurance_trajectory_reuse_validation = false;
+    bool scalar_rof_years = false;
+    bool objectives_only_collection = false;
+    bool single_precision_time_series = false;
+    int time_series_format = TIME_SERIES_CSV; /// can be "csv," "csv_round_trip," "binary," and "binary_compressed."
+    OutputSpecification output_specification; /// all time series if not set.
     bool print_time_series = false;
     vector<unsigned long> realizations_to_run;
     vector<unsigned long> solutions_to_run;
@@ -192,6 +213,46 @@ public:
 
     int getUseRofTables() const;
 
+    int getRofTablesDataType() const;
+
+    int getRofTablesIOThreads() const;
+
+    unsigned long getRofTablesQueueDepth() const;
+
+    int getRofTablesShard() const;
+
+    int getRofTablesNShards() const;
+
+    bool isDistributedRofTables() const;
+
+    unsigned long getLongTermROFCacheSize() const;
+
+    const string &getLongTermROFCacheSpillFile() const;
+
+    int getAdaptiveROFBatchSize() const;
+
+    double getAdaptiveROFConfidence() const;
+
+    bool isAdaptiveROFValidation() const;
+
+    bool isStorageBoundROF() const;
+
+    bool isStorageBoundROFValidation() const;
+
+    int getInsuranceTrajectoryReuseYears() const;
+
+    bool isInsuranceTrajectoryReuseValidation() const;
+
+    bool isScalarROFYears() const;
+
+    bool isObjectivesOnlyCollection() const;
+
+    bool isSinglePrecisionTimeSeries() const;
+
+    int getTimeSeriesFormat() const;
+
+    const OutputSpecification &getOutputSpecification() const;
+
     int getNThreads() const;
 
     int getRdmNo() const;
@@ -210,6 +271,8 @@ public:
 
     int getNRealizations() const;
 
+    int getNUtilities() const;
+
     int getNBootstrapSamples() const;
 
     int getBootstrapSampleSize() const;
@@ -7,6 +7,7 @@
 #include "HardCodedProblem.h"
 
 HardCodedProblem::HardCodedProblem(unsigned long n_weeks, int n_realizations,
+                                   int n_utilities,
                                    int import_export_rof_table,
                                    string system_io, string &rof_tables_directory, int seed,
                                    unsigned long n_threads,
@@ -26,6 +27,7 @@ HardCodedProblem::HardCodedProblem(unsigned long n_weeks, int n_realizations,
     setN_threads(n_threads);
     setIODirectory(system_io);
     setN_weeks(n_weeks);
+    this->n_utilities = n_utilities;
 
     // Load bootstrap samples if necessary.
     if (strlen(bootstrap_file.c_str()) > 2) {
@@ -10,7 +10,8 @@
 class HardCodedProblem : public Problem {
 public:
     HardCodedProblem(unsigned long n_weeks, int n_realizations,
-                     int import_export_rof_table, string system_io,
+                     int n_utilities, int import_export_rof_table,
+                     string system_io,
                      string &rof_tables_directory, int seed,
                      unsigned long n_threads, string bootstrap_file,
                      string &utilities_rdm_file, string &policies_rdm_file,
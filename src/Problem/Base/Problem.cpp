@@ -10,6 +10,10 @@
 #include "../../Utils/Utils.h"
 #include <omp.h>
 
+#ifdef  PARALLEL
+#include <mpi.h>
+#endif
+
 Problem::Problem() {
     Reservoir::unsetSeed();
 }
@@ -58,11 +62,26 @@ void Problem::printTimeSeriesAndPathways(bool plot_time_series) {
         //FIXME:PRINT_POLICIES_OUTPUT_TABULAR BLOWING UP MEMORY.
         cout << "Printing Pathways" << endl;
         this->master_data_collector->setOutputDirectory(io_directory);
+        this->master_data_collector->setRoundTripText(
+                time_series_format == TIME_SERIES_CSV_ROUND_TRIP);
         this->master_data_collector->printPathways(
                 fpw + "_s" + std::to_string(solution_no) + fname_sufix);
 
-        // Only print time series if requested.
-        if (plot_time_series) {
+        // Only print time series if requested and collected.
+        if (plot_time_series &&
+            this->master_data_collector->isObjectivesOnly()) {
+            printf("Time series were not collected because only objectives "
+                   "were, so they will not be printed.\n");
+        } else if (plot_time_series &&
+                   (time_series_format == TIME_SERIES_BINARY ||
+                    time_series_format == TIME_SERIES_BINARY_COMPRESSED)) {
+            cout << "Printing time series" << endl;
+            this->master_data_collector->printTimeSeriesBinary(
+                    0, (int) n_weeks, "TimeSeries_s" +
+                                      std::to_string(solution_no) +
+                                      fname_sufix,
+                    time_series_format == TIME_SERIES_BINARY_COMPRESSED);
+        } else if (plot_time_series) {
             cout << "Printing time series" << endl;
             this->master_data_collector->printUtilitiesOutputCompact(
                     0, (int) n_weeks, fu + "_s" + std::to_string(solution_no) +
@@ -98,6 +117,43 @@ Problem::setRofTables(unsigned long n_realizations, string rof_tables_directory)
 
     double start_time = omp_get_wtime();
     printf("Reading ROF tables.\n");
+
+    // Map binary tables file if there is one, which avoids parsing one csv
+    // file per realization and utility.
+    string binary_file_name = rof_tables_directory + ROFTablesFile::FILE_NAME;
+    if (std::ifstream(binary_file_name)) {
+        rof_tables_file.open(binary_file_name);
+        auto &header = rof_tables_file.getHeader();
+        if (header.n_tiers != NO_OF_INSURANCE_STORAGE_TIERS) {
+            char error[256];
+            sprintf(error, "Number of tiers in tables (%lu) does not match "
+                           "number of tiers for this problem (%d).",
+                    header.n_tiers, NO_OF_INSURANCE_STORAGE_TIERS);
+            throw invalid_argument(error);
+        }
+        if (header.n_weeks < n_weeks) {
+            char error[512];
+            sprintf(error, "ROF tables in %s cover %lu weeks but %lu weeks "
+                           "are simulated.", binary_file_name.c_str(),
+                    (unsigned long) header.n_weeks, n_weeks);
+            throw invalid_argument(error);
+        }
+        if (header.n_utilities != (unsigned long) n_utilities) {
+            char error[512];
+            sprintf(error, "ROF tables in %s are for %lu utilities but this "
+                           "problem has %d.", binary_file_name.c_str(),
+                    (unsigned long) header.n_utilities, n_utilities);
+            throw invalid_argument(error);
+        }
+        rof_tables = rof_tables_file.getTables(n_realizations);
+
+        printf("Loading tables took %f time.\n", omp_get_wtime() - start_time);
+        return;
+    }
+
+    printf("No %s found in %s, reading csv tables instead. Converting "
+           "them with WaterPaths -F will make loading them faster.\n",
+           ROFTablesFile::FILE_NAME, rof_tables_directory.c_str());
     string file_name = rof_tables_directory + "tables_r0_u0.csv";
     auto data_r0_u0 = Utils::parse2DCsvFile(file_name);
     auto n_weeks_in_table = (int) data_r0_u0.size();
@@ -118,10 +174,11 @@ Problem::setRofTables(unsigned long n_realizations, string rof_tables_directory)
         ifile = std::ifstream(fname.c_str());
     }
 
-    rof_tables = vector<vector<Matrix2D<double>>>(
+    csv_rof_tables = vector<vector<Matrix2D<double>>>(
             n_realizations,
             vector<Matrix2D<double>>((unsigned long) n_utilities,
                                      Matrix2D<double>(n_weeks_in_table, n_tiers)));
+    rof_tables = vector<vector<ROFTable>>(n_realizations);
 
     for (unsigned long r = 0; r < n_realizations; ++r) {
 
@@ -130,8 +187,11 @@ Problem::setRofTables(unsigned long n_realizations, string rof_tables_directory)
             auto tables_utility_week = Utils::parse2DCsvFile(file_name);
 
             for (unsigned long w = 0; w < n_weeks; ++w) {
-                rof_tables[r][u].setPartialData(w, tables_utility_week[w].data(), tables_utility_week[w].size());
+                csv_rof_tables[r][u].setPartialData(w, tables_utility_week[w].data(), tables_utility_week[w].size());
             }
+            rof_tables[r].emplace_back(
+                    n_weeks_in_table, n_tiers, ROF_TABLE_FLOAT64,
+                    csv_rof_tables[r][u].getPointerToElement(0, 0));
         }
     }
 
@@ -139,6 +199,154 @@ Problem::setRofTables(unsigned long n_realizations, string rof_tables_directory)
 }
 
 
+void Problem::setRofTablesDataType(int rof_tables_dtype) {
+    Problem::rof_tables_dtype = rof_tables_dtype;
+}
+
+/**
+ * Sets how the ROF tables generated by simulations this problem runs are
+ * written in the background (see ROFTablesWriter).
+ * @param n_io_threads number of threads writing tables.
+ * @param max_queued_realizations number of finished realizations whose
+ * tables can wait to be written.
+ */
+void Problem::setRofTablesWriter(int n_io_threads,
+                                 unsigned long max_queued_realizations) {
+    rof_tables_io_threads = n_io_threads;
+    rof_tables_queue_depth = max_queued_realizations;
+}
+
+/**
+ * Makes this problem generate only one of several shards of the ROF tables,
+ * such as one per job of a job array, to be merged afterwards with
+ * ROFTablesFile::mergeShards.
+ * @param shard
+ * @param n_shards
+ */
+void Problem::setRofTablesShard(int shard, int n_shards) {
+    if (n_shards < 1 || shard < 0 || shard >= n_shards) {
+        char error[128];
+        sprintf(error, "Invalid ROF tables shard %d of %d.", shard, n_shards);
+        throw invalid_argument(error);
+    }
+    rof_tables_shard = shard;
+    n_rof_tables_shards = n_shards;
+    merge_rof_tables_shards = false;
+}
+
+/**
+ * Splits the generation of ROF tables across the ranks of an MPI run, each
+ * rank generating one shard, which rank 0 merges into a single tables file
+ * once all ranks are done. Initializes MPI if needed.
+ */
+void Problem::setDistributedRofTables() {
+#ifdef  PARALLEL
+    int mpi_initialized;
+    MPI_Initialized(&mpi_initialized);
+    if (!mpi_initialized)
+        MPI_Init(nullptr, nullptr);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rof_tables_shard);
+    MPI_Comm_size(MPI_COMM_WORLD, &n_rof_tables_shards);
+    merge_rof_tables_shards = true;
+#else
+    throw invalid_argument("This version of WaterPaths was not compiled with "
+                           "MPI, so ROF tables cannot be generated by MPI "
+                           "ranks.");
+#endif
+}
+
+/**
+ * Creates a long-term ROF cache shared by all simulations this problem runs,
+ * such as all function evaluations of an optimization.
+ * @param max_entries_in_memory number of long-term ROF calculations kept in
+ * memory.
+ * @param spill_file_name file to write calculations beyond
+ * max_entries_in_memory to, or empty for not keeping them.
+ */
+void Problem::setLongTermROFCache(unsigned long max_entries_in_memory,
+                                  const string &spill_file_name) {
+    long_term_rof_cache = unique_ptr<LongTermROFCache>(
+            new LongTermROFCache(max_entries_in_memory, spill_file_name));
+}
+
+/**
+ * Makes all simulations this problem runs sample short-term ROFs
+ * adaptively (see AdaptiveROFSampling).
+ * @param batch_size number of ROF years run between checks.
+ * @param confidence with which ROFs must be known relative to triggers.
+ * @param validate whether to also run all years and report how many
+ * decisions would have been different.
+ */
+void Problem::setAdaptiveROFSampling(int batch_size, double confidence,
+                                     bool validate) {
+    adaptive_rof_sampling = unique_ptr<AdaptiveROFSampling>(
+            new AdaptiveROFSampling(batch_size, confidence, validate));
+}
+
+/**
+ * Skips short-term ROF calculations whose ROFs can be proven to be zero from
+ * storages alone (see StorageBoundROF).
+ * @param validate whether to still run the ROF years and check them against
+ * the bound.
+ */
+void Problem::setStorageBoundROF(bool validate) {
+    storage_bound_rof = unique_ptr<StorageBoundROF>(
+            new StorageBoundROF(validate));
+}
+
+/**
+ * Prices insurance reusing the storage trajectories of ROF years simulated
+ * by previous pricings (see InsurancePricing).
+ * @param max_trajectory_age number of years for which trajectories are
+ * reused.
+ * @param validate whether to also price insurance simulating all years and
+ * use those prices.
+ */
+void Problem::setInsurancePricing(int max_trajectory_age, bool validate) {
+    insurance_pricing = unique_ptr<InsurancePricing>(
+            new InsurancePricing(max_trajectory_age, validate));
+}
+
+/**
+ * Runs ROF years one at a time instead of all at once, which gives the same
+ * results more slowly.
+ */
+void Problem::setScalarROFYears() {
+    scalar_rof_years = true;
+}
+
+/**
+ * Collects only the data needed to calculate objectives, as in
+ * optimizations, so that no time series can be printed.
+ */
+void Problem::setObjectivesOnlyCollection() {
+    objectives_only_collection = true;
+}
+
+/**
+ * Stores time series in single precision, halving the memory they take.
+ */
+void Problem::setSinglePrecisionTimeSeries() {
+    single_precision_time_series = true;
+}
+
+/**
+ * Sets the format of printed time series.
+ * @param time_series_format one of the TIME_SERIES_* formats.
+ */
+void Problem::setTimeSeriesFormat(int time_series_format) {
+    Problem::time_series_format = time_series_format;
+}
+
+/**
+ * Sets which time series are recorded by the simulations.
+ * @param output_specification
+ */
+void Problem::setOutputSpecification(
+        const OutputSpecification &output_specification) {
+    Problem::output_specification = output_specification;
+}
+
 void Problem::setImport_export_rof_tables(int import_export_rof_tables, string rof_tables_directory) {
     if (std::abs(import_export_rof_tables) > 1)
         throw invalid_argument("Import/export ROF tables can be assigned as:\n"
@@ -160,6 +368,8 @@ void Problem::runBootstrapRealizationThinning(int standard_solution, int n_sets,
                                               int threads,
                                               const vector<vector<unsigned long>> &bs_realizations) {
     master_data_collector->setOutputDirectory(io_directory);
+    master_data_collector->setRoundTripText(
+            time_series_format == TIME_SERIES_CSV_ROUND_TRIP);
     master_data_collector->performBootstrapAnalysis(standard_solution, n_sets,
                                                     n_bs_samples, threads,
                                                     bs_realizations);
@@ -5,10 +5,16 @@
 #ifndef TRIANGLEMODEL_PROBLEM_H
 #define TRIANGLEMODEL_PROBLEM_H
 
+#include <memory>
 #include <vector>
 #include "../../DataCollector/Base/DataCollector.h"
 #include "../../DataCollector/MasterDataCollector.h"
 #include "../../Utils/Utils.h"
+#include "../../Utils/ROFTablesFile.h"
+#include "../../ContinuityModels/LongTermROFCache.h"
+#include "../../ContinuityModels/AdaptiveROFSampling.h"
+#include "../../ContinuityModels/StorageBoundROF.h"
+#include "../../DroughtMitigationInstruments/InsurancePricing.h"
 #include "../../SystemComponents/WaterSources/Reservoir.h"
 #ifdef  PARALLEL
 #include "../../../Borg/borgms.h"
@@ -40,7 +46,25 @@ protected:
     vector<vector<double>> utilities_rdm;
     vector<vector<double>> water_sources_rdm;
     vector<vector<double>> policies_rdm;
-    vector<vector<Matrix2D<double>>> rof_tables;
+    vector<vector<ROFTable>> rof_tables;
+    vector<vector<Matrix2D<double>>> csv_rof_tables;
+    ROFTablesFile rof_tables_file;
+    int rof_tables_dtype = ROF_TABLE_FLOAT64;
+    int rof_tables_io_threads = 1;
+    unsigned long rof_tables_queue_depth = 4;
+    int rof_tables_shard = 0;
+    int n_rof_tables_shards = 1;
+    bool merge_rof_tables_shards = false;
+    bool scalar_rof_years = false;
+    bool objectives_only_collection = false;
+    bool single_precision_time_series = false;
+    int time_series_format = TIME_SERIES_CSV;
+    OutputSpecification output_specification;
+    /// Shared by all simulations run by this problem.
+    unique_ptr<LongTermROFCache> long_term_rof_cache;
+    unique_ptr<AdaptiveROFSampling> adaptive_rof_sampling;
+    unique_ptr<StorageBoundROF> storage_bound_rof;
+    unique_ptr<InsurancePricing> insurance_pricing;
     vector<vector<unsigned long>> bs_realizations;
     vector<int> solutions_to_run_range;
     string system_io, solutions_file, bootstrap_file;
@@ -98,6 +122,36 @@ public:
     void setImport_export_rof_tables(int import_export_rof_tables,
                                      string rof_tables_directory);
 
+    void setRofTablesDataType(int rof_tables_dtype);
+
+    void setRofTablesWriter(int n_io_threads,
+                            unsigned long max_queued_realizations);
+
+    void setRofTablesShard(int shard, int n_shards);
+
+    void setDistributedRofTables();
+
+    void setLongTermROFCache(unsigned long max_entries_in_memory,
+                             const string &spill_file_name);
+
+    void setAdaptiveROFSampling(int batch_size, double confidence,
+                                bool validate);
+
+    void setStorageBoundROF(bool validate);
+
+    void setInsurancePricing(int max_trajectory_age, bool validate);
+
+    void setScalarROFYears();
+
+    void setObjectivesOnlyCollection();
+
+    void setSinglePrecisionTimeSeries();
+
+    void setTimeSeriesFormat(int time_series_format);
+
+    void setOutputSpecification(
+            const OutputSpecification &output_specification);
+
     void runBootstrapRealizationThinning(int standard_solution, int n_sets,
                                          int n_bs_samples,
                                          int threads,
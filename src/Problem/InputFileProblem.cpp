@@ -45,8 +45,38 @@ void InputFileProblem::setRofTablesAndRunParams() {
     n_realizations = parser.getNRealizations();
     n_threads = parser.getNThreads();
     n_weeks = parser.getNWeeks();
+    n_utilities = parser.getNUtilities();
     solutions_file = parser.getSolutionsFile();
     solutions_to_run = parser.getSolutionsToRun();
+    rof_tables_dtype = parser.getRofTablesDataType();
+    setRofTablesWriter(parser.getRofTablesIOThreads(),
+                       parser.getRofTablesQueueDepth());
+    if (parser.isDistributedRofTables())
+        setDistributedRofTables();
+    else if (parser.getRofTablesNShards() > 1)
+        setRofTablesShard(parser.getRofTablesShard(),
+                          parser.getRofTablesNShards());
+    if (parser.getLongTermROFCacheSize() > 0 ||
+        !parser.getLongTermROFCacheSpillFile().empty())
+        setLongTermROFCache(parser.getLongTermROFCacheSize(),
+                            parser.getLongTermROFCacheSpillFile());
+    if (parser.getAdaptiveROFBatchSize() > 0)
+        setAdaptiveROFSampling(parser.getAdaptiveROFBatchSize(),
+                               parser.getAdaptiveROFConfidence(),
+                               parser.isAdaptiveROFValidation());
+    if (parser.isStorageBoundROF())
+        setStorageBoundROF(parser.isStorageBoundROFValidation());
+    if (parser.getInsuranceTrajectoryReuseYears() > 0)
+        setInsurancePricing(parser.getInsuranceTrajectoryReuseYears(),
+                            parser.isInsuranceTrajectoryReuseValidation());
+    if (parser.isScalarROFYears())
+        setScalarROFYears();
+    if (parser.isObjectivesOnlyCollection() || parser.isOptimize())
+        setObjectivesOnlyCollection();
+    if (parser.isSinglePrecisionTimeSeries())
+        setSinglePrecisionTimeSeries();
+    setTimeSeriesFormat(parser.getTimeSeriesFormat());
+    setOutputSpecification(parser.getOutputSpecification());
     setImport_export_rof_tables(parser.getUseRofTables(),
                                 parser.getRofTablesDir());
 }
@@ -74,6 +104,18 @@ int InputFileProblem::functionEvaluation(double *vars, double *objs,
                             parser.getNWeeks(),
                             parser.getRealizationsToRun(),
                             parser.getRofTablesDir());
+        s->setRofTablesDataType(rof_tables_dtype);
+        s->setRofTablesWriter(rof_tables_io_threads, rof_tables_queue_depth);
+        s->setRofTablesShard(rof_tables_shard, n_rof_tables_shards,
+                             merge_rof_tables_shards);
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     } else if (import_export_rof_tables == IMPORT_ROF_TABLES) {
         s = new Simulation(parser.getWaterSources(),
@@ -90,6 +132,14 @@ int InputFileProblem::functionEvaluation(double *vars, double *objs,
                             rof_tables,
                             parser.getTableStorageShift(),
                             rof_tables_directory);
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     } else {
         s = new Simulation(parser.getWaterSources(),
@@ -103,6 +153,14 @@ int InputFileProblem::functionEvaluation(double *vars, double *objs,
                             parser.getRdmDmp(),
                             parser.getNWeeks(),
                             parser.getRealizationsToRun());
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     }
 
@@ -16,6 +16,7 @@
 #include "../SystemComponents/Bonds/LevelDebtServiceBond.h"
 #include "../Simulation/Simulation.h"
 #include "../SystemComponents/WaterSources/WaterReuse.h"
+#include "../Utils/TimeSeriesFile.h"
 
 #ifdef PARALLEL
 #include <mpi.h>
@@ -78,7 +79,8 @@ PaperTestProblem::PaperTestProblem(unsigned long n_weeks, int n_realizations,
                                    string &solutions_file,
                                    vector<int> &solutions_to_run_range,
                                    bool plotting, bool print_obj_row)
-        : HardCodedProblem(n_weeks, n_realizations, import_export_rof_table,
+        : HardCodedProblem(n_weeks, n_realizations, N_UTILITIES,
+                           import_export_rof_table,
                            system_io, rof_tables_directory, seed, n_threads,
                            bootstrap_file, utilities_rdm_file,
                            policies_rdm_file,
@@ -761,6 +763,18 @@ int PaperTestProblem::functionEvaluation(double *vars, double *objs,
                            n_weeks,
                            realizations_to_run,
                            rof_tables_directory);
+        s->setRofTablesDataType(rof_tables_dtype);
+        s->setRofTablesWriter(rof_tables_io_threads, rof_tables_queue_depth);
+        s->setRofTablesShard(rof_tables_shard, n_rof_tables_shards,
+                             merge_rof_tables_shards);
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     } else if (import_export_rof_tables == IMPORT_ROF_TABLES) {
         s = new Simulation(water_sources,
@@ -777,6 +791,14 @@ int PaperTestProblem::functionEvaluation(double *vars, double *objs,
                            rof_tables,
                            table_storage_shift,
                            rof_tables_directory);
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     } else {
         s = new Simulation(water_sources,
@@ -790,6 +812,14 @@ int PaperTestProblem::functionEvaluation(double *vars, double *objs,
                            policies_rdm,
                            n_weeks,
                            realizations_to_run);
+        s->setLongTermROFCache(long_term_rof_cache.get());
+        s->setAdaptiveROFSampling(adaptive_rof_sampling.get());
+        s->setStorageBoundROF(storage_bound_rof.get());
+        s->setInsurancePricing(insurance_pricing.get());
+        s->setScalarROFYears(scalar_rof_years);
+        s->setObjectivesOnlyCollection(objectives_only_collection);
+        s->setSinglePrecisionTimeSeries(single_precision_time_series);
+        s->setOutputSpecification(output_specification);
         this->master_data_collector = s->runFullSimulation(n_threads, vars);
     }
     double end_time = omp_get_wtime();
@@ -848,103 +878,103 @@ void PaperTestProblem::readInputData() {
 //    {
 //// #pragma omp single
 //        {
-            streamflows_durham = Utils::parse2DCsvFile(
+            streamflows_durham = TimeSeriesFile::load(
                     io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                     "inflows" + evap_inflows_suffix + BAR +
                     "durham_inflows.csv", n_realizations);
 
 // #pragma omp single
-        streamflows_flat = Utils::parse2DCsvFile(
+        streamflows_flat = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "falls_lake_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_swift = Utils::parse2DCsvFile(
+        streamflows_swift = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "lake_wb_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_llr = Utils::parse2DCsvFile(
+        streamflows_llr = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "little_river_raleigh_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_phils = Utils::parse2DCsvFile(
+        streamflows_phils = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "stone_quarry_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_cane = Utils::parse2DCsvFile(
+        streamflows_cane = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "cane_creek_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_morgan = Utils::parse2DCsvFile(
+        streamflows_morgan = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "university_lake_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_crabtree = Utils::parse2DCsvFile(
+        streamflows_crabtree = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "crabtree_inflows.csv", n_realizations);
 //                BAR + "university_lake_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_haw = Utils::parse2DCsvFile(
+        streamflows_haw = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "jordan_lake_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_lillington = Utils::parse2DCsvFile(
+        streamflows_lillington = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "lillington_inflows.csv", n_realizations);
 // #pragma omp single
-        streamflows_clayton = Utils::parse2DCsvFile(
+        streamflows_clayton = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "inflows" +
                 evap_inflows_suffix +
                 BAR + "clayton_inflows.csv", n_realizations);
 
 // #pragma omp single
-        evap_durham = Utils::parse2DCsvFile(
+        evap_durham = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                 "evaporation" + evap_inflows_suffix +
                 BAR + "durham_evap.csv", n_realizations);
 // #pragma omp single
-        evap_falls_lake = Utils::parse2DCsvFile(
+        evap_falls_lake = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                 "evaporation" + evap_inflows_suffix +
                 BAR + "falls_lake_evap.csv", n_realizations);
 // #pragma omp single
-        evap_jordan_lake = Utils::parse2DCsvFile(
+        evap_jordan_lake = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                 "evaporation" + evap_inflows_suffix +
                 BAR + "jordan_lake_evap.csv", n_realizations);
 // #pragma omp single
-        evap_little_river = Utils::parse2DCsvFile(
+        evap_little_river = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                 "evaporation" + evap_inflows_suffix +
                 BAR + "little_river_raleigh_evap.csv", n_realizations);
 // #pragma omp single
         {
-            evap_wheeler_benson = Utils::parse2DCsvFile(
+            evap_wheeler_benson = TimeSeriesFile::load(
                     io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir +
                     "evaporation" + evap_inflows_suffix +
                     BAR + "wb_evap.csv", n_realizations);
         }
 
 // #pragma omp single
-        demand_watertown = Utils::parse2DCsvFile(
+        demand_watertown = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "demands" +
                 evap_inflows_suffix +
                 BAR + "cary_demand.csv", n_realizations);
 // #pragma omp single
-        demand_dryville = Utils::parse2DCsvFile(
+        demand_dryville = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "demands" +
                 evap_inflows_suffix +
                 BAR + "durham_demand.csv", n_realizations);
 // #pragma omp single
-        demand_fallsland = Utils::parse2DCsvFile(
+        demand_fallsland = TimeSeriesFile::load(
                 io_directory + DEFAULT_DATA_DIR + rdm_tseries_dir + "demands" +
                 evap_inflows_suffix +
                 BAR + "raleigh_demand.csv", n_realizations);
@@ -18,7 +18,7 @@ using namespace std;
 
 class PaperTestProblem : public HardCodedProblem {
 private:
-    const int n_utilities = 3;
+    static const int N_UTILITIES = 3;
 
     vector<vector<double>> streamflows_durham;
     vector<vector<double>> streamflows_clayton;
@@ -4,10 +4,15 @@
 
 #include "Simulation.h"
 #include "../Utils/Utils.h"
+#include "../Utils/AllocationCounter.h"
+#include "../Utils/ROFTablesFile.h"
+#include "../Utils/ROFTablesWriter.h"
+#include "../DroughtMitigationInstruments/InsuranceStorageToROF.h"
 #include <ctime>
 #include <algorithm>
 #include <numeric>
 #include <omp.h>
+#include <map>
 #include <set>
 
 #ifdef  PARALLEL
@@ -17,6 +22,8 @@
 #define PBSTR "||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||"
 #define PBWIDTH 60
 
+vector<double> Simulation::realization_run_times;
+
 
 Simulation::Simulation(
         vector<WaterSource *> water_sources, const Graph &water_sources_graph,
@@ -62,7 +69,7 @@ Simulation::Simulation(
         const vector<vector<double>> &policies_rdm,
         const unsigned long total_simulation_time,
         const vector<unsigned long> &realizations_to_run,
-        const vector<vector<Matrix2D<double>>> &precomputed_rof_tables,
+        const vector<vector<ROFTable>> &precomputed_rof_tables,
         const vector<vector<double>> &table_storage_shift,
         const string &rof_tables_folder) :
         total_simulation_time(total_simulation_time),
@@ -216,10 +223,13 @@ void Simulation::setupSimulation(vector<WaterSource *> &water_sources,
     }
 
     // Creates the data collector for the simulation.
-    master_data_collector = new MasterDataCollector(realizations_to_run);
+    master_data_collector = new MasterDataCollector(realizations_to_run,
+                                                    total_simulation_time);
 }
 
-Simulation::~Simulation() = default;
+Simulation::~Simulation() {
+    clearModelsPool();
+}
 
 /**
  * Assignment constructor
@@ -246,19 +256,6 @@ void Simulation::createContinuityModels(unsigned long realization,
     vector<MinEnvFlowControl *> min_env_flow_controls_realization =
             Utils::copyMinEnvFlowControlVector(min_env_flow_controls);
 
-    // Store realization models in vector
-    realization_model = new ContinuityModelRealization(
-            water_sources_realization,
-            water_sources_graph,
-            water_sources_to_utilities,
-            utilities_realization,
-            drought_mitigation_policies_realization,
-            min_env_flow_controls_realization,
-            utilities_rdm.at(realization),
-            water_sources_rdm.at(realization),
-            policies_rdm.at(realization),
-            (int) realization);
-
     // Create rof models by copying the water utilities and sources.
     vector<WaterSource *> water_sources_rof =
             Utils::copyWaterSourceVector(water_sources);
@@ -266,22 +263,90 @@ void Simulation::createContinuityModels(unsigned long realization,
     vector<MinEnvFlowControl *> min_env_flow_controls_rof =
             Utils::copyMinEnvFlowControlVector(min_env_flow_controls);
 
-    // Store realization models in vector
-    rof_model = new ContinuityModelROF(
-            water_sources_rof,
-            water_sources_graph,
-            water_sources_to_utilities,
-            utilities_rof,
-            min_env_flow_controls_rof,
-            utilities_rdm.at(realization),
-            water_sources_rdm.at(realization),
-            total_simulation_time,
-            import_export_rof_tables,
-            realization);
+    // Reuse the models of the last realization this thread ran, if any,
+    // rebinding them to the copies above. Otherwise, build them.
+    auto thread = (unsigned long) omp_get_thread_num();
+    realization_model = realization_models_pool[thread];
+    rof_model = rof_models_pool[thread];
+    if (realization_model) {
+        realization_model->rebind(
+                water_sources_realization,
+                utilities_realization,
+                drought_mitigation_policies_realization,
+                min_env_flow_controls_realization,
+                utilities_rdm.at(realization),
+                water_sources_rdm.at(realization),
+                policies_rdm.at(realization),
+                realization);
+        rof_model->rebind(
+                water_sources_rof,
+                utilities_rof,
+                min_env_flow_controls_rof,
+                utilities_rdm.at(realization),
+                water_sources_rdm.at(realization),
+                realization);
+    } else {
+        realization_model = new ContinuityModelRealization(
+                water_sources_realization,
+                water_sources_graph,
+                water_sources_to_utilities,
+                utilities_realization,
+                drought_mitigation_policies_realization,
+                min_env_flow_controls_realization,
+                utilities_rdm.at(realization),
+                water_sources_rdm.at(realization),
+                policies_rdm.at(realization),
+                (int) realization);
+
+        rof_model = new ContinuityModelROF(
+                water_sources_rof,
+                water_sources_graph,
+                water_sources_to_utilities,
+                utilities_rof,
+                min_env_flow_controls_rof,
+                utilities_rdm.at(realization),
+                water_sources_rdm.at(realization),
+                total_simulation_time,
+                import_export_rof_tables,
+                realization);
+
+        realization_models_pool[thread] = realization_model;
+        rof_models_pool[thread] = rof_model;
+    }
 
     // Initialize rof models by connecting it to realization water sources.
     rof_model->connectRealizationWaterSources(water_sources_realization);
     rof_model->connectRealizationUtilities(utilities_realization);
+    rof_model->setLongTermROFCache(long_term_rof_cache);
+
+    // Short-term ROF triggers of all policies, by utility, which tell
+    // adaptive ROF sampling when to stop.
+    vector<vector<double>> utilities_rof_triggers;
+    if (adaptive_rof_sampling != nullptr) {
+        utilities_rof_triggers.resize(utilities.size());
+        for (DroughtMitigationPolicy *dmp :
+                realization_model->getDrought_mitigation_policies())
+            dmp->addShortTermROFTriggers(utilities_rof_triggers);
+    }
+    rof_model->setAdaptiveROFSampling(adaptive_rof_sampling,
+                                      utilities_rof_triggers);
+
+    // The storage bound may only skip ROF years if the storage-ROF table
+    // they fill is neither exported nor used by insurance policies.
+    bool rof_table_used = import_export_rof_tables == EXPORT_ROF_TABLES;
+    for (DroughtMitigationPolicy *dmp :
+            realization_model->getDrought_mitigation_policies())
+        if (dmp->type == INSURANCE_STORAGE_ROF)
+            rof_table_used = true;
+    rof_model->setStorageBoundROF(storage_bound_rof, rof_table_used);
+    if (scalar_rof_years)
+        rof_model->disableROFLanes();
+
+    for (DroughtMitigationPolicy *dmp :
+            realization_model->getDrought_mitigation_policies())
+        if (dmp->type == INSURANCE_STORAGE_ROF)
+            dynamic_cast<InsuranceStorageToROF *>(dmp)->setInsurancePricing(
+                    insurance_pricing);
 
     // Pass ROF tables to continuity model
     if (import_export_rof_tables == IMPORT_ROF_TABLES) {
@@ -294,9 +359,19 @@ void Simulation::createContinuityModels(unsigned long realization,
             realization_model->getDrought_mitigation_policies())
         dmp->setStorage_to_rof_table_(
                 rof_model->getUt_storage_to_rof_table(),
+                rof_model->getUt_imported_rof_table(),
                 import_export_rof_tables);
 }
 
+void Simulation::clearModelsPool() {
+    for (auto realization_model : realization_models_pool)
+        delete realization_model;
+    for (auto rof_model : rof_models_pool)
+        delete rof_model;
+    realization_models_pool.clear();
+    rof_models_pool.clear();
+}
+
 void printProgress(double percentage) {
     int val = (int) (percentage * 100);
     int lpad = (int) (percentage * PBWIDTH);
@@ -330,22 +405,76 @@ Simulation::runFullSimulation(unsigned long n_threads, double *vars) {
         }
     }
 
+    // Exported ROF tables must be calculated over all ROF years.
+    if (adaptive_rof_sampling != nullptr &&
+        import_export_rof_tables == EXPORT_ROF_TABLES) {
+        throw invalid_argument("Adaptive ROF sampling cannot be used when "
+                               "exporting ROF tables.");
+    }
+
     set<unsigned long> s(realizations_to_run.begin(),
                          realizations_to_run.end());
     vector<unsigned long> realizations_to_run_unique;
     realizations_to_run_unique.assign(s.begin(), s.end());
+    unsigned long n_realization_ids = realizations_to_run_unique.back() + 1;
+
+    // When tables are generated in shards, only generate the ones of the
+    // realizations of this shard (see ROFTablesFile::mergeShards).
+    string rof_tables_file_name = rof_tables_folder + ROFTablesFile::FILE_NAME;
+    if (import_export_rof_tables == EXPORT_ROF_TABLES &&
+        n_rof_tables_shards > 1) {
+        realizations_to_run_unique.erase(
+                remove_if(realizations_to_run_unique.begin(),
+                          realizations_to_run_unique.end(),
+                          [this](unsigned long r) {
+                              return (int) (r % n_rof_tables_shards) !=
+                                     rof_tables_shard;
+                          }),
+                realizations_to_run_unique.end());
+        rof_tables_file_name = ROFTablesFile::shardFileName(rof_tables_folder,
+                                                            rof_tables_shard);
+    }
+    vector<unsigned long> realizations_schedule =
+            scheduleRealizations(realizations_to_run_unique);
+
+    // Create binary tables file to be filled in by all realizations from
+    // background threads. Breakpoint tables are converted from exact uint8
+    // tables at the end.
+    unique_ptr<ROFTablesWriter> rof_tables_writer;
+    if (import_export_rof_tables == EXPORT_ROF_TABLES) {
+        ROFTablesFile::create(rof_tables_file_name, n_realization_ids,
+                              utilities.size(), total_simulation_time,
+                              (unsigned long) NO_OF_INSURANCE_STORAGE_TIERS,
+                              rof_tables_dtype == ROF_TABLE_BREAKPOINTS ?
+                              ROF_TABLE_UINT8 : rof_tables_dtype);
+        rof_tables_writer = unique_ptr<ROFTablesWriter>(
+                new ROFTablesWriter(rof_tables_file_name,
+                                    rof_tables_queue_depth,
+                                    rof_tables_io_threads));
+    }
 
-    // Prepare error output.
-    int had_catch = 0;
-    string error_m = "Error in realizations ";
-    string error_file_name = "error_reals";
-    string error_file_content = "#";
-
-    // Run realizations.
-#pragma omp parallel for ordered num_threads(n_threads) shared(had_catch, realizations_to_run_unique, error_m, error_file_name, error_file_content) default(none)
-    for (unsigned long r = 0; r < realizations_to_run_unique.size(); ++r) {
-        unsigned long realization = realizations_to_run_unique[r];
-        //printf("Realization %lu\n", r);
+    // Failure channel: each realization only writes its own slot, so that
+    // no shared state is modified by more than one thread.
+    unsigned long n_scheduled = realizations_schedule.size();
+    vector<char> failed(n_scheduled, 0);
+    vector<string> failure_messages(n_scheduled);
+    vector<double> run_times(n_scheduled, 0.);
+    unsigned long realizations_completed = 0;
+    if (adaptive_rof_sampling != nullptr)
+        adaptive_rof_sampling->resetStatistics();
+    if (storage_bound_rof != nullptr)
+        storage_bound_rof->resetStatistics();
+    if (insurance_pricing != nullptr)
+        insurance_pricing->resetStatistics();
+    realization_models_pool.assign(n_threads, nullptr);
+    rof_models_pool.assign(n_threads, nullptr);
+
+    // Run realizations, each thread taking the next realization in the
+    // schedule as soon as it is done with the previous one.
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads) shared(realizations_schedule, n_scheduled, failed, failure_messages, run_times, realizations_completed, rof_tables_writer) default(none)
+    for (unsigned long r = 0; r < n_scheduled; ++r) {
+        unsigned long realization = realizations_schedule[r];
+        double start_time = omp_get_wtime();
 
         // Create continuity models.
         ContinuityModelRealization *realization_model = nullptr;
@@ -359,9 +488,23 @@ Simulation::runFullSimulation(unsigned long n_threads, double *vars) {
                 realization_model->getContinuity_utilities(),
                 realization);
 
+        // Short-term ROFs of all utilities, reused every week.
+        vector<double> short_term_rofs(
+                realization_model->getContinuity_utilities().size());
+
         try {
-//        double start = omp_get_wtime();
+#ifdef COUNT_ALLOCATIONS
+            // Heap allocations made by the ROF and continuity calculations
+            // and by whole weeks (including drought mitigation policies and
+            // data collection) after the first one, which sets things up.
+            unsigned long max_allocations_calcs = 0;
+            unsigned long max_allocations_week = 0;
+#endif
             for (int w = 0; w < (int) total_simulation_time; ++w) {
+#ifdef COUNT_ALLOCATIONS
+                unsigned long allocations_week_start =
+                        AllocationCounter::count();
+#endif
                 // DO NOT change the order of the steps. This would mess up
                 // important dependencies.
                 // Calculate long-term risk-of-failre if current week is first week of the year.
@@ -369,43 +512,122 @@ Simulation::runFullSimulation(unsigned long n_threads, double *vars) {
                     realization_model->setLongTermROFs(
                             rof_model->calculateLongTermROF(w), w);
                 // Calculate short-term risk-of-failure
-                realization_model->setShortTermROFs(
-                        rof_model->calculateShortTermROF(w,
-                                                         import_export_rof_tables));
+                rof_model->calculateShortTermROF(w, import_export_rof_tables,
+                                                 short_term_rofs);
+                realization_model->setShortTermROFs(short_term_rofs);
+#ifdef COUNT_ALLOCATIONS
+                unsigned long allocations_calcs =
+                        AllocationCounter::count() - allocations_week_start;
+#endif
                 // Apply drought mitigation policies
                 if (import_export_rof_tables != EXPORT_ROF_TABLES) {
                     realization_model->applyDroughtMitigationPolicies(w);
                 }
+#ifdef COUNT_ALLOCATIONS
+                unsigned long allocations_continuity_start =
+                        AllocationCounter::count();
+#endif
                 // Continuity calculations for current week
                 realization_model->continuityStep(w);
+#ifdef COUNT_ALLOCATIONS
+                allocations_calcs += AllocationCounter::count() -
+                                     allocations_continuity_start;
+#endif
                 // Collect system data for output printing and objective calculations.
                 if (import_export_rof_tables != EXPORT_ROF_TABLES) {
-                    master_data_collector->collectData(realization);
+                    master_data_collector->collectData(realization, w);
+                }
+#ifdef COUNT_ALLOCATIONS
+                if (w > 0) {
+                    max_allocations_calcs = max(max_allocations_calcs,
+                                                allocations_calcs);
+                    max_allocations_week = max(
+                            max_allocations_week,
+                            AllocationCounter::count() -
+                            allocations_week_start);
                 }
+#endif
             }
+#ifdef COUNT_ALLOCATIONS
+#pragma omp critical
+            printf("Realization %lu: at most %lu heap allocations per week in "
+                   "ROF and continuity calculations and %lu per whole week.\n",
+                   realization, max_allocations_calcs, max_allocations_week);
+#endif
             // Export ROF tables for future simulations of the same problem with the same states-of-the-world.
             if (import_export_rof_tables == EXPORT_ROF_TABLES) {
-                rof_model->printROFTable(rof_tables_folder);
+                rof_tables_writer->push(
+                        realization, rof_model->getUt_storage_to_rof_table());
             }
-//        printf("Realization %lu took %f seconds.\n", r, omp_get_wtime() - start);
-
-#pragma omp critical
-            printProgress(
-                    (double) master_data_collector->getRealizations_created() /
-                    (double) realizations_to_run_unique.size());
-
+        } catch (const exception &e) {
+            failed[r] = 1;
+            failure_messages[r] = e.what();
+            master_data_collector->removeRealization(realization);
         } catch (...) {
-#pragma omp atomic
-            ++had_catch;
-            error_m += to_string(realization) + " ";
-            error_file_name += "_" + to_string(realization);
-            error_file_content += to_string(realization) + ",";
+            failed[r] = 1;
             master_data_collector->removeRealization(realization);
         }
 
-        delete realization_model;
-        delete rof_model;
+        run_times[r] = omp_get_wtime() - start_time;
+
+        // Only print progress when the percentage changes.
+        unsigned long completed;
+#pragma omp atomic capture
+        completed = ++realizations_completed;
+        if (completed * 100 / n_scheduled !=
+            (completed - 1) * 100 / n_scheduled) {
+#pragma omp critical
+            printProgress((double) completed / (double) n_scheduled);
+        }
     }
+
+    clearModelsPool();
+
+    if (long_term_rof_cache != nullptr)
+        long_term_rof_cache->printStatistics();
+    if (adaptive_rof_sampling != nullptr &&
+        import_export_rof_tables != IMPORT_ROF_TABLES)
+        adaptive_rof_sampling->printStatistics();
+    if (storage_bound_rof != nullptr &&
+        import_export_rof_tables != IMPORT_ROF_TABLES)
+        storage_bound_rof->printStatistics();
+    if (insurance_pricing != nullptr)
+        insurance_pricing->printStatistics();
+
+    // Record run times for the schedule of the next simulation.
+    if (realization_run_times.size() < n_realization_ids)
+        realization_run_times.resize(n_realization_ids, NON_INITIALIZED);
+    for (unsigned long r = 0; r < n_scheduled; ++r)
+        realization_run_times[realizations_schedule[r]] = run_times[r];
+
+    // Gather failures in realization order.
+    map<unsigned long, string> failures;
+    for (unsigned long r = 0; r < n_scheduled; ++r)
+        if (failed[r])
+            failures[realizations_schedule[r]] = failure_messages[r];
+
+    int had_catch = (int) failures.size();
+    string error_m = "Error in realizations ";
+    string error_file_name = "error_reals";
+    string error_file_content = "#";
+    for (auto &failure : failures) {
+        error_m += to_string(failure.first) + " ";
+        error_file_name += "_" + to_string(failure.first);
+        error_file_content += to_string(failure.first) + ",";
+        if (!failure.second.empty())
+            printf("Realization %lu failed: %s\n", failure.first,
+                   failure.second.c_str());
+    }
+    if (import_export_rof_tables == EXPORT_ROF_TABLES) {
+        rof_tables_writer->close();
+        ROFTablesFile::finalize(rof_tables_file_name);
+        if (n_rof_tables_shards == 1 &&
+            rof_tables_dtype == ROF_TABLE_BREAKPOINTS)
+            ROFTablesFile::convertToBreakpoints(rof_tables_folder);
+        if (merge_rof_tables_shards)
+            mergeRofTablesShards();
+    }
+
     // Handle exception from the OpenMP region and pass it up to the
     // problem class.
     if (had_catch) {
@@ -444,7 +666,167 @@ Simulation::runFullSimulation(unsigned long n_threads, double *vars) {
     return master_data_collector;
 }
 
+/**
+ * Waits for the MPI ranks generating the shards of the exported ROF tables
+ * to finish and has rank 0 merge them into a single tables file.
+ */
+void Simulation::mergeRofTablesShards() const {
+#ifdef  PARALLEL
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rof_tables_shard == 0)
+        ROFTablesFile::mergeShards(rof_tables_folder, n_rof_tables_shards,
+                                   rof_tables_dtype == ROF_TABLE_BREAKPOINTS);
+    MPI_Barrier(MPI_COMM_WORLD);
+#else
+    throw invalid_argument("This version of WaterPaths was not compiled with "
+                           "MPI, so ROF tables shards cannot be merged "
+                           "automatically.");
+#endif
+}
+
+/**
+ * Orders realizations so that the ones that took longest in the previous
+ * simulation are run first, which keeps threads from waiting on a few long
+ * realizations at the end of the simulation. Realizations without a
+ * previous run time go first, and ties keep realization order.
+ * @param realizations sorted realization ids.
+ * @return realizations in the order they should be started.
+ */
+vector<unsigned long> Simulation::scheduleRealizations(
+        const vector<unsigned long> &realizations) const {
+    vector<unsigned long> schedule(realizations);
+    auto run_time = [](unsigned long realization) {
+        return realization < realization_run_times.size() &&
+               realization_run_times[realization] >= 0 ?
+               realization_run_times[realization] :
+               numeric_limits<double>::max();
+    };
+    stable_sort(schedule.begin(), schedule.end(),
+                [&run_time](unsigned long a, unsigned long b) {
+                    return run_time(a) > run_time(b);
+                });
+
+    return schedule;
+}
+
 void Simulation::setRof_tables_folder(const string &rof_tables_folder) {
     Simulation::rof_tables_folder = rof_tables_folder;
 }
 
+/**
+ * Sets the data type in which exported ROF tables will be stored.
+ * @param rof_tables_dtype ROF_TABLE_FLOAT64, ROF_TABLE_UINT8,
+ * ROF_TABLE_FLOAT16 or ROF_TABLE_BREAKPOINTS.
+ */
+void Simulation::setRofTablesDataType(int rof_tables_dtype) {
+    Simulation::rof_tables_dtype = rof_tables_dtype;
+}
+
+/**
+ * Sets how exported ROF tables are written in the background (see
+ * ROFTablesWriter).
+ * @param n_io_threads number of threads writing tables.
+ * @param max_queued_realizations number of finished realizations whose
+ * tables can wait to be written before simulation threads wait for them.
+ */
+void Simulation::setRofTablesWriter(int n_io_threads,
+                                    unsigned long max_queued_realizations) {
+    rof_tables_io_threads = n_io_threads;
+    rof_tables_queue_depth = max_queued_realizations;
+}
+
+/**
+ * Makes this simulation generate one of several shards of the ROF tables,
+ * with the tables of the realizations r with r % n_shards == shard, which are
+ * written to ROFTablesFile::shardFileName instead of the tables file.
+ * @param shard
+ * @param n_shards
+ * @param merge_shards whether shards are generated by the ranks of an MPI
+ * run, whose rank 0 merges them once all ranks are done.
+ */
+void Simulation::setRofTablesShard(int shard, int n_shards,
+                                   bool merge_shards) {
+    if (n_shards < 1 || shard < 0 || shard >= n_shards) {
+        char error[128];
+        sprintf(error, "Invalid ROF tables shard %d of %d.", shard, n_shards);
+        throw invalid_argument(error);
+    }
+    rof_tables_shard = shard;
+    n_rof_tables_shards = n_shards;
+    merge_rof_tables_shards = merge_shards;
+}
+
+/**
+ * Sets the cache long-term ROFs are looked up in, which may be shared with
+ * other simulations, or nullptr for none.
+ * @param long_term_rof_cache
+ */
+void Simulation::setLongTermROFCache(LongTermROFCache *long_term_rof_cache) {
+    Simulation::long_term_rof_cache = long_term_rof_cache;
+}
+
+/**
+ * Sets the settings short-term ROFs are sampled adaptively with, which may
+ * be shared with other simulations, or nullptr for always running all ROF
+ * years.
+ * @param adaptive_rof_sampling
+ */
+void Simulation::setAdaptiveROFSampling(
+        AdaptiveROFSampling *adaptive_rof_sampling) {
+    Simulation::adaptive_rof_sampling = adaptive_rof_sampling;
+}
+
+/**
+ * Sets the storage bound short-term ROFs are checked against before being
+ * simulated, which may be shared with other simulations, or nullptr for
+ * always simulating them.
+ * @param storage_bound_rof
+ */
+void Simulation::setStorageBoundROF(StorageBoundROF *storage_bound_rof) {
+    Simulation::storage_bound_rof = storage_bound_rof;
+}
+
+/**
+ * Sets the reuse of ROF-year trajectories by insurance pricing, which may be
+ * shared with other simulations, or nullptr for simulating all ROF years in
+ * every pricing.
+ * @param insurance_pricing
+ */
+void Simulation::setInsurancePricing(InsurancePricing *insurance_pricing) {
+    Simulation::insurance_pricing = insurance_pricing;
+}
+
+/**
+ * Sets whether ROF years are always run one at a time instead of all at
+ * once when the sources' minimum environmental flow controls allow it.
+ * @param scalar_rof_years
+ */
+void Simulation::setScalarROFYears(bool scalar_rof_years) {
+    Simulation::scalar_rof_years = scalar_rof_years;
+}
+
+/**
+ * Sets whether only the data needed to calculate objectives is collected
+ * instead of full time series.
+ * @param objectives_only
+ */
+void Simulation::setObjectivesOnlyCollection(bool objectives_only) {
+    master_data_collector->setObjectivesOnly(objectives_only);
+}
+
+/**
+ * Sets whether time series are stored in single precision.
+ * @param single_precision
+ */
+void Simulation::setSinglePrecisionTimeSeries(bool single_precision) {
+    master_data_collector->setSinglePrecisionSeries(single_precision);
+}
+
+/**
+ * Sets which time series are recorded.
+ * @param output_specification
+ */
+void Simulation::setOutputSpecification(
+        const OutputSpecification &output_specification) {
+    master_data_collector->setOutputSpecification(output_specification);
+}
@@ -9,11 +9,13 @@
 #include "../SystemComponents/WaterSources/Base/WaterSource.h"
 #include "../SystemComponents/Utility/Utility.h"
 #include "../DroughtMitigationInstruments/Restrictions.h"
+#include "../DroughtMitigationInstruments/InsurancePricing.h"
 #include "../ContinuityModels/Base/ContinuityModel.h"
 #include "../ContinuityModels/ContinuityModelRealization.h"
 #include "../ContinuityModels/ContinuityModelROF.h"
 #include "../Controls/Base/MinEnvFlowControl.h"
 #include "../DataCollector/MasterDataCollector.h"
+#include "../Utils/ROFTable.h"
 #include <vector>
 
 using namespace Constants;
@@ -35,13 +37,40 @@ private:
     const vector<vector<double>> &water_sources_rdm;
     const vector<vector<double>> &policies_rdm;
 
-    const vector<vector<Matrix2D<double>>> *precomputed_rof_tables;
+    const vector<vector<ROFTable>> *precomputed_rof_tables;
     const vector<vector<double>> *table_storage_shift;
     MasterDataCollector* master_data_collector = nullptr;
     string rof_tables_folder;
+    int rof_tables_dtype = ROF_TABLE_FLOAT64;
+    int rof_tables_io_threads = 1;
+    unsigned long rof_tables_queue_depth = 4;
+    /// Exported tables are generated in n_rof_tables_shards shards, of which
+    /// this simulation generates shard rof_tables_shard.
+    int rof_tables_shard = 0;
+    int n_rof_tables_shards = 1;
+    bool merge_rof_tables_shards = false;
+    LongTermROFCache *long_term_rof_cache = nullptr;
+    AdaptiveROFSampling *adaptive_rof_sampling = nullptr;
+    StorageBoundROF *storage_bound_rof = nullptr;
+    InsurancePricing *insurance_pricing = nullptr;
+    bool scalar_rof_years = false;
+
+    /// Seconds each realization took to run in the last simulation, used
+    /// to start the most expensive realizations first in the next one.
+    static vector<double> realization_run_times;
+
+    /// Models of the realization each thread ran last, which are rebound to
+    /// the next realization the thread runs instead of being built again.
+    vector<ContinuityModelRealization *> realization_models_pool;
+    vector<ContinuityModelROF *> rof_models_pool;
 
     void setRof_tables_folder(const string &rof_tables_folder);
 
+    vector<unsigned long> scheduleRealizations(
+            const vector<unsigned long> &realizations) const;
+
+    void mergeRofTablesShards() const;
+
 public:
 
     Simulation(
@@ -69,7 +98,7 @@ public:
             const vector<vector<double>> &policies_rdm,
                const unsigned long total_simulation_time,
             const vector<unsigned long> &realizations_to_run,
-            const vector<vector<Matrix2D<double>>> &precomputed_rof_tables,
+            const vector<vector<ROFTable>> &precomputed_rof_tables,
             const vector<vector<double>> &table_storage_shift,
             const string &rof_tables_folder);
 
@@ -92,6 +121,30 @@ public:
 
     MasterDataCollector *runFullSimulation(unsigned long n_threads, double *vars);
 
+    void setRofTablesDataType(int rof_tables_dtype);
+
+    void setRofTablesWriter(int n_io_threads,
+                            unsigned long max_queued_realizations);
+
+    void setRofTablesShard(int shard, int n_shards, bool merge_shards);
+
+    void setLongTermROFCache(LongTermROFCache *long_term_rof_cache);
+
+    void setAdaptiveROFSampling(AdaptiveROFSampling *adaptive_rof_sampling);
+
+    void setStorageBoundROF(StorageBoundROF *storage_bound_rof);
+
+    void setInsurancePricing(InsurancePricing *insurance_pricing);
+
+    void setScalarROFYears(bool scalar_rof_years);
+
+    void setObjectivesOnlyCollection(bool objectives_only);
+
+    void setSinglePrecisionTimeSeries(bool single_precision);
+
+    void setOutputSpecification(
+            const OutputSpecification &output_specification);
+
     void setupSimulation(vector<WaterSource *> &water_sources,
                          const Graph &water_sources_graph,
                              const vector<vector<int>> &water_sources_to_utilities, vector<Utility *> &utilities,
@@ -104,6 +157,8 @@ public:
 
     void createContinuityModels(unsigned long realization, ContinuityModelRealization *&realization_model,
                                     ContinuityModelROF *&rof_model);
+
+    void clearModelsPool();
 };
 
 
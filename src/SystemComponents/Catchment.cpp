@@ -2,6 +2,7 @@
 // Created by bernardo on 1/13/17.
 //
 
+#include <algorithm>
 #include <cmath>
 #include "Catchment.h"
 
@@ -34,7 +35,11 @@ Catchment::Catchment(const Catchment &catchment) :
         streamflows_all(catchment.streamflows_all),
         streamflows_realization(catchment.streamflows_realization),
         series_length(catchment.series_length),
-        parent(false) {}
+        realization_length(catchment.realization_length),
+        parent(false),
+        streamflow_range_set(catchment.streamflow_range_set),
+        min_streamflow(catchment.min_streamflow),
+        max_streamflow(catchment.max_streamflow) {}
 
 /**
  * Copy assignment operator.
@@ -69,13 +74,36 @@ double Catchment::getStreamflow(int week) const {
 }
 
 /**
- * Get time series corresponding to realization index and eliminate reference to
- * comprehensive streamflow
- * data set.
+ * Point to the time series corresponding to realization index in the
+ * comprehensive streamflow data set, which is shared by all copies of the
+ * catchment instead of being copied.
  * @param r
  */
 void Catchment::setRealization(unsigned long r, const vector<double> &rdm_factors) {
-    streamflows_realization = vector<double>(streamflows_all->at(r));
+    streamflows_realization = streamflows_all->at(r).data();
+    realization_length = streamflows_all->at(r).size();
+    streamflow_range_set = false;
+}
+
+/**
+ * Gets the smallest and largest values of the whole series of the current
+ * realization, including the weeks reserved for ROF calculations.
+ * @param min_streamflow
+ * @param max_streamflow
+ */
+void Catchment::getStreamflowRange(double &min_streamflow,
+                                   double &max_streamflow) {
+    if (!streamflow_range_set) {
+        auto range = minmax_element(
+                streamflows_realization,
+                streamflows_realization + realization_length);
+        this->min_streamflow = *range.first;
+        this->max_streamflow = *range.second;
+        streamflow_range_set = true;
+    }
+
+    min_streamflow = this->min_streamflow;
+    max_streamflow = this->max_streamflow;
 }
 
 int Catchment::getSeriesLength() const {
@@ -14,9 +14,17 @@ using namespace Constants;
 class Catchment {
 protected:
     vector<vector<double>> *streamflows_all = nullptr;
-    vector<double> streamflows_realization;
+    /// Series of the current realization, which is not copied from
+    /// streamflows_all and must therefore not outlive it.
+    const double *streamflows_realization = nullptr;
     int series_length = NON_INITIALIZED;
+    unsigned long realization_length = 0;
     bool parent = true;
+    /// Smallest and largest values of the series of the current
+    /// realization, calculated the first time they are needed.
+    bool streamflow_range_set = false;
+    double min_streamflow = NONE;
+    double max_streamflow = NONE;
     // Number of historical years of data - used to set week delta_week to week 0.
     int delta_week = (int) std::round(
             Constants::WEEKS_IN_YEAR * Constants::NUMBER_REALIZATIONS_ROF);
@@ -35,6 +43,8 @@ public:
 
     double getStreamflow(int week) const;
 
+    void getStreamflowRange(double &min_streamflow, double &max_streamflow);
+
     virtual void setRealization(unsigned long r, const vector<double> &rdm_factors);
 
     int getSeriesLength() const;
@@ -195,6 +195,8 @@ Utility::Utility(Utility &utility) :
         wwtp_discharge_rule(utility.wwtp_discharge_rule),
         demands_all_realizations(utility.demands_all_realizations),
         demand_series_realization(utility.demand_series_realization),
+        demand_rdm_multiplier(utility.demand_rdm_multiplier),
+        demand_rdm_delta(utility.demand_rdm_delta),
         infra_discount_rate(utility.infra_discount_rate),
         bond_term_multiplier(utility.bond_term_multiplier),
         bond_interest_rate_multiplier(utility.bond_interest_rate_multiplier),
@@ -224,11 +226,16 @@ Utility::~Utility() {
     delete[] utility_owned_wtp_capacities_tmp;
     delete[] available_treated_flow_rate;
     delete[] has_treatment_capacity;
+    delete[] storages_tmp;
+    delete[] split_demands_tmp;
+    delete[] has_spare_flow_rate_tmp;
+    delete[] over_allocated_tmp;
 }
 
 Utility &Utility::operator=(const Utility &utility) {
-    demand_series_realization = vector<double>(
-            (unsigned long) utility.number_of_week_demands);
+    demand_series_realization = utility.demand_series_realization;
+    demand_rdm_multiplier = utility.demand_rdm_multiplier;
+    demand_rdm_delta = utility.demand_rdm_delta;
 
     infrastructure_construction_manager.connectWaterSourcesVectorsToUtilitys(
             water_sources,
@@ -267,6 +274,17 @@ void Utility::updateTreatmentAndNumberOfStorageSources() {
     n_wtp = utility_owned_wtp_capacities.size();
     utility_owned_wtp_capacities_tmp = new double[n_wtp];
 
+    // Scratch arrays for splitting demands, allocated here so that
+    // splitDemands does not allocate memory every week.
+    delete[] storages_tmp;
+    delete[] split_demands_tmp;
+    delete[] has_spare_flow_rate_tmp;
+    delete[] over_allocated_tmp;
+    storages_tmp = new double[n_storage_sources];
+    split_demands_tmp = new double[n_storage_sources];
+    has_spare_flow_rate_tmp = new bool[n_storage_sources];
+    over_allocated_tmp = new bool[n_storage_sources];
+
     total_treatment_capacity = accumulate(utility_owned_wtp_capacities.begin(),
                                           utility_owned_wtp_capacities.end(),
                                           0.);
@@ -505,7 +523,7 @@ void Utility::splitDemands(
         bool apply_demand_buffer) {
     memcpy(utility_owned_wtp_capacities_tmp, utility_owned_wtp_capacities.data(),
             sizeof(double) * n_wtp);
-    unrestricted_demand = demand_series_realization[week] +
+    unrestricted_demand = getUnrestrictedDemand(week) +
                           apply_demand_buffer * demand_buffer *
                           weekly_peaking_factor[Utils::weekOfTheYear(week)];
     restricted_demand = unrestricted_demand * demand_multiplier - demand_offset;
@@ -531,7 +549,7 @@ void Utility::splitDemands(
         utility_owned_wtp_capacities_tmp[water_source_to_wtp[ws]] -= source_demand;
     }
 
-    double storages[n_storage_sources];
+    double *storages = storages_tmp;
     double total_available_flow_rate = 0;
     for (int i = 0; i < n_storage_sources; ++i) {
         auto ws = water_sources[non_priority_draw_water_source[i]];
@@ -558,10 +576,9 @@ void Utility::splitDemands(
 
         // Create auxiliary variables and check which sources are over allocated
         // and which have spare capacity.
-        bool has_spare_flow_rate[n_storage_sources];
-        memset(has_spare_flow_rate, true, 2);
-        bool over_allocated[n_storage_sources];
-        double split_demands[n_storage_sources];
+        bool *has_spare_flow_rate = has_spare_flow_rate_tmp;
+        bool *over_allocated = over_allocated_tmp;
+        double *split_demands = split_demands_tmp;
 
         treatment_capacity_violation = idealDemandSplitUnconstrained(
                 split_demands,
@@ -625,6 +642,250 @@ void Utility::splitDemands(
     }
 }
 
+/**
+ * Same as splitDemands but for ROF years first_lane to
+ * end_lane - 1 at once, taking storages from the batched ROF
+ * state instead of from the water sources. No financial calculations are
+ * made, since this is only used for ROF calculations.
+ * @param week
+ * @param source_lanes state of each water source.
+ * @param demands demands [water source][utility][ROF year] to be filled.
+ * @param apply_demand_buffer
+ * @param lanes state of this utility.
+ * @param first_lane
+ * @param end_lane
+ */
+#pragma GCC optimize("O3")
+void Utility::splitDemandsLanes(int week,
+                                const vector<SourceLanes> &source_lanes,
+                                vector<vector<vector<double>>> &demands,
+                                bool apply_demand_buffer, UtilityLanes &lanes,
+                                int first_lane, int end_lane) {
+    unrestricted_demand = getUnrestrictedDemand(week) +
+                          apply_demand_buffer * demand_buffer *
+                          weekly_peaking_factor[Utils::weekOfTheYear(week)];
+    double demand = unrestricted_demand * demand_multiplier - demand_offset;
+
+    double *storages = storages_tmp;
+    double *available_flow_rate = available_treated_flow_rate;
+    bool *has_spare_flow_rate = has_spare_flow_rate_tmp;
+    bool *over_allocated = over_allocated_tmp;
+    double *split_demands = split_demands_tmp;
+
+    for (int r = first_lane; r < end_lane; ++r) {
+        memcpy(utility_owned_wtp_capacities_tmp,
+               utility_owned_wtp_capacities.data(), sizeof(double) * n_wtp);
+        double total_stored_volume = lanes.total_stored_volume[r];
+        double unfulfilled = max(max(demand - lanes.total_available_volume[r],
+                                     demand - total_treatment_capacity),
+                                 0.);
+        double restricted = demand - unfulfilled;
+        double demand_non_priority_sources = restricted;
+
+        // Allocates demand to intakes and reuse based on allocated volume to
+        // this utility.
+        for (int &ws : priority_draw_water_source) {
+            double max_source_output = min(
+                    source_lanes[ws].allocatedVolume(id)[r],
+                    utility_owned_wtp_capacities_tmp[water_source_to_wtp[ws]]);
+            double source_demand = min(demand_non_priority_sources,
+                                       max_source_output);
+            demands[ws][id][r] = source_demand;
+            demand_non_priority_sources -= source_demand;
+            utility_owned_wtp_capacities_tmp[water_source_to_wtp[ws]] -=
+                    source_demand;
+        }
+
+        double total_available_flow_rate = 0;
+        for (int i = 0; i < n_storage_sources; ++i) {
+            int ws = non_priority_draw_water_source[i];
+            storages[i] = source_lanes[ws].allocatedVolume(id)[r];
+            available_flow_rate[i] = min(
+                    storages[i],
+                    utility_owned_wtp_capacities_tmp[water_source_to_wtp[ws]]);
+            total_available_flow_rate += available_flow_rate[i];
+        }
+
+        bool treatment_capacity_violation = false;
+        if (demand_non_priority_sources > total_available_flow_rate) {
+            for (int i = 0; i < n_storage_sources; ++i) {
+                demands[non_priority_draw_water_source[i]][id][r] =
+                        available_flow_rate[i];
+            }
+            treatment_capacity_violation = true;
+        } else if (demand_non_priority_sources > 0) {
+            treatment_capacity_violation = idealDemandSplitUnconstrained(
+                    split_demands, available_flow_rate,
+                    demand_non_priority_sources, storages,
+                    total_stored_volume, n_storage_sources);
+
+            if (treatment_capacity_violation) {
+                for (int i = 0; i < n_storage_sources; ++i) {
+                    over_allocated[i] = split_demands[i] - 1e-9 >
+                                        available_flow_rate[i];
+                    has_spare_flow_rate[i] = split_demands[i] + 1e-9 <
+                                             available_flow_rate[i];
+                }
+
+                while (treatment_capacity_violation) {
+                    double remainder_demand = demand_non_priority_sources;
+                    for (int i = 0; i < n_storage_sources; ++i) {
+                        if (over_allocated[i]) {
+                            split_demands[i] = available_flow_rate[i];
+                        }
+                        if (!has_spare_flow_rate[i]) {
+                            remainder_demand -= split_demands[i];
+                        }
+                    }
+                    treatment_capacity_violation = idealDemandSplitConstrained(
+                            split_demands, over_allocated,
+                            has_spare_flow_rate, available_flow_rate,
+                            remainder_demand, storages, total_stored_volume,
+                            n_storage_sources);
+                }
+            }
+
+            for (int j = 0; j < n_storage_sources; ++j) {
+                demands[non_priority_draw_water_source[j]][id][r] =
+                        split_demands[j];
+            }
+        }
+
+        lanes.restricted_demand[r] = restricted;
+        lanes.unfulfilled_demand[r] = (treatment_capacity_violation ?
+                                       restricted - total_available_flow_rate :
+                                       0.);
+    }
+}
+
+/**
+ * Same as updateTotalAvailableVolume but for ROF years first_lane to
+ * end_lane - 1 at once.
+ * @param source_lanes
+ * @param lanes
+ * @param first_lane
+ * @param end_lane
+ */
+void Utility::updateTotalAvailableVolumeLanes(
+        const vector<SourceLanes> &source_lanes, UtilityLanes &lanes,
+        int first_lane, int end_lane) {
+    for (int r = first_lane; r < end_lane; ++r) {
+        lanes.total_available_volume[r] = 0.;
+        lanes.total_stored_volume[r] = 0.;
+    }
+
+    for (int ws : priority_draw_water_source) {
+        const double *volume = source_lanes[ws].allocatedVolume(id);
+        for (int r = first_lane; r < end_lane; ++r) {
+            lanes.total_available_volume[r] += max(1.0e-6, volume[r]);
+        }
+    }
+
+    for (int ws : non_priority_draw_water_source) {
+        const double *volume = source_lanes[ws].allocatedVolume(id);
+        for (int r = first_lane; r < end_lane; ++r) {
+            double stored_volume = max(1.0e-6, volume[r]);
+            lanes.total_available_volume[r] += stored_volume;
+            lanes.total_stored_volume[r] += stored_volume;
+        }
+    }
+}
+
+/**
+ * Same as calculateWastewater_releases but for ROF years first_lane to
+ * end_lane - 1 at once.
+ * @param week
+ * @param lanes
+ * @param discharges discharges [water source][ROF year] to be added to.
+ * @param first_lane
+ * @param end_lane
+ */
+void Utility::calculateWastewater_releasesLanes(
+        int week, const UtilityLanes &lanes,
+        vector<vector<double>> &discharges, int first_lane, int end_lane) {
+    int week_of_year = Utils::weekOfTheYear(week);
+
+    for (int &id : wwtp_discharge_rule.discharge_to_source_ids) {
+        double fraction = wwtp_discharge_rule.get_dependent_variable(
+                id, week_of_year);
+        for (int r = first_lane; r < end_lane; ++r) {
+            discharges[id][r] += lanes.restricted_demand[r] * fraction;
+        }
+    }
+}
+
+/**
+ * Restricted demand splitDemands would calculate for a week if the
+ * utility's stored volume were not limiting.
+ * @param week
+ * @param apply_demand_buffer
+ * @return restricted demand.
+ */
+double Utility::predictRestrictedDemand(int week,
+                                        bool apply_demand_buffer) const {
+    double unrestricted = getUnrestrictedDemand(week) +
+                          apply_demand_buffer * demand_buffer *
+                          weekly_peaking_factor[Utils::weekOfTheYear(week)];
+    double restricted = unrestricted * demand_multiplier - demand_offset;
+    return restricted - max(restricted - total_treatment_capacity, 0.);
+}
+
+/**
+ * Lower bound on the stored volume updateTotalAvailableVolume would
+ * calculate if what each water source has available to the utility lost at
+ * most the given volume to anything but the utility's own demand, and the
+ * utility drew at most max_demand from all its sources combined. Sources
+ * without storage, such as intakes, may have nothing available at any week.
+ * @param water_sources_losses largest volume each source may lose, by id,
+ * not counting the utility's demand.
+ * @param max_demand largest volume the utility may draw.
+ * @return
+ */
+double Utility::getTotalStoredVolumeLowerBound(
+        const vector<double> &water_sources_losses, double max_demand) const {
+    double stored_volume = -max_demand;
+    for (int ws : non_priority_draw_water_source) {
+        WaterSource *water_source = water_sources[ws];
+        if (water_source->source_type == RESERVOIR ||
+            water_source->source_type == ALLOCATED_RESERVOIR ||
+            water_source->source_type == QUARRY)
+            stored_volume += max(1.0e-6,
+                                 water_source->getAvailableAllocatedVolume(id)
+                                 - water_sources_losses[ws]);
+        else
+            stored_volume += 1.0e-6;
+    }
+
+    return max(stored_volume,
+               1.0e-6 * (double) non_priority_draw_water_source.size());
+}
+
+/**
+ * Copies the state of the utility relevant for ROF calculations into one
+ * lane of the batched ROF state.
+ * @param lanes
+ * @param lane
+ */
+void Utility::saveLaneState(UtilityLanes &lanes, int lane) const {
+    lanes.total_available_volume[lane] = total_available_volume;
+    lanes.total_stored_volume[lane] = total_stored_volume;
+    lanes.restricted_demand[lane] = restricted_demand;
+    lanes.unfulfilled_demand[lane] = unfulfilled_demand;
+}
+
+/**
+ * Sets the state of the utility relevant for ROF calculations to that of one
+ * lane of the batched ROF state.
+ * @param lanes
+ * @param lane
+ */
+void Utility::loadLaneState(const UtilityLanes &lanes, int lane) {
+    total_available_volume = lanes.total_available_volume[lane];
+    total_stored_volume = lanes.total_stored_volume[lane];
+    restricted_demand = lanes.restricted_demand[lane];
+    unfulfilled_demand = lanes.unfulfilled_demand[lane];
+}
+
 /**
  * Update contingency fund based on regular contribution, restrictions, and
  * transfers. This function works for both sources and receivers of
@@ -785,7 +1046,7 @@ int Utility::infrastructureConstructionHandler(double long_term_rof, int week) {
         //                            demand_series_realization.begin() + week, 0.0) / WEEKS_IN_YEAR;
 
         for (int w = week - (int) WEEKS_IN_YEAR; w < week; ++w) {
-            past_year_average_demand += demand_series_realization.at(w) /
+            past_year_average_demand += getUnrestrictedDemand(w) /
                     WEEKS_IN_YEAR;
         }
     }
@@ -848,17 +1109,12 @@ Utility::setDemand_offset(double demand_offset, double offset_rate_per_volume) {
  */
 void
 Utility::setRealization(unsigned long r, const vector<double> &rdm_factors) {
-    unsigned long n_weeks = demands_all_realizations.at(r).size();
-    demand_series_realization = vector<double>(n_weeks);
-
-    // Apply demand multiplier and copy demands pertaining to current realization.
-    double delta_demand =
+    // Point to demands pertaining to current realization, to which the
+    // demand multiplier is applied on lookup.
+    demand_series_realization = demands_all_realizations.at(r).data();
+    demand_rdm_multiplier = rdm_factors.at(0);
+    demand_rdm_delta =
             demands_all_realizations.at(r)[0] * (1. - rdm_factors.at(0));
-    for (unsigned long w = 0; w < n_weeks; ++w) {
-        demand_series_realization[w] = demands_all_realizations.at(r)[w] *
-                                       rdm_factors.at(0)
-                                       + delta_demand;
-    }
 
     try {
         bond_term_multiplier = rdm_factors.at(1);
@@ -958,6 +1214,10 @@ double Utility::getRestrictedDemand() const {
     return restricted_demand;
 }
 
+void Utility::setRestricted_demand(double restricted_demand) {
+    Utility::restricted_demand = restricted_demand;
+}
+
 double Utility::getGrossRevenue() const {
     return gross_revenue;
 }
@@ -967,7 +1227,8 @@ double Utility::getDemand_multiplier() const {
 }
 
 double Utility::getUnrestrictedDemand(int week) const {
-    return demand_series_realization[week];
+    return demand_series_realization[week] * demand_rdm_multiplier +
+           demand_rdm_delta;
 }
 
 double Utility::getInfrastructure_net_present_cost() const {
@@ -1052,6 +1313,10 @@ double Utility::getDemand_offset() const {
     return demand_offset;
 }
 
+double Utility::getDemand_buffer() const {
+    return demand_buffer;
+}
+
 double Utility::getInfraDiscountRate() const {
     return infra_discount_rate;
 }
@@ -34,6 +34,11 @@ private:
     double price_rdm_multiplier = 1.;
     double *available_treated_flow_rate = nullptr;
     double *utility_owned_wtp_capacities_tmp = nullptr;
+    /// Scratch arrays of splitDemands, one element per storage source.
+    double *storages_tmp = nullptr;
+    double *split_demands_tmp = nullptr;
+    bool *has_spare_flow_rate_tmp = nullptr;
+    bool *over_allocated_tmp = nullptr;
     bool *has_treatment_capacity = nullptr;
     unsigned long n_wtp = NONE;
     bool used_for_realization = true;
@@ -41,7 +46,12 @@ private:
     vector<WaterSource *> water_sources;
     WwtpDischargeRule wwtp_discharge_rule;
     vector<vector<double>> &demands_all_realizations;
-    vector<double> demand_series_realization;
+    /// Demand series of the current realization in
+    /// demands_all_realizations, which is scaled by the demand RDM
+    /// multiplier on lookup instead of being copied.
+    const double *demand_series_realization = nullptr;
+    double demand_rdm_multiplier = 1.;
+    double demand_rdm_delta = 0.;
     vector<double> utility_owned_wtp_capacities; /// vector with water treatment capacity shared across one or more sources.
     vector<int> water_source_to_wtp;
     InfrastructureManager infrastructure_construction_manager;
@@ -129,6 +139,30 @@ public:
             int week, vector<vector<double>> &demands, bool
     apply_demand_buffer = false);
 
+    void splitDemandsLanes(int week, const vector<SourceLanes> &source_lanes,
+                           vector<vector<vector<double>>> &demands,
+                           bool apply_demand_buffer, UtilityLanes &lanes,
+                           int first_lane, int end_lane);
+
+    void updateTotalAvailableVolumeLanes(
+            const vector<SourceLanes> &source_lanes, UtilityLanes &lanes,
+            int first_lane, int end_lane);
+
+    void calculateWastewater_releasesLanes(
+            int week, const UtilityLanes &lanes,
+            vector<vector<double>> &discharges, int first_lane,
+            int end_lane);
+
+    double predictRestrictedDemand(int week, bool apply_demand_buffer) const;
+
+    double getTotalStoredVolumeLowerBound(
+            const vector<double> &water_sources_losses,
+            double max_demand) const;
+
+    void saveLaneState(UtilityLanes &lanes, int lane) const;
+
+    void loadLaneState(const UtilityLanes &lanes, int lane);
+
     void checkErrorsAddWaterSourceOnline(WaterSource *water_source);
 
     void resetDroughtMitigationVariables();
@@ -178,6 +212,8 @@ public:
 
     double getRestrictedDemand() const;
 
+    void setRestricted_demand(double restricted_demand);
+
     void setRestricted_price(double restricted_price);
 
     double getDemand_multiplier() const;
@@ -234,6 +270,8 @@ public:
 
     double getDemand_offset() const;
 
+    double getDemand_buffer() const;
+
     double getInfraDiscountRate() const;
 
     void updateTreatmentAndNumberOfStorageSources();
@@ -233,6 +233,179 @@ void AllocatedReservoir::applyContinuity(int week, double upstream_source_inflow
     policy_added_demand = 0;
 }
 
+/**
+ * Allocated reservoir mass balance for ROF years first_lane to end_lane - 1
+ * at once. The common cases, in which the reservoir either spills or has no
+ * allocation exceeding its capacity or running dry, are calculated for each
+ * year directly on the lanes. Years falling in any other case, as well as
+ * those failing a sanity check, are run with applyContinuity so that they
+ * are redistributed or reported exactly as when run one at a time.
+ * @param weeks week of the streamflow records for each ROF year.
+ * @param first_lane first ROF year to be updated.
+ * @param end_lane one past the last ROF year to be updated.
+ * @param upstream_source_inflow
+ * @param wastewater_inflow
+ * @param demand_outflow demand of each utility for each ROF year.
+ * @param lanes
+ */
+void AllocatedReservoir::applyContinuityLanes(const int *weeks, int first_lane,
+                                              int end_lane,
+                                              const double *upstream_source_inflow,
+                                              const double *wastewater_inflow,
+                                              const vector<vector<double>> &demand_outflow,
+                                              SourceLanes &lanes) {
+    // Demand added by policies applies to the first year only and the lanes
+    // may not have been sized yet, so those cases are left to the generic
+    // implementation.
+    if (!online || policy_added_demand != 0 ||
+        lanes.available_allocated_volumes.size() !=
+        available_allocated_volumes.size()) {
+        WaterSource::applyContinuityLanes(weeks, first_lane, end_lane,
+                                          upstream_source_inflow,
+                                          wastewater_inflow, demand_outflow,
+                                          lanes);
+        return;
+    }
+
+    continuity_error = 0;
+    lane_allocations.resize(available_allocated_volumes.size());
+    for (int r = first_lane; r < end_lane; ++r) {
+        if (!continuityLane(weeks[r], r, upstream_source_inflow,
+                            wastewater_inflow, demand_outflow, lanes)) {
+            lane_demand.resize(demand_outflow.size());
+            for (unsigned long u = 0; u < lane_demand.size(); ++u) {
+                lane_demand[u] = demand_outflow[u][r];
+            }
+
+            loadLaneState(lanes, r);
+            applyContinuity(weeks[r], upstream_source_inflow[r],
+                            wastewater_inflow[r], lane_demand);
+            saveLaneState(lanes, r);
+        }
+    }
+}
+
+/**
+ * Mass balance of one ROF year for applyContinuityLanes, following the same
+ * steps as applyContinuity. The lanes are left untouched if the year needs
+ * to be run with applyContinuity.
+ * @param week
+ * @param lane
+ * @param upstream_source_inflow
+ * @param wastewater_inflow
+ * @param demand_outflow
+ * @param lanes
+ * @return true if the year was updated.
+ */
+bool AllocatedReservoir::continuityLane(int week, int lane,
+                                        const double *upstream_source_inflow,
+                                        const double *wastewater_inflow,
+                                        const vector<vector<double>> &demand_outflow,
+                                        SourceLanes &lanes) {
+    const int r = lane;
+    double total_upstream_inflow = upstream_source_inflow[r] +
+                                   wastewater_inflow[r];
+    double available_volume_old = lanes.available_volume[r];
+
+    double direct_demand = 0.0;
+    for (const vector<double> &d : demand_outflow) {
+        direct_demand += d[r];
+    }
+
+    double min_env_outflow = (has_water_quality_pool ?
+                              min(lanes.min_environmental_outflow[r],
+                                  lanes.available_allocated_volumes.back()[r]) :
+                              lanes.min_environmental_outflow[r]);
+    double outflow = min_env_outflow;
+
+    double catchment_inflow = 0;
+    for (Catchment &c : catchments)
+        catchment_inflow += c.getStreamflow(week);
+
+    double evaporation =
+            (fixed_area ? area * evaporation_series.getEvaporation(week) :
+             storage_area_curve.get_dependent_variable(available_volume_old) *
+             evaporation_series.getEvaporation(week));
+
+    double volume = available_volume_old
+                    + total_upstream_inflow
+                    + catchment_inflow
+                    - direct_demand
+                    - min_env_outflow
+                    - evaporation;
+
+    for (unsigned long a = 0; a < lane_allocations.size(); ++a) {
+        lane_allocations[a] = lanes.available_allocated_volumes[a][r];
+    }
+
+    if (volume > capacity) {
+        for (int &u : utilities_with_allocations)
+            lane_allocations[u] = this->capacity * allocated_fractions[u];
+        outflow = min_env_outflow + volume - capacity;
+        volume = capacity;
+    } else {
+        double net_inflow = catchment_inflow + total_upstream_inflow -
+                            evaporation;
+        int n_allocations = (int) utilities_with_allocations.size();
+        if (has_water_quality_pool) {
+            double negative_utility_allocation = 0;
+            for (int i = 0; i < n_allocations - 1; ++i) {
+                int u = utilities_with_allocations[i];
+                lane_allocations[u] += net_inflow * allocated_fractions[u] -
+                                       demand_outflow[u][r];
+                if (lane_allocations[u] > allocated_capacities[u])
+                    return false;
+                if (lane_allocations[u] < 0) {
+                    negative_utility_allocation += lane_allocations[u];
+                    lane_allocations[u] = 0;
+                }
+            }
+
+            int u = utilities_with_allocations.back();
+            lane_allocations[u] += net_inflow * allocated_fractions[u] -
+                                   min_env_outflow +
+                                   negative_utility_allocation;
+            if (lane_allocations[u] > allocated_capacities[u] ||
+                lane_allocations[u] < 0)
+                return false;
+        } else {
+            net_inflow -= min_env_outflow;
+            for (int &u : utilities_with_allocations) {
+                lane_allocations[u] += net_inflow * allocated_fractions[u] -
+                                       demand_outflow[u][r];
+                if (lane_allocations[u] > allocated_capacities[u])
+                    return false;
+            }
+        }
+    }
+
+    // Same sanity checks as applyContinuity, whose errors are left to it.
+    double sum_allocations = accumulate(lane_allocations.begin(),
+                                        lane_allocations.end(), 0.);
+    double cont_error =
+            abs(available_volume_old - direct_demand + total_upstream_inflow +
+                catchment_inflow - evaporation - outflow - volume);
+    if ((int) abs(sum_allocations - volume) > 1 || abs(cont_error) > 1.f ||
+        volume < -1.f || sum_allocations < -1.f)
+        return false;
+    if (volume < 0)
+        volume = 0;
+
+    lanes.available_volume[r] = volume;
+    lanes.total_outflow[r] = outflow;
+    lanes.upstream_source_inflow[r] = upstream_source_inflow[r];
+    lanes.wastewater_inflow[r] = wastewater_inflow[r];
+    lanes.upstream_catchment_inflow[r] = catchment_inflow;
+    lanes.total_demand[r] = direct_demand;
+    lanes.min_environmental_outflow[r] = min_env_outflow;
+    lanes.evaporated_volume[r] = evaporation;
+    for (unsigned long a = 0; a < lane_allocations.size(); ++a) {
+        lanes.available_allocated_volumes[a][r] = lane_allocations[a];
+    }
+
+    return true;
+}
+
 void AllocatedReservoir::distributeStoredVolume(vector<double> &demand_outflow,
                                                 double total_upstream_inflow,
                                                 double available_volume_new) {
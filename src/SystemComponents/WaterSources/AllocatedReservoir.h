@@ -12,6 +12,9 @@ class AllocatedReservoir : public Reservoir {
 protected:
     const bool has_water_quality_pool;
     double continuity_error = NON_INITIALIZED;
+    /// Allocated volumes of the ROF year being updated in
+    /// applyContinuityLanes.
+    vector<double> lane_allocations;
 
 public:
     AllocatedReservoir(
@@ -71,6 +74,13 @@ public:
                              double wastewater_inflow,
                              vector<double> &demand_outflow) override;
 
+    void applyContinuityLanes(const int *weeks, int first_lane,
+                              int end_lane,
+                              const double *upstream_source_inflow,
+                              const double *wastewater_inflow,
+                              const vector<vector<double>> &demand_outflow,
+                              SourceLanes &lanes) override;
+
     void setFull() override;
 
     double getAvailableAllocatedVolume(int utility_id) override;
@@ -99,6 +109,12 @@ public:
 
     void setOnline() override;
 
+    bool continuityLane(int week, int lane,
+                        const double *upstream_source_inflow,
+                        const double *wastewater_inflow,
+                        const vector<vector<double>> &demand_outflow,
+                        SourceLanes &lanes);
+
     void distributeStoredVolume(vector<double> &demand_outflow,
                                 double total_upstream_inflow,
                                 double available_volume_new);
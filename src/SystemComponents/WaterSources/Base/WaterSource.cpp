@@ -529,6 +529,97 @@ WaterSource::continuityWaterSource(int week, double &upstream_source_inflow,
         bypass(week, upstream_source_inflow + wastewater_inflow);
 }
 
+/**
+ * Applies continuity to the water source for ROF years first_lane to
+ * end_lane - 1 at once. This default implementation swaps
+ * each year's state in and out of the source and calls
+ * continuityWaterSource, so it is exact for any source type, except for
+ * offline sources, which are bypassed for all lanes at once. Sources with a
+ * simple mass balance should override it with a loop over the lanes.
+ * @param weeks week of the streamflow records for each ROF year.
+ * @param first_lane first ROF year to be updated.
+ * @param end_lane one past the last ROF year to be updated.
+ * @param upstream_source_inflow upstream spillage for each ROF year.
+ * @param wastewater_inflow wastewater discharges for each ROF year.
+ * @param demand_outflow demand of each utility for each ROF year.
+ * @param lanes source state for each ROF year.
+ */
+void WaterSource::applyContinuityLanes(const int *weeks, int first_lane,
+                                       int end_lane,
+                                       const double *upstream_source_inflow,
+                                       const double *wastewater_inflow,
+                                       const vector<vector<double>> &demand_outflow,
+                                       SourceLanes &lanes) {
+    if (!online) {
+        bypassLanes(weeks, first_lane, end_lane, upstream_source_inflow,
+                    wastewater_inflow, lanes);
+        return;
+    }
+
+    lane_demand.resize(demand_outflow.size());
+    for (int r = first_lane; r < end_lane; ++r) {
+        for (unsigned long u = 0; u < lane_demand.size(); ++u) {
+            lane_demand[u] = demand_outflow[u][r];
+        }
+        double upstream = upstream_source_inflow[r];
+        double wastewater = wastewater_inflow[r];
+
+        loadLaneState(lanes, r);
+        continuityWaterSource(weeks[r], upstream, wastewater, lane_demand);
+        saveLaneState(lanes, r);
+    }
+}
+
+/**
+ * Copies the state carried by the source from one week to the next into one
+ * lane of the batched ROF state.
+ * @param lanes
+ * @param lane
+ */
+void WaterSource::saveLaneState(SourceLanes &lanes, int lane) const {
+    lanes.available_volume[lane] = available_volume;
+    lanes.total_outflow[lane] = total_outflow;
+    lanes.upstream_source_inflow[lane] = upstream_source_inflow;
+    lanes.wastewater_inflow[lane] = wastewater_inflow;
+    lanes.upstream_catchment_inflow[lane] = upstream_catchment_inflow;
+    lanes.total_demand[lane] = total_demand;
+    lanes.min_environmental_outflow[lane] = min_environmental_outflow;
+    lanes.evaporated_volume[lane] = evaporated_volume;
+
+    if (lanes.available_allocated_volumes.size() !=
+        available_allocated_volumes.size()) {
+        lanes.available_allocated_volumes.assign(
+                available_allocated_volumes.size(),
+                vector<double>(NUMBER_REALIZATIONS_ROF, 0.));
+    }
+    for (unsigned long a = 0; a < available_allocated_volumes.size(); ++a) {
+        lanes.available_allocated_volumes[a][lane] =
+                available_allocated_volumes[a];
+    }
+}
+
+/**
+ * Sets the state carried by the source from one week to the next to that of
+ * one lane of the batched ROF state.
+ * @param lanes
+ * @param lane
+ */
+void WaterSource::loadLaneState(const SourceLanes &lanes, int lane) {
+    available_volume = lanes.available_volume[lane];
+    total_outflow = lanes.total_outflow[lane];
+    upstream_source_inflow = lanes.upstream_source_inflow[lane];
+    wastewater_inflow = lanes.wastewater_inflow[lane];
+    upstream_catchment_inflow = lanes.upstream_catchment_inflow[lane];
+    total_demand = lanes.total_demand[lane];
+    min_environmental_outflow = lanes.min_environmental_outflow[lane];
+    evaporated_volume = lanes.evaporated_volume[lane];
+
+    for (unsigned long a = 0; a < available_allocated_volumes.size(); ++a) {
+        available_allocated_volumes[a] =
+                lanes.available_allocated_volumes[a][lane];
+    }
+}
+
 /**
  * Does not apply continuity to the water source, by instead just treats it as
  * non existing, i.e. outflow = inflow + catchment_flow
@@ -549,6 +640,35 @@ void WaterSource::bypass(int week, double total_upstream_inflow) {
     this->upstream_source_inflow = total_upstream_inflow;
 }
 
+/**
+ * Same as bypass for ROF years first_lane to end_lane - 1 at once.
+ * @param weeks week of the streamflow records for each ROF year.
+ * @param first_lane
+ * @param end_lane
+ * @param upstream_source_inflow upstream spillage for each ROF year.
+ * @param wastewater_inflow wastewater discharges for each ROF year.
+ * @param lanes
+ */
+void WaterSource::bypassLanes(const int *weeks, int first_lane, int end_lane,
+                              const double *upstream_source_inflow,
+                              const double *wastewater_inflow,
+                              SourceLanes &lanes) {
+    for (int r = first_lane; r < end_lane; ++r) {
+        double total_upstream_inflow = upstream_source_inflow[r] +
+                                       wastewater_inflow[r];
+        double catchment_inflow = 0;
+        for (Catchment &c : catchments) {
+            catchment_inflow += c.getStreamflow(weeks[r]);
+        }
+
+        lanes.upstream_catchment_inflow[r] = catchment_inflow;
+        lanes.total_demand[r] = NONE;
+        lanes.available_volume[r] = NONE;
+        lanes.total_outflow[r] = catchment_inflow + total_upstream_inflow;
+        lanes.upstream_source_inflow[r] = total_upstream_inflow;
+    }
+}
+
 /**
  * If creating a new water source that can be allocated to different utilities,
  * this function must be overwritten to:
@@ -699,6 +819,58 @@ double WaterSource::getSupplyAllocatedFraction(int utility_id) {
     return 1.0;
 }
 
+/**
+ * Upper bound on the volume the source can lose in one week other than
+ * through demands and minimum environmental outflows, over the whole
+ * series of the current realization. Here, this is the volume lost to
+ * negative catchment inflows, if any.
+ * @return
+ */
+double WaterSource::getMaxWeeklyNaturalLoss() {
+    double max_loss = 0.;
+    double min_streamflow, max_streamflow;
+    for (Catchment &c : catchments) {
+        c.getStreamflowRange(min_streamflow, max_streamflow);
+        max_loss += max(0., -min_streamflow);
+    }
+
+    return max_loss;
+}
+
+/**
+ * Checks whether the minimum environmental outflow is certainly kept by the
+ * source's continuity over a period with the given largest losses. Only
+ * sources with a water quality pool constrain the outflow to what is left in
+ * the pool, which pays for the outflows, for its share of natural losses
+ * and for whatever utilities draw beyond their allocations.
+ * @param max_outflow largest total environmental outflow.
+ * @param max_natural_loss largest total loss to evaporation and negative
+ * inflows.
+ * @param utilities_max_demands largest total demand of each utility, by id.
+ * @return
+ */
+bool WaterSource::keepsMinEnvironmentalOutflow(
+        double max_outflow, double max_natural_loss,
+        const vector<double> &utilities_max_demands) const {
+    if (wq_pool_id == NON_INITIALIZED)
+        return true;
+
+    double pool_loss = max_outflow +
+                       allocated_fractions[wq_pool_id] * max_natural_loss;
+    for (int u : utilities_with_allocations)
+        if (u != wq_pool_id)
+            pool_loss += max(0., utilities_max_demands[u] +
+                                 allocated_fractions[u] * max_natural_loss -
+                                 available_allocated_volumes[u]);
+
+    return available_allocated_volumes[wq_pool_id] - pool_loss >=
+           min_environmental_outflow;
+}
+
+bool WaterSource::hasWaterQualityPool() const {
+    return wq_pool_id != NON_INITIALIZED;
+}
+
 double WaterSource::getEvaporated_volume() const {
     return evaporated_volume;
 }
@@ -730,13 +902,14 @@ void WaterSource::resetAllocations(
 }
 
 void WaterSource::setAvailableAllocatedVolumes(
-        vector<double> available_allocated_volumes, double available_volume) {
+        const vector<double> &available_allocated_volumes,
+        double available_volume) {
     if (!utilities_with_allocations.empty())
       this->available_allocated_volumes = available_allocated_volumes;
     this->available_volume = available_volume;
 }
 
-vector<double> WaterSource::getAvailable_allocated_volumes() const {
+const vector<double> &WaterSource::getAvailable_allocated_volumes() const {
     return available_allocated_volumes;
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include "../../Catchment.h"
 #include "../../../Utils/Constants.h"
+#include "../../../Utils/LaneState.h"
 #include "../../Bonds/Base/Bond.h"
 
 using namespace std;
@@ -44,6 +45,8 @@ protected:
     double evaporated_volume = 0;
     double total_treatment_capacity = 0;
     int highest_alloc_id = NON_INITIALIZED;
+    /// Scratch demands of one ROF year used by applyContinuityLanes.
+    vector<double> lane_demand;
 
     static int seed;
     virtual void applyContinuity(int week, double upstream_source_inflow,
@@ -52,6 +55,10 @@ protected:
 
     void bypass(int week, double total_upstream_inflow);
 
+    void bypassLanes(const int *weeks, int first_lane, int end_lane,
+                     const double *upstream_source_inflow,
+                     const double *wastewater_inflow, SourceLanes &lanes);
+
 public:
     const int id;
     string name;
@@ -110,6 +117,17 @@ public:
                                double &wastewater_inflow,
                                vector<double> &demand_outflow);
 
+    virtual void applyContinuityLanes(const int *weeks, int first_lane,
+                                      int end_lane,
+                                      const double *upstream_source_inflow,
+                                      const double *wastewater_inflow,
+                                      const vector<vector<double>> &demand_outflow,
+                                      SourceLanes &lanes);
+
+    void saveLaneState(SourceLanes &lanes, int lane) const;
+
+    void loadLaneState(const SourceLanes &lanes, int lane);
+
     virtual void addTreatmentCapacity(const double added_treatment_capacity, int utility_id);
 
     virtual void removeWater(int allocation_id, double volume);
@@ -167,9 +185,10 @@ public:
     void resetAllocations(const vector<double> *new_allocated_fractions);
 
     void setAvailableAllocatedVolumes(
-            vector<double> available_allocated_volumes, double available_volume);
+            const vector<double> &available_allocated_volumes,
+            double available_volume);
 
-    vector<double> getAvailable_allocated_volumes() const;
+    const vector<double> &getAvailable_allocated_volumes() const;
 
     const vector<int> &getUtilitiesWithAllocations() const;
 
@@ -183,6 +202,14 @@ public:
 
     virtual double getSupplyAllocatedFraction(int utility_id);
 
+    virtual double getMaxWeeklyNaturalLoss();
+
+    bool keepsMinEnvironmentalOutflow(
+            double max_outflow, double max_natural_loss,
+            const vector<double> &utilities_max_demands) const;
+
+    bool hasWaterQualityPool() const;
+
     Bond &getBond(int utility_id);
 
     void checkForInputErrorsConstruction();
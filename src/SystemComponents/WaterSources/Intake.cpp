@@ -95,6 +95,64 @@ void Intake::applyContinuity(int week, double upstream_source_inflow,
     this->wastewater_inflow = wastewater_inflow;
 }
 
+/**
+ * Intake mass balance for ROF years first_lane to end_lane - 1 at once. Same
+ * calculations as applyContinuity, but looping over the ROF years inside.
+ * @param weeks week of the streamflow records for each ROF year.
+ * @param first_lane first ROF year to be updated.
+ * @param end_lane one past the last ROF year to be updated.
+ * @param upstream_source_inflow
+ * @param wastewater_inflow
+ * @param demand_outflow demand of each utility for each ROF year.
+ * @param lanes
+ */
+void Intake::applyContinuityLanes(const int *weeks, int first_lane,
+                                  int end_lane,
+                                  const double *upstream_source_inflow,
+                                  const double *wastewater_inflow,
+                                  const vector<vector<double>> &demand_outflow,
+                                  SourceLanes &lanes) {
+    if (!online) {
+        WaterSource::applyContinuityLanes(weeks, first_lane, end_lane,
+                                          upstream_source_inflow,
+                                          wastewater_inflow, demand_outflow,
+                                          lanes);
+        return;
+    }
+
+    for (int r = first_lane; r < end_lane; ++r) {
+        double total_upstream_inflow = upstream_source_inflow[r] +
+                                       wastewater_inflow[r];
+
+        double total_demand = 0;
+        for (const vector<double> &d : demand_outflow) {
+            total_demand += d[r];
+        }
+
+        double catchment_inflow = 0;
+        double next_catchment_inflow = 0;
+        for (Catchment &c : catchments) {
+            catchment_inflow += c.getStreamflow(weeks[r]);
+            next_catchment_inflow += c.getStreamflow(weeks[r] + 1);
+        }
+
+        /// Demand added by policies only applies to the first ROF year, as
+        /// in applyContinuity.
+        total_demand += policy_added_demand;
+        policy_added_demand = 0;
+
+        lanes.available_volume[r] = min(total_treatment_capacity,
+                                        next_catchment_inflow -
+                                        lanes.min_environmental_outflow[r]);
+        lanes.total_demand[r] = total_demand;
+        lanes.total_outflow[r] = total_upstream_inflow + catchment_inflow -
+                                 total_demand;
+        lanes.upstream_catchment_inflow[r] = catchment_inflow;
+        lanes.upstream_source_inflow[r] = upstream_source_inflow[r];
+        lanes.wastewater_inflow[r] = wastewater_inflow[r];
+    }
+}
+
 void
 Intake::setRealization(unsigned long r, const vector<double> &rdm_factors) {
     WaterSource::setRealization(r, rdm_factors);
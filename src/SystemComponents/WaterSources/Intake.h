@@ -34,6 +34,13 @@ public:
     void applyContinuity(int week, double upstream_source_min_env_flow,
                              double wastewater_inflow, vector<double> &demand) override;
 
+    void applyContinuityLanes(const int *weeks, int first_lane,
+                              int end_lane,
+                              const double *upstream_source_inflow,
+                              const double *wastewater_inflow,
+                              const vector<vector<double>> &demand_outflow,
+                              SourceLanes &lanes) override;
+
     void
     setRealization(unsigned long r, const vector<double> &rdm_factors) override;
 
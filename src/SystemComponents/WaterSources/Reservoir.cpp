@@ -2,6 +2,8 @@
 // Created by bernardo on 1/12/17.
 //
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include "Reservoir.h"
 
@@ -353,6 +355,84 @@ void Reservoir::applyContinuity(int week, double upstream_source_inflow,
     this->wastewater_inflow = wastewater_inflow;
 }
 
+/**
+ * Reservoir mass balance for ROF years first_lane to
+ * end_lane - 1 at once. Same calculations as applyContinuity,
+ * but looping over the ROF years inside so that the loop can be vectorized.
+ * Sources derived from Reservoir with their own applyContinuity (e.g.
+ * quarries) use the generic lane implementation unless they override this
+ * method, as this mass balance is not theirs.
+ * @param weeks week of the streamflow records for each ROF year.
+ * @param first_lane first ROF year to be updated.
+ * @param end_lane one past the last ROF year to be updated.
+ * @param upstream_source_inflow
+ * @param wastewater_inflow
+ * @param demand_outflow demand of each utility for each ROF year.
+ * @param lanes
+ */
+#pragma GCC optimize("O3")
+void Reservoir::applyContinuityLanes(const int *weeks, int first_lane,
+                                     int end_lane,
+                                     const double *upstream_source_inflow,
+                                     const double *wastewater_inflow,
+                                     const vector<vector<double>> &demand_outflow,
+                                     SourceLanes &lanes) {
+    if (!online || source_type != RESERVOIR) {
+        WaterSource::applyContinuityLanes(weeks, first_lane, end_lane,
+                                          upstream_source_inflow,
+                                          wastewater_inflow, demand_outflow,
+                                          lanes);
+        return;
+    }
+
+    double *volume = lanes.available_volume.data();
+    double *outflow = lanes.total_outflow.data();
+    double *min_env_outflow = lanes.min_environmental_outflow.data();
+
+    for (int r = first_lane; r < end_lane; ++r) {
+        double total_upstream_inflow = upstream_source_inflow[r] +
+                                       wastewater_inflow[r];
+
+        double total_demand = 0;
+        for (const vector<double> &d : demand_outflow) {
+            total_demand += d[r];
+        }
+
+        double catchment_inflow = 0;
+        for (Catchment &c : catchments) {
+            catchment_inflow += c.getStreamflow(weeks[r]);
+        }
+
+        double evaporated_volume =
+                (fixed_area ? area : storage_area_curve
+                        .get_dependent_variable(volume[r])) *
+                evaporation_series.getEvaporation(weeks[r]);
+
+        double stored_volume_new = volume[r]
+                                   + total_upstream_inflow + catchment_inflow
+                                   - total_demand - min_env_outflow[r]
+                                   - evaporated_volume;
+        double outflow_new = min_env_outflow[r];
+
+        if (stored_volume_new > capacity) {
+            outflow_new += stored_volume_new - capacity;
+            stored_volume_new = capacity;
+        } else if (stored_volume_new < 0) {
+            outflow_new = max(outflow_new + stored_volume_new, 0.);
+            stored_volume_new = 0.;
+        }
+
+        lanes.total_demand[r] = total_demand + policy_added_demand;
+        lanes.evaporated_volume[r] = evaporated_volume;
+        lanes.upstream_catchment_inflow[r] = catchment_inflow;
+        lanes.upstream_source_inflow[r] = upstream_source_inflow[r];
+        lanes.wastewater_inflow[r] = wastewater_inflow[r];
+        volume[r] = stored_volume_new;
+        outflow[r] = outflow_new;
+    }
+    policy_added_demand = 0;
+}
+
 void Reservoir::setOnline() {
     WaterSource::setOnline();
 
@@ -371,6 +451,40 @@ double Reservoir::getArea() const {
     return area;
 }
 
+/**
+ * @return largest area the reservoir can have at any storage between empty
+ * and full.
+ */
+double Reservoir::getMaxArea() {
+    if (fixed_area)
+        return area;
+
+    // The storage-area curve is piecewise linear, so its largest value is
+    // at the ends of the storage range or on one side of a break point.
+    double max_area = max(storage_area_curve.get_dependent_variable(0.),
+                          storage_area_curve.get_dependent_variable(capacity));
+    for (double storage : storage_area_curve.getSeries_x()) {
+        if (storage > 0. && storage < capacity) {
+            max_area = max(max_area,
+                           storage_area_curve.get_dependent_variable(storage));
+            max_area = max(max_area, storage_area_curve.get_dependent_variable(
+                    nextafter(storage, capacity)));
+        }
+    }
+
+    return max_area;
+}
+
+/**
+ * Upper bound on the volume lost in one week to evaporation and negative
+ * catchment inflows.
+ * @return
+ */
+double Reservoir::getMaxWeeklyNaturalLoss() {
+    return WaterSource::getMaxWeeklyNaturalLoss() +
+           getMaxArea() * max(0., evaporation_series.getMaxEvaporation());
+}
+
 const DataSeries &Reservoir::getStorageAreaCurve() const {
     return storage_area_curve;
 }
@@ -109,6 +109,13 @@ public:
                              double wastewater_discharge,
                              vector<double> &demand_outflow) override;
 
+    void applyContinuityLanes(const int *weeks, int first_lane,
+                              int end_lane,
+                              const double *upstream_source_inflow,
+                              const double *wastewater_inflow,
+                              const vector<vector<double>> &demand_outflow,
+                              SourceLanes &lanes) override;
+
     void setOnline() override;
 
     void
@@ -116,6 +123,10 @@ public:
 
     double getArea() const;
 
+    double getMaxArea();
+
+    double getMaxWeeklyNaturalLoss() override;
+
     const DataSeries &getStorageAreaCurve() const;
 
     EvaporationSeries getEvaporationSeries() const;
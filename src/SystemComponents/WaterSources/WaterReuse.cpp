@@ -34,6 +34,32 @@ void WaterReuse::applyContinuity(int week, double upstream_source_inflow,
     treated_volume = min(total_demand, total_treatment_capacity);
 }
 
+/**
+ * Water reuse carries no state across weeks, so for ROF years only the
+ * treated volume of the last one is kept, as if they had been run one at a
+ * time.
+ */
+void WaterReuse::applyContinuityLanes(const int *weeks, int first_lane,
+                                      int end_lane,
+                                      const double *upstream_source_inflow,
+                                      const double *wastewater_inflow,
+                                      const vector<vector<double>> &demand_outflow,
+                                      SourceLanes &lanes) {
+    if (!online || first_lane == end_lane) {
+        WaterSource::applyContinuityLanes(weeks, first_lane, end_lane,
+                                          upstream_source_inflow,
+                                          wastewater_inflow, demand_outflow,
+                                          lanes);
+        return;
+    }
+
+    double total_demand = 0.;
+    for (const vector<double> &d : demand_outflow) {
+        total_demand += d[end_lane - 1];
+    }
+
+    treated_volume = min(total_demand, total_treatment_capacity);
+}
 
 WaterReuse &WaterReuse::operator=(const WaterReuse &water_reuse) {
     WaterSource::operator=(water_reuse);
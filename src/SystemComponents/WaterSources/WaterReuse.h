@@ -23,6 +23,13 @@ public:
                              double wastewater_discharge,
                              vector<double> &demand_outflow) override;
 
+    void applyContinuityLanes(const int *weeks, int first_lane,
+                              int end_lane,
+                              const double *upstream_source_inflow,
+                              const double *wastewater_inflow,
+                              const vector<vector<double>> &demand_outflow,
+                              SourceLanes &lanes) override;
+
     WaterReuse &operator=(const WaterReuse &water_reuse);
 
     double getReused_volume() const;
@@ -0,0 +1,52 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include "AllocationCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+static thread_local unsigned long allocations_count = 0;
+
+unsigned long AllocationCounter::count() {
+    return allocations_count;
+}
+
+void *operator new(std::size_t size) {
+    ++allocations_count;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#else
+
+unsigned long AllocationCounter::count() {
+    return 0;
+}
+
+#endif
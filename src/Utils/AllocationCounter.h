@@ -0,0 +1,23 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_ALLOCATIONCOUNTER_H
+#define TRIANGLEMODEL_ALLOCATIONCOUNTER_H
+
+/**
+ * Debug counter of heap allocations. When compiled with -DCOUNT_ALLOCATIONS
+ * the global operator new is replaced by one that counts the allocations made
+ * by each thread, so that the simulation can report how many allocations
+ * each simulated week makes. Without the flag count() always returns 0 and
+ * operator new is untouched.
+ */
+namespace AllocationCounter {
+    /**
+     * Number of heap allocations made so far by the calling thread.
+     * @return allocations count.
+     */
+    unsigned long count();
+}
+
+#endif //TRIANGLEMODEL_ALLOCATIONCOUNTER_H
@@ -57,6 +57,20 @@ namespace Constants {
     const int IMPORT_ROF_TABLES = -1;
     const double BASE_STORAGE_CAPACITY_MULTIPLIER = 4.;
 
+    const int ROF_TABLE_FLOAT64 = 0;
+    const int ROF_TABLE_UINT8 = 1; /// ROF as count of failed ROF years.
+    const int ROF_TABLE_FLOAT16 = 2;
+    const int ROF_TABLE_BREAKPOINTS = 3; /// Tiers where ROF counts change.
+
+    const int SERIES_FLOAT32 = 0; /// Exact for series read from csv files.
+    const int SERIES_FLOAT64 = 1;
+
+    const int TIME_SERIES_CSV = 0;
+    const int TIME_SERIES_BINARY = 1;
+    const int TIME_SERIES_BINARY_COMPRESSED = 2;
+    const int TIME_SERIES_CSV_ROUND_TRIP = 3; /// csv with exact values.
+    const int MAX_TEXT_FILES_IN_FLIGHT = 16;
+
     const bool ONLINE = true;
     const bool OFFLINE = false;
 
@@ -113,6 +127,8 @@ namespace Constants {
 
     const double INSURANCE_SHIFT_STORAGE_CURVES_THRESHOLD = 1. / 75;
     const int NO_OF_INSURANCE_STORAGE_TIERS = (int) std::round(1. / INSURANCE_SHIFT_STORAGE_CURVES_THRESHOLD);
+    // Largest shift of a reused insurance pricing trajectory, as a fraction of storage capacity.
+    const double INSURANCE_TRAJECTORY_MAX_SHIFT = 0.1;
 
     const int WATER_QUALITY_ALLOCATION = -1;
     const int ALL_PARAMS = -2;
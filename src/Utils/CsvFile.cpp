@@ -0,0 +1,311 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include "CsvFile.h"
+
+CsvFile::~CsvFile() {
+    close();
+}
+
+/**
+ * Memory maps a file read-only.
+ * @param file_name
+ * @return false if the file could not be opened.
+ */
+bool CsvFile::open(const string &file_name) {
+    close();
+
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    size = (size_t) file_stat.st_size;
+    if (size > 0) {
+        void *mapped_data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd,
+                                 0);
+        if (mapped_data == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            return false;
+        }
+        data = (const char *) mapped_data;
+    }
+    ::close(fd);
+
+    return true;
+}
+
+void CsvFile::close() {
+    if (data != nullptr)
+        munmap((void *) data, size);
+    data = nullptr;
+    size = 0;
+    line_begins.clear();
+    line_ends.clear();
+}
+
+/**
+ * Finds the first max_lines lines of the file as std::getline would read
+ * them, without their '\n'. A file ending with '\n' has no empty last line.
+ * @param max_lines
+ */
+void CsvFile::findLines(unsigned long max_lines) {
+    size_t position = 0;
+    while (position < size && line_begins.size() < max_lines) {
+        auto newline = (const char *) memchr(data + position, '\n',
+                                             size - position);
+        size_t end = newline ? (size_t) (newline - data) : size;
+        line_begins.push_back(position);
+        line_ends.push_back(end);
+        position = end + 1;
+    }
+}
+
+/**
+ * Parses a number the same way std::stof does, including ignoring leading
+ * white space and anything after the number, and converts it to double.
+ * Plain decimals with up to 7 significant digits and 10 decimal places, the
+ * bulk of the input files, are converted with a single float division, which
+ * is correctly rounded and therefore the same as strtof. Anything else goes
+ * through strtof.
+ * @param begin first character of the token.
+ * @param end one past the last character of the token.
+ * @param value parsed value.
+ * @return PARSED, or NOT_A_NUMBER or OUT_OF_RANGE if std::stof would have
+ * thrown invalid_argument or out_of_range.
+ */
+int CsvFile::parseFloat(const char *begin, const char *end, double &value) {
+    static const float powers_of_ten[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                          1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+    const char *c = begin;
+    bool negative = c != end && *c == '-';
+    if (c != end && (*c == '-' || *c == '+'))
+        ++c;
+    uint32_t mantissa = 0;
+    int n_digits = 0;
+    int n_decimals = 0;
+    for (; c != end && *c >= '0' && *c <= '9' && n_digits < 8; ++c, ++n_digits)
+        mantissa = mantissa * 10 + (*c - '0');
+    if (c != end && *c == '.') {
+        const char *point = c++;
+        for (; c != end && *c >= '0' && *c <= '9' && n_digits < 8;
+               ++c, ++n_digits)
+            mantissa = mantissa * 10 + (*c - '0');
+        n_decimals = (int) (c - point - 1);
+    }
+    if (c == end && n_digits > 0 && n_digits < 8 && n_decimals <= 10) {
+        float parsed = (float) mantissa / powers_of_ten[n_decimals];
+        value = negative ? -parsed : parsed;
+        return PARSED;
+    }
+
+    char buffer[64];
+    string long_token;
+    const char *token = buffer;
+    auto length = (size_t) (end - begin);
+    if (length < sizeof(buffer)) {
+        memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+    } else {
+        long_token.assign(begin, end);
+        token = long_token.c_str();
+    }
+
+    char *parsed_end;
+    errno = 0;
+    value = strtof(token, &parsed_end);
+
+    if (parsed_end == token)
+        return NOT_A_NUMBER;
+    if (errno == ERANGE)
+        return OUT_OF_RANGE;
+    return PARSED;
+}
+
+/**
+ * Reads a csv file into a table. See Utils::parse2DCsvFile.
+ * @param file_name
+ * @param max_lines
+ * @param rows_to_read
+ * @return table.
+ */
+vector<vector<double>> CsvFile::parse2D(
+        const string &file_name, unsigned long max_lines,
+        const vector<unsigned long> &rows_to_read) {
+    CsvFile csv_file;
+    if (!csv_file.open(file_name)) {
+        string error = "File " + file_name + " not found.";
+        throw invalid_argument(error);
+    }
+
+    // Lines 0 to max_lines + 1, or to the last row to read + 1, are read.
+    unsigned long last_line = (rows_to_read.empty() ? max_lines :
+                               *max_element(rows_to_read.begin(),
+                                            rows_to_read.end())) + 1;
+    csv_file.findLines(last_line + 1);
+    auto n_lines = (long) csv_file.line_begins.size();
+
+    vector<char> selected((unsigned long) n_lines, rows_to_read.empty());
+    for (unsigned long r : rows_to_read)
+        if ((long) r < n_lines)
+            selected[r] = true;
+
+    // Count the values each line may have, so that all lines can be parsed
+    // at once into a single buffer.
+    vector<size_t> offsets((unsigned long) n_lines + 1, 0);
+    long first_space_line = LONG_MAX;
+#pragma omp parallel for reduction(min:first_space_line)
+    for (long l = 0; l < n_lines; ++l) {
+        const char *line = csv_file.data + csv_file.line_begins[l];
+        size_t length = csv_file.line_ends[l] - csv_file.line_begins[l];
+        if (memchr(line, ' ', length) != nullptr)
+            first_space_line = min(first_space_line, l);
+        else if (selected[l] && length > 0 && line[0] != '#')
+            offsets[l + 1] = (size_t) count(line, line + length, ',') + 1;
+    }
+    // Lines after one with spaces would not have been read.
+    n_lines = min(n_lines, first_space_line);
+    offsets.resize((unsigned long) n_lines + 1);
+    partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    vector<double> values(offsets.back());
+    vector<size_t> n_values((unsigned long) n_lines, 0);
+    vector<pair<long, int>> not_numbers;
+    long first_out_of_range = LONG_MAX;
+#pragma omp parallel for schedule(dynamic, 64) reduction(min:first_out_of_range)
+    for (long l = 0; l < n_lines; ++l) {
+        if (offsets[l + 1] == offsets[l])
+            continue;
+
+        const char *token = csv_file.data + csv_file.line_begins[l];
+        const char *line_end = csv_file.data + csv_file.line_ends[l];
+        double *row = values.data() + offsets[l];
+        int c = 0;
+        while (true) {
+            auto comma = (const char *) memchr(token, ',', line_end - token);
+            // Like std::getline, do not read an empty token after the last
+            // comma.
+            if (comma == nullptr && token == line_end)
+                break;
+
+            double value;
+            int status = parseFloat(token, comma ? comma : line_end, value);
+            if (status == PARSED) {
+                row[n_values[l]++] = value;
+            } else if (status == NOT_A_NUMBER) {
+#pragma omp critical
+                not_numbers.emplace_back(l, c);
+            } else {
+                first_out_of_range = min(first_out_of_range, l);
+            }
+            c++;
+
+            if (comma == nullptr)
+                break;
+            token = comma + 1;
+        }
+    }
+
+    // Report values that are not numbers in the order they would be found
+    // reading the file line by line, up to the first line with an error.
+    sort(not_numbers.begin(), not_numbers.end());
+    for (auto &not_number : not_numbers) {
+        if (not_number.first > first_out_of_range)
+            break;
+        cout << "NaN found in file " << file_name << " line "
+             << not_number.first << " column " << not_number.second << endl;
+    }
+    if (first_out_of_range != LONG_MAX)
+        throw out_of_range("stof");
+    if (first_space_line != LONG_MAX) {
+        char error[500];
+        sprintf(error, "File %s seems to be space-separated.",
+                file_name.c_str());
+        throw std::invalid_argument(error);
+    }
+
+    vector<vector<double>> data((unsigned long) n_lines);
+#pragma omp parallel for
+    for (long l = 0; l < n_lines; ++l)
+        data[l].assign(values.data() + offsets[l],
+                       values.data() + offsets[l] + n_values[l]);
+
+    if (rows_to_read.empty())
+        return data;
+
+    vector<vector<double>> return_data;
+    for (unsigned long r : rows_to_read) {
+        if ((long) r >= n_lines) {
+            char error[500];
+            sprintf(error, "Row %lu was requested from file %s, which has "
+                           "%ld lines.", r, file_name.c_str(), n_lines);
+            throw invalid_argument(error);
+        }
+        return_data.push_back(data[r]);
+    }
+    return return_data;
+}
+
+/**
+ * Reads the first value of lines of a csv file into a vector. See
+ * Utils::parse1DCsvFile.
+ * @param file_name
+ * @param max_lines
+ * @param rows_to_read
+ * @return vector.
+ */
+vector<double> CsvFile::parse1D(const string &file_name,
+                                unsigned long max_lines,
+                                vector<unsigned long> rows_to_read) {
+    CsvFile csv_file;
+    if (!csv_file.open(file_name) && max_lines > 0) {
+        cerr << "Could not read file " << file_name << "\n";
+        throw invalid_argument("File not found.");
+    }
+    csv_file.findLines(max_lines);
+
+    vector<double> data;
+    for (unsigned long l = 0; l < csv_file.line_begins.size(); ++l) {
+        const char *line = csv_file.data + csv_file.line_begins[l];
+        const char *line_end = csv_file.data + csv_file.line_ends[l];
+        if ((line != line_end && line[0] == '#') ||
+            (!rows_to_read.empty() && l != rows_to_read[0]))
+            continue;
+
+        double value;
+        int status = parseFloat(line, line_end, value);
+        if (status == PARSED)
+            data.push_back(value);
+        else if (status == NOT_A_NUMBER)
+            cout << "NaN found in file " << file_name << " line " << l + 1
+                 << endl;
+        else
+            throw out_of_range("stof");
+
+        if (!rows_to_read.empty())
+            rows_to_read.erase(rows_to_read.begin());
+    }
+
+    return data;
+}
@@ -0,0 +1,59 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_CSVFILE_H
+#define TRIANGLEMODEL_CSVFILE_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Parser of numeric csv files behind Utils::parse2DCsvFile and
+ * Utils::parse1DCsvFile. The file is memory mapped and split into lines,
+ * which are parsed by several threads at once into a single buffer without
+ * creating a string per value. Results, including the handling of comment
+ * lines, of values that are not numbers and of lines with spaces, are the
+ * same as those of parsing the file line by line with std::stof.
+ */
+class CsvFile {
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+    vector<size_t> line_begins;
+    vector<size_t> line_ends;
+
+    void findLines(unsigned long max_lines);
+
+public:
+    static const int PARSED = 0;
+    static const int NOT_A_NUMBER = 1;
+    static const int OUT_OF_RANGE = 2;
+
+    CsvFile() = default;
+
+    CsvFile(const CsvFile &csv_file) = delete;
+
+    CsvFile &operator=(const CsvFile &csv_file) = delete;
+
+    ~CsvFile();
+
+    bool open(const string &file_name);
+
+    void close();
+
+    static vector<vector<double>> parse2D(
+            const string &file_name, unsigned long max_lines,
+            const vector<unsigned long> &rows_to_read);
+
+    static vector<double> parse1D(const string &file_name,
+                                  unsigned long max_lines,
+                                  vector<unsigned long> rows_to_read);
+
+    static int parseFloat(const char *begin, const char *end, double &value);
+};
+
+
+#endif //TRIANGLEMODEL_CSVFILE_H
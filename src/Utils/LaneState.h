@@ -0,0 +1,88 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_LANESTATE_H
+#define TRIANGLEMODEL_LANESTATE_H
+
+#include <vector>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+/**
+ * State of one water source across all NUMBER_REALIZATIONS_ROF synthetic
+ * years of the ROF calculations. Each vector holds one lane per ROF year, so
+ * that the batched ROF continuity step can advance all years of a source
+ * in one contiguous loop.
+ */
+struct SourceLanes {
+    vector<double> available_volume;
+    vector<double> total_outflow;
+    vector<double> upstream_source_inflow;
+    vector<double> wastewater_inflow;
+    vector<double> upstream_catchment_inflow;
+    vector<double> total_demand;
+    vector<double> min_environmental_outflow;
+    vector<double> evaporated_volume;
+    /// [allocation id][lane], empty for sources without allocations.
+    vector<vector<double>> available_allocated_volumes;
+    /// whether utilities draw from available_allocated_volumes or from
+    /// available_volume.
+    bool allocated = false;
+
+    SourceLanes() :
+            available_volume(NUMBER_REALIZATIONS_ROF, 0.),
+            total_outflow(NUMBER_REALIZATIONS_ROF, 0.),
+            upstream_source_inflow(NUMBER_REALIZATIONS_ROF, 0.),
+            wastewater_inflow(NUMBER_REALIZATIONS_ROF, 0.),
+            upstream_catchment_inflow(NUMBER_REALIZATIONS_ROF, 0.),
+            total_demand(NUMBER_REALIZATIONS_ROF, 0.),
+            min_environmental_outflow(NUMBER_REALIZATIONS_ROF, 0.),
+            evaporated_volume(NUMBER_REALIZATIONS_ROF, 0.) {}
+
+    /**
+     * Lanes of the volume a utility can draw from this source, which is the
+     * utility's allocation for allocated sources and the whole available
+     * volume otherwise.
+     * @param utility_id
+     * @return pointer to NUMBER_REALIZATIONS_ROF lanes.
+     */
+    const double *allocatedVolume(int utility_id) const {
+        return (allocated ? available_allocated_volumes[utility_id].data() :
+                available_volume.data());
+    }
+
+    /**
+     * Same as WaterSource::getAvailableSupplyVolume for one lane, which
+     * excludes the water quality pool of allocated sources.
+     * @param lane
+     * @return available volume for supply.
+     */
+    double availableSupplyVolume(int lane) const {
+        return (available_allocated_volumes.empty() ? available_volume[lane] :
+                available_volume[lane] -
+                available_allocated_volumes.back()[lane]);
+    }
+};
+
+/**
+ * State of one utility across all NUMBER_REALIZATIONS_ROF synthetic years of
+ * the ROF calculations. The unrestricted demand is not here because it is
+ * the same for all ROF years.
+ */
+struct UtilityLanes {
+    vector<double> total_available_volume;
+    vector<double> total_stored_volume;
+    vector<double> restricted_demand;
+    vector<double> unfulfilled_demand;
+
+    UtilityLanes() :
+            total_available_volume(NUMBER_REALIZATIONS_ROF, 0.),
+            total_stored_volume(NUMBER_REALIZATIONS_ROF, 0.),
+            restricted_demand(NUMBER_REALIZATIONS_ROF, 0.),
+            unfulfilled_demand(NUMBER_REALIZATIONS_ROF, 0.) {}
+};
+
+#endif //TRIANGLEMODEL_LANESTATE_H
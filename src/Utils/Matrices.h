@@ -18,12 +18,16 @@ class Matrix2D {
 private:
     int di_, dj_;
     unique_ptr<T[]> data_;
+    /// Points to data_ or, for views, to memory owned by someone else.
+    T *ptr_ = nullptr;
     bool not_initialized = true;
 public:
     Matrix2D();
 
     Matrix2D(int di, int dj);
 
+    Matrix2D(int di, int dj, T *external_data);
+
     T &operator()(int i, int j);        // Subscript operators often come in pairs
     T operator()(int i, int j) const;  // Subscript operators often come in pairs
     // ...
@@ -60,15 +64,36 @@ Matrix2D<T>::Matrix2D(int di, int dj) : di_(di), dj_(dj) {
     if (di == 0 || dj == 0)
         throw length_error("Matrix2D constructor has 0 size");
     data_ = unique_ptr<T[]>(new T[di * dj]);
-    fill_n(data_.get(), di_ * dj_, 0);
+    ptr_ = data_.get();
+    fill_n(ptr_, di_ * dj_, 0);
+}
+
+/**
+ * Creates a view of di x dj row-major data owned by someone else, such as a
+ * memory-mapped file, which must outlive the view and its copies. Copies of
+ * views are views of the same data.
+ * @param di
+ * @param dj
+ * @param external_data
+ */
+template<typename T>
+Matrix2D<T>::Matrix2D(int di, int dj, T *external_data) : di_(di), dj_(dj),
+                                                         ptr_(external_data) {
+    if (di == 0 || dj == 0)
+        throw length_error("Matrix2D constructor has 0 size");
 }
 
 template<typename T>
 Matrix2D<T>::Matrix2D(const Matrix2D<T> &m) : di_(m.di_), dj_(m.dj_), not_initialized(m.not_initialized) {
     if (di_ == 0 || dj_ == 0)
         throw length_error("Matrix2D dimensions has 0 size");
-    data_ = unique_ptr<T[]>(new T[di_ * dj_]);
-    std::copy(m.data_.get(), m.data_.get() + di_ * dj_, data_.get());
+    if (m.data_) {
+        data_ = unique_ptr<T[]>(new T[di_ * dj_]);
+        ptr_ = data_.get();
+        std::copy(m.ptr_, m.ptr_ + di_ * dj_, ptr_);
+    } else {
+        ptr_ = m.ptr_;
+    }
 }
 
 template<typename T>
@@ -83,8 +108,14 @@ Matrix2D<T> &Matrix2D<T>::operator=(const Matrix2D<T> &m) {
     dj_ = m.dj_;
     if (di_ == 0 || dj_ == 0)
         throw length_error("Matrix2D dimensions has 0 size");
-    data_ = unique_ptr<T[]>(new T[di_ * dj_]);
-    std::copy(m.data_.get(), m.data_.get() + di_ * dj_, data_.get());
+    if (m.data_) {
+        data_ = unique_ptr<T[]>(new T[di_ * dj_]);
+        ptr_ = data_.get();
+        std::copy(m.ptr_, m.ptr_ + di_ * dj_, ptr_);
+    } else {
+        data_.reset();
+        ptr_ = m.ptr_;
+    }
     return *this;
 }
 
@@ -95,7 +126,7 @@ Matrix2D<T> &Matrix2D<T>::operator+=(const Matrix2D<T> &m) {
         throw length_error("Matrixes of different sizes cannot be added.");
 
     for (int i = 0; i < di_ * dj_; ++i) {
-        data_[i] += m.data_[i];
+        ptr_[i] += m.ptr_[i];
     }
     return *this;
 }
@@ -104,7 +135,7 @@ template<typename T>
 Matrix2D<T> &Matrix2D<T>::operator/(const double n) {
 
     for (int i = 0; i < di_ * dj_; ++i) {
-        data_[i] /= n;
+        ptr_[i] /= n;
     }
     return *this;
 }
@@ -117,7 +148,7 @@ T &Matrix2D<T>::operator()(int i, int j) {
                                to_string(j) + " (>" + to_string(dj_) + "?)";
         std::throw_with_nested(std::length_error(error_message.c_str()));
     }
-    return data_[dj_ * i + j];
+    return ptr_[dj_ * i + j];
 }
 
 template<typename T>
@@ -128,13 +159,13 @@ T Matrix2D<T>::operator()(int i, int j) const {
                                to_string(j) + " (>" + to_string(dj_) + "?)";
         std::throw_with_nested(std::length_error(error_message.c_str()));
     }
-    return data_[dj_ * i + j];
+    return ptr_[dj_ * i + j];
 }
 
 template<typename T>
 void Matrix2D<T>::print(int i) const {
     for (int j = 0; j < dj_; ++j) {
-        printf("%0.2f ", data_[dj_ * i + j]);
+        printf("%0.2f ", ptr_[dj_ * i + j]);
     }
     printf("\n");
 }
@@ -146,25 +177,25 @@ void Matrix2D<T>::setData(T *data, int length) {
                     to_string(length) + " vs. " + to_string(di_*dj_);
         throw_with_nested(invalid_argument(er.c_str()));
     }
-    memcpy(data_.get(), data, length * sizeof(T));
+    memcpy(ptr_, data, length * sizeof(T));
 }
 
 template<typename T>
 void Matrix2D<T>::setPartialData(unsigned long i, T *data, unsigned long length) {
-    if (i * dj_ + length > di_ * dj_) {
+    if (i * dj_ + length > (unsigned long) di_ * dj_) {
         throw length_error("Matrix2D subscript out of bounds");
     }
-    memcpy(data_.get() + i * dj_, data, length * sizeof(T));
+    memcpy(ptr_ + i * dj_, data, length * sizeof(T));
 }
 
 template<typename T>
 T *Matrix2D<T>::getPointerToElement(int i, int j) const {
-    return data_.get() + i * dj_ + j;
+    return ptr_ + i * dj_ + j;
 }
 
 template<typename T>
 void Matrix2D<T>::reset(T value) {
-    fill_n(data_.get(), di_ * dj_, value);
+    fill_n(ptr_, di_ * dj_, value);
 }
 
 template<typename T>
@@ -187,7 +218,7 @@ void Matrix2D<T>::add_to_position(int i, int j, T *data,
                                   int length) {
     int pos0 = i * dj_ + j;
     for (int p = 0; p < length; ++p) {
-        data_[pos0 + p] += data[p];
+        ptr_[pos0 + p] += data[p];
     }
 }
 
@@ -197,7 +228,7 @@ const vector<vector<T>> Matrix2D<T>::get_vector() const {
     for (int i = 0; i < di_; ++i) {
         vector<T> row;
         for (int j = 0; j < dj_; ++j) {
-            row.push_back(data_[dj_ * i + j]);
+            row.push_back(ptr_[dj_ * i + j]);
         }
         vector_matrix.push_back(row);
     }
@@ -18,33 +18,18 @@ double ObjectivesCalculator::calculateReliabilityObjective(
         n_realizations = realizations.size();
     }
 
-    unsigned long n_weeks = utility_collector[realizations[0]]->getCombined_storage().size();
+    unsigned long n_weeks = (unsigned long)
+            utility_collector[realizations[0]]->getN_weeks_collected();
     unsigned long n_years = (unsigned long) round(n_weeks / WEEKS_IN_YEAR);
 
-    vector<vector<int>> realizations_year_reliabilities(
-            utility_collector.size(), vector<int>(n_years, NON_INITIALIZED));
     vector<int> year_reliabilities(n_years, 0);
 
-    /// Creates a table with years that failed in each realization.
-    for (const unsigned long &r : realizations) {
-        for (unsigned long y = 0; y < n_years; ++y) {
-            for (int w = (int) round(y * WEEKS_IN_YEAR);
-                 w <
-                 (int) min((int) n_weeks, (int) round((y + 1) * WEEKS_IN_YEAR));
-                 ++w) {
-                if (utility_collector[r]->getCombined_storage()[w] /
-                    utility_collector[r]->getCapacity()[w] <
-                    STORAGE_CAPACITY_RATIO_FAIL) {
-                    realizations_year_reliabilities[r][y] = FAILURE;
-                }
-            }
-        }
-    }
-
     /// Creates a vector with the number of realizations that failed for each year.
-    for (unsigned long y = 0; y < n_years; ++y) {
-        for (const unsigned long &r : realizations) {
-            if (realizations_year_reliabilities[r][y] == FAILURE)
+    for (const unsigned long &r : realizations) {
+        const vector<bool> &failure_years =
+                utility_collector[r]->getFailure_years();
+        for (unsigned long y = 0; y < min(n_years, failure_years.size()); ++y) {
+            if (failure_years[y])
                 year_reliabilities[y]++;
         }
     }
@@ -85,23 +70,20 @@ double ObjectivesCalculator::calculateRestrictionFrequencyObjective(
 
     // Check if there were restriction policies in place.
     if (!restriction_data.empty()) {
-        unsigned long n_weeks = restriction_data[realizations[0]]->getRestriction_multipliers().size();
+        unsigned long n_weeks = (unsigned long)
+                restriction_data[realizations[0]]->getN_weeks_collected();
         unsigned long n_years = (unsigned long) round(n_weeks / WEEKS_IN_YEAR);
 
         double restriction_frequency = 0;
 
         // Counts how many years across all realizations had restrictions.
         for (const unsigned long &r : realizations) {
-            for (unsigned long y = 0; y < n_years; ++y) {
-                for (int w = (int) round(y * WEEKS_IN_YEAR);
-                     w < (int) min((int) n_weeks,
-                                   (int) round((y + 1) * WEEKS_IN_YEAR)); ++w) {
-                    if (restriction_data[r]->getRestriction_multipliers()[w] !=
-                        1.0) {
-                        restriction_frequency++;
-                        break;
-                    }
-                }
+            const vector<bool> &restriction_years =
+                    restriction_data[r]->getRestriction_years();
+            for (unsigned long y = 0;
+                 y < min(n_years, restriction_years.size()); ++y) {
+                if (restriction_years[y])
+                    restriction_frequency++;
             }
         }
 
@@ -131,11 +113,8 @@ double ObjectivesCalculator::calculateNetPresentCostInfrastructureObjective(
 
     double infrastructure_npc = 0;
     for (const unsigned long &r : realizations) {
-        auto realization = utility_data[r];
-        infrastructure_npc += accumulate(
-                realization->getNet_present_infrastructure_cost().begin(),
-                realization->getNet_present_infrastructure_cost().end(),
-                0.);
+        infrastructure_npc +=
+                utility_data[r]->getNet_present_infrastructure_cost_sum();
     }
 
     return infrastructure_npc / n_realizations;
@@ -153,52 +132,28 @@ double ObjectivesCalculator::calculatePeakFinancialCostsObjective(
         n_realizations = realizations.size();
     }
 
-    unsigned long n_weeks = utility_data[realizations[0]]->getGross_revenues().size();
+    unsigned long n_weeks = (unsigned long)
+            utility_data[realizations[0]]->getN_weeks_collected();
     unsigned long n_years = (unsigned long) round(n_weeks / WEEKS_IN_YEAR);
-    double discount_rate = utility_data[0]->getUtility()->getInfraDiscountRate();
+    double discount_rate = utility_data[0]->getInfra_discount_rate();
 
-    double realizations_year_debt_payment = 0;
-    double realizations_year_cont_fund_contribution = 0;
-    double realizations_year_gross_revenue = 1e-6;
-    double realizations_year_insurance_contract_cost = 0;
+    FinancialAmounts open_year = FinancialAmounts::startOfYear();
+    vector<FinancialAmounts> years;
     vector<double> year_financial_costs;
     vector<double> realization_financial_costs(utility_data.size(), 0);
 
     // Creates a table with years that failed in each realization.
-    int y;
     for (const unsigned long &r : realizations) {
         year_financial_costs.assign(n_years, 0.0);
-        y = 0;
-        for (unsigned long w = 0; w < n_weeks; ++w) {
-            // accumulate year's info by summing weekly amounts.
-            realizations_year_debt_payment +=
-                    utility_data[r]->getDebt_service_payments()[w];
-            realizations_year_cont_fund_contribution +=
-                    utility_data[r]->getContingency_fund_contribution()[w];
-            realizations_year_gross_revenue +=
-                    utility_data[r]->getGross_revenues()[w];
-            realizations_year_insurance_contract_cost +=
-                    utility_data[r]->getInsurance_contract_cost()[w];
-
-            // if last week of the year, close the books and calculate
-            // financial cost for the year.
-            if (Utils::isFirstWeekOfTheYear(w + 1)) {
-                year_financial_costs[y] +=
-                        (realizations_year_debt_payment +
-                         realizations_year_cont_fund_contribution +
-                         realizations_year_insurance_contract_cost) /
-//                                realizations_year_gross_revenue;
-                        (realizations_year_gross_revenue *
-                         (1. + pow(1. + discount_rate, y)));
-                // update year count.
-                y++;
-
-                // reset accounts.
-                realizations_year_debt_payment = 0;
-                realizations_year_cont_fund_contribution = 0;
-                realizations_year_gross_revenue = 1e-6;
-                realizations_year_insurance_contract_cost = 0;
-            }
+        sumFinancialYears(utility_data[r], open_year, years);
+        for (int y = 0; y < (int) min(years.size(), n_years); ++y) {
+            // financial cost of each year whose books are closed.
+            year_financial_costs[y] +=
+                    (years[y].debt_service_payments +
+                     years[y].contingency_fund_contribution +
+                     years[y].insurance_contract_cost) /
+                    (years[y].gross_revenue *
+                     (1. + pow(1. + discount_rate, y)));
         }
         // store highest year cost as the cost financial cost of the realization.
         realization_financial_costs[r] =
@@ -233,39 +188,27 @@ double ObjectivesCalculator::calculateWorseCaseCostsObjective(
         n_realizations = realizations.size();
     }
 
-    unsigned long n_weeks = utility_data[realizations[0]]->getGross_revenues().size();
+    unsigned long n_weeks = (unsigned long)
+            utility_data[realizations[0]]->getN_weeks_collected();
     unsigned long n_years = (unsigned long) round(n_weeks / WEEKS_IN_YEAR);
-    double discount_rate = utility_data[0]->getUtility()->getInfraDiscountRate();
+    double discount_rate = utility_data[0]->getInfra_discount_rate();
 
+    FinancialAmounts open_year = FinancialAmounts::startOfYear();
+    vector<FinancialAmounts> years;
     vector<double> worse_year_financial_costs;
     vector<double> year_financial_costs;
-    double year_drought_mitigation_cost = 0;
-    double year_gross_revenue = 1e-6;
 
     // Creates a table with years that failed in each realization.
-    int y;
     for (const unsigned long &r : realizations) {
-        y = 0;
         year_financial_costs.assign(n_years, 0);
-        for (unsigned long w = 0; w < n_weeks; ++w) {
-            // accumulate year's info by summing weekly amounts.
-            year_drought_mitigation_cost +=
-                    utility_data[r]->getDrought_mitigation_cost()[w];
-            year_gross_revenue += utility_data[r]->getGross_revenues()[w];
-
-            // if last week of the year, close the books and calculate financial cost for the year.
-            if (Utils::isFirstWeekOfTheYear(w + 1)) {
-                year_financial_costs[y] =
-                        max(year_drought_mitigation_cost
-                            - utility_data[r]->getContingency_fund_size()[w],
-//                            0.0) / year_gross_revenue;
-                            0.0) / (year_gross_revenue * (1. + pow(1. + discount_rate, y)));
-
-                year_gross_revenue = 1e-6;
-                year_drought_mitigation_cost = 0;
-                // update year count.
-                y++;
-            }
+        sumFinancialYears(utility_data[r], open_year, years);
+        for (int y = 0; y < (int) min(years.size(), n_years); ++y) {
+            // financial cost of each year whose books are closed.
+            year_financial_costs[y] =
+                    max(years[y].drought_mitigation_cost
+                        - years[y].contingency_fund_size,
+                        0.0) / (years[y].gross_revenue *
+                                (1. + pow(1. + discount_rate, y)));
         }
         // store highest year cost as the drought mitigation cost of the realization.
         worse_year_financial_costs.push_back(*max_element(
@@ -287,3 +230,29 @@ double ObjectivesCalculator::calculateWorseCaseCostsObjective(
         return obj_value;
     }
 }
+
+/**
+ * Sums a realization's weekly financial amounts into years. Sums are only
+ * reset when a year ends, so weeks left at the end of a realization are
+ * added to the first year of the next realization calculated.
+ * @param utility_data collector of the realization.
+ * @param open_year sums carried over from the previous realization, updated
+ * to those carried over to the next one.
+ * @param years sums of each year of the realization that ended.
+ */
+void ObjectivesCalculator::sumFinancialYears(
+        const UtilitiesDataCollector *utility_data,
+        FinancialAmounts &open_year, vector<FinancialAmounts> &years) {
+    years.clear();
+    for (const FinancialAmounts &week :
+            utility_data->getFirst_financial_year_weeks())
+        open_year.add(week);
+    if (!utility_data->isFirst_financial_year_closed())
+        return;
+
+    years.push_back(open_year);
+    years.insert(years.end(),
+                 utility_data->getLater_financial_years().begin(),
+                 utility_data->getLater_financial_years().end());
+    open_year = utility_data->getOpen_financial_year();
+}
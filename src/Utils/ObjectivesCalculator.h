@@ -9,7 +9,16 @@
 #include "../DataCollector/UtilitiesDataCollector.h"
 #include "../DataCollector/RestrictionsDataCollector.h"
 
+/**
+ * Calculates the objectives from the yearly aggregates kept by the
+ * utilities' and restriction policies' data collectors, which are available
+ * whether or not time series were collected.
+ */
 class ObjectivesCalculator {
+private:
+    static void sumFinancialYears(const UtilitiesDataCollector *utility_data,
+                                  FinancialAmounts &open_year,
+                                  vector<FinancialAmounts> &years);
 
 public:
     static double calculateReliabilityObjective(
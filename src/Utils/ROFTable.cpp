@@ -0,0 +1,93 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include "ROFTable.h"
+
+ROFTable::ROFTable() = default;
+
+/**
+ * Creates a view of a table stored elsewhere.
+ * @param n_weeks number of rows of the table.
+ * @param n_tiers number of columns of the table.
+ * @param dtype ROF_TABLE_FLOAT64, ROF_TABLE_UINT8, ROF_TABLE_FLOAT16 or
+ * ROF_TABLE_BREAKPOINTS.
+ * @param data table in row-major order, or for breakpoint tables the
+ * uint32 index of the first breakpoint of each week and of the end of the
+ * last week, followed by the uint8 tier and uint8 count of each breakpoint.
+ * It must outlive the view.
+ * @param count_denominator number of ROF years the counts of uint8 and
+ * breakpoint tables are out of.
+ */
+ROFTable::ROFTable(int n_weeks, int n_tiers, int dtype, const void *data,
+                   double count_denominator)
+        : n_weeks(n_weeks), n_tiers(n_tiers), dtype(dtype), data(data),
+          count_denominator(count_denominator) {
+    if (dtype != ROF_TABLE_FLOAT64 && dtype != ROF_TABLE_UINT8 &&
+        dtype != ROF_TABLE_FLOAT16 && dtype != ROF_TABLE_BREAKPOINTS) {
+        char error[128];
+        sprintf(error, "Unknown ROF table data type %d.", dtype);
+        throw invalid_argument(error);
+    }
+
+    if (dtype == ROF_TABLE_BREAKPOINTS) {
+        week_breakpoints = (const uint32_t *) data;
+        breakpoint_tiers = (const uint8_t *) (week_breakpoints + n_weeks + 1);
+        breakpoint_counts = breakpoint_tiers + week_breakpoints[n_weeks];
+    }
+}
+
+int ROFTable::get_i() const {
+    return n_weeks;
+}
+
+int ROFTable::get_j() const {
+    return n_tiers;
+}
+
+int ROFTable::getDataType() const {
+    return dtype;
+}
+
+/**
+ * Converts a double into an IEEE 754 half precision number, rounding to the
+ * nearest representable value (ties to even).
+ * @param value
+ * @return half precision number bits.
+ */
+uint16_t ROFTable::encodeFloat16(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+
+    auto sign = (uint16_t) ((bits >> 48) & 0x8000);
+    int exponent = (int) ((bits >> 52) & 0x7FF) - 1023 + 15;
+    uint64_t mantissa = bits & 0xFFFFFFFFFFFFFULL;
+
+    // NaN and infinity.
+    if (((bits >> 52) & 0x7FF) == 0x7FF)
+        return (uint16_t) (sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    // Too large to be represented.
+    if (exponent >= 0x1F)
+        return (uint16_t) (sign | 0x7C00);
+
+    int shift = 42;
+    if (exponent <= 0) {
+        // Too small even for a subnormal.
+        if (exponent < -10)
+            return sign;
+        // Subnormal, with the implicit leading bit made explicit.
+        mantissa |= 1ULL << 52;
+        shift = 43 - exponent;
+        exponent = 0;
+    }
+
+    uint64_t half_mantissa = mantissa >> shift;
+    uint64_t remainder = mantissa & ((1ULL << shift) - 1);
+    uint64_t halfway = 1ULL << (shift - 1);
+    auto half = (uint16_t) (sign | (exponent << 10) | half_mantissa);
+    // Rounding up may carry into the exponent, which is still correct.
+    if (remainder > halfway || (remainder == halfway && (half & 1)))
+        ++half;
+
+    return half;
+}
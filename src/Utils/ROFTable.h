@@ -0,0 +1,142 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_ROFTABLE_H
+#define TRIANGLEMODEL_ROFTABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+/**
+ * Read-only view of an imported storage-ROF table of one utility, stored
+ * with one of the ROF_TABLE_* data types. Tables stored as uint8 hold the
+ * number of ROF years that failed out of count_denominator, which is exact
+ * since ROFs have a resolution of 1 / NUMBER_REALIZATIONS_ROF, and tables
+ * stored as float16 hold ROFs within 2^-11 relative error. Either takes an
+ * eighth or a fourth of the memory of a table of doubles. Values are decoded
+ * to double on lookup.
+ *
+ * Since ROFs only change in steps of 1 / NUMBER_REALIZATIONS_ROF as storage
+ * decreases, breakpoint tables only store, for each week, the tiers at
+ * which the count of failed ROF years changes and the count from each of
+ * them on, starting at tier 0. A lookup is a binary search over the few
+ * breakpoints of a week, and whole tables usually fit in cache.
+ */
+class ROFTable {
+private:
+    int n_weeks = 0;
+    int n_tiers = 0;
+    int dtype = ROF_TABLE_FLOAT64;
+    const void *data = nullptr;
+    double count_denominator = 1.;
+    /// Breakpoints of week w are [week_breakpoints[w], week_breakpoints[w+1]).
+    const uint32_t *week_breakpoints = nullptr;
+    const uint8_t *breakpoint_tiers = nullptr;
+    const uint8_t *breakpoint_counts = nullptr;
+
+    inline double valueAt(int week, int tier) const {
+        long i = (long) n_tiers * week + tier;
+        switch (dtype) {
+            case ROF_TABLE_UINT8:
+                return ((const uint8_t *) data)[i] / count_denominator;
+            case ROF_TABLE_FLOAT16:
+                return decodeFloat16(((const uint16_t *) data)[i]);
+            case ROF_TABLE_BREAKPOINTS: {
+                // Last breakpoint at or below tier, the first being tier 0.
+                const uint8_t *breakpoint = upper_bound(
+                        breakpoint_tiers + week_breakpoints[week],
+                        breakpoint_tiers + week_breakpoints[week + 1],
+                        (uint8_t) tier) - 1;
+                return breakpoint_counts[breakpoint - breakpoint_tiers] /
+                       count_denominator;
+            }
+            default:
+                return ((const double *) data)[i];
+        }
+    }
+
+public:
+    ROFTable();
+
+    ROFTable(int n_weeks, int n_tiers, int dtype, const void *data,
+             double count_denominator = 1.);
+
+    inline double operator()(int week, int tier) const {
+        if (week >= n_weeks || tier >= n_tiers) {
+            string error_message = "ROF table subscript out of bounds.\ni=" +
+                                   to_string(week) + " (>=" +
+                                   to_string(n_weeks) + "?)\nj=" +
+                                   to_string(tier) + " (>" +
+                                   to_string(n_tiers) + "?)";
+            std::throw_with_nested(std::length_error(error_message.c_str()));
+        }
+
+        return valueAt(week, tier);
+    }
+
+    /**
+     * Linearly interpolates the ROF of a week between the two tiers around
+     * a fractional tier, which is clamped to the first and last tiers. The
+     * week is not checked, so that lookups made every week are cheap.
+     * @param week
+     * @param tier fractional tier.
+     * @return
+     */
+    inline double interpolate(int week, double tier) const {
+        double last_tier = n_tiers - 1;
+        if (!(tier > 0.))
+            tier = 0.;
+        else if (tier > last_tier)
+            tier = last_tier;
+        int lower_tier = min((int) tier, n_tiers - 2);
+        double weight = tier - lower_tier;
+
+        double lower_rof = valueAt(week, lower_tier);
+        return lower_rof + weight * (valueAt(week, lower_tier + 1) - lower_rof);
+    }
+
+    int get_i() const;
+
+    int get_j() const;
+
+    int getDataType() const;
+
+    static uint16_t encodeFloat16(double value);
+
+    /**
+     * Converts an IEEE 754 half precision number into a double.
+     * @param value half precision number bits.
+     * @return value as a double.
+     */
+    static inline double decodeFloat16(uint16_t value) {
+        uint64_t sign = (uint64_t) (value & 0x8000) << 48;
+        uint64_t exponent = (value >> 10) & 0x1F;
+        uint64_t mantissa = value & 0x3FF;
+        uint64_t bits;
+
+        if (exponent == 0) {
+            // Zero and subnormals, which are mantissa * 2^-24.
+            double subnormal = mantissa * 5.9604644775390625e-08;
+            return sign ? -subnormal : subnormal;
+        } else if (exponent == 0x1F) {
+            bits = sign | 0x7FF0000000000000ULL | (mantissa << 42);
+        } else {
+            bits = sign | ((exponent - 15 + 1023) << 52) | (mantissa << 42);
+        }
+
+        double decoded;
+        memcpy(&decoded, &bits, sizeof(double));
+        return decoded;
+    }
+};
+
+
+#endif //TRIANGLEMODEL_ROFTABLE_H
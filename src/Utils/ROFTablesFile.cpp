@@ -0,0 +1,785 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "ROFTablesFile.h"
+#include "Utils.h"
+
+constexpr const char *ROFTablesFile::FILE_NAME;
+constexpr const char *ROFTablesFile::DENSE_FILE_NAME;
+constexpr const char *ROFTablesFile::MANIFEST_FILE_NAME;
+constexpr uint32_t ROFTablesFile::VERSION;
+
+static const char ROF_TABLES_MAGIC[8] = {'W', 'P', 'R', 'O', 'F', 'T', 'B',
+                                         '\0'};
+
+ROFTablesFile::ROFTablesFile() = default;
+
+ROFTablesFile::~ROFTablesFile() {
+    close();
+}
+
+/**
+ * Size in bytes of the tables in a file, padded to a multiple of 8 bytes.
+ * @param header
+ * @return size in bytes.
+ */
+size_t ROFTablesFile::dataSize(const ROFTablesFileHeader &header) {
+    size_t size = header.n_realizations * header.n_utilities *
+                  header.n_weeks * header.n_tiers *
+                  bytesPerValue((int) header.dtype);
+    return (size + 7) / 8 * 8;
+}
+
+/**
+ * Size in bytes of the tables in a breakpoint tables file, which is the end
+ * offset at the end of its table offsets.
+ * @param header
+ * @param file_data whole file, starting with the header.
+ * @param file_size size of the whole file in bytes.
+ * @return size in bytes, or 0 if the file is too small to hold the table
+ * offsets.
+ */
+size_t ROFTablesFile::breakpointsDataSize(const ROFTablesFileHeader &header,
+                                          const void *file_data,
+                                          size_t file_size) {
+    size_t n_tables = header.n_realizations * header.n_utilities;
+    if (file_size < sizeof(ROFTablesFileHeader) +
+                    (n_tables + 1) * sizeof(uint64_t))
+        return 0;
+
+    auto table_offsets = (const uint64_t *) ((const char *) file_data +
+                                             sizeof(ROFTablesFileHeader));
+    return (size_t) table_offsets[n_tables];
+}
+
+/**
+ * Size in bytes of each table entry stored with a given data type.
+ * @param dtype
+ * @return size in bytes, or 0 if the data type is unknown or has no fixed
+ * size per entry (breakpoints).
+ */
+size_t ROFTablesFile::bytesPerValue(int dtype) {
+    switch (dtype) {
+        case ROF_TABLE_FLOAT64:
+            return sizeof(double);
+        case ROF_TABLE_UINT8:
+            return sizeof(uint8_t);
+        case ROF_TABLE_FLOAT16:
+            return sizeof(uint16_t);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Data type corresponding to the name used in input files and in the
+ * command line.
+ * @param name "float64", "uint8", "float16" or "breakpoints".
+ * @return one of the ROF_TABLE_* data types.
+ */
+int ROFTablesFile::dataTypeFromName(const string &name) {
+    if (name == "float64")
+        return ROF_TABLE_FLOAT64;
+    else if (name == "uint8")
+        return ROF_TABLE_UINT8;
+    else if (name == "float16")
+        return ROF_TABLE_FLOAT16;
+    else if (name == "breakpoints")
+        return ROF_TABLE_BREAKPOINTS;
+
+    char error[256];
+    sprintf(error, "Unknown ROF tables data type \"%s\". Valid types are "
+                   "\"float64\", \"uint8\", \"float16\" and "
+                   "\"breakpoints\".", name.c_str());
+    throw invalid_argument(error);
+}
+
+/**
+ * Name of a data type used in input files and in the command line.
+ * @param dtype one of the ROF_TABLE_* data types.
+ * @return name.
+ */
+string ROFTablesFile::dataTypeName(int dtype) {
+    switch (dtype) {
+        case ROF_TABLE_FLOAT64:
+            return "float64";
+        case ROF_TABLE_UINT8:
+            return "uint8";
+        case ROF_TABLE_FLOAT16:
+            return "float16";
+        case ROF_TABLE_BREAKPOINTS:
+            return "breakpoints";
+        default:
+            char error[128];
+            sprintf(error, "Unknown ROF table data type %d.", dtype);
+            throw invalid_argument(error);
+    }
+}
+
+/**
+ * Checksum of a block of memory whose size is a multiple of 8 bytes. Each
+ * 64-bit word is mixed with its position before being added, so that the
+ * sum can be calculated by several threads at once.
+ * @param data
+ * @param size size in bytes.
+ * @return checksum.
+ */
+uint64_t ROFTablesFile::checksum(const void *data, size_t size) {
+    auto words = (const uint64_t *) data;
+    long n_words = (long) (size / sizeof(uint64_t));
+    uint64_t sum = 0;
+#pragma omp parallel for reduction(+:sum)
+    for (long i = 0; i < n_words; ++i) {
+        uint64_t x = words[i] ^ ((uint64_t) i * 0x9E3779B97F4A7C15ULL);
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        sum += x;
+    }
+    return sum;
+}
+
+/**
+ * Memory maps a binary ROF tables file read-only and checks its header.
+ * @param file_name
+ * @param verify_checksum whether to check the tables against the checksum
+ * in the header, which requires reading the whole file.
+ */
+void ROFTablesFile::open(const string &file_name, bool verify_checksum) {
+    close();
+    this->file_name = file_name;
+
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        char error[512];
+        sprintf(error, "Could not open ROF tables file %s.",
+                file_name.c_str());
+        throw invalid_argument(error);
+    }
+
+    struct stat file_stat{};
+    fstat(fd, &file_stat);
+    if ((size_t) file_stat.st_size < sizeof(ROFTablesFileHeader)) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "ROF tables file %s is too small to be a ROF tables "
+                       "file.", file_name.c_str());
+        throw invalid_argument(error);
+    }
+
+    mapped_size = (size_t) file_stat.st_size;
+    mapped_data = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped_data == MAP_FAILED) {
+        mapped_data = nullptr;
+        mapped_size = 0;
+        char error[512];
+        sprintf(error, "Could not memory map ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    memcpy(&header, mapped_data, sizeof(ROFTablesFileHeader));
+    size_t data_size = header.dtype == ROF_TABLE_BREAKPOINTS ?
+                       breakpointsDataSize(header, mapped_data, mapped_size) :
+                       dataSize(header);
+    char error[512] = "";
+    if (memcmp(header.magic, ROF_TABLES_MAGIC, sizeof(ROF_TABLES_MAGIC)) != 0) {
+        sprintf(error, "File %s is not a ROF tables file.", file_name.c_str());
+    } else if (header.version != VERSION) {
+        sprintf(error, "ROF tables file %s has version %u but version %u was "
+                       "expected.", file_name.c_str(), header.version, VERSION);
+    } else if (bytesPerValue((int) header.dtype) == 0 &&
+               header.dtype != ROF_TABLE_BREAKPOINTS) {
+        sprintf(error, "ROF tables file %s has unknown data type %u.",
+                file_name.c_str(), header.dtype);
+    } else if ((header.dtype == ROF_TABLE_UINT8 ||
+                header.dtype == ROF_TABLE_BREAKPOINTS) &&
+               header.count_denominator == 0) {
+        sprintf(error, "ROF tables file %s has tables of counts but no "
+                       "number of ROF years to divide them by.",
+                file_name.c_str());
+    } else if (mapped_size != sizeof(ROFTablesFileHeader) + data_size) {
+        sprintf(error, "ROF tables file %s has %lu bytes but its header "
+                       "indicates it should have %lu.", file_name.c_str(),
+                mapped_size, sizeof(ROFTablesFileHeader) + data_size);
+    } else if (verify_checksum &&
+               checksum((char *) mapped_data + sizeof(ROFTablesFileHeader),
+                        data_size) != header.checksum) {
+        sprintf(error, "Checksum of ROF tables file %s does not match the "
+                       "one in its header. The file may be corrupted or may "
+                       "not have been finalized.", file_name.c_str());
+    }
+
+    if (strlen(error) > 0) {
+        close();
+        throw invalid_argument(error);
+    }
+}
+
+void ROFTablesFile::close() {
+    if (mapped_data != nullptr) {
+        munmap(mapped_data, mapped_size);
+        mapped_data = nullptr;
+        mapped_size = 0;
+    }
+}
+
+bool ROFTablesFile::isOpen() const {
+    return mapped_data != nullptr;
+}
+
+const ROFTablesFileHeader &ROFTablesFile::getHeader() const {
+    return header;
+}
+
+/**
+ * Tables of the first n_realizations realizations of the file, as
+ * read-only views of the mapped file which are valid while the file is
+ * open.
+ * @param n_realizations
+ * @return tables [realization][utility].
+ */
+vector<vector<ROFTable>> ROFTablesFile::getTables(
+        unsigned long n_realizations) const {
+    if (n_realizations > header.n_realizations) {
+        char error[512];
+        sprintf(error, "ROF tables file %s has tables for %lu realizations "
+                       "but %lu were requested.", file_name.c_str(),
+                header.n_realizations, n_realizations);
+        throw invalid_argument(error);
+    }
+
+    auto data = (const char *) mapped_data + sizeof(ROFTablesFileHeader);
+    auto table_offsets = (const uint64_t *) data;
+    size_t table_size = header.n_weeks * header.n_tiers *
+                        bytesPerValue((int) header.dtype);
+    vector<vector<ROFTable>> tables(n_realizations);
+    for (unsigned long r = 0; r < n_realizations; ++r) {
+        for (unsigned long u = 0; u < header.n_utilities; ++u) {
+            unsigned long i = r * header.n_utilities + u;
+            tables[r].emplace_back(
+                    (int) header.n_weeks, (int) header.n_tiers,
+                    (int) header.dtype,
+                    data + (header.dtype == ROF_TABLE_BREAKPOINTS ?
+                            table_offsets[i] : i * table_size),
+                    (double) header.count_denominator);
+        }
+    }
+
+    return tables;
+}
+
+/**
+ * Creates a ROF tables file with all tables zeroed, to be filled with
+ * writeRealization and then finalized.
+ * @param file_name
+ * @param n_realizations
+ * @param n_utilities
+ * @param n_weeks
+ * @param n_tiers
+ * @param dtype data type in which tables will be stored, which cannot be
+ * breakpoints (see convertToBreakpoints).
+ */
+void ROFTablesFile::create(const string &file_name,
+                           unsigned long n_realizations,
+                           unsigned long n_utilities, unsigned long n_weeks,
+                           unsigned long n_tiers, int dtype) {
+    if (dtype == ROF_TABLE_BREAKPOINTS)
+        throw invalid_argument("Breakpoint ROF tables cannot be written one "
+                               "realization at a time. Write dense tables and "
+                               "convert them instead.");
+    if (bytesPerValue(dtype) == 0) {
+        char error[128];
+        sprintf(error, "Unknown ROF table data type %d.", dtype);
+        throw invalid_argument(error);
+    }
+    if (dtype == ROF_TABLE_UINT8 && NUMBER_REALIZATIONS_ROF > UINT8_MAX)
+        throw invalid_argument("ROF tables cannot be stored as uint8 counts "
+                               "with more than 255 ROF years.");
+
+    ROFTablesFileHeader header{};
+    memcpy(header.magic, ROF_TABLES_MAGIC, sizeof(ROF_TABLES_MAGIC));
+    header.version = VERSION;
+    header.dtype = (uint32_t) dtype;
+    header.count_denominator = (uint64_t) (dtype == ROF_TABLE_UINT8 ?
+                                           NUMBER_REALIZATIONS_ROF : 0);
+    header.n_realizations = n_realizations;
+    header.n_utilities = n_utilities;
+    header.n_weeks = n_weeks;
+    header.n_tiers = n_tiers;
+
+    int fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || pwrite(fd, &header, sizeof(header), 0) !=
+                  (ssize_t) sizeof(header) ||
+        ftruncate(fd, (off_t) (sizeof(header) + dataSize(header))) != 0) {
+        if (fd >= 0) ::close(fd);
+        char error[512];
+        sprintf(error, "Could not create ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+    ::close(fd);
+}
+
+/**
+ * Writes the first n_tiers tiers of the tables of all utilities of one
+ * realization into a file created with create, converting them to the
+ * file's data type. Different realizations can be written at the same time
+ * by different threads.
+ * @param file_name
+ * @param realization
+ * @param tables table of each utility for the realization.
+ */
+void ROFTablesFile::writeRealization(const string &file_name,
+                                     unsigned long realization,
+                                     vector<Matrix2D<double>> &tables) {
+    int fd = ::open(file_name.c_str(), O_RDWR);
+    ROFTablesFileHeader header{};
+    if (fd < 0 || pread(fd, &header, sizeof(header), 0) !=
+                  (ssize_t) sizeof(header)) {
+        if (fd >= 0) ::close(fd);
+        char error[512];
+        sprintf(error, "Could not open ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    if (realization >= header.n_realizations ||
+        tables.size() != header.n_utilities) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "ROF tables file %s has room for %lu realizations of "
+                       "%lu utilities but realization %lu of %lu utilities "
+                       "was to be written.", file_name.c_str(),
+                header.n_realizations, header.n_utilities, realization,
+                tables.size());
+        throw invalid_argument(error);
+    }
+
+    size_t table_size = header.n_weeks * header.n_tiers *
+                        bytesPerValue((int) header.dtype);
+    vector<char> buffer(table_size);
+    auto buffer_uint8 = (uint8_t *) buffer.data();
+    auto buffer_float16 = (uint16_t *) buffer.data();
+    for (unsigned long u = 0; u < header.n_utilities; ++u) {
+        for (unsigned long w = 0; w < header.n_weeks; ++w) {
+            double *row = tables[u].getPointerToElement((int) w, 0);
+            unsigned long i = w * header.n_tiers;
+            switch (header.dtype) {
+                case ROF_TABLE_UINT8:
+                    for (unsigned long t = 0; t < header.n_tiers; ++t)
+                        buffer_uint8[i + t] = (uint8_t) round(
+                                row[t] * header.count_denominator);
+                    break;
+                case ROF_TABLE_FLOAT16:
+                    for (unsigned long t = 0; t < header.n_tiers; ++t)
+                        buffer_float16[i + t] =
+                                ROFTable::encodeFloat16(row[t]);
+                    break;
+                default:
+                    memcpy(buffer.data() + i * sizeof(double), row,
+                           header.n_tiers * sizeof(double));
+            }
+        }
+        auto offset = (off_t) (sizeof(header) + (realization *
+                                                 header.n_utilities + u) *
+                                                table_size);
+        if (pwrite(fd, buffer.data(), table_size, offset) !=
+            (ssize_t) table_size) {
+            ::close(fd);
+            char error[512];
+            sprintf(error, "Could not write tables of realization %lu to ROF "
+                           "tables file %s.", realization,
+                    file_name.c_str());
+            throw runtime_error(error);
+        }
+    }
+    ::close(fd);
+}
+
+/**
+ * Writes the checksum of the tables into the header of a file once all
+ * realizations have been written.
+ * @param file_name
+ */
+void ROFTablesFile::finalize(const string &file_name) {
+    int fd = ::open(file_name.c_str(), O_RDWR);
+    ROFTablesFileHeader header{};
+    if (fd < 0 || pread(fd, &header, sizeof(header), 0) !=
+                  (ssize_t) sizeof(header)) {
+        if (fd >= 0) ::close(fd);
+        char error[512];
+        sprintf(error, "Could not open ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    struct stat file_stat{};
+    fstat(fd, &file_stat);
+    auto size = (size_t) file_stat.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "Could not memory map ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+    size_t data_size = header.dtype == ROF_TABLE_BREAKPOINTS ?
+                       breakpointsDataSize(header, data, size) :
+                       dataSize(header);
+    header.checksum = checksum((char *) data + sizeof(header),
+                               min(data_size, size - sizeof(header)));
+    munmap(data, size);
+
+    if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "Could not write header of ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+    ::close(fd);
+}
+
+/**
+ * Converts the tables_rX_uY.csv files of realizations 0 to n_realizations - 1
+ * in a directory into a binary ROF tables file in the same directory.
+ * Breakpoint tables are converted from a float64 file, which is kept as
+ * DENSE_FILE_NAME.
+ * @param directory
+ * @param n_realizations
+ * @param dtype data type in which tables will be stored.
+ */
+void ROFTablesFile::convertCSVTables(const string &directory,
+                                     unsigned long n_realizations,
+                                     int dtype) {
+    unsigned long n_utilities = 0;
+    while (ifstream(directory + "tables_r0_u" + to_string(n_utilities) +
+                    ".csv"))
+        ++n_utilities;
+    if (n_utilities == 0) {
+        char error[512];
+        sprintf(error, "No ROF tables CSV files found in %s.",
+                directory.c_str());
+        throw invalid_argument(error);
+    }
+
+    auto table_r0_u0 = Utils::parse2DCsvFile(directory + "tables_r0_u0.csv");
+    unsigned long n_weeks = table_r0_u0.size();
+    unsigned long n_tiers = table_r0_u0.at(0).size();
+
+    string file_name = directory + FILE_NAME;
+    create(file_name, n_realizations, n_utilities, n_weeks, n_tiers,
+           dtype == ROF_TABLE_BREAKPOINTS ? ROF_TABLE_FLOAT64 : dtype);
+    for (unsigned long r = 0; r < n_realizations; ++r) {
+        vector<Matrix2D<double>> tables;
+        for (unsigned long u = 0; u < n_utilities; ++u) {
+            string csv_file_name = directory + "tables_r" + to_string(r) +
+                                   "_u" + to_string(u) + ".csv";
+            auto table = Utils::parse2DCsvFile(csv_file_name);
+            if (table.size() != n_weeks || table.at(0).size() != n_tiers) {
+                char error[512];
+                sprintf(error, "ROF tables CSV file %s does not have the same "
+                               "dimensions as %stables_r0_u0.csv.",
+                        csv_file_name.c_str(), directory.c_str());
+                throw invalid_argument(error);
+            }
+            tables.emplace_back((int) n_weeks, (int) n_tiers);
+            for (unsigned long w = 0; w < n_weeks; ++w)
+                tables[u].setPartialData(w, table[w].data(), n_tiers);
+        }
+        writeRealization(file_name, r, tables);
+    }
+    finalize(file_name);
+
+    printf("Converted ROF tables of %lu realizations and %lu utilities in %s "
+           "into %s.\n", n_realizations, n_utilities, directory.c_str(),
+           file_name.c_str());
+
+    if (dtype == ROF_TABLE_BREAKPOINTS)
+        convertToBreakpoints(directory);
+}
+
+/**
+ * Converts the dense binary ROF tables file in a directory into breakpoint
+ * tables, which only store the tiers at which ROFs change (see ROFTable).
+ * The dense file is renamed to DENSE_FILE_NAME and the breakpoint tables
+ * take its place, so that they are imported instead. Lookups in the
+ * converted tables return the same values as in float64 and uint8 tables,
+ * while float16 values are rounded to the exact ROFs they approximate.
+ * The sizes of both files are printed.
+ * @param directory
+ */
+void ROFTablesFile::convertToBreakpoints(const string &directory) {
+    string file_name = directory + FILE_NAME;
+    string dense_file_name = directory + DENSE_FILE_NAME;
+
+    ROFTablesFile dense_file;
+    dense_file.open(file_name);
+    ROFTablesFileHeader header = dense_file.getHeader();
+    if (header.dtype == ROF_TABLE_BREAKPOINTS) {
+        char error[512];
+        sprintf(error, "ROF tables file %s already has breakpoint tables.",
+                file_name.c_str());
+        throw invalid_argument(error);
+    }
+    if (header.n_tiers > UINT8_MAX + 1 || header.n_weeks * header.n_tiers >
+                                          UINT32_MAX) {
+        char error[512];
+        sprintf(error, "Tables in ROF tables file %s are too large to be "
+                       "stored as breakpoints.", file_name.c_str());
+        throw invalid_argument(error);
+    }
+    if (rename(file_name.c_str(), dense_file_name.c_str()) != 0) {
+        char error[512];
+        sprintf(error, "Could not rename ROF tables file %s to %s.",
+                file_name.c_str(), dense_file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    auto dense_tables = dense_file.getTables(header.n_realizations);
+    size_t dense_size = sizeof(header) + dataSize(header);
+    size_t float64_size = sizeof(header) + header.n_realizations *
+                                           header.n_utilities *
+                                           header.n_weeks * header.n_tiers *
+                                           sizeof(double);
+    double count_denominator = header.dtype == ROF_TABLE_UINT8 ?
+                               (double) header.count_denominator :
+                               (double) NUMBER_REALIZATIONS_ROF;
+    header.dtype = ROF_TABLE_BREAKPOINTS;
+    header.count_denominator = (uint64_t) count_denominator;
+    header.checksum = 0;
+
+    int fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        char error[512];
+        sprintf(error, "Could not create ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    unsigned long n_tables = header.n_realizations * header.n_utilities;
+    vector<uint64_t> table_offsets(n_tables + 1);
+    uint64_t offset = (n_tables + 1) * sizeof(uint64_t);
+    unsigned long n_breakpoints = 0;
+    vector<uint32_t> week_breakpoints(header.n_weeks + 1);
+    vector<uint8_t> tiers;
+    vector<uint8_t> counts;
+    vector<char> buffer;
+    for (unsigned long i = 0; i < n_tables; ++i) {
+        const ROFTable &table = dense_tables[i / header.n_utilities]
+                                            [i % header.n_utilities];
+        tiers.clear();
+        counts.clear();
+        for (int w = 0; w < (int) header.n_weeks; ++w) {
+            week_breakpoints[w] = (uint32_t) tiers.size();
+            for (int t = 0; t < (int) header.n_tiers; ++t) {
+                // Float16 ROFs are within 2^-11 relative error of the count.
+                double count = table(w, t) * count_denominator;
+                double rounded_count = round(count);
+                if (!(abs(count - rounded_count) < 0.05) ||
+                    rounded_count < 0 || rounded_count > UINT8_MAX) {
+                    ::close(fd);
+                    char error[512];
+                    sprintf(error, "ROF %f of week %d and tier %d of "
+                                   "realization %lu and utility %lu in %s is "
+                                   "not a multiple of 1/%d, so tables cannot "
+                                   "be stored as breakpoints.", table(w, t),
+                            w, t, i / header.n_utilities,
+                            i % header.n_utilities, dense_file_name.c_str(),
+                            (int) count_denominator);
+                    throw invalid_argument(error);
+                }
+                if (t == 0 || (uint8_t) rounded_count != counts.back()) {
+                    tiers.push_back((uint8_t) t);
+                    counts.push_back((uint8_t) rounded_count);
+                }
+            }
+        }
+        week_breakpoints[header.n_weeks] = (uint32_t) tiers.size();
+        n_breakpoints += tiers.size();
+
+        size_t index_size = week_breakpoints.size() * sizeof(uint32_t);
+        size_t table_size = (index_size + 2 * tiers.size() + 7) / 8 * 8;
+        buffer.assign(table_size, 0);
+        memcpy(buffer.data(), week_breakpoints.data(), index_size);
+        memcpy(buffer.data() + index_size, tiers.data(), tiers.size());
+        memcpy(buffer.data() + index_size + tiers.size(), counts.data(),
+               counts.size());
+
+        table_offsets[i] = offset;
+        if (pwrite(fd, buffer.data(), table_size,
+                   (off_t) (sizeof(header) + offset)) !=
+            (ssize_t) table_size) {
+            ::close(fd);
+            char error[512];
+            sprintf(error, "Could not write breakpoint tables to ROF tables "
+                           "file %s.", file_name.c_str());
+            throw runtime_error(error);
+        }
+        offset += table_size;
+    }
+    table_offsets[n_tables] = offset;
+
+    size_t offsets_size = table_offsets.size() * sizeof(uint64_t);
+    if (pwrite(fd, table_offsets.data(), offsets_size, sizeof(header)) !=
+        (ssize_t) offsets_size ||
+        pwrite(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "Could not write ROF tables file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+    ::close(fd);
+    finalize(file_name);
+
+    size_t breakpoints_size = sizeof(header) + offset;
+    printf("Converted ROF tables in %s into breakpoint tables in %s, keeping "
+           "the dense tables in %s. %lu breakpoints for %lu table entries "
+           "take %lu bytes instead of %lu (%lu as float64), a compression "
+           "ratio of %.1f (%.1f relative to float64).\n", directory.c_str(),
+           file_name.c_str(), dense_file_name.c_str(), n_breakpoints,
+           (unsigned long) (n_tables * header.n_weeks * header.n_tiers),
+           breakpoints_size, dense_size, float64_size,
+           (double) dense_size / breakpoints_size,
+           (double) float64_size / breakpoints_size);
+}
+
+/**
+ * Name of the file with the tables generated by one of several processes,
+ * such as MPI ranks, each generating the tables of the realizations r with
+ * r % n_shards == shard.
+ * @param directory
+ * @param shard
+ * @return file name.
+ */
+string ROFTablesFile::shardFileName(const string &directory, int shard) {
+    return directory + "rof_tables_shard_" + to_string(shard) + ".bin";
+}
+
+/**
+ * Merges the ROF tables files generated by n_shards processes (see
+ * shardFileName) into a single ROF tables file in the same directory, which
+ * is described in a manifest file. Each shard file has room for all
+ * realizations, and the tables of realization r are taken from shard
+ * r % n_shards. Shard files are deleted once merged.
+ * @param directory
+ * @param n_shards
+ * @param convert_to_breakpoints whether to convert the merged tables into
+ * breakpoint tables (see convertToBreakpoints).
+ */
+void ROFTablesFile::mergeShards(const string &directory, int n_shards,
+                                bool convert_to_breakpoints) {
+    if (n_shards < 1) {
+        char error[128];
+        sprintf(error, "Cannot merge %d ROF tables shards.", n_shards);
+        throw invalid_argument(error);
+    }
+
+    vector<ROFTablesFile> shards((unsigned long) n_shards);
+    for (int k = 0; k < n_shards; ++k) {
+        shards[k].open(shardFileName(directory, k));
+        const ROFTablesFileHeader &shard_header = shards[k].header;
+        const ROFTablesFileHeader &first_header = shards[0].header;
+        if (shard_header.dtype != first_header.dtype ||
+            shard_header.n_realizations != first_header.n_realizations ||
+            shard_header.n_utilities != first_header.n_utilities ||
+            shard_header.n_weeks != first_header.n_weeks ||
+            shard_header.n_tiers != first_header.n_tiers) {
+            char error[512];
+            sprintf(error, "ROF tables shard %s does not have the same data "
+                           "type and dimensions as %s.",
+                    shards[k].file_name.c_str(),
+                    shards[0].file_name.c_str());
+            throw invalid_argument(error);
+        }
+        if (shard_header.dtype == ROF_TABLE_BREAKPOINTS) {
+            char error[512];
+            sprintf(error, "ROF tables shard %s has breakpoint tables, which "
+                           "cannot be merged.", shards[k].file_name.c_str());
+            throw invalid_argument(error);
+        }
+    }
+
+    const ROFTablesFileHeader &header = shards[0].header;
+    string file_name = directory + FILE_NAME;
+    create(file_name, header.n_realizations, header.n_utilities,
+           header.n_weeks, header.n_tiers, (int) header.dtype);
+
+    int fd = ::open(file_name.c_str(), O_WRONLY);
+    size_t realization_size = header.n_utilities * header.n_weeks *
+                              header.n_tiers *
+                              bytesPerValue((int) header.dtype);
+    for (unsigned long r = 0; r < header.n_realizations; ++r) {
+        size_t offset = sizeof(header) + r * realization_size;
+        auto shard_data = (const char *) shards[r % n_shards].mapped_data;
+        if (fd < 0 || pwrite(fd, shard_data + offset, realization_size,
+                             (off_t) offset) != (ssize_t) realization_size) {
+            if (fd >= 0) ::close(fd);
+            char error[512];
+            sprintf(error, "Could not write tables of realization %lu to ROF "
+                           "tables file %s.", r, file_name.c_str());
+            throw runtime_error(error);
+        }
+    }
+    ::close(fd);
+    finalize(file_name);
+
+    for (int k = 0; k < n_shards; ++k) {
+        shards[k].close();
+        remove(shardFileName(directory, k).c_str());
+    }
+
+    printf("Merged ROF tables of %lu realizations from %d shards into %s.\n",
+           header.n_realizations, n_shards, file_name.c_str());
+
+    if (convert_to_breakpoints)
+        convertToBreakpoints(directory);
+    writeManifest(directory, n_shards);
+}
+
+/**
+ * Writes a csv file describing the ROF tables file in a directory, with
+ * one parameter and its value per line.
+ * @param directory
+ * @param n_shards number of shards the tables were generated in.
+ */
+void ROFTablesFile::writeManifest(const string &directory, int n_shards) {
+    ROFTablesFile rof_tables_file;
+    rof_tables_file.open(directory + FILE_NAME, false);
+    const ROFTablesFileHeader &header = rof_tables_file.header;
+
+    string manifest_file_name = directory + MANIFEST_FILE_NAME;
+    ofstream manifest(manifest_file_name);
+    if (!manifest) {
+        char error[512];
+        sprintf(error, "Could not create ROF tables manifest %s.",
+                manifest_file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    manifest << "file," << FILE_NAME << "\n"
+             << "version," << header.version << "\n"
+             << "dtype," << dataTypeName((int) header.dtype) << "\n"
+             << "n_realizations," << header.n_realizations << "\n"
+             << "n_utilities," << header.n_utilities << "\n"
+             << "n_weeks," << header.n_weeks << "\n"
+             << "n_tiers," << header.n_tiers << "\n"
+             << "count_denominator," << header.count_denominator << "\n"
+             << "checksum," << header.checksum << "\n"
+             << "size," << rof_tables_file.mapped_size << "\n"
+             << "n_shards," << n_shards << "\n";
+}
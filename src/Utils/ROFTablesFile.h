@@ -0,0 +1,124 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_ROFTABLESFILE_H
+#define TRIANGLEMODEL_ROFTABLESFILE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+#include "Matrices.h"
+#include "ROFTable.h"
+
+/**
+ * Header of the binary ROF tables file. The header is followed by the
+ * tables of all realizations and utilities, stored with data type dtype
+ * (one of the ROF_TABLE_* constants) as [realization][utility][week][tier]
+ * in row-major order starting at byte sizeof(ROFTablesFileHeader), so that
+ * each utility's table of each realization can be used in place.
+ *
+ * Breakpoint tables have different sizes, so their data starts with the
+ * uint64 byte offset of each table relative to the end of the header, in
+ * [realization][utility] order, followed by the offset of the end of the
+ * data. Each table is laid out as described in ROFTable and padded to a
+ * multiple of 8 bytes.
+ */
+struct ROFTablesFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t n_realizations;
+    uint64_t n_utilities;
+    uint64_t n_weeks;
+    uint64_t n_tiers;
+    uint64_t checksum;
+    uint64_t count_denominator; /// ROF years per uint8 or breakpoint count.
+};
+
+/**
+ * Single-file binary storage for precomputed storage-ROF tables, replacing
+ * one CSV file per realization and utility. Imported files are memory
+ * mapped read-only, so tables are used without being parsed or copied and
+ * the pages are shared by all threads and by all processes (e.g. MPI ranks)
+ * on a node that map the same file.
+ */
+class ROFTablesFile {
+private:
+    ROFTablesFileHeader header;
+    void *mapped_data = nullptr;
+    size_t mapped_size = 0;
+    string file_name;
+
+    static size_t dataSize(const ROFTablesFileHeader &header);
+
+    static size_t breakpointsDataSize(const ROFTablesFileHeader &header,
+                                      const void *file_data,
+                                      size_t file_size);
+
+public:
+    static constexpr const char *FILE_NAME = "rof_tables.bin";
+    /// Dense tables kept when tables are converted into breakpoint tables.
+    static constexpr const char *DENSE_FILE_NAME = "rof_tables_dense.bin";
+    /// Description of tables merged from shards.
+    static constexpr const char *MANIFEST_FILE_NAME = "rof_tables_manifest.csv";
+    static constexpr uint32_t VERSION = 1;
+
+    ROFTablesFile();
+
+    ROFTablesFile(const ROFTablesFile &rof_tables_file) = delete;
+
+    ROFTablesFile &operator=(const ROFTablesFile &rof_tables_file) = delete;
+
+    ~ROFTablesFile();
+
+    void open(const string &file_name, bool verify_checksum = true);
+
+    void close();
+
+    bool isOpen() const;
+
+    const ROFTablesFileHeader &getHeader() const;
+
+    vector<vector<ROFTable>> getTables(unsigned long n_realizations) const;
+
+    static void create(const string &file_name, unsigned long n_realizations,
+                       unsigned long n_utilities, unsigned long n_weeks,
+                       unsigned long n_tiers, int dtype = ROF_TABLE_FLOAT64);
+
+    static void writeRealization(const string &file_name,
+                                 unsigned long realization,
+                                 vector<Matrix2D<double>> &tables);
+
+    static void finalize(const string &file_name);
+
+    static void convertCSVTables(const string &directory,
+                                 unsigned long n_realizations,
+                                 int dtype = ROF_TABLE_FLOAT64);
+
+    static void convertToBreakpoints(const string &directory);
+
+    static string shardFileName(const string &directory, int shard);
+
+    static void mergeShards(const string &directory, int n_shards,
+                            bool convert_to_breakpoints = false);
+
+    static void writeManifest(const string &directory, int n_shards);
+
+    static int dataTypeFromName(const string &name);
+
+    static string dataTypeName(int dtype);
+
+    static size_t bytesPerValue(int dtype);
+
+    static uint64_t checksum(const void *data, size_t size);
+};
+
+
+#endif //TRIANGLEMODEL_ROFTABLESFILE_H
@@ -0,0 +1,113 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <cstdio>
+#include <stdexcept>
+#include "ROFTablesWriter.h"
+#include "ROFTablesFile.h"
+
+/**
+ * Starts the I/O threads.
+ * @param file_name ROF tables file created with ROFTablesFile::create.
+ * @param max_queued_realizations number of realizations whose tables can
+ * wait to be written.
+ * @param n_io_threads number of threads writing tables.
+ */
+ROFTablesWriter::ROFTablesWriter(const string &file_name,
+                                 unsigned long max_queued_realizations,
+                                 int n_io_threads)
+        : file_name(file_name),
+          max_queued_realizations(max(max_queued_realizations, 1ul)) {
+    for (int t = 0; t < max(n_io_threads, 1); ++t)
+        io_threads.emplace_back(&ROFTablesWriter::writeQueuedTables, this);
+}
+
+ROFTablesWriter::~ROFTablesWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Errors are only reported by explicit calls to close.
+    }
+}
+
+/**
+ * Loop of the I/O threads, which write queued tables until the writer is
+ * closed and the queue is empty.
+ */
+void ROFTablesWriter::writeQueuedTables() {
+    unique_lock<mutex> lock(queue_mutex);
+    while (true) {
+        queue_not_empty.wait(lock, [this] {
+            return closing || !queue.empty();
+        });
+        if (queue.empty())
+            return;
+
+        Job job = move(queue.front());
+        queue.pop_front();
+        queue_not_full.notify_one();
+
+        lock.unlock();
+        string error;
+        try {
+            ROFTablesFile::writeRealization(file_name, job.realization,
+                                            job.tables);
+        } catch (const exception &e) {
+            error = e.what();
+        }
+        lock.lock();
+
+        if (!error.empty() && error_message.empty())
+            error_message = error;
+        written_tables.push_back(move(job.tables));
+    }
+}
+
+/**
+ * Queues the tables of a finished realization to be written, waiting if the
+ * queue is full. The tables are replaced by tables already written, or by
+ * new ones of the same size, which the caller is expected to reset before
+ * using them again.
+ * @param realization
+ * @param tables table of each utility for the realization.
+ */
+void ROFTablesWriter::push(unsigned long realization,
+                           vector<Matrix2D<double>> &tables) {
+    unique_lock<mutex> lock(queue_mutex);
+    queue_not_full.wait(lock, [this] {
+        return queue.size() < max_queued_realizations;
+    });
+
+    vector<Matrix2D<double>> replacement_tables;
+    if (!written_tables.empty()) {
+        replacement_tables = move(written_tables.back());
+        written_tables.pop_back();
+    } else {
+        replacement_tables.reserve(tables.size());
+        for (auto &table : tables)
+            replacement_tables.emplace_back(table.get_i(), table.get_j());
+    }
+    swap(tables, replacement_tables);
+
+    queue.push_back({realization, move(replacement_tables)});
+    queue_not_empty.notify_one();
+}
+
+/**
+ * Waits for all queued tables to be written and stops the I/O threads.
+ * Throws an exception if any tables could not be written.
+ */
+void ROFTablesWriter::close() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        closing = true;
+    }
+    queue_not_empty.notify_all();
+    for (auto &io_thread : io_threads)
+        if (io_thread.joinable())
+            io_thread.join();
+
+    if (!error_message.empty())
+        throw runtime_error(error_message);
+}
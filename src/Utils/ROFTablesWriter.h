@@ -0,0 +1,71 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_ROFTABLESWRITER_H
+#define TRIANGLEMODEL_ROFTABLESWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+#include "Matrices.h"
+
+/**
+ * Writes the storage-ROF tables of finished realizations into a binary ROF
+ * tables file (see ROFTablesFile) from background I/O threads, so that
+ * simulation threads go straight to their next realization instead of
+ * converting and writing tables.
+ *
+ * Tables are handed over by swapping them with tables that have already been
+ * written, so no tables are copied. At most max_queued_realizations
+ * realizations wait to be written, and threads handing over tables wait
+ * while the queue is full, which caps the memory taken by tables.
+ */
+class ROFTablesWriter {
+private:
+    struct Job {
+        unsigned long realization;
+        vector<Matrix2D<double>> tables;
+    };
+
+    const string file_name;
+    const unsigned long max_queued_realizations;
+
+    mutex queue_mutex;
+    condition_variable queue_not_empty;
+    condition_variable queue_not_full;
+    deque<Job> queue;
+    /// Tables already written, to be swapped with the next ones queued.
+    vector<vector<Matrix2D<double>>> written_tables;
+    vector<thread> io_threads;
+    bool closing = false;
+    string error_message;
+
+    void writeQueuedTables();
+
+public:
+    ROFTablesWriter(const string &file_name,
+                    unsigned long max_queued_realizations, int n_io_threads);
+
+    ROFTablesWriter(const ROFTablesWriter &rof_tables_writer) = delete;
+
+    ROFTablesWriter &operator=(const ROFTablesWriter &rof_tables_writer) =
+            delete;
+
+    ~ROFTablesWriter();
+
+    void push(unsigned long realization, vector<Matrix2D<double>> &tables);
+
+    void close();
+};
+
+
+#endif //TRIANGLEMODEL_ROFTABLESWRITER_H
@@ -0,0 +1,523 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "SimulationOutputFile.h"
+
+constexpr uint32_t SimulationOutputFile::VERSION;
+constexpr uint32_t SimulationOutputFile::NO_COMPRESSION;
+constexpr uint32_t SimulationOutputFile::XOR_RLE_COMPRESSION;
+
+static const char SIMULATION_OUTPUT_MAGIC[8] = {'W', 'P', 'O', 'U', 'T', 'P',
+                                                'T', '\0'};
+
+static size_t bytesPerValue(int dtype) {
+    return dtype == SERIES_FLOAT32 ? sizeof(float) : sizeof(double);
+}
+
+/**
+ * Name of the column in exported csv files, which is the group followed by
+ * the column's name in the group's compact csv files (e.g.
+ * Utilities.0st_vol).
+ * @return
+ */
+string SimulationOutputColumn::name() const {
+    return group + "." + to_string(component_id) + variable;
+}
+
+/**
+ * Creates the file and writes its header and schema.
+ * @param file_name
+ * @param columns
+ * @param dtype SERIES_FLOAT32 or SERIES_FLOAT64.
+ * @param compression NO_COMPRESSION or XOR_RLE_COMPRESSION.
+ * @param first_week week of the simulation of the first value of each
+ * chunk's columns.
+ * @param week_step weeks between consecutive values of the columns.
+ */
+SimulationOutputFile::Writer::Writer(
+        const string &file_name, const vector<SimulationOutputColumn> &columns,
+        int dtype, uint32_t compression, unsigned long first_week,
+        unsigned long week_step) : file_name(file_name) {
+    if (dtype != SERIES_FLOAT32 && dtype != SERIES_FLOAT64) {
+        char error[128];
+        sprintf(error, "Unknown time series data type %d.", dtype);
+        throw invalid_argument(error);
+    }
+
+    stringstream schema;
+    for (const SimulationOutputColumn &column : columns)
+        schema << column.group << "\t" << column.component_id << "\t"
+               << column.component_name << "\t" << column.variable << "\n";
+    string schema_string = schema.str();
+
+    header = SimulationOutputFileHeader{};
+    memcpy(header.magic, SIMULATION_OUTPUT_MAGIC,
+           sizeof(SIMULATION_OUTPUT_MAGIC));
+    header.version = VERSION;
+    header.dtype = (uint32_t) dtype;
+    header.compression = compression;
+    header.week_step = (uint32_t) week_step;
+    header.first_week = first_week;
+    header.n_columns = columns.size();
+    header.schema_size = schema_string.size();
+
+    output_file.open(file_name, ios::binary | ios::trunc);
+    output_file.write((const char *) &header, sizeof(header));
+    output_file.write(schema_string.data(), schema_string.size());
+    if (!output_file) {
+        char error[512];
+        sprintf(error, "Could not create simulation output file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+}
+
+SimulationOutputFile::Writer::~Writer() {
+    try {
+        close();
+    } catch (...) {
+        // Errors are only reported by explicit calls to close.
+    }
+}
+
+/**
+ * Encodes the values of a realization into a chunk, which starts with the
+ * size in bytes of each column's data. Can be called by several threads at
+ * once.
+ * @param values weekly values of each column, all with the same number of
+ * weeks.
+ * @return chunk.
+ */
+vector<char> SimulationOutputFile::Writer::encodeChunk(
+        const vector<vector<double>> &values) const {
+    if (values.size() != header.n_columns) {
+        char error[256];
+        sprintf(error, "Chunk with %lu columns written to simulation output "
+                       "file %s, which has %lu.",
+                (unsigned long) values.size(), file_name.c_str(),
+                (unsigned long) header.n_columns);
+        throw invalid_argument(error);
+    }
+
+    size_t bytes_per_value = bytesPerValue((int) header.dtype);
+    vector<uint64_t> column_sizes(values.size());
+    vector<char> data(values.size() * sizeof(uint64_t));
+    vector<char> column_bytes;
+    for (unsigned long c = 0; c < values.size(); ++c) {
+        const vector<double> &column = values[c];
+        column_bytes.resize(column.size() * bytes_per_value);
+        if (header.dtype == SERIES_FLOAT32) {
+            for (unsigned long w = 0; w < column.size(); ++w) {
+                auto value = (float) column[w];
+                memcpy(&column_bytes[w * sizeof(float)], &value,
+                       sizeof(float));
+            }
+        } else if (!column.empty()) {
+            memcpy(column_bytes.data(), column.data(), column_bytes.size());
+        }
+
+        if (header.compression == XOR_RLE_COMPRESSION) {
+            vector<char> compressed = compress(column_bytes, bytes_per_value);
+            data.insert(data.end(), compressed.begin(), compressed.end());
+            column_sizes[c] = compressed.size();
+        } else {
+            data.insert(data.end(), column_bytes.begin(), column_bytes.end());
+            column_sizes[c] = column_bytes.size();
+        }
+    }
+    if (!column_sizes.empty())
+        memcpy(data.data(), column_sizes.data(),
+               column_sizes.size() * sizeof(uint64_t));
+
+    return data;
+}
+
+/**
+ * Appends an encoded chunk to the file.
+ * @param realization
+ * @param n_weeks number of weeks of each column of the chunk.
+ * @param data chunk returned by encodeChunk.
+ */
+void SimulationOutputFile::Writer::writeChunk(unsigned long realization,
+                                              unsigned long n_weeks,
+                                              const vector<char> &data) {
+    SimulationOutputChunk chunk{};
+    chunk.realization = realization;
+    chunk.n_weeks = n_weeks;
+    chunk.offset = (uint64_t) output_file.tellp();
+    chunk.size = data.size();
+    output_file.write(data.data(), data.size());
+    chunks.push_back(chunk);
+}
+
+/**
+ * Writes the index of chunks and the final header, and closes the file.
+ */
+void SimulationOutputFile::Writer::close() {
+    if (!output_file.is_open())
+        return;
+
+    header.n_chunks = chunks.size();
+    header.index_offset = (uint64_t) output_file.tellp();
+    output_file.write((const char *) chunks.data(),
+                      chunks.size() * sizeof(SimulationOutputChunk));
+    output_file.seekp(0);
+    output_file.write((const char *) &header, sizeof(header));
+    output_file.close();
+
+    if (!output_file) {
+        char error[512];
+        sprintf(error, "Could not write simulation output file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+}
+
+unsigned long SimulationOutputFile::Writer::getBytesWritten() const {
+    unsigned long bytes = 0;
+    for (const SimulationOutputChunk &chunk : chunks)
+        bytes += chunk.size;
+    return bytes;
+}
+
+SimulationOutputFile::SimulationOutputFile() = default;
+
+/**
+ * Reads the header, schema and index of chunks of a simulation output file.
+ * @param file_name
+ */
+void SimulationOutputFile::open(const string &file_name) {
+    this->file_name = file_name;
+    input_file.close();
+    input_file.clear();
+    input_file.open(file_name, ios::binary);
+    if (!input_file) {
+        char error[512];
+        sprintf(error, "Could not open simulation output file %s.",
+                file_name.c_str());
+        throw invalid_argument(error);
+    }
+
+    input_file.seekg(0, ios::end);
+    auto file_size = (uint64_t) input_file.tellg();
+    input_file.seekg(0);
+    header = SimulationOutputFileHeader{};
+    input_file.read((char *) &header, sizeof(header));
+
+    char error[512] = "";
+    if (!input_file || memcmp(header.magic, SIMULATION_OUTPUT_MAGIC,
+                              sizeof(SIMULATION_OUTPUT_MAGIC)) != 0) {
+        sprintf(error, "File %s is not a simulation output file.",
+                file_name.c_str());
+    } else if (header.version != VERSION) {
+        sprintf(error, "Simulation output file %s has version %u but "
+                       "version %u was expected.", file_name.c_str(),
+                header.version, VERSION);
+    } else if (header.dtype != SERIES_FLOAT32 &&
+               header.dtype != SERIES_FLOAT64) {
+        sprintf(error, "Simulation output file %s has unknown data type %u.",
+                file_name.c_str(), header.dtype);
+    } else if (header.index_offset < sizeof(header) + header.schema_size ||
+               header.index_offset + header.n_chunks *
+                                     sizeof(SimulationOutputChunk) !=
+               file_size) {
+        sprintf(error, "Simulation output file %s is truncated or was not "
+                       "closed.", file_name.c_str());
+    }
+    if (strlen(error) > 0)
+        throw invalid_argument(error);
+
+    string schema(header.schema_size, '\0');
+    input_file.read(&schema[0], schema.size());
+    columns.clear();
+    stringstream schema_stream(schema);
+    string line;
+    while (getline(schema_stream, line)) {
+        stringstream line_stream(line);
+        SimulationOutputColumn column;
+        string id;
+        getline(line_stream, column.group, '\t');
+        getline(line_stream, id, '\t');
+        getline(line_stream, column.component_name, '\t');
+        getline(line_stream, column.variable, '\t');
+        column.component_id = stoi(id);
+        columns.push_back(column);
+    }
+
+    chunks.resize(header.n_chunks);
+    input_file.seekg(header.index_offset);
+    input_file.read((char *) chunks.data(),
+                    chunks.size() * sizeof(SimulationOutputChunk));
+
+    if (columns.size() != header.n_columns || !input_file) {
+        sprintf(error, "Simulation output file %s has a corrupted schema or "
+                       "index.", file_name.c_str());
+        throw invalid_argument(error);
+    }
+}
+
+const SimulationOutputFileHeader &SimulationOutputFile::getHeader() const {
+    return header;
+}
+
+const vector<SimulationOutputColumn> &
+SimulationOutputFile::getColumns() const {
+    return columns;
+}
+
+const vector<SimulationOutputChunk> &SimulationOutputFile::getChunks() const {
+    return chunks;
+}
+
+/**
+ * Reads columns of a chunk.
+ * @param chunk index of the chunk.
+ * @param columns_to_read
+ * @return weekly values of each column read.
+ */
+vector<vector<double>> SimulationOutputFile::readChunk(
+        unsigned long chunk, const vector<unsigned long> &columns_to_read) {
+    const SimulationOutputChunk &chunk_info = chunks.at(chunk);
+    vector<char> data(chunk_info.size);
+    input_file.seekg(chunk_info.offset);
+    input_file.read(data.data(), data.size());
+    if (!input_file) {
+        char error[512];
+        sprintf(error, "Could not read chunk %lu of simulation output file "
+                       "%s.", chunk, file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    vector<uint64_t> column_offsets(header.n_columns + 1,
+                                    header.n_columns * sizeof(uint64_t));
+    for (unsigned long c = 0; c < header.n_columns; ++c) {
+        uint64_t size;
+        memcpy(&size, &data[c * sizeof(uint64_t)], sizeof(uint64_t));
+        column_offsets[c + 1] = column_offsets[c] + size;
+    }
+
+    size_t bytes_per_value = bytesPerValue((int) header.dtype);
+    vector<vector<double>> values;
+    for (unsigned long c : columns_to_read) {
+        const char *column_data = data.data() + column_offsets[c];
+        size_t column_size = column_offsets[c + 1] - column_offsets[c];
+        vector<char> column_bytes;
+        if (header.compression == XOR_RLE_COMPRESSION)
+            column_bytes = decompress(column_data, column_size,
+                                      chunk_info.n_weeks, bytes_per_value);
+        else
+            column_bytes.assign(column_data, column_data + column_size);
+
+        vector<double> column(chunk_info.n_weeks);
+        for (unsigned long w = 0; w < chunk_info.n_weeks; ++w) {
+            if (header.dtype == SERIES_FLOAT32) {
+                float value;
+                memcpy(&value, &column_bytes[w * sizeof(float)],
+                       sizeof(float));
+                column[w] = value;
+            } else {
+                memcpy(&column[w], &column_bytes[w * sizeof(double)],
+                       sizeof(double));
+            }
+        }
+        values.push_back(column);
+    }
+
+    return values;
+}
+
+/**
+ * Finds the columns matching any of the selectors, which can be a column
+ * name (e.g. Utilities.0st_vol), a column name without the group (0st_vol),
+ * a variable name (st_vol) or a group (Utilities).
+ * @param selectors selectors, or none for all columns.
+ * @return indices of the selected columns, in the order they are stored.
+ */
+vector<unsigned long> SimulationOutputFile::selectColumns(
+        const vector<string> &selectors) const {
+    vector<bool> selected(columns.size(), selectors.empty());
+    for (const string &selector : selectors) {
+        bool found = false;
+        for (unsigned long c = 0; c < columns.size(); ++c) {
+            const SimulationOutputColumn &column = columns[c];
+            if (selector == column.name() || selector == column.group ||
+                selector == column.variable ||
+                selector == to_string(column.component_id) + column.variable) {
+                selected[c] = true;
+                found = true;
+            }
+        }
+        if (!found) {
+            char error[512];
+            sprintf(error, "No column of simulation output file %s matches "
+                           "\"%s\".", file_name.c_str(), selector.c_str());
+            throw invalid_argument(error);
+        }
+    }
+
+    vector<unsigned long> selected_columns;
+    for (unsigned long c = 0; c < columns.size(); ++c)
+        if (selected[c])
+            selected_columns.push_back(c);
+    return selected_columns;
+}
+
+/**
+ * Exports columns of a simulation output file into a csv file with the
+ * same name and extension .csv, with one row per realization and week.
+ * @param file_name
+ * @param selectors selectors of the columns to export (see selectColumns),
+ * or none for all columns.
+ */
+void SimulationOutputFile::exportCSV(const string &file_name,
+                                     const vector<string> &selectors) {
+    SimulationOutputFile output_file;
+    output_file.open(file_name);
+    vector<unsigned long> selected_columns =
+            output_file.selectColumns(selectors);
+
+    size_t extension = file_name.rfind(".bin");
+    string csv_file_name =
+            (extension != string::npos && extension + 4 == file_name.size() ?
+             file_name.substr(0, extension) : file_name) + ".csv";
+    ofstream csv_file(csv_file_name);
+    csv_file << "realization,week";
+    for (unsigned long c : selected_columns)
+        csv_file << "," << output_file.columns[c].name();
+    csv_file << "\n";
+
+    int precision = output_file.header.dtype == SERIES_FLOAT32 ? 9 : 17;
+    char value[32];
+    for (unsigned long k = 0; k < output_file.chunks.size(); ++k) {
+        vector<vector<double>> values =
+                output_file.readChunk(k, selected_columns);
+        for (unsigned long w = 0; w < output_file.chunks[k].n_weeks; ++w) {
+            csv_file << output_file.chunks[k].realization << ","
+                     << output_file.header.first_week +
+                        w * output_file.header.week_step;
+            for (const vector<double> &column : values) {
+                snprintf(value, sizeof(value), ",%.*g", precision, column[w]);
+                csv_file << value;
+            }
+            csv_file << "\n";
+        }
+    }
+
+    if (!csv_file) {
+        char error[512];
+        sprintf(error, "Could not write csv file %s.", csv_file_name.c_str());
+        throw runtime_error(error);
+    }
+    printf("Exported %lu columns of %lu realizations of %s into %s.\n",
+           (unsigned long) selected_columns.size(),
+           (unsigned long) output_file.chunks.size(), file_name.c_str(),
+           csv_file_name.c_str());
+}
+
+/**
+ * Time series output format corresponding to the name used in the input
+ * file and command line.
+ * @param name "csv", "csv_round_trip", "binary" or "binary_compressed".
+ * @return one of the TIME_SERIES_* formats.
+ */
+int SimulationOutputFile::formatFromName(const string &name) {
+    if (name == "csv")
+        return TIME_SERIES_CSV;
+    else if (name == "csv_round_trip")
+        return TIME_SERIES_CSV_ROUND_TRIP;
+    else if (name == "binary")
+        return TIME_SERIES_BINARY;
+    else if (name == "binary_compressed")
+        return TIME_SERIES_BINARY_COMPRESSED;
+
+    char error[256];
+    sprintf(error, "Unknown time series output format \"%s\". Valid formats "
+                   "are \"csv\", \"csv_round_trip\", \"binary\" and \"binary_compressed\".",
+            name.c_str());
+    throw invalid_argument(error);
+}
+
+/**
+ * Compresses the bytes of a column's values. Each value is XORed with the
+ * previous one, so that repeated values become zeros and slowly changing
+ * values share their leading bytes, the bytes are grouped by their position
+ * in the values, and each run of zero bytes is stored as a zero followed by
+ * the length of the run (up to 255).
+ * @param values bytes of the values.
+ * @param bytes_per_value 4 or 8.
+ * @return compressed bytes.
+ */
+vector<char> SimulationOutputFile::compress(const vector<char> &values,
+                                            size_t bytes_per_value) {
+    size_t n_values = values.size() / bytes_per_value;
+    vector<unsigned char> planes(values.size());
+    uint64_t previous = 0;
+    for (size_t i = 0; i < n_values; ++i) {
+        uint64_t value = 0;
+        memcpy(&value, &values[i * bytes_per_value], bytes_per_value);
+        uint64_t delta = value ^ previous;
+        previous = value;
+        for (size_t b = 0; b < bytes_per_value; ++b)
+            planes[b * n_values + i] = (unsigned char) (delta >> (8 * b));
+    }
+
+    vector<char> compressed;
+    compressed.reserve(planes.size() / 4);
+    for (size_t i = 0; i < planes.size();) {
+        if (planes[i] != 0) {
+            compressed.push_back((char) planes[i++]);
+        } else {
+            unsigned char run = 0;
+            while (i < planes.size() && planes[i] == 0 && run < 255) {
+                ++run;
+                ++i;
+            }
+            compressed.push_back(0);
+            compressed.push_back((char) run);
+        }
+    }
+
+    return compressed;
+}
+
+/**
+ * Reverses compress.
+ * @param data compressed bytes.
+ * @param size number of compressed bytes.
+ * @param n_values number of values compressed.
+ * @param bytes_per_value 4 or 8.
+ * @return bytes of the values.
+ */
+vector<char> SimulationOutputFile::decompress(const char *data, size_t size,
+                                              size_t n_values,
+                                              size_t bytes_per_value) {
+    vector<unsigned char> planes(n_values * bytes_per_value, 0);
+    size_t position = 0;
+    for (size_t i = 0; i < size && position < planes.size(); ++i) {
+        if (data[i] != 0)
+            planes[position++] = (unsigned char) data[i];
+        else if (i + 1 < size)
+            position += (unsigned char) data[++i];
+    }
+    if (position != planes.size())
+        throw invalid_argument("Corrupted column in simulation output "
+                               "file.");
+
+    vector<char> values(planes.size());
+    uint64_t previous = 0;
+    for (size_t i = 0; i < n_values; ++i) {
+        uint64_t delta = 0;
+        for (size_t b = 0; b < bytes_per_value; ++b)
+            delta |= (uint64_t) planes[b * n_values + i] << (8 * b);
+        uint64_t value = delta ^ previous;
+        previous = value;
+        memcpy(&values[i * bytes_per_value], &value, bytes_per_value);
+    }
+
+    return values;
+}
@@ -0,0 +1,152 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_SIMULATIONOUTPUTFILE_H
+#define TRIANGLEMODEL_SIMULATIONOUTPUTFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+/**
+ * Header of a binary simulation output file. The header is followed by the
+ * schema, of schema_size bytes, and by one chunk per realization. The index
+ * of chunks, with one SimulationOutputChunk per chunk, starts at byte
+ * index_offset.
+ *
+ * The schema has one tab-separated line per column with the column's group
+ * (Utilities, WaterSources or Policies), component id, component name and
+ * variable name. Chunks hold the weekly values of each column one column
+ * after the other, stored with data type dtype (one of the SERIES_*
+ * constants) and, if compression is XOR_RLE_COMPRESSION, compressed column
+ * by column.
+ */
+struct SimulationOutputFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t compression;
+    uint32_t week_step; /// Weeks between consecutive values of a column.
+    uint64_t n_columns;
+    uint64_t n_chunks;
+    uint64_t schema_size;
+    uint64_t index_offset;
+    uint64_t first_week; /// Week of the simulation of the first values.
+};
+
+struct SimulationOutputChunk {
+    uint64_t realization;
+    uint64_t n_weeks;
+    uint64_t offset; /// Byte offset of the chunk from the start of the file.
+    uint64_t size; /// Size of the chunk in bytes.
+};
+
+struct SimulationOutputColumn {
+    string group;
+    int component_id;
+    string component_name;
+    string variable;
+
+    string name() const;
+};
+
+/**
+ * Binary columnar file with the time series of the utilities, water sources
+ * and policies of all realizations of a run, replacing one csv file per
+ * realization and group of components. Values are written as they are
+ * stored instead of being formatted as text, and can be compressed with a
+ * lightweight lossless scheme (each value is XORed with the previous value
+ * of its column, the bytes of all values are grouped by position and runs
+ * of zero bytes are stored as their length), which shrinks series that
+ * change slowly or not at all.
+ *
+ * Files are written chunk by chunk with a Writer, and read or exported to
+ * csv one chunk at a time.
+ */
+class SimulationOutputFile {
+private:
+    SimulationOutputFileHeader header;
+    vector<SimulationOutputColumn> columns;
+    vector<SimulationOutputChunk> chunks;
+    ifstream input_file;
+    string file_name;
+
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t NO_COMPRESSION = 0;
+    static constexpr uint32_t XOR_RLE_COMPRESSION = 1;
+
+    /**
+     * Writes a simulation output file. Chunks can be encoded by several
+     * threads at once with encodeChunk and are then written in any order.
+     */
+    class Writer {
+    private:
+        SimulationOutputFileHeader header;
+        vector<SimulationOutputChunk> chunks;
+        ofstream output_file;
+        string file_name;
+
+    public:
+        Writer(const string &file_name,
+               const vector<SimulationOutputColumn> &columns, int dtype,
+               uint32_t compression, unsigned long first_week = 0,
+               unsigned long week_step = 1);
+
+        Writer(const Writer &writer) = delete;
+
+        Writer &operator=(const Writer &writer) = delete;
+
+        ~Writer();
+
+        vector<char> encodeChunk(const vector<vector<double>> &values) const;
+
+        void writeChunk(unsigned long realization, unsigned long n_weeks,
+                        const vector<char> &data);
+
+        void close();
+
+        unsigned long getBytesWritten() const;
+    };
+
+    SimulationOutputFile();
+
+    SimulationOutputFile(const SimulationOutputFile &output_file) = delete;
+
+    SimulationOutputFile &operator=(const SimulationOutputFile &output_file) =
+            delete;
+
+    void open(const string &file_name);
+
+    const SimulationOutputFileHeader &getHeader() const;
+
+    const vector<SimulationOutputColumn> &getColumns() const;
+
+    const vector<SimulationOutputChunk> &getChunks() const;
+
+    vector<vector<double>> readChunk(unsigned long chunk,
+                                     const vector<unsigned long> &
+                                     columns_to_read);
+
+    vector<unsigned long> selectColumns(const vector<string> &selectors) const;
+
+    static void exportCSV(const string &file_name,
+                          const vector<string> &selectors);
+
+    static int formatFromName(const string &name);
+
+    static vector<char> compress(const vector<char> &values,
+                                 size_t bytes_per_value);
+
+    static vector<char> decompress(const char *data, size_t size,
+                                   size_t n_values, size_t bytes_per_value);
+};
+
+
+#endif //TRIANGLEMODEL_SIMULATIONOUTPUTFILE_H
@@ -0,0 +1,180 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "TextWriter.h"
+
+/**
+ * @param flush_size number of bytes the buffer holds before being written
+ * to the file.
+ */
+TextWriter::TextWriter(unsigned long flush_size)
+        : buffer(flush_size + (flush_size >> 2)), flush_size(flush_size) {}
+
+TextWriter::~TextWriter() {
+    if (file) {
+        fwrite(buffer.data(), 1, used, file);
+        fclose(file);
+    }
+}
+
+/**
+ * Opens a file for writing, closing the previous one if still open.
+ * @param file_name
+ */
+void TextWriter::open(const string &file_name) {
+    close();
+    file = fopen(file_name.c_str(), "w");
+    if (!file) {
+        char error[512];
+        sprintf(error, "Could not open %s for writing.", file_name.c_str());
+        throw runtime_error(error);
+    }
+    // The buffer is already written in large blocks.
+    setvbuf(file, nullptr, _IONBF, 0);
+    this->file_name = file_name;
+    used = 0;
+}
+
+/**
+ * Writes what is left in the buffer and closes the file.
+ */
+void TextWriter::close() {
+    if (file) {
+        flush();
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void TextWriter::flush() {
+    if (used > 0 && fwrite(buffer.data(), 1, used, file) != used) {
+        char error[512];
+        sprintf(error, "Could not write to %s.", file_name.c_str());
+        throw runtime_error(error);
+    }
+    used = 0;
+}
+
+/**
+ * Prints values with the fewest significant digits that read back to the
+ * same values instead of the default six significant digits.
+ * @param round_trip
+ */
+void TextWriter::setRoundTrip(bool round_trip) {
+    TextWriter::round_trip = round_trip;
+}
+
+void TextWriter::write(const char *text) {
+    write(text, strlen(text));
+}
+
+void TextWriter::write(const char *text, unsigned long length) {
+    reserve(length);
+    memcpy(buffer.data() + used, text, length);
+    used += length;
+}
+
+void TextWriter::write(const string &text) {
+    write(text.c_str(), text.size());
+}
+
+/**
+ * Writes text right aligned in a field of width characters, as by setw.
+ * @param text
+ * @param width
+ */
+void TextWriter::writePadded(const string &text, int width) {
+    for (int i = (int) text.size(); i < width; ++i)
+        write(' ');
+    write(text);
+}
+
+void TextWriter::writeInteger(long value) {
+    format("%ld", value);
+}
+
+/**
+ * Writes an integer right aligned in a field of width characters, as by setw.
+ * @param value
+ * @param width
+ */
+void TextWriter::writeInteger(long value, int width) {
+    format("%*ld", width, value);
+}
+
+/**
+ * Writes a value as an ostream with default settings would.
+ * @param value
+ */
+void TextWriter::writeValue(double value) {
+    if (round_trip)
+        writeRoundTrip(value, 0);
+    else
+        format("%g", value);
+}
+
+/**
+ * Writes a value right aligned in a field of width characters, as an ostream
+ * would after setw(width) and setprecision(precision).
+ * @param value
+ * @param width
+ * @param precision
+ */
+void TextWriter::writeValue(double value, int width, int precision) {
+    if (round_trip)
+        writeRoundTrip(value, width);
+    else
+        format("%*.*g", width, precision, value);
+}
+
+/**
+ * Writes a value as to_string would, with six decimal places.
+ * @param value
+ */
+void TextWriter::writeFixed(double value) {
+    if (round_trip)
+        writeRoundTrip(value, 0);
+    else
+        format("%f", value);
+}
+
+void TextWriter::writeRoundTrip(double value, int width) {
+    char digits[32];
+    for (int precision = 15; precision <= 17; ++precision) {
+        snprintf(digits, sizeof(digits), "%.*g", precision, value);
+        if (strtod(digits, nullptr) == value)
+            break;
+    }
+    format("%*s", width, digits);
+}
+
+/**
+ * Removes the last character of the current line, if the line is not empty.
+ * @param line_start position of the start of the line, from getLineStart.
+ */
+void TextWriter::removeLastCharacter(unsigned long line_start) {
+    if (used > line_start)
+        used--;
+}
+
+/**
+ * Position in the buffer of what is written next, to be passed to
+ * removeLastCharacter at the end of the line.
+ * @return
+ */
+unsigned long TextWriter::getLineStart() const {
+    return used;
+}
+
+/**
+ * Ends the current line, writing the buffer to the file if full.
+ */
+void TextWriter::endLine() {
+    write('\n');
+    if (used >= flush_size)
+        flush();
+}
@@ -0,0 +1,108 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_TEXTWRITER_H
+#define TRIANGLEMODEL_TEXTWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Writes text output files through a large buffer that values are formatted
+ * straight into, instead of building a string or stringstream per line or
+ * value. The buffer is only written to the file when it holds more than
+ * flush_size bytes at the end of a line, or when the file is closed, so files
+ * are written with a few large writes. A writer can be reused for any number
+ * of files, one at a time, keeping its buffer.
+ *
+ * By default, values are formatted as by an ostream with its default
+ * settings (six significant digits), as by setw and setprecision, or as by
+ * to_string. If round_trip is set, values are instead printed with the
+ * fewest significant digits that read back to the exact same double.
+ */
+class TextWriter {
+private:
+    FILE *file = nullptr;
+    string file_name;
+    vector<char> buffer;
+    unsigned long used = 0;
+    unsigned long flush_size;
+    bool round_trip = false;
+
+    inline void reserve(unsigned long n_bytes) {
+        if (used + n_bytes > buffer.size())
+            buffer.resize(2 * (used + n_bytes));
+    }
+
+    /**
+     * Formats values straight into the end of the buffer, growing it if they
+     * do not fit.
+     */
+    template<typename... Values>
+    inline void format(const char *format_string, Values... values) {
+        unsigned long available = buffer.size() - used;
+        int n = snprintf(buffer.data() + used, available, format_string,
+                         values...);
+        if ((unsigned long) n >= available) {
+            reserve((unsigned long) n + 1);
+            snprintf(buffer.data() + used, buffer.size() - used,
+                     format_string, values...);
+        }
+        used += (unsigned long) n;
+    }
+
+    void flush();
+
+    void writeRoundTrip(double value, int width);
+
+public:
+    explicit TextWriter(unsigned long flush_size = 1 << 20);
+
+    TextWriter(const TextWriter &text_writer) = delete;
+
+    TextWriter &operator=(const TextWriter &text_writer) = delete;
+
+    ~TextWriter();
+
+    void open(const string &file_name);
+
+    void close();
+
+    void setRoundTrip(bool round_trip);
+
+    inline void write(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    void write(const char *text);
+
+    void write(const char *text, unsigned long length);
+
+    void write(const string &text);
+
+    void writePadded(const string &text, int width);
+
+    void writeInteger(long value);
+
+    void writeInteger(long value, int width);
+
+    void writeValue(double value);
+
+    void writeValue(double value, int width, int precision);
+
+    void writeFixed(double value);
+
+    void removeLastCharacter(unsigned long line_start);
+
+    unsigned long getLineStart() const;
+
+    void endLine();
+};
+
+
+#endif //TRIANGLEMODEL_TEXTWRITER_H
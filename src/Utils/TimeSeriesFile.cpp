@@ -0,0 +1,318 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include "TimeSeriesFile.h"
+#include "Utils.h"
+
+constexpr uint32_t TimeSeriesFile::VERSION;
+
+static const char TIME_SERIES_MAGIC[8] = {'W', 'P', 'S', 'E', 'R', 'I', 'E',
+                                          '\0'};
+
+TimeSeriesFile::TimeSeriesFile() = default;
+
+TimeSeriesFile::~TimeSeriesFile() {
+    close();
+}
+
+/**
+ * Size in bytes of the index and values of a file, padded to a multiple of
+ * 8 bytes.
+ * @param header
+ * @return size in bytes.
+ */
+size_t TimeSeriesFile::dataSize(const TimeSeriesFileHeader &header) {
+    size_t size = (header.n_rows + 1) * sizeof(uint64_t) +
+                  header.n_values * bytesPerValue((int) header.dtype);
+    return (size + 7) / 8 * 8;
+}
+
+/**
+ * Size in bytes of each value stored with a given data type.
+ * @param dtype
+ * @return size in bytes, or 0 if the data type is unknown.
+ */
+size_t TimeSeriesFile::bytesPerValue(int dtype) {
+    switch (dtype) {
+        case SERIES_FLOAT32:
+            return sizeof(float);
+        case SERIES_FLOAT64:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Data type corresponding to the name used in the command line.
+ * @param name "float32" or "float64".
+ * @return one of the SERIES_* data types.
+ */
+int TimeSeriesFile::dataTypeFromName(const string &name) {
+    if (name == "float32")
+        return SERIES_FLOAT32;
+    else if (name == "float64")
+        return SERIES_FLOAT64;
+
+    char error[256];
+    sprintf(error, "Unknown time series data type \"%s\". Valid types are "
+                   "\"float32\" and \"float64\".", name.c_str());
+    throw invalid_argument(error);
+}
+
+/**
+ * Name of the binary version of a csv file, which is the csv file name with
+ * extension .bin instead of .csv.
+ * @param csv_file_name
+ * @return binary file name.
+ */
+string TimeSeriesFile::binaryFileName(const string &csv_file_name) {
+    size_t extension = csv_file_name.rfind(".csv");
+    if (extension != string::npos && extension + 4 == csv_file_name.size())
+        return csv_file_name.substr(0, extension) + ".bin";
+    return csv_file_name + ".bin";
+}
+
+/**
+ * Memory maps a binary time series file read-only and checks its header
+ * and index.
+ * @param file_name
+ */
+void TimeSeriesFile::open(const string &file_name) {
+    close();
+    this->file_name = file_name;
+
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        char error[512];
+        sprintf(error, "Could not open time series file %s.",
+                file_name.c_str());
+        throw invalid_argument(error);
+    }
+
+    struct stat file_stat{};
+    fstat(fd, &file_stat);
+    if ((size_t) file_stat.st_size < sizeof(TimeSeriesFileHeader)) {
+        ::close(fd);
+        char error[512];
+        sprintf(error, "Time series file %s is too small to be a time series "
+                       "file.", file_name.c_str());
+        throw invalid_argument(error);
+    }
+
+    mapped_size = (size_t) file_stat.st_size;
+    mapped_data = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped_data == MAP_FAILED) {
+        mapped_data = nullptr;
+        mapped_size = 0;
+        char error[512];
+        sprintf(error, "Could not memory map time series file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+
+    memcpy(&header, mapped_data, sizeof(TimeSeriesFileHeader));
+    char error[512] = "";
+    if (memcmp(header.magic, TIME_SERIES_MAGIC,
+               sizeof(TIME_SERIES_MAGIC)) != 0) {
+        sprintf(error, "File %s is not a time series file.",
+                file_name.c_str());
+    } else if (header.version != VERSION) {
+        sprintf(error, "Time series file %s has version %u but version %u "
+                       "was expected.", file_name.c_str(), header.version,
+                VERSION);
+    } else if (bytesPerValue((int) header.dtype) == 0) {
+        sprintf(error, "Time series file %s has unknown data type %u.",
+                file_name.c_str(), header.dtype);
+    } else if (mapped_size != sizeof(TimeSeriesFileHeader) +
+                              dataSize(header)) {
+        sprintf(error, "Time series file %s has %lu bytes but its header "
+                       "indicates it should have %lu.", file_name.c_str(),
+                mapped_size, sizeof(TimeSeriesFileHeader) + dataSize(header));
+    } else {
+        auto index = (const uint64_t *) ((const char *) mapped_data +
+                                         sizeof(TimeSeriesFileHeader));
+        bool index_ok = index[0] == 0 && index[header.n_rows] ==
+                                         header.n_values;
+        for (uint64_t r = 0; r < header.n_rows && index_ok; ++r)
+            index_ok = index[r] <= index[r + 1];
+        if (!index_ok)
+            sprintf(error, "Time series file %s has a corrupted index.",
+                    file_name.c_str());
+    }
+
+    if (strlen(error) > 0) {
+        close();
+        throw invalid_argument(error);
+    }
+}
+
+void TimeSeriesFile::close() {
+    if (mapped_data != nullptr) {
+        munmap(mapped_data, mapped_size);
+        mapped_data = nullptr;
+        mapped_size = 0;
+    }
+}
+
+bool TimeSeriesFile::isOpen() const {
+    return mapped_data != nullptr;
+}
+
+const TimeSeriesFileHeader &TimeSeriesFile::getHeader() const {
+    return header;
+}
+
+/**
+ * Reads rows of the file, converted to double, with the same arguments and
+ * results as Utils::parse2DCsvFile on the csv file the binary file was
+ * converted from. Only the requested rows are read from the file.
+ * @param max_lines
+ * @param rows_to_read
+ * @return rows.
+ */
+vector<vector<double>> TimeSeriesFile::getRows(
+        unsigned long max_lines,
+        const vector<unsigned long> &rows_to_read) const {
+    vector<unsigned long> rows = rows_to_read;
+    if (rows.empty()) {
+        // Utils::parse2DCsvFile reads up to max_lines + 2 lines.
+        rows.resize(min(header.n_rows, (uint64_t) max_lines + 2));
+        iota(rows.begin(), rows.end(), 0);
+    }
+    for (unsigned long r : rows) {
+        if (r >= header.n_rows) {
+            char error[512];
+            sprintf(error, "Row %lu was requested from time series file %s, "
+                           "which has %lu rows.", r, file_name.c_str(),
+                    header.n_rows);
+            throw invalid_argument(error);
+        }
+    }
+
+    auto index = (const uint64_t *) ((const char *) mapped_data +
+                                     sizeof(TimeSeriesFileHeader));
+    auto values = (const char *) (index + header.n_rows + 1);
+    vector<vector<double>> data(rows.size());
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < (long) rows.size(); ++i) {
+        uint64_t begin = index[rows[i]];
+        uint64_t length = index[rows[i] + 1] - begin;
+        data[i].resize(length);
+        if (header.dtype == SERIES_FLOAT32) {
+            auto row = (const float *) values + begin;
+            for (uint64_t w = 0; w < length; ++w)
+                data[i][w] = row[w];
+        } else {
+            memcpy(data[i].data(), (const double *) values + begin,
+                   length * sizeof(double));
+        }
+    }
+
+    return data;
+}
+
+/**
+ * Reads rows of a csv file of time series, from its binary version if there
+ * is one that is not older than the csv file.
+ * @param csv_file_name
+ * @param max_lines
+ * @param rows_to_read
+ * @return rows.
+ */
+vector<vector<double>> TimeSeriesFile::load(
+        const string &csv_file_name, unsigned long max_lines,
+        const vector<unsigned long> &rows_to_read) {
+    string binary_file_name = binaryFileName(csv_file_name);
+    struct stat binary_stat{}, csv_stat{};
+    if (stat(binary_file_name.c_str(), &binary_stat) == 0) {
+        if (stat(csv_file_name.c_str(), &csv_stat) != 0 ||
+            csv_stat.st_mtime <= binary_stat.st_mtime) {
+            TimeSeriesFile time_series_file;
+            time_series_file.open(binary_file_name);
+            return time_series_file.getRows(max_lines, rows_to_read);
+        }
+        printf("Binary file %s is older than %s and will not be used.\n",
+               binary_file_name.c_str(), csv_file_name.c_str());
+    }
+
+    return Utils::parse2DCsvFile(csv_file_name, max_lines, rows_to_read);
+}
+
+/**
+ * Writes rows of time series into a binary time series file.
+ * @param file_name
+ * @param rows
+ * @param dtype data type in which values will be stored.
+ */
+void TimeSeriesFile::write(const string &file_name,
+                           const vector<vector<double>> &rows, int dtype) {
+    if (bytesPerValue(dtype) == 0) {
+        char error[128];
+        sprintf(error, "Unknown time series data type %d.", dtype);
+        throw invalid_argument(error);
+    }
+
+    TimeSeriesFileHeader header{};
+    memcpy(header.magic, TIME_SERIES_MAGIC, sizeof(TIME_SERIES_MAGIC));
+    header.version = VERSION;
+    header.dtype = (uint32_t) dtype;
+    header.n_rows = rows.size();
+
+    vector<uint64_t> index(1, 0);
+    for (auto &row : rows)
+        index.push_back(index.back() + row.size());
+    header.n_values = index.back();
+
+    ofstream output_file(file_name, ios::binary | ios::trunc);
+    output_file.write((const char *) &header, sizeof(header));
+    output_file.write((const char *) index.data(),
+                      index.size() * sizeof(uint64_t));
+    for (auto &row : rows) {
+        if (dtype == SERIES_FLOAT32) {
+            vector<float> row_float(row.begin(), row.end());
+            output_file.write((const char *) row_float.data(),
+                              row_float.size() * sizeof(float));
+        } else {
+            output_file.write((const char *) row.data(),
+                              row.size() * sizeof(double));
+        }
+    }
+    size_t padding = sizeof(header) + dataSize(header) -
+                     (size_t) output_file.tellp();
+    output_file.write("\0\0\0\0\0\0\0", padding);
+
+    if (!output_file) {
+        char error[512];
+        sprintf(error, "Could not write time series file %s.",
+                file_name.c_str());
+        throw runtime_error(error);
+    }
+}
+
+/**
+ * Converts a csv file of time series into its binary version, which is
+ * written next to it and used instead of it by load. Since csv files are
+ * parsed with single precision, float32 files hold the exact same values.
+ * @param csv_file_name
+ * @param dtype data type in which values will be stored.
+ */
+void TimeSeriesFile::convertCSVFile(const string &csv_file_name, int dtype) {
+    auto rows = Utils::parse2DCsvFile(csv_file_name);
+    string file_name = binaryFileName(csv_file_name);
+    write(file_name, rows, dtype);
+
+    printf("Converted %lu rows of %s into %s.\n", rows.size(),
+           csv_file_name.c_str(), file_name.c_str());
+}
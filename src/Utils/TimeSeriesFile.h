@@ -0,0 +1,92 @@
+//
+// Created by bernardo on 10/16/26.
+//
+
+#ifndef TRIANGLEMODEL_TIMESERIESFILE_H
+#define TRIANGLEMODEL_TIMESERIESFILE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Constants.h"
+
+using namespace std;
+using namespace Constants;
+
+/**
+ * Header of a binary time series file. The header is followed by an index
+ * of n_rows + 1 offsets, in number of values, of the beginning of each row
+ * (the last one being the total number of values), and then by the values
+ * of all rows one after the other, stored with data type dtype (one of the
+ * SERIES_* constants). Rows are realizations, so each realization's series
+ * is contiguous and can be read without reading the others.
+ */
+struct TimeSeriesFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t n_rows;
+    uint64_t n_values;
+};
+
+/**
+ * Binary version of the csv files with ensembles of streamflow, evaporation
+ * and demand series. Files are memory mapped read-only and the rows to be
+ * loaded are converted to double by several threads at once, instead of
+ * being parsed line by line.
+ */
+class TimeSeriesFile {
+private:
+    TimeSeriesFileHeader header;
+    void *mapped_data = nullptr;
+    size_t mapped_size = 0;
+    string file_name;
+
+    static size_t dataSize(const TimeSeriesFileHeader &header);
+
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    TimeSeriesFile();
+
+    TimeSeriesFile(const TimeSeriesFile &time_series_file) = delete;
+
+    TimeSeriesFile &operator=(const TimeSeriesFile &time_series_file) = delete;
+
+    ~TimeSeriesFile();
+
+    void open(const string &file_name);
+
+    void close();
+
+    bool isOpen() const;
+
+    const TimeSeriesFileHeader &getHeader() const;
+
+    vector<vector<double>> getRows(
+            unsigned long max_lines = 10000000,
+            const vector<unsigned long> &rows_to_read =
+                    vector<unsigned long>()) const;
+
+    static vector<vector<double>> load(
+            const string &csv_file_name, unsigned long max_lines = 10000000,
+            const vector<unsigned long> &rows_to_read =
+                    vector<unsigned long>());
+
+    static void write(const string &file_name,
+                      const vector<vector<double>> &rows,
+                      int dtype = SERIES_FLOAT32);
+
+    static void convertCSVFile(const string &csv_file_name,
+                               int dtype = SERIES_FLOAT32);
+
+    static string binaryFileName(const string &csv_file_name);
+
+    static int dataTypeFromName(const string &name);
+
+    static size_t bytesPerValue(int dtype);
+};
+
+
+#endif //TRIANGLEMODEL_TIMESERIESFILE_H
@@ -21,6 +21,7 @@
 #include "../SystemComponents/Bonds/BalloonPaymentBond.h"
 #include "../SystemComponents/Bonds/FloatingInterestBalloonPaymentBond.h"
 #include "../SystemComponents/WaterSources/JointTreatmentCapacityExpansion.h"
+#include "CsvFile.h"
 #include <fstream>
 #include <algorithm>
 #include <climits>
@@ -36,101 +37,12 @@
  */
 vector<vector<double>> Utils::parse2DCsvFile(string file_name, unsigned long max_lines,
                                              vector<unsigned long> rows_to_read) {
-
-    vector<vector<double> > data;
-    ifstream inputFile(file_name);
-    int l = -1;
-    int ml = (int) (rows_to_read.empty() ? max_lines : *max_element(
-                            rows_to_read.begin(), rows_to_read.end())) + 1;
-//    if (!rows_to_read.empty())
-//        ml = max_lines;
-//    else
-//        ml = *max_element(rows_to_read.begin(), rows_to_read.end());
-    if (inputFile.is_open()) {
-        while (inputFile && l < ml) {
-            l++;
-            string s;
-            if (!getline(inputFile, s)) break;
-	    if (s.find(" ") != string::npos) {
-		char error[500];
-		sprintf(error, "File %s seems to be space-separated.", file_name.c_str());
-	        throw std::invalid_argument(error);
-	    }
-
-            vector<double> record;
-            if (s[0] != '#' &&
-                (rows_to_read.empty() ||
-                 std::find(rows_to_read.begin(), rows_to_read.end(), l)
-                 != rows_to_read.end())) {
-                istringstream ss(s);
-
-                int c = 0;
-                while (ss) {
-                    string line;
-                    if (!getline(ss, line, ','))
-                        break;
-                    try {
-                        record.push_back(stof(line));
-                    } catch (const std::invalid_argument e) {
-                        cout << "NaN found in file " << file_name << " line "
-                             << l << " column " << c << endl;
-                        e.what();
-                    }
-                    c++;
-                }
-            }
-            data.push_back(record);
-        }
-    } else {
-	string error = "File " + file_name + " not found.";
-	char error_char[error.size() + 1];
-	strcpy(error_char, error.c_str());
-        throw invalid_argument(error_char);
-    }
-
-    if (rows_to_read.empty())
-        return data;
-    else {
-        vector<vector<double>> return_data;
-        for (int i : rows_to_read)
-            return_data.push_back(data[i]);
-        return return_data;
-    }
+    return CsvFile::parse2D(file_name, max_lines, rows_to_read);
 }
 
 vector<double> Utils::parse1DCsvFile(string file_name, unsigned long max_lines,
                                      vector<unsigned long> rows_to_read) {
-    vector<double> data;
-    ifstream infile(file_name);
-    unsigned long l = 0;
-
-    while (infile && l < max_lines) {
-        l++;
-        string s;
-        if (!getline(infile, s)) break;
-        if (s[0] != '#' && (rows_to_read.empty() || (!rows_to_read.empty() && l - 1 == rows_to_read[0]))) {
-
-            istringstream ss(s);
-            double record;
-
-            try {
-                record = stof(ss.str());
-                data.push_back(record);
-            } catch (const std::invalid_argument e) {
-                cout << "NaN found in file " << file_name << " line " << l << endl;
-                e.what();
-            }
-            if (!rows_to_read.empty())// && rows_to_read[0] != NON_INITIALIZED) 
-		    rows_to_read.erase(rows_to_read.begin());
-        }
-    }
-
-    if (!infile.eof() && l < max_lines) {
-        cerr << "Could not read file " << file_name << "\n";
-        throw invalid_argument("File not found.");
-    }
-
-    return data;
+    return CsvFile::parse1D(file_name, max_lines, rows_to_read);
 }
 
 vector<MinEnvFlowControl *> Utils::copyMinEnvFlowControlVector(
@@ -278,6 +190,22 @@ int Utils::weekOfTheYear(int week) {
     return WEEK_OF_YEAR[week];
 }
 
+/**
+ * Year a week belongs to for the reliability and restriction frequency
+ * objectives, in which year y spans weeks round(y * WEEKS_IN_YEAR) to
+ * round((y + 1) * WEEKS_IN_YEAR) - 1.
+ * @param week
+ * @return
+ */
+int Utils::objectivesYearOfWeek(int week) {
+    int year = (int) (week / WEEKS_IN_YEAR);
+    while ((int) round((year + 1) * WEEKS_IN_YEAR) <= week)
+        year++;
+    while (year > 0 && (int) round(year * WEEKS_IN_YEAR) > week)
+        year--;
+    return year;
+}
+
 void Utils::removeIntFromVector(vector<int>& vec, int el) {
 
     auto vbeg = vec.begin();
@@ -61,6 +61,8 @@ public:
 
     static int weekOfTheYear(int week);
 
+    static int objectivesYearOfWeek(int week);
+
     static void removeIntFromVector(vector<int> &vec, int el);
 
     static void print_exception(const exception &e, int level = 0);
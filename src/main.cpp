@@ -4,6 +4,9 @@
 #include "Problem/PaperTestProblem.h"
 #include "InputFileParser/MasterSystemInputFileParser.h"
 #include "Problem/InputFileProblem.h"
+#include "Utils/ROFTablesFile.h"
+#include "Utils/TimeSeriesFile.h"
+#include "Utils/SimulationOutputFile.h"
 
 #ifdef  PARALLEL
 #include <mpi.h>
@@ -12,6 +15,7 @@
 #include <algorithm>
 #include <getopt.h>
 #include <fstream>
+#include <sstream>
 
 #ifdef PROFILE
 #include </opt/ohpc/pub/utils/valgrind/3.15.0/include/valgrind/callgrind.h>
@@ -67,6 +71,30 @@ int main(int argc, char *argv[]) {
     bool plotting = true;
     bool run_optimization = false;
     bool print_objs_row = false;
+    bool convert_rof_tables = false;
+    bool convert_rof_tables_to_breakpoints = false;
+    int n_rof_tables_shards_to_merge = 0;
+    bool distributed_rof_tables = false;
+    int rof_tables_dtype = ROF_TABLE_FLOAT64;
+    int rof_tables_io_threads = 1;
+    unsigned long rof_tables_queue_depth = 4;
+    vector<string> series_files_to_convert;
+    int series_dtype = SERIES_FLOAT32;
+    unsigned long long_term_rof_cache_size = 0;
+    string long_term_rof_cache_spill_file;
+    int adaptive_rof_batch_size = 0;
+    double adaptive_rof_confidence = 0.99;
+    bool adaptive_rof_validation = false;
+    bool storage_bound_rof = false;
+    bool storage_bound_rof_validation = false;
+    int insurance_trajectory_reuse_years = 0;
+    bool insurance_trajectory_reuse_validation = false;
+    bool scalar_rof_years = false;
+    bool objectives_only_collection = false;
+    bool single_precision_time_series = false;
+    int time_series_format = NON_INITIALIZED;
+    string simulation_output_to_export;
+    string output_specification;
     unsigned long n_islands = 2;
     unsigned long nfe = 1000;
     unsigned long output_frequency = 200;
@@ -79,10 +107,18 @@ int main(int argc, char *argv[]) {
     vector<vector<double>> water_sources_rdm;
     vector<vector<double>> policies_rdm;
 
+    // Options without a letter, numbered past all option characters.
+    const int OUTPUT_SPECIFICATION_OPTION = 256;
+    const struct option long_options[] = {
+            {"output-spec", required_argument, nullptr,
+             OUTPUT_SPECIFICATION_OPTION},
+            {nullptr, 0, nullptr, 0}
+    };
+
     int c;
-    while ((c = getopt(argc, argv,
-                       "?s:u:T:r:t:d:f:l:m:v:c:p:b:i:n:o:e:y:S:A:R:U:P:W:I:C:O:B:")) !=
-           -1) {
+    while ((c = getopt_long(argc, argv,
+                            "?s:u:T:r:t:d:f:l:m:v:c:p:b:i:n:o:e:y:S:A:R:U:P:W:I:C:O:B:FMQ:E:N:Yq:X:D:L:K:G:Z:VHJa:kxjgw:z:",
+                            long_options, nullptr)) != -1) {
         switch (c) {
             case '?':
                 fprintf(stdout,
@@ -122,6 +158,78 @@ int main(int argc, char *argv[]) {
                         "ROF table binaries\n"
                         "\t-C: Import/export rof tables (1: export, 0:"
                         " do nothing (standard), -1: import)\n"
+                        "\t-F: Convert the ROF table csv files of the first -r "
+                        "realizations in the -O directory into a single "
+                        "binary file that is imported much faster, and exit\n"
+                        "\t-Q: Data type of exported or converted ROF tables "
+                        "(float64 (standard), uint8, float16 or breakpoints). "
+                        "uint8 and float16 tables take 8 and 4 times less "
+                        "memory, and breakpoint tables, which only store the "
+                        "tiers at which ROFs change, usually tens of times "
+                        "less\n"
+                        "\t-M: Convert the binary ROF tables file in the -O "
+                        "directory into breakpoint tables, keeping the dense "
+                        "tables in rof_tables_dense.bin, print the "
+                        "compression ratio and exit\n"
+                        "\t-E: Number of threads writing exported ROF tables "
+                        "in the background (1 by default)\n"
+                        "\t-N: Number of realizations whose exported ROF "
+                        "tables can wait to be written before simulation "
+                        "threads wait for them (4 by default)\n"
+                        "\t-Y: Split the generation of ROF tables across MPI "
+                        "ranks, rank 0 merging the tables of all ranks into "
+                        "a single file described in rof_tables_manifest.csv\n"
+                        "\t-q: Merge this many ROF tables shards in the -O "
+                        "directory, generated with rof_tables_shard and "
+                        "rof_tables_n_shards, into a single file and exit\n"
+                        "\t-X: Convert a csv file with streamflow, evaporation "
+                        "or demand series into a binary file with extension "
+                        ".bin, which is loaded instead of the csv file, and "
+                        "exit. Can be passed more than once\n"
+                        "\t-D: Data type of converted series (float32 "
+                        "(standard, exact for csv files) or float64)\n"
+                        "\t-L: Number of long-term ROF calculations to cache "
+                        "in memory and reuse across solutions (0)\n"
+                        "\t-K: File to cache long-term ROF calculations "
+                        "beyond -L in\n"
+                        "\t-G: Run short-term ROF years in batches of this "
+                        "size, stopping once ROFs are settled relative to "
+                        "all policy triggers (0: always run all years)\n"
+                        "\t-Z: Confidence with which -G ROFs must be on the "
+                        "right side of triggers (0.99)\n"
+                        "\t-V: Also run all ROF years with -G and report how "
+                        "often decisions would have differed\n"
+                        "\t-H: Skip short-term ROF calculations that storage "
+                        "bounds prove to be zero\n"
+                        "\t-J: Also run all ROF years with -H and check them "
+                        "against the bound\n"
+                        "\t-a: Reuse ROF-year storage trajectories for this "
+                        "many years when pricing insurance (0: simulate all "
+                        "years in every pricing)\n"
+                        "\t-k: Also price insurance simulating all years with "
+                        "-a, use those prices and report the difference\n"
+                        "\t-x: Run ROF years one at a time instead of all at "
+                        "once\n"
+                        "\t-j: Collect only the data needed for objectives, "
+                        "without time series (always the case when "
+                        "optimizing)\n"
+                        "\t-g: Store time series in single precision\n"
+                        "\t-w: Format of printed time series (csv "
+                        "(standard), csv_round_trip, binary or "
+                        "binary_compressed). csv_round_trip prints values "
+                        "with all digits needed to read them back exactly "
+                        "and binary time series of all realizations are "
+                        "printed into a single file\n"
+                        "\t-z: Export columns of a binary time series file "
+                        "into a csv file with the same name and exit, as "
+                        "file.bin or file.bin:column,... (columns can be "
+                        "given as Utilities.0st_vol, 0st_vol, st_vol or "
+                        "Utilities)\n"
+                        "\t--output-spec: Time series to record, as clauses "
+                        "separated by ';' or spaces (e.g. "
+                        "components=Utilities,WaterSources.3 "
+                        "variables=st_vol,st_rof weeks=0-519 "
+                        "realizations=0-9,20 every=4)\n"
                         "\t-B: Export objectives for all utilities on a single "
                         "line",
                         argv[0], n_realizations, n_weeks, system_io.c_str());
@@ -207,12 +315,128 @@ int main(int argc, char *argv[]) {
             case 'O':
                 rof_tables_directory = optarg;
                 break;
+            case 'F':
+                convert_rof_tables = true;
+                break;
+            case 'Q':
+                rof_tables_dtype = ROFTablesFile::dataTypeFromName(optarg);
+                break;
+            case 'E':
+                rof_tables_io_threads = atoi(optarg);
+                break;
+            case 'N':
+                rof_tables_queue_depth = (unsigned long) atol(optarg);
+                break;
+            case 'Y':
+                distributed_rof_tables = true;
+                break;
+            case 'q':
+                n_rof_tables_shards_to_merge = atoi(optarg);
+                break;
+            case 'M':
+                convert_rof_tables_to_breakpoints = true;
+                break;
+            case 'X':
+                series_files_to_convert.emplace_back(optarg);
+                break;
+            case 'D':
+                series_dtype = TimeSeriesFile::dataTypeFromName(optarg);
+                break;
+            case 'L':
+                long_term_rof_cache_size = (unsigned long) atol(optarg);
+                break;
+            case 'K':
+                long_term_rof_cache_spill_file = optarg;
+                break;
+            case 'G':
+                adaptive_rof_batch_size = atoi(optarg);
+                break;
+            case 'Z':
+                adaptive_rof_confidence = atof(optarg);
+                break;
+            case 'V':
+                adaptive_rof_validation = true;
+                break;
+            case 'H':
+                storage_bound_rof = true;
+                break;
+            case 'J':
+                storage_bound_rof_validation = true;
+                break;
+            case 'a':
+                insurance_trajectory_reuse_years = atoi(optarg);
+                break;
+            case 'k':
+                insurance_trajectory_reuse_validation = true;
+                break;
+            case 'x':
+                scalar_rof_years = true;
+                break;
+            case 'j':
+                objectives_only_collection = true;
+                break;
+            case 'g':
+                single_precision_time_series = true;
+                break;
+            case 'w':
+                time_series_format =
+                        SimulationOutputFile::formatFromName(optarg);
+                break;
+            case 'z':
+                simulation_output_to_export = optarg;
+                break;
+            case OUTPUT_SPECIFICATION_OPTION:
+                output_specification = optarg;
+                break;
             default:
                 fprintf(stderr, "Unknown option (-%c)\n", c);
                 return -1;
         }
     }
 
+    if (!simulation_output_to_export.empty()) {
+        // Columns to export follow the last ':' after the directories.
+        string file_name = simulation_output_to_export;
+        vector<string> selectors;
+        size_t separator = file_name.rfind(':');
+        if (separator != string::npos &&
+            (file_name.rfind('/') == string::npos ||
+             separator > file_name.rfind('/'))) {
+            stringstream columns(file_name.substr(separator + 1));
+            string selector;
+            while (getline(columns, selector, ','))
+                if (!selector.empty())
+                    selectors.push_back(selector);
+            file_name = file_name.substr(0, separator);
+        }
+        SimulationOutputFile::exportCSV(file_name, selectors);
+        return 0;
+    }
+
+    if (!series_files_to_convert.empty()) {
+        for (auto &file_name : series_files_to_convert)
+            TimeSeriesFile::convertCSVFile(file_name, series_dtype);
+        return 0;
+    }
+
+    if (convert_rof_tables) {
+        ROFTablesFile::convertCSVTables(rof_tables_directory, n_realizations,
+                                        rof_tables_dtype);
+        return 0;
+    }
+
+    if (n_rof_tables_shards_to_merge > 0) {
+        ROFTablesFile::mergeShards(rof_tables_directory,
+                                   n_rof_tables_shards_to_merge,
+                                   rof_tables_dtype == ROF_TABLE_BREAKPOINTS);
+        return 0;
+    }
+
+    if (convert_rof_tables_to_breakpoints) {
+        ROFTablesFile::convertToBreakpoints(rof_tables_directory);
+        return 0;
+    }
+
     if (!system_input_file.empty()) {
         problem_ptr = new InputFileProblem(system_input_file);
 
@@ -244,6 +468,36 @@ int main(int argc, char *argv[]) {
                                            n_sets, n_bs_samples, solution_file,
                                            solutions_to_run_range, plotting,
                                            print_objs_row);
+        problem_ptr->setRofTablesDataType(rof_tables_dtype);
+        problem_ptr->setRofTablesWriter(rof_tables_io_threads,
+                                        rof_tables_queue_depth);
+        if (distributed_rof_tables)
+            problem_ptr->setDistributedRofTables();
+        if (long_term_rof_cache_size > 0 ||
+            !long_term_rof_cache_spill_file.empty())
+            problem_ptr->setLongTermROFCache(long_term_rof_cache_size,
+                                             long_term_rof_cache_spill_file);
+        if (adaptive_rof_batch_size > 0)
+            problem_ptr->setAdaptiveROFSampling(adaptive_rof_batch_size,
+                                                adaptive_rof_confidence,
+                                                adaptive_rof_validation);
+        if (storage_bound_rof)
+            problem_ptr->setStorageBoundROF(storage_bound_rof_validation);
+        if (insurance_trajectory_reuse_years > 0)
+            problem_ptr->setInsurancePricing(
+                    insurance_trajectory_reuse_years,
+                    insurance_trajectory_reuse_validation);
+        if (scalar_rof_years)
+            problem_ptr->setScalarROFYears();
+        if (objectives_only_collection || run_optimization)
+            problem_ptr->setObjectivesOnlyCollection();
+        if (single_precision_time_series)
+            problem_ptr->setSinglePrecisionTimeSeries();
+        if (time_series_format != NON_INITIALIZED)
+            problem_ptr->setTimeSeriesFormat(time_series_format);
+        if (!output_specification.empty())
+            problem_ptr->setOutputSpecification(
+                    OutputSpecification(output_specification));
     }
 
     // If Borg is not called, run in simulation mode
@@ -257,6 +511,13 @@ int main(int argc, char *argv[]) {
 #ifdef PROFILE
 	CALLGRIND_STOP_INSTRUMENTATION;
 #endif
+#ifdef  PARALLEL
+        // Set up by distributed ROF tables generation, if used.
+        int mpi_initialized;
+        MPI_Initialized(&mpi_initialized);
+        if (mpi_initialized)
+            MPI_Finalize();
+#endif
 
         return 0;
     } else {